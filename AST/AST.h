@@ -39,6 +39,7 @@ FOUNDATION_EXPORT const unsigned char ASTVersionString[];
 #import <AST/ASTViewController.h>
 #import <AST/ASTItem.h>
 #import <AST/ASTItemSubclass.h>
+#import <AST/ASTItemTemplate.h>
 #import <AST/ASTSection.h>
 #import <AST/ASTSectionSubclass.h>
 #import <AST/ASTMultiValueItem.h>
@@ -49,3 +50,9 @@ FOUNDATION_EXPORT const unsigned char ASTVersionString[];
 #import <AST/ASTMultiValuePrefItem.h>
 #import <AST/ASTPrefGroupItem.h>
 #import <AST/ASTPrefSwitchItem.h>
+#import <AST/ASTTableDefinition.h>
+#import <AST/ASTSortedObjectsController.h>
+#import <AST/ASTPreferenceStore.h>
+#import <AST/ASTImageLoader.h>
+#import <AST/ASTPerformanceMetrics.h>
+#import <AST/ASTSorting.h>
@@ -0,0 +1,89 @@
+//==============================================================================
+//
+//  ASTCellPool.h
+//
+//==============================================================================
+//
+//  Copyright (c) 2016 Adobe Systems Incorporated. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a
+//  copy of this software and associated documentation files (the "Software"),
+//  to deal in the Software without restriction, including without limitation
+//  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//  and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//
+//==============================================================================
+
+// This is private to the framework. Items and the table view controller use
+// it to share cells when the table view controller reuses cells.
+
+#import <UIKit/UIKit.h>
+
+#import "ASTViewController.h"
+
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class ASTItem;
+
+//------------------------------------------------------------------------------
+
+@interface ASTCellPool : NSObject
+
+/// The number of cells waiting in the pool to be bound to an item.
+@property (readonly,nonatomic) NSUInteger pooledCellCount;
+
+/// Returns a cell from the pool that was created with the class and style or
+/// nil if there is no such cell. The cell has been sent prepareForReuse.
+- (nullable UITableViewCell*) dequeueCellWithClass: (Class) cellClass
+		style: (UITableViewCellStyle) style;
+
+/// Makes the item the owner of the cell. Any cell properties of a previous
+/// owner that the item does not have are reset to the values a new cell has.
+/// The item must already hold the cell.
+- (void) bindCell: (UITableViewCell*) cell toItem: (ASTItem*) item;
+/// Returns the item the cell is bound to or nil.
+- (nullable ASTItem*) itemForCell: (UITableViewCell*) cell;
+/// Removes the owner of the cell. The cell properties of the owner are
+/// remembered so they can be reset when the cell is bound again. If the item
+/// is nil the current owner is used.
+- (void) unbindCell: (UITableViewCell*) cell fromItem: (nullable ASTItem*) item;
+
+/// Must be called when a cell property is applied to a bound cell so the
+/// property can be reset when the cell is bound to another item.
+- (void) willApplyCellPropertyForKeyPath: (NSString*) keyPath
+		toCell: (UITableViewCell*) cell;
+
+/// Unbinds the cell and puts it in the pool. Cells with a reuse identifier are
+/// owned by the table view reuse queue and are only unbound.
+- (void) enqueueCell: (UITableViewCell*) cell;
+
+/// Releases all of the cells waiting in the pool.
+- (void) removeAllCells;
+
+@end
+
+//------------------------------------------------------------------------------
+
+@interface ASTViewController( ASTCellPool )
+
+/// The pool shared by the items when reusesCells is YES, otherwise nil.
+@property (readonly,nullable,nonatomic) ASTCellPool* cellPool;
+
+@end
+
+//------------------------------------------------------------------------------
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,262 @@
+//==============================================================================
+//
+//  ASTCellPool.m
+//
+//==============================================================================
+//
+//  Copyright (c) 2016 Adobe Systems Incorporated. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a
+//  copy of this software and associated documentation files (the "Software"),
+//  to deal in the Software without restriction, including without limitation
+//  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//  and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//
+//==============================================================================
+
+#import "ASTCellPool.h"
+
+#import "ASTItem.h"
+#import "ASTItemSubclass.h"
+
+
+//------------------------------------------------------------------------------
+
+static NSString* poolKey( Class cellClass, UITableViewCellStyle style,
+		NSString* reuseIdentifier )
+{
+	return [ NSString stringWithFormat: @"%@:%ld:%@", NSStringFromClass( cellClass ),
+			(long)style, reuseIdentifier ?: @"" ];
+}
+
+//------------------------------------------------------------------------------
+
+static BOOL objectHasValueForKey( id object, NSString* key )
+{
+	if( key.length == 0 ) {
+		return NO;
+	}
+	if( [ object respondsToSelector: NSSelectorFromString( key ) ] ) {
+		return YES;
+	}
+	NSString* isKey = [ NSString stringWithFormat: @"is%@%@",
+			[ [ key substringToIndex: 1 ] uppercaseString ],
+			[ key substringFromIndex: 1 ] ];
+	return [ object respondsToSelector: NSSelectorFromString( isKey ) ];
+}
+
+//------------------------------------------------------------------------------
+
+// Reads the value of a cell property from a cell. Keypaths that invoke
+// selectors or that have no getter can not be read and are reset to nil.
+
+static id cellPropertyValue( UITableViewCell* cell, NSString* keyPath )
+{
+	NSString* remainder = [ keyPath substringFromIndex: AST_cellPropertiesKeyPathPrefix.length ];
+	id currentTarget = cell;
+	for( NSString* component in [ remainder componentsSeparatedByString: @"." ] ) {
+		if( [ component hasPrefix: @"-" ] || objectHasValueForKey( currentTarget, component ) == NO ) {
+			return [ NSNull null ];
+		}
+		currentTarget = [ currentTarget valueForKey: component ];
+	}
+	return currentTarget ?: [ NSNull null ];
+}
+
+//------------------------------------------------------------------------------
+
+@interface ASTCellPool() {
+	NSMutableDictionary* _queues;
+	NSHashTable* _pooledCells;
+	NSMapTable* _cellItems;
+	NSMapTable* _cellKeys;
+	NSMapTable* _cellAppliedKeyPaths;
+	NSMutableDictionary* _templateCells;
+	NSMutableDictionary* _defaultValues;
+}
+
+@end
+
+//------------------------------------------------------------------------------
+
+@implementation ASTCellPool
+
+//------------------------------------------------------------------------------
+
+- (instancetype) init
+{
+	self = [ super init ];
+	if( self ) {
+		_queues = [ NSMutableDictionary dictionary ];
+		_pooledCells = [ NSHashTable weakObjectsHashTable ];
+		_cellItems = [ NSMapTable weakToWeakObjectsMapTable ];
+		_cellKeys = [ NSMapTable weakToStrongObjectsMapTable ];
+		_cellAppliedKeyPaths = [ NSMapTable weakToStrongObjectsMapTable ];
+		_templateCells = [ NSMutableDictionary dictionary ];
+		_defaultValues = [ NSMutableDictionary dictionary ];
+	}
+	return self;
+}
+
+//------------------------------------------------------------------------------
+
+- (NSUInteger) pooledCellCount
+{
+	NSUInteger result = 0;
+	for( NSString* key in _queues ) {
+		result += [ _queues[ key ] count ];
+	}
+	return result;
+}
+
+//------------------------------------------------------------------------------
+
+- (UITableViewCell*) dequeueCellWithClass: (Class) cellClass
+		style: (UITableViewCellStyle) style
+{
+	NSMutableArray* queue = _queues[ poolKey( cellClass, style, nil ) ];
+	UITableViewCell* cell = queue.lastObject;
+	if( cell ) {
+		[ queue removeLastObject ];
+		[ _pooledCells removeObject: cell ];
+		[ cell prepareForReuse ];
+	}
+	return cell;
+}
+
+//------------------------------------------------------------------------------
+
+- (void) bindCell: (UITableViewCell*) cell toItem: (ASTItem*) item
+{
+	NSParameterAssert( cell );
+	NSParameterAssert( item.cellLoaded && item.cell == cell );
+	
+	[ _cellItems setObject: item forKey: cell ];
+	NSString* key = [ _cellKeys objectForKey: cell ];
+	if( key == nil ) {
+		key = poolKey( item.cellClass, item.cellStyle, cell.reuseIdentifier );
+		[ _cellKeys setObject: key forKey: cell ];
+	}
+	
+	NSMutableSet* appliedKeyPaths = [ _cellAppliedKeyPaths objectForKey: cell ];
+	if( appliedKeyPaths == nil ) {
+		[ _cellAppliedKeyPaths setObject: [ NSMutableSet set ] forKey: cell ];
+		return;
+	}
+	
+	NSDictionary* cellProperties = item.cellProperties;
+	for( NSString* keyPath in [ appliedKeyPaths copy ] ) {
+		if( cellProperties[ keyPath ] == nil ) {
+			id value = [ self defaultValueForKeyPath: keyPath ofCell: cell
+					key: key style: item.cellStyle ];
+			[ item setCellPropertyValue: value forKeyPath: keyPath ];
+			[ appliedKeyPaths removeObject: keyPath ];
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+
+// The defaults are read from a cell that is never configured so that the
+// values are the ones a new cell would have.
+
+- (id) defaultValueForKeyPath: (NSString*) keyPath ofCell: (UITableViewCell*) cell
+		key: (NSString*) key style: (UITableViewCellStyle) style
+{
+	NSMutableDictionary* defaults = _defaultValues[ key ];
+	if( defaults == nil ) {
+		defaults = [ NSMutableDictionary dictionary ];
+		_defaultValues[ key ] = defaults;
+	}
+	
+	id result = defaults[ keyPath ];
+	if( result == nil ) {
+		UITableViewCell* templateCell = _templateCells[ key ];
+		if( templateCell == nil ) {
+			templateCell = [ [ [ cell class ] alloc ] initWithStyle: style
+					reuseIdentifier: cell.reuseIdentifier ];
+			_templateCells[ key ] = templateCell;
+		}
+		result = cellPropertyValue( templateCell, keyPath );
+		defaults[ keyPath ] = result;
+	}
+	return result;
+}
+
+//------------------------------------------------------------------------------
+
+- (ASTItem*) itemForCell: (UITableViewCell*) cell
+{
+	return [ _cellItems objectForKey: cell ];
+}
+
+//------------------------------------------------------------------------------
+
+- (void) unbindCell: (UITableViewCell*) cell fromItem: (ASTItem*) item
+{
+	// Input items store edits made in the cell in their cell properties
+	// without applying them, so those keypaths have to be reset too.
+	if( item == nil ) {
+		item = [ _cellItems objectForKey: cell ];
+	}
+	if( item ) {
+		[ [ _cellAppliedKeyPaths objectForKey: cell ] addObjectsFromArray:
+				item.cellProperties.allKeys ];
+		[ _cellItems removeObjectForKey: cell ];
+	}
+}
+
+//------------------------------------------------------------------------------
+
+- (void) willApplyCellPropertyForKeyPath: (NSString*) keyPath
+		toCell: (UITableViewCell*) cell
+{
+	[ [ _cellAppliedKeyPaths objectForKey: cell ] addObject: keyPath ];
+}
+
+//------------------------------------------------------------------------------
+
+- (void) enqueueCell: (UITableViewCell*) cell
+{
+	NSParameterAssert( cell );
+	
+	[ self unbindCell: cell fromItem: nil ];
+	
+	NSString* key = [ _cellKeys objectForKey: cell ];
+	if( key == nil || cell.reuseIdentifier != nil || [ _pooledCells containsObject: cell ] ) {
+		return;
+	}
+	
+	NSMutableArray* queue = _queues[ key ];
+	if( queue == nil ) {
+		queue = [ NSMutableArray array ];
+		_queues[ key ] = queue;
+	}
+	[ queue addObject: cell ];
+	[ _pooledCells addObject: cell ];
+}
+
+//------------------------------------------------------------------------------
+
+- (void) removeAllCells
+{
+	[ _queues removeAllObjects ];
+	[ _pooledCells removeAllObjects ];
+	[ _templateCells removeAllObjects ];
+}
+
+//------------------------------------------------------------------------------
+
+@end
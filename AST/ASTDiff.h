@@ -0,0 +1,65 @@
+//==============================================================================
+//
+//  ASTDiff.h
+//
+//==============================================================================
+//
+//  Copyright (c) 2016 Adobe Systems Incorporated. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a
+//  copy of this software and associated documentation files (the "Software"),
+//  to deal in the Software without restriction, including without limitation
+//  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//  and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//
+//==============================================================================
+
+// This is private to the framework. The table view controller and sections use
+// it to turn a replacement of their items or sections into table view updates,
+// see ASTTableViewUpdate.h. It only uses Foundation.
+
+#import <Foundation/Foundation.h>
+
+
+NS_ASSUME_NONNULL_BEGIN
+
+//------------------------------------------------------------------------------
+
+@interface ASTDiff : NSObject
+
+/// Compares two arrays of items or sections. An old and a new object match if
+/// they are the same object or if they have the same identifier. Objects
+/// without an identifier only match themselves. The comparison takes linear
+/// time, so some objects may be reported as moved that a minimal diff would
+/// leave in place.
++ (instancetype) diffFromObjects: (NSArray*) oldObjects toObjects: (NSArray*) newObjects;
+
+/// The indexes of the old objects that have no match.
+@property (readonly,nonatomic) NSIndexSet* deletedIndexes;
+/// The indexes of the new objects that have no match.
+@property (readonly,nonatomic) NSIndexSet* insertedIndexes;
+/// The indexes of the new objects that have a match but are not at the
+/// position the old object is left at by the deletions and insertions.
+@property (readonly,nonatomic) NSIndexSet* movedIndexes;
+
+/// Returns the index of the old object matching the new object at the index or
+/// NSNotFound if there is no match.
+- (NSUInteger) oldIndexForNewIndex: (NSUInteger) newIndex;
+
+@end
+
+//------------------------------------------------------------------------------
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,160 @@
+//==============================================================================
+//
+//  ASTDiff.m
+//
+//==============================================================================
+//
+//  Copyright (c) 2016 Adobe Systems Incorporated. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a
+//  copy of this software and associated documentation files (the "Software"),
+//  to deal in the Software without restriction, including without limitation
+//  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//  and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//
+//==============================================================================
+
+#import "ASTDiff.h"
+
+
+//------------------------------------------------------------------------------
+
+// Sections and items both have an identifier.
+@protocol ASTDiffObject <NSObject>
+
+- (nullable NSString*) identifier;
+
+@end
+
+//------------------------------------------------------------------------------
+
+@interface ASTDiff() {
+	NSMutableArray* _oldIndexes;
+}
+
+@end
+
+//------------------------------------------------------------------------------
+
+@implementation ASTDiff
+
+//------------------------------------------------------------------------------
+
++ (instancetype) diffFromObjects: (NSArray*) oldObjects toObjects: (NSArray*) newObjects
+{
+	ASTDiff* diff = [ [ self alloc ] init ];
+	[ diff compareObjects: oldObjects toObjects: newObjects ];
+	return diff;
+}
+
+//------------------------------------------------------------------------------
+
+- (void) compareObjects: (NSArray*) oldObjects toObjects: (NSArray*) newObjects
+{
+	NSUInteger oldCount = oldObjects.count;
+	NSUInteger newCount = newObjects.count;
+	
+	NSMapTable* oldIndexesByObject = [ NSMapTable
+			mapTableWithKeyOptions: NSPointerFunctionsObjectPointerPersonality
+			valueOptions: NSPointerFunctionsStrongMemory ];
+	NSMutableDictionary* oldIndexesByIdentifier = [ NSMutableDictionary dictionary ];
+	for( NSUInteger i = 0; i < oldCount; ++i ) {
+		id object = oldObjects[ i ];
+		[ oldIndexesByObject setObject: @(i) forKey: object ];
+		NSString* identifier = [ (id<ASTDiffObject>)object identifier ];
+		if( identifier ) {
+			NSMutableArray* indexes = oldIndexesByIdentifier[ identifier ];
+			if( indexes == nil ) {
+				indexes = [ NSMutableArray array ];
+				oldIndexesByIdentifier[ identifier ] = indexes;
+			}
+			[ indexes addObject: @(i) ];
+		}
+	}
+	
+	// Objects that are kept match themselves before anything is matched by
+	// identifier.
+	NSMutableIndexSet* matchedOldIndexes = [ NSMutableIndexSet indexSet ];
+	_oldIndexes = [ NSMutableArray arrayWithCapacity: newCount ];
+	for( NSUInteger i = 0; i < newCount; ++i ) {
+		NSNumber* oldIndex = [ oldIndexesByObject objectForKey: newObjects[ i ] ];
+		if( oldIndex && [ matchedOldIndexes containsIndex: oldIndex.unsignedIntegerValue ] == NO ) {
+			[ matchedOldIndexes addIndex: oldIndex.unsignedIntegerValue ];
+			[ _oldIndexes addObject: oldIndex ];
+		} else {
+			[ _oldIndexes addObject: @(NSNotFound) ];
+		}
+	}
+	
+	// Repeated identifiers match in order. Each old index is taken from the
+	// front of its list at most once.
+	for( NSUInteger i = 0; i < newCount; ++i ) {
+		if( [ _oldIndexes[ i ] unsignedIntegerValue ] != NSNotFound ) {
+			continue;
+		}
+		NSString* identifier = [ (id<ASTDiffObject>)newObjects[ i ] identifier ];
+		NSMutableArray* indexes = identifier ? oldIndexesByIdentifier[ identifier ] : nil;
+		while( indexes.count ) {
+			NSNumber* oldIndex = indexes.firstObject;
+			[ indexes removeObjectAtIndex: 0 ];
+			if( [ matchedOldIndexes containsIndex: oldIndex.unsignedIntegerValue ] == NO ) {
+				[ matchedOldIndexes addIndex: oldIndex.unsignedIntegerValue ];
+				_oldIndexes[ i ] = oldIndex;
+				break;
+			}
+		}
+	}
+	
+	NSMutableIndexSet* deletedIndexes = [ NSMutableIndexSet indexSet ];
+	NSMutableData* deletionsBeforeData = [ NSMutableData
+			dataWithLength: oldCount * sizeof( NSUInteger ) ];
+	NSUInteger* deletionsBefore = deletionsBeforeData.mutableBytes;
+	for( NSUInteger i = 0; i < oldCount; ++i ) {
+		deletionsBefore[ i ] = deletedIndexes.count;
+		if( [ matchedOldIndexes containsIndex: i ] == NO ) {
+			[ deletedIndexes addIndex: i ];
+		}
+	}
+	_deletedIndexes = [ deletedIndexes copy ];
+	
+	// An old object that survives ends up at its index less the deletions
+	// before it plus the insertions before its new index. Anything else has to
+	// be moved.
+	NSMutableIndexSet* insertedIndexes = [ NSMutableIndexSet indexSet ];
+	NSMutableIndexSet* movedIndexes = [ NSMutableIndexSet indexSet ];
+	NSUInteger insertionsBefore = 0;
+	for( NSUInteger i = 0; i < newCount; ++i ) {
+		NSUInteger oldIndex = [ _oldIndexes[ i ] unsignedIntegerValue ];
+		if( oldIndex == NSNotFound ) {
+			[ insertedIndexes addIndex: i ];
+			++insertionsBefore;
+		} else if( oldIndex - deletionsBefore[ oldIndex ] + insertionsBefore != i ) {
+			[ movedIndexes addIndex: i ];
+		}
+	}
+	_insertedIndexes = [ insertedIndexes copy ];
+	_movedIndexes = [ movedIndexes copy ];
+}
+
+//------------------------------------------------------------------------------
+
+- (NSUInteger) oldIndexForNewIndex: (NSUInteger) newIndex
+{
+	return [ _oldIndexes[ newIndex ] unsignedIntegerValue ];
+}
+
+//------------------------------------------------------------------------------
+
+@end
@@ -0,0 +1,151 @@
+//==============================================================================
+//
+//  ASTDiffTests.m
+//
+//==============================================================================
+//
+//  Copyright (c) 2016 Adobe Systems Incorporated. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a
+//  copy of this software and associated documentation files (the "Software"),
+//  to deal in the Software without restriction, including without limitation
+//  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//  and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//
+//==============================================================================
+
+#import <UIKit/UIKit.h>
+#import <XCTest/XCTest.h>
+#import "ASTItem.h"
+#import "ASTDiff.h"
+
+
+//------------------------------------------------------------------------------
+
+@interface ASTDiffTests : XCTestCase
+
+@end
+
+//------------------------------------------------------------------------------
+
+@implementation ASTDiffTests
+
+//------------------------------------------------------------------------------
+
+- (NSArray*) itemsWithIdentifiers: (NSString*) identifiers
+{
+	NSMutableArray* result = [ NSMutableArray array ];
+	for( NSString* identifier in [ identifiers componentsSeparatedByString: @" " ] ) {
+		[ result addObject: [ ASTItem itemWithDict: @{ AST_id : identifier } ] ];
+	}
+	return result;
+}
+
+//------------------------------------------------------------------------------
+
+- (NSArray*) oldIndexesOfDiff: (ASTDiff*) diff count: (NSUInteger) count
+{
+	NSMutableArray* result = [ NSMutableArray array ];
+	for( NSUInteger i = 0; i < count; ++i ) {
+		[ result addObject: @([ diff oldIndexForNewIndex: i ]) ];
+	}
+	return result;
+}
+
+//------------------------------------------------------------------------------
+
+- (void) testMatchingByIdentifier
+{
+	NSArray* oldItems = [ self itemsWithIdentifiers: @"a b c d" ];
+	NSArray* newItems = [ self itemsWithIdentifiers: @"a c e d" ];
+	ASTDiff* diff = [ ASTDiff diffFromObjects: oldItems toObjects: newItems ];
+	
+	XCTAssertEqualObjects( [ self oldIndexesOfDiff: diff count: 4 ],
+			(@[ @0, @2, @(NSNotFound), @3 ]) );
+	XCTAssertEqualObjects( diff.deletedIndexes, [ NSIndexSet indexSetWithIndex: 1 ] );
+	XCTAssertEqualObjects( diff.insertedIndexes, [ NSIndexSet indexSetWithIndex: 2 ] );
+	XCTAssertEqual( diff.movedIndexes.count, 0 );
+}
+
+//------------------------------------------------------------------------------
+
+- (void) testMatchingByIdentity
+{
+	ASTItem* item = [ ASTItem item ];
+	NSArray* oldItems = @[ [ ASTItem item ], item ];
+	NSArray* newItems = @[ item, [ ASTItem item ] ];
+	ASTDiff* diff = [ ASTDiff diffFromObjects: oldItems toObjects: newItems ];
+	
+	// Items without identifiers only match themselves.
+	XCTAssertEqualObjects( [ self oldIndexesOfDiff: diff count: 2 ],
+			(@[ @1, @(NSNotFound) ]) );
+	XCTAssertEqualObjects( diff.deletedIndexes, [ NSIndexSet indexSetWithIndex: 0 ] );
+	XCTAssertEqualObjects( diff.insertedIndexes, [ NSIndexSet indexSetWithIndex: 1 ] );
+	XCTAssertEqual( diff.movedIndexes.count, 0 );
+}
+
+//------------------------------------------------------------------------------
+
+- (void) testRepeatedIdentifiersMatchInOrder
+{
+	NSArray* oldItems = [ self itemsWithIdentifiers: @"a a b" ];
+	NSArray* newItems = @[ oldItems[ 1 ], [ ASTItem itemWithDict: @{ AST_id : @"a" } ],
+			[ ASTItem itemWithDict: @{ AST_id : @"a" } ] ];
+	ASTDiff* diff = [ ASTDiff diffFromObjects: oldItems toObjects: newItems ];
+	
+	XCTAssertEqualObjects( [ self oldIndexesOfDiff: diff count: 3 ],
+			(@[ @1, @0, @(NSNotFound) ]) );
+	XCTAssertEqualObjects( diff.deletedIndexes, [ NSIndexSet indexSetWithIndex: 2 ] );
+}
+
+//------------------------------------------------------------------------------
+
+- (void) testMoves
+{
+	NSArray* oldItems = [ self itemsWithIdentifiers: @"a b c d" ];
+	NSArray* newItems = @[ oldItems[ 3 ], oldItems[ 0 ], oldItems[ 1 ], oldItems[ 2 ] ];
+	ASTDiff* diff = [ ASTDiff diffFromObjects: oldItems toObjects: newItems ];
+	
+	XCTAssertEqual( diff.deletedIndexes.count, 0 );
+	XCTAssertEqual( diff.insertedIndexes.count, 0 );
+	XCTAssert( [ diff.movedIndexes containsIndex: 0 ] );
+	
+	// Everything that is not reported as moved keeps its relative order.
+	NSUInteger lastOldIndex = 0;
+	for( NSUInteger i = 0; i < newItems.count; ++i ) {
+		if( [ diff.movedIndexes containsIndex: i ] == NO ) {
+			NSUInteger oldIndex = [ diff oldIndexForNewIndex: i ];
+			XCTAssertGreaterThanOrEqual( oldIndex, lastOldIndex );
+			lastOldIndex = oldIndex;
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+
+- (void) testShiftsAreNotMoves
+{
+	NSArray* oldItems = [ self itemsWithIdentifiers: @"a b c" ];
+	NSArray* newItems = [ self itemsWithIdentifiers: @"x b c y" ];
+	ASTDiff* diff = [ ASTDiff diffFromObjects: oldItems toObjects: newItems ];
+	
+	XCTAssertEqualObjects( diff.deletedIndexes, [ NSIndexSet indexSetWithIndex: 0 ] );
+	XCTAssertEqual( diff.insertedIndexes.count, 2 );
+	XCTAssertEqual( diff.movedIndexes.count, 0 );
+}
+
+//------------------------------------------------------------------------------
+
+@end
@@ -0,0 +1,117 @@
+//==============================================================================
+//
+//  ASTImageLoader.h
+//
+//==============================================================================
+//
+//  Copyright (c) 2016 Adobe Systems Incorporated. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a
+//  copy of this software and associated documentation files (the "Software"),
+//  to deal in the Software without restriction, including without limitation
+//  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//  and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//
+//==============================================================================
+
+#import <UIKit/UIKit.h>
+
+
+NS_ASSUME_NONNULL_BEGIN
+
+//------------------------------------------------------------------------------
+
+@class ASTCancellationToken;
+
+/// Called on the main thread with the loaded image, or with nil if the file
+/// could not be read as an image.
+typedef void (^ASTImageLoadCompletion)( UIImage* __nullable image );
+
+//------------------------------------------------------------------------------
+
+/// Loads images from files for display in cells. Images are decoded on a
+/// background queue, downsampled to the size they are displayed at, and kept in
+/// a memory cache that is bounded by the bytes of the decoded images, dropping
+/// the least recently used ones first. Downsampled images can also be kept in a
+/// disk cache so that large files are only decoded once, which is bounded by the
+/// bytes of its files in the same way. A loader is used on the main thread.
+@interface ASTImageLoader : NSObject
+
+/// Returns the loader used by image views for AST_cell_imageView_imageURL. The
+/// default loader has no disk cache.
+/// @return The shared ASTImageLoader.
++ (ASTImageLoader*) sharedLoader;
+/// Replaces the shared loader, for example with one that has a disk cache.
+/// @param loader The new shared loader, or nil to restore the default loader.
++ (void) setSharedLoader: (nullable ASTImageLoader*) loader;
+
+/// Initializes and returns a loader without a disk cache.
+/// @return A new ASTImageLoader.
+- (instancetype) init;
+/// Initializes and returns a loader that keeps the downsampled images in a
+/// directory. The directory is created if needed. Entries are invalidated when
+/// the modification date of the file they were made from changes.
+/// @param diskCacheURL The file URL of the directory of the disk cache, or nil
+/// for no disk cache.
+/// @return A new ASTImageLoader.
+- (instancetype) initWithDiskCacheURL: (nullable NSURL*) diskCacheURL NS_DESIGNATED_INITIALIZER;
+
+/// The directory of the disk cache, nil if the loader has no disk cache.
+@property (readonly,nullable,nonatomic) NSURL* diskCacheURL;
+/// The number of bytes of decoded images the memory cache may keep. The default
+/// is 32 MB. Lowering the capacity evicts images right away.
+@property (nonatomic) NSUInteger memoryCacheCapacity;
+/// The number of bytes of the decoded images in the memory cache.
+@property (readonly,nonatomic) NSUInteger memoryCacheCost;
+/// The number of bytes the files of the disk cache may take. The default is
+/// 100 MB. The least recently used entries are removed after each write to the
+/// disk cache and when the capacity is lowered.
+@property (nonatomic) NSUInteger diskCacheCapacity;
+/// The maximum width and height, in points, of images loaded for image views
+/// that were not laid out yet and for the image views of the standard cell
+/// styles, which take the size of their image. Items prefetch their images at
+/// this size. The default is 60, the size of a large image in a standard cell.
+/// 0 loads the images at the size of their file.
+@property (nonatomic) CGFloat defaultMaximumSize;
+/// The scale of the loaded images. The default is the scale of the main screen.
+@property (nonatomic) CGFloat scale;
+
+/// Returns the image of the file from the memory cache, or nil if it is not in
+/// the cache.
+/// @param url The file URL of the image.
+/// @param maximumSize The maximum width and height of the image in points, or
+/// 0 for the size of the file.
+/// @return The cached image or nil.
+- (nullable UIImage*) cachedImageWithURL: (NSURL*) url maximumSize: (CGFloat) maximumSize;
+/// Loads the image of a file in the background. The completion is called later
+/// even if the image is in the memory cache. Loads of the same file and size
+/// are shared. A load whose requests are all cancelled is abandoned if it was
+/// not decoded yet.
+/// @param url The file URL of the image.
+/// @param maximumSize The maximum width and height of the image in points, or
+/// 0 for the size of the file.
+/// @param completion The block to be called with the image unless the request
+/// is cancelled first.
+/// @return A token that cancels the request.
+- (ASTCancellationToken*) loadImageWithURL: (NSURL*) url
+		maximumSize: (CGFloat) maximumSize
+		completion: (ASTImageLoadCompletion) completion;
+
+/// Removes the images from the memory cache and from the disk cache.
+- (void) removeAllCachedImages;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,546 @@
+//==============================================================================
+//
+//  ASTImageLoader.m
+//
+//==============================================================================
+//
+//  Copyright (c) 2016 Adobe Systems Incorporated. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a
+//  copy of this software and associated documentation files (the "Software"),
+//  to deal in the Software without restriction, including without limitation
+//  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//  and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//
+//==============================================================================
+
+#import "ASTImageLoader.h"
+
+#import "ASTItem.h"
+
+#import <CommonCrypto/CommonDigest.h>
+#import <ImageIO/ImageIO.h>
+
+
+//------------------------------------------------------------------------------
+
+static const NSUInteger ASTImageLoaderDefaultMemoryCacheCapacity = 32 * 1024 * 1024;
+static const NSUInteger ASTImageLoaderDefaultDiskCacheCapacity = 100 * 1024 * 1024;
+// The size of the image view of a standard cell with a large image.
+static const CGFloat ASTImageLoaderDefaultMaximumSize = 60;
+
+//------------------------------------------------------------------------------
+
+// Decodes the image of a file, downsampled so that neither side is larger than
+// maximumPixelSize, or at full size if it is 0. The image is decoded before
+// this returns so that the main thread does not decode it when it is drawn.
+
+static UIImage* decodeImage( NSURL* url, CGFloat maximumPixelSize, CGFloat scale )
+{
+	NSDictionary* sourceOptions = @{ (__bridge NSString*)kCGImageSourceShouldCache : @NO };
+	CGImageSourceRef source = CGImageSourceCreateWithURL( (__bridge CFURLRef)url,
+			(__bridge CFDictionaryRef)sourceOptions );
+	if( source == NULL ) {
+		return nil;
+	}
+	
+	NSMutableDictionary* options = [ @{
+		(__bridge NSString*)kCGImageSourceCreateThumbnailFromImageAlways : @YES,
+		(__bridge NSString*)kCGImageSourceCreateThumbnailWithTransform : @YES,
+		(__bridge NSString*)kCGImageSourceShouldCacheImmediately : @YES,
+	} mutableCopy ];
+	if( maximumPixelSize > 0 ) {
+		options[ (__bridge NSString*)kCGImageSourceThumbnailMaxPixelSize ] = @( maximumPixelSize );
+	}
+	CGImageRef cgImage = CGImageSourceCreateThumbnailAtIndex( source, 0,
+			(__bridge CFDictionaryRef)options );
+	CFRelease( source );
+	if( cgImage == NULL ) {
+		return nil;
+	}
+	
+	UIImage* result = [ UIImage imageWithCGImage: cgImage scale: scale
+			orientation: UIImageOrientationUp ];
+	CGImageRelease( cgImage );
+	return result;
+}
+
+//------------------------------------------------------------------------------
+
+static NSUInteger imageCost( UIImage* image )
+{
+	CGImageRef cgImage = image.CGImage;
+	return CGImageGetBytesPerRow( cgImage ) * CGImageGetHeight( cgImage );
+}
+
+//------------------------------------------------------------------------------
+
+// The disk cache entry of a downsampled image is named after the load and the
+// modification date of the file, so a changed file does not match old entries.
+
+static NSString* diskCacheFileName( NSString* loadKey, NSDate* modificationDate )
+{
+	NSString* string = [ NSString stringWithFormat: @"%@|%f", loadKey,
+			modificationDate.timeIntervalSinceReferenceDate ];
+	NSData* data = [ string dataUsingEncoding: NSUTF8StringEncoding ];
+	unsigned char digest[ CC_SHA256_DIGEST_LENGTH ];
+	CC_SHA256( data.bytes, (CC_LONG)data.length, digest );
+	
+	NSMutableString* result = [ NSMutableString string ];
+	for( NSUInteger i = 0; i < CC_SHA256_DIGEST_LENGTH; i++ ) {
+		[ result appendFormat: @"%02x", digest[ i ] ];
+	}
+	[ result appendString: @".png" ];
+	return result;
+}
+
+//------------------------------------------------------------------------------
+
+// Removes the least recently used entries of the disk cache until its files
+// take at most capacity bytes. Entries are touched when they are read, so their
+// modification date is the date they were last used.
+
+static void pruneDiskCache( NSURL* diskCacheURL, NSUInteger capacity )
+{
+	NSArray* keys = @[ NSURLContentModificationDateKey, NSURLFileSizeKey ];
+	NSArray* entryURLs = [ [ NSFileManager defaultManager ] contentsOfDirectoryAtURL: diskCacheURL
+			includingPropertiesForKeys: keys options: NSDirectoryEnumerationSkipsHiddenFiles
+			error: nil ];
+	NSUInteger size = 0;
+	for( NSURL* entryURL in entryURLs ) {
+		NSNumber* entrySize = nil;
+		[ entryURL getResourceValue: &entrySize forKey: NSURLFileSizeKey error: nil ];
+		size += entrySize.unsignedIntegerValue;
+	}
+	if( size <= capacity ) {
+		return;
+	}
+	
+	NSArray* sortedEntryURLs = [ entryURLs sortedArrayUsingComparator: ^( NSURL* entryURL, NSURL* otherEntryURL ) {
+		NSDate* date = nil;
+		NSDate* otherDate = nil;
+		[ entryURL getResourceValue: &date forKey: NSURLContentModificationDateKey error: nil ];
+		[ otherEntryURL getResourceValue: &otherDate forKey: NSURLContentModificationDateKey error: nil ];
+		return [ date ?: [ NSDate distantPast ] compare: otherDate ?: [ NSDate distantPast ] ];
+	} ];
+	for( NSURL* entryURL in sortedEntryURLs ) {
+		if( size <= capacity ) {
+			break;
+		}
+		NSNumber* entrySize = nil;
+		[ entryURL getResourceValue: &entrySize forKey: NSURLFileSizeKey error: nil ];
+		if( [ [ NSFileManager defaultManager ] removeItemAtURL: entryURL error: nil ] ) {
+			size -= MIN( size, entrySize.unsignedIntegerValue );
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+
+static ASTImageLoader* sharedLoader;
+
+//------------------------------------------------------------------------------
+
+// One decode of a file at a size, shared by the requests for it.
+
+@interface ASTImageLoad : NSObject
+
+- (instancetype) initWithKey: (NSString*) key;
+
+@property (readonly,nonatomic) NSString* key;
+// The tokens of the requests waiting for the image.
+@property (readonly,nonatomic) NSMutableArray* tokens;
+// Set on the main thread when all the requests are cancelled, read by the
+// decode queue.
+@property (atomic) BOOL abandoned;
+
+@end
+
+//------------------------------------------------------------------------------
+
+@interface ASTImageLoadToken : ASTCancellationToken
+
+@property (weak,nonatomic) ASTImageLoader* loader;
+@property (weak,nonatomic) ASTImageLoad* load;
+@property (nullable,copy,nonatomic) ASTImageLoadCompletion completion;
+
+@end
+
+//------------------------------------------------------------------------------
+
+@interface ASTImageLoader() {
+	NSMutableDictionary* _memoryCache;
+	// The keys of the memory cache from the least to the most recently used.
+	NSMutableOrderedSet* _memoryCacheKeys;
+	// The loads in progress by key. Abandoned loads are removed right away so
+	// that a new request starts a new load.
+	NSMutableDictionary* _loads;
+	dispatch_queue_t _decodeQueue;
+	dispatch_queue_t _diskQueue;
+}
+
+- (void) requestWasCancelled: (ASTImageLoadToken*) token;
+
+@end
+
+//------------------------------------------------------------------------------
+
+@implementation ASTImageLoader
+
+//------------------------------------------------------------------------------
+
++ (ASTImageLoader*) sharedLoader
+{
+	if( sharedLoader == nil ) {
+		sharedLoader = [ [ ASTImageLoader alloc ] init ];
+	}
+	return sharedLoader;
+}
+
+//------------------------------------------------------------------------------
+
++ (void) setSharedLoader: (ASTImageLoader*) loader
+{
+	sharedLoader = loader;
+}
+
+//------------------------------------------------------------------------------
+
+- (instancetype) init
+{
+	return [ self initWithDiskCacheURL: nil ];
+}
+
+//------------------------------------------------------------------------------
+
+- (instancetype) initWithDiskCacheURL: (NSURL*) diskCacheURL
+{
+	NSParameterAssert( diskCacheURL == nil || diskCacheURL.isFileURL );
+	
+	self = [ super init ];
+	if( self ) {
+		_diskCacheURL = diskCacheURL;
+		_memoryCacheCapacity = ASTImageLoaderDefaultMemoryCacheCapacity;
+		_diskCacheCapacity = ASTImageLoaderDefaultDiskCacheCapacity;
+		_defaultMaximumSize = ASTImageLoaderDefaultMaximumSize;
+		_scale = [ UIScreen mainScreen ].scale;
+		_memoryCache = [ NSMutableDictionary dictionary ];
+		_memoryCacheKeys = [ NSMutableOrderedSet orderedSet ];
+		_loads = [ NSMutableDictionary dictionary ];
+		_decodeQueue = dispatch_queue_create( "ASTImageLoader.decode",
+				dispatch_queue_attr_make_with_qos_class( DISPATCH_QUEUE_SERIAL,
+				QOS_CLASS_USER_INITIATED, 0 ) );
+		_diskQueue = dispatch_queue_create( "ASTImageLoader.disk",
+				dispatch_queue_attr_make_with_qos_class( DISPATCH_QUEUE_SERIAL,
+				QOS_CLASS_UTILITY, 0 ) );
+		
+		if( diskCacheURL ) {
+			[ [ NSFileManager defaultManager ] createDirectoryAtURL: diskCacheURL
+					withIntermediateDirectories: YES attributes: nil error: nil ];
+		}
+		
+		[ [ NSNotificationCenter defaultCenter ] addObserver: self
+				selector: @selector(didReceiveMemoryWarning:)
+				name: UIApplicationDidReceiveMemoryWarningNotification object: nil ];
+	}
+	return self;
+}
+
+//------------------------------------------------------------------------------
+
+- (void) dealloc
+{
+	[ [ NSNotificationCenter defaultCenter ] removeObserver: self ];
+}
+
+//------------------------------------------------------------------------------
+
+- (void) didReceiveMemoryWarning: (NSNotification*) notification
+{
+	[ self evictImagesToCost: 0 ];
+}
+
+//------------------------------------------------------------------------------
+
+- (NSString*) keyForURL: (NSURL*) url maximumPixelSize: (CGFloat) maximumPixelSize
+{
+	return [ NSString stringWithFormat: @"%@#%g", url.absoluteString, maximumPixelSize ];
+}
+
+//------------------------------------------------------------------------------
+
+- (CGFloat) pixelSizeForSize: (CGFloat) maximumSize
+{
+	return maximumSize > 0 ? ceil( maximumSize * _scale ) : 0;
+}
+
+//------------------------------------------------------------------------------
+
+- (UIImage*) cachedImageWithURL: (NSURL*) url maximumSize: (CGFloat) maximumSize
+{
+	NSParameterAssert( url.isFileURL );
+	
+	NSString* key = [ self keyForURL: url maximumPixelSize: [ self pixelSizeForSize: maximumSize ] ];
+	UIImage* result = _memoryCache[ key ];
+	if( result ) {
+		[ _memoryCacheKeys removeObject: key ];
+		[ _memoryCacheKeys addObject: key ];
+	}
+	return result;
+}
+
+//------------------------------------------------------------------------------
+
+- (ASTCancellationToken*) loadImageWithURL: (NSURL*) url
+		maximumSize: (CGFloat) maximumSize
+		completion: (ASTImageLoadCompletion) completion
+{
+	NSParameterAssert( url.isFileURL );
+	NSParameterAssert( completion );
+	
+	ASTImageLoadToken* token = [ [ ASTImageLoadToken alloc ] init ];
+	token.loader = self;
+	token.completion = completion;
+	
+	UIImage* cachedImage = [ self cachedImageWithURL: url maximumSize: maximumSize ];
+	if( cachedImage ) {
+		dispatch_async( dispatch_get_main_queue(), ^{
+			ASTImageLoadCompletion tokenCompletion = token.completion;
+			token.completion = nil;
+			if( tokenCompletion ) {
+				tokenCompletion( cachedImage );
+			}
+		} );
+		return token;
+	}
+	
+	CGFloat pixelSize = [ self pixelSizeForSize: maximumSize ];
+	NSString* key = [ self keyForURL: url maximumPixelSize: pixelSize ];
+	ASTImageLoad* load = _loads[ key ];
+	if( load == nil ) {
+		load = [ [ ASTImageLoad alloc ] initWithKey: key ];
+		_loads[ key ] = load;
+		[ self startLoad: load url: url pixelSize: pixelSize ];
+	}
+	token.load = load;
+	[ load.tokens addObject: token ];
+	return token;
+}
+
+//------------------------------------------------------------------------------
+
+- (void) startLoad: (ASTImageLoad*) load url: (NSURL*) url pixelSize: (CGFloat) pixelSize
+{
+	NSURL* diskCacheURL = pixelSize > 0 ? _diskCacheURL : nil;
+	NSUInteger diskCacheCapacity = _diskCacheCapacity;
+	dispatch_queue_t diskQueue = _diskQueue;
+	CGFloat scale = _scale;
+	__weak ASTImageLoader* weakSelf = self;
+	dispatch_async( _decodeQueue, ^{
+		UIImage* image = nil;
+		if( load.abandoned == NO ) {
+			// Full size images are not written to the disk cache since they
+			// would not be any faster to decode than the file.
+			NSURL* entryURL = nil;
+			if( diskCacheURL ) {
+				NSDictionary* attributes = [ [ NSFileManager defaultManager ]
+						attributesOfItemAtPath: url.path error: nil ];
+				NSDate* modificationDate = attributes[ NSFileModificationDate ];
+				if( modificationDate ) {
+					entryURL = [ diskCacheURL URLByAppendingPathComponent:
+							diskCacheFileName( load.key, modificationDate ) ];
+					if( [ [ NSFileManager defaultManager ] fileExistsAtPath: entryURL.path ] ) {
+						image = decodeImage( entryURL, 0, scale );
+					}
+					if( image ) {
+						dispatch_async( diskQueue, ^{
+							[ [ NSFileManager defaultManager ] setAttributes:
+									@{ NSFileModificationDate : [ NSDate date ] }
+									ofItemAtPath: entryURL.path error: nil ];
+						} );
+					}
+				}
+			}
+			if( image == nil ) {
+				image = decodeImage( url, pixelSize, scale );
+				if( image && entryURL ) {
+					dispatch_async( diskQueue, ^{
+						[ UIImagePNGRepresentation( image ) writeToURL: entryURL atomically: YES ];
+						pruneDiskCache( diskCacheURL, diskCacheCapacity );
+					} );
+				}
+			}
+		}
+		dispatch_async( dispatch_get_main_queue(), ^{
+			[ weakSelf finishLoad: load withImage: image ];
+		} );
+	} );
+}
+
+//------------------------------------------------------------------------------
+
+- (void) finishLoad: (ASTImageLoad*) load withImage: (UIImage*) image
+{
+	if( _loads[ load.key ] == load ) {
+		[ _loads removeObjectForKey: load.key ];
+	}
+	if( image ) {
+		[ self cacheImage: image forKey: load.key ];
+	}
+	for( ASTImageLoadToken* token in load.tokens ) {
+		ASTImageLoadCompletion completion = token.completion;
+		token.completion = nil;
+		if( completion && token.isCancelled == NO ) {
+			completion( image );
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+
+- (void) requestWasCancelled: (ASTImageLoadToken*) token
+{
+	token.completion = nil;
+	ASTImageLoad* load = token.load;
+	if( load == nil ) {
+		return;
+	}
+	for( ASTImageLoadToken* loadToken in load.tokens ) {
+		if( loadToken.isCancelled == NO ) {
+			return;
+		}
+	}
+	load.abandoned = YES;
+	if( _loads[ load.key ] == load ) {
+		[ _loads removeObjectForKey: load.key ];
+	}
+}
+
+//------------------------------------------------------------------------------
+
+- (void) cacheImage: (UIImage*) image forKey: (NSString*) key
+{
+	NSUInteger cost = imageCost( image );
+	if( cost > _memoryCacheCapacity ) {
+		return;
+	}
+	[ self removeCachedImageForKey: key ];
+	_memoryCache[ key ] = image;
+	[ _memoryCacheKeys addObject: key ];
+	_memoryCacheCost += cost;
+	[ self evictImagesToCost: _memoryCacheCapacity ];
+}
+
+//------------------------------------------------------------------------------
+
+- (void) removeCachedImageForKey: (NSString*) key
+{
+	UIImage* image = _memoryCache[ key ];
+	if( image ) {
+		_memoryCacheCost -= imageCost( image );
+		[ _memoryCache removeObjectForKey: key ];
+		[ _memoryCacheKeys removeObject: key ];
+	}
+}
+
+//------------------------------------------------------------------------------
+
+- (void) evictImagesToCost: (NSUInteger) cost
+{
+	while( _memoryCacheCost > cost && _memoryCacheKeys.count > 0 ) {
+		[ self removeCachedImageForKey: _memoryCacheKeys.firstObject ];
+	}
+}
+
+//------------------------------------------------------------------------------
+
+- (void) setMemoryCacheCapacity: (NSUInteger) memoryCacheCapacity
+{
+	_memoryCacheCapacity = memoryCacheCapacity;
+	[ self evictImagesToCost: memoryCacheCapacity ];
+}
+
+//------------------------------------------------------------------------------
+
+- (void) setDiskCacheCapacity: (NSUInteger) diskCacheCapacity
+{
+	_diskCacheCapacity = diskCacheCapacity;
+	NSURL* diskCacheURL = _diskCacheURL;
+	if( diskCacheURL ) {
+		dispatch_async( _diskQueue, ^{
+			pruneDiskCache( diskCacheURL, diskCacheCapacity );
+		} );
+	}
+}
+
+//------------------------------------------------------------------------------
+
+- (void) removeAllCachedImages
+{
+	[ self evictImagesToCost: 0 ];
+	
+	NSURL* diskCacheURL = _diskCacheURL;
+	if( diskCacheURL ) {
+		dispatch_async( _diskQueue, ^{
+			NSFileManager* fileManager = [ NSFileManager defaultManager ];
+			[ fileManager removeItemAtURL: diskCacheURL error: nil ];
+			[ fileManager createDirectoryAtURL: diskCacheURL
+					withIntermediateDirectories: YES attributes: nil error: nil ];
+		} );
+	}
+}
+
+//------------------------------------------------------------------------------
+
+@end
+
+//------------------------------------------------------------------------------
+
+@implementation ASTImageLoad
+
+//------------------------------------------------------------------------------
+
+- (instancetype) initWithKey: (NSString*) key
+{
+	self = [ super init ];
+	if( self ) {
+		_key = key;
+		_tokens = [ NSMutableArray array ];
+	}
+	return self;
+}
+
+//------------------------------------------------------------------------------
+
+@end
+
+//------------------------------------------------------------------------------
+
+@implementation ASTImageLoadToken
+
+//------------------------------------------------------------------------------
+
+- (void) cancel
+{
+	if( self.isCancelled ) {
+		return;
+	}
+	[ super cancel ];
+	[ _loader requestWasCancelled: self ];
+}
+
+//------------------------------------------------------------------------------
+
+@end
@@ -0,0 +1,332 @@
+//==============================================================================
+//
+//  ASTImageLoaderTests.m
+//
+//==============================================================================
+//
+//  Copyright (c) 2016 Adobe Systems Incorporated. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a
+//  copy of this software and associated documentation files (the "Software"),
+//  to deal in the Software without restriction, including without limitation
+//  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//  and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//
+//==============================================================================
+
+#import "ASTImageLoader.h"
+
+#import "ASTItem.h"
+
+#import <UIKit/UIKit.h>
+#import <XCTest/XCTest.h>
+
+
+//------------------------------------------------------------------------------
+
+@interface ASTImageLoaderTests : XCTestCase {
+	NSURL* _directoryURL;
+	// A 400 by 200 pixel image.
+	NSURL* _imageURL;
+}
+
+@end
+
+//------------------------------------------------------------------------------
+
+@implementation ASTImageLoaderTests
+
+//------------------------------------------------------------------------------
+
+- (void) setUp
+{
+	[ super setUp ];
+	
+	NSString* path = [ NSTemporaryDirectory() stringByAppendingPathComponent:
+			[ NSUUID UUID ].UUIDString ];
+	_directoryURL = [ NSURL fileURLWithPath: path isDirectory: YES ];
+	[ [ NSFileManager defaultManager ] createDirectoryAtURL: _directoryURL
+			withIntermediateDirectories: YES attributes: nil error: nil ];
+	
+	UIGraphicsImageRendererFormat* format = [ UIGraphicsImageRendererFormat defaultFormat ];
+	format.scale = 1;
+	UIGraphicsImageRenderer* renderer = [ [ UIGraphicsImageRenderer alloc ]
+			initWithSize: CGSizeMake( 400, 200 ) format: format ];
+	UIImage* image = [ renderer imageWithActions: ^( UIGraphicsImageRendererContext* context ) {
+		[ [ UIColor redColor ] setFill ];
+		UIRectFill( CGRectMake( 0, 0, 400, 200 ) );
+	} ];
+	_imageURL = [ _directoryURL URLByAppendingPathComponent: @"image.png" ];
+	[ UIImagePNGRepresentation( image ) writeToURL: _imageURL atomically: YES ];
+}
+
+//------------------------------------------------------------------------------
+
+- (void) tearDown
+{
+	[ ASTImageLoader setSharedLoader: nil ];
+	[ [ NSFileManager defaultManager ] removeItemAtURL: _directoryURL error: nil ];
+	
+	[ super tearDown ];
+}
+
+//------------------------------------------------------------------------------
+
+- (UIImage*) loadImageWithLoader: (ASTImageLoader*) loader maximumSize: (CGFloat) maximumSize
+{
+	__block UIImage* result = nil;
+	XCTestExpectation* expectation = [ self expectationWithDescription: @"loaded" ];
+	[ loader loadImageWithURL: _imageURL maximumSize: maximumSize
+			completion: ^( UIImage* image ) {
+		XCTAssertTrue( [ NSThread isMainThread ] );
+		result = image;
+		[ expectation fulfill ];
+	} ];
+	[ self waitForExpectationsWithTimeout: 10 handler: nil ];
+	return result;
+}
+
+//------------------------------------------------------------------------------
+
+- (void) waitForSeconds: (NSTimeInterval) seconds
+{
+	XCTestExpectation* expectation = [ self expectationWithDescription: @"waited" ];
+	dispatch_after( dispatch_time( DISPATCH_TIME_NOW, (int64_t)(seconds * NSEC_PER_SEC) ),
+			dispatch_get_main_queue(), ^{
+		[ expectation fulfill ];
+	} );
+	[ self waitForExpectationsWithTimeout: 10 handler: nil ];
+}
+
+//------------------------------------------------------------------------------
+
+- (void) testLoadDownsamplesImage
+{
+	ASTImageLoader* loader = [ [ ASTImageLoader alloc ] init ];
+	loader.scale = 2;
+	XCTAssertEqual( loader.defaultMaximumSize, 60 );
+	
+	UIImage* image = [ self loadImageWithLoader: loader maximumSize: 50 ];
+	XCTAssertEqual( CGImageGetWidth( image.CGImage ), 100 );
+	XCTAssertEqual( CGImageGetHeight( image.CGImage ), 50 );
+	XCTAssertEqual( image.scale, 2 );
+	XCTAssertTrue( CGSizeEqualToSize( image.size, CGSizeMake( 50, 25 ) ) );
+	XCTAssertEqual( [ loader cachedImageWithURL: _imageURL maximumSize: 50 ], image );
+	XCTAssertGreaterThan( loader.memoryCacheCost, 0 );
+	
+	image = [ self loadImageWithLoader: loader maximumSize: 0 ];
+	XCTAssertEqual( CGImageGetWidth( image.CGImage ), 400 );
+	XCTAssertEqual( CGImageGetHeight( image.CGImage ), 200 );
+	
+	NSURL* missingURL = [ _directoryURL URLByAppendingPathComponent: @"missing.png" ];
+	XCTestExpectation* expectation = [ self expectationWithDescription: @"failed" ];
+	[ loader loadImageWithURL: missingURL maximumSize: 50 completion: ^( UIImage* missingImage ) {
+		XCTAssertNil( missingImage );
+		[ expectation fulfill ];
+	} ];
+	[ self waitForExpectationsWithTimeout: 10 handler: nil ];
+}
+
+//------------------------------------------------------------------------------
+
+- (void) testMemoryCacheEvictsLeastRecentlyUsedImages
+{
+	ASTImageLoader* loader = [ [ ASTImageLoader alloc ] init ];
+	loader.scale = 1;
+	
+	[ self loadImageWithLoader: loader maximumSize: 100 ];
+	[ self loadImageWithLoader: loader maximumSize: 80 ];
+	loader.memoryCacheCapacity = loader.memoryCacheCost;
+	
+	XCTAssertNotNil( [ loader cachedImageWithURL: _imageURL maximumSize: 100 ] );
+	[ self loadImageWithLoader: loader maximumSize: 40 ];
+	XCTAssertLessThanOrEqual( loader.memoryCacheCost, loader.memoryCacheCapacity );
+	XCTAssertNotNil( [ loader cachedImageWithURL: _imageURL maximumSize: 100 ] );
+	XCTAssertNil( [ loader cachedImageWithURL: _imageURL maximumSize: 80 ] );
+	XCTAssertNotNil( [ loader cachedImageWithURL: _imageURL maximumSize: 40 ] );
+	
+	loader.memoryCacheCapacity = 0;
+	XCTAssertEqual( loader.memoryCacheCost, 0 );
+	XCTAssertNil( [ loader cachedImageWithURL: _imageURL maximumSize: 100 ] );
+	
+	loader.memoryCacheCapacity = 32 * 1024 * 1024;
+	[ self loadImageWithLoader: loader maximumSize: 100 ];
+	[ loader removeAllCachedImages ];
+	XCTAssertEqual( loader.memoryCacheCost, 0 );
+}
+
+//------------------------------------------------------------------------------
+
+- (void) testCancelledRequestsDoNotComplete
+{
+	ASTImageLoader* loader = [ [ ASTImageLoader alloc ] init ];
+	
+	__block BOOL cancelledCompleted = NO;
+	ASTCancellationToken* token = [ loader loadImageWithURL: _imageURL maximumSize: 50
+			completion: ^( UIImage* image ) {
+		cancelledCompleted = YES;
+	} ];
+	// The other request for the same image shares the load and still gets it.
+	__block UIImage* sharedImage = nil;
+	XCTestExpectation* expectation = [ self expectationWithDescription: @"loaded" ];
+	[ loader loadImageWithURL: _imageURL maximumSize: 50 completion: ^( UIImage* image ) {
+		sharedImage = image;
+		[ expectation fulfill ];
+	} ];
+	[ token cancel ];
+	[ self waitForExpectationsWithTimeout: 10 handler: nil ];
+	XCTAssertNotNil( sharedImage );
+	XCTAssertFalse( cancelledCompleted );
+	
+	[ loader removeAllCachedImages ];
+	token = [ loader loadImageWithURL: _imageURL maximumSize: 50
+			completion: ^( UIImage* image ) {
+		cancelledCompleted = YES;
+	} ];
+	[ token cancel ];
+	XCTAssertTrue( token.isCancelled );
+	[ self waitForSeconds: 0.5 ];
+	XCTAssertFalse( cancelledCompleted );
+}
+
+//------------------------------------------------------------------------------
+
+- (void) testDiskCache
+{
+	NSURL* cacheURL = [ _directoryURL URLByAppendingPathComponent: @"Cache" isDirectory: YES ];
+	ASTImageLoader* loader = [ [ ASTImageLoader alloc ] initWithDiskCacheURL: cacheURL ];
+	loader.scale = 1;
+	XCTAssertEqualObjects( loader.diskCacheURL, cacheURL );
+	
+	[ self loadImageWithLoader: loader maximumSize: 50 ];
+	[ self waitForSeconds: 0.5 ];
+	NSArray* entries = [ [ NSFileManager defaultManager ]
+			contentsOfDirectoryAtPath: cacheURL.path error: nil ];
+	XCTAssertEqual( entries.count, 1 );
+	
+	ASTImageLoader* otherLoader = [ [ ASTImageLoader alloc ] initWithDiskCacheURL: cacheURL ];
+	otherLoader.scale = 1;
+	UIImage* image = [ self loadImageWithLoader: otherLoader maximumSize: 50 ];
+	XCTAssertEqual( CGImageGetWidth( image.CGImage ), 50 );
+	XCTAssertEqual( CGImageGetHeight( image.CGImage ), 25 );
+	
+	[ otherLoader removeAllCachedImages ];
+	[ self waitForSeconds: 0.5 ];
+	entries = [ [ NSFileManager defaultManager ] contentsOfDirectoryAtPath: cacheURL.path error: nil ];
+	XCTAssertEqual( entries.count, 0 );
+}
+
+//------------------------------------------------------------------------------
+
+- (void) testDiskCacheCapacity
+{
+	NSURL* cacheURL = [ _directoryURL URLByAppendingPathComponent: @"Cache" isDirectory: YES ];
+	ASTImageLoader* loader = [ [ ASTImageLoader alloc ] initWithDiskCacheURL: cacheURL ];
+	loader.scale = 1;
+	XCTAssertEqual( loader.diskCacheCapacity, 100 * 1024 * 1024 );
+	
+	[ self loadImageWithLoader: loader maximumSize: 100 ];
+	[ self waitForSeconds: 0.5 ];
+	NSFileManager* fileManager = [ NSFileManager defaultManager ];
+	NSArray* entries = [ fileManager contentsOfDirectoryAtPath: cacheURL.path error: nil ];
+	XCTAssertEqual( entries.count, 1 );
+	NSString* entryPath = [ cacheURL.path stringByAppendingPathComponent: entries.firstObject ];
+	NSNumber* entrySize = [ fileManager attributesOfItemAtPath: entryPath error: nil ][ NSFileSize ];
+	
+	// The smaller entry of a second size only fits without the first one.
+	loader.diskCacheCapacity = entrySize.unsignedIntegerValue;
+	[ self loadImageWithLoader: loader maximumSize: 20 ];
+	[ self waitForSeconds: 0.5 ];
+	NSArray* newEntries = [ fileManager contentsOfDirectoryAtPath: cacheURL.path error: nil ];
+	XCTAssertEqual( newEntries.count, 1 );
+	XCTAssertNotEqualObjects( newEntries.firstObject, entries.firstObject );
+	
+	loader.diskCacheCapacity = 0;
+	[ self waitForSeconds: 0.5 ];
+	XCTAssertEqual( [ fileManager contentsOfDirectoryAtPath: cacheURL.path error: nil ].count, 0 );
+}
+
+//------------------------------------------------------------------------------
+
+- (void) testImageViewImageURL
+{
+	ASTImageLoader* loader = [ [ ASTImageLoader alloc ] init ];
+	loader.scale = 1;
+	[ ASTImageLoader setSharedLoader: loader ];
+	XCTAssertEqual( [ ASTImageLoader sharedLoader ], loader );
+	
+	UIImageView* imageView = [ [ UIImageView alloc ] initWithFrame: CGRectMake( 0, 0, 40, 40 ) ];
+	[ imageView setImageURL: _imageURL ];
+	XCTAssertNil( imageView.image );
+	[ self waitForSeconds: 0.5 ];
+	XCTAssertTrue( CGSizeEqualToSize( imageView.image.size, CGSizeMake( 40, 20 ) ) );
+	
+	// A cached image is set right away.
+	UIImageView* otherImageView = [ [ UIImageView alloc ] initWithFrame: CGRectMake( 0, 0, 40, 40 ) ];
+	[ otherImageView setImageURL: _imageURL ];
+	XCTAssertEqual( otherImageView.image, imageView.image );
+	[ otherImageView setImageURL: nil ];
+	XCTAssertNil( otherImageView.image );
+	
+	// Paths and file URL strings load the same file.
+	UIImageView* pathImageView = [ [ UIImageView alloc ] initWithFrame: CGRectMake( 0, 0, 40, 40 ) ];
+	[ pathImageView setImageURL: _imageURL.path ];
+	XCTAssertEqual( pathImageView.image, imageView.image );
+	[ pathImageView setImageURL: nil ];
+	[ pathImageView setImageURL: _imageURL.absoluteString ];
+	XCTAssertEqual( pathImageView.image, imageView.image );
+	
+	// A cancelled load leaves the image view empty.
+	[ loader removeAllCachedImages ];
+	[ otherImageView setImageURL: _imageURL ];
+	[ otherImageView cancelImageLoad ];
+	[ self waitForSeconds: 0.5 ];
+	XCTAssertNil( otherImageView.image );
+	
+	loader.defaultMaximumSize = 20;
+	ASTItem* item = [ ASTItem itemWithDict: @{
+		AST_cell_imageView_imageURL : _imageURL,
+	} ];
+	UITableViewCell* cell = item.cell;
+	[ self waitForSeconds: 0.5 ];
+	UIImage* image = cell.imageView.image;
+	XCTAssertTrue( CGSizeEqualToSize( image.size, CGSizeMake( 20, 10 ) ) );
+}
+
+//------------------------------------------------------------------------------
+
+- (void) testItemPrefetchesImage
+{
+	ASTImageLoader* loader = [ [ ASTImageLoader alloc ] init ];
+	loader.scale = 1;
+	loader.defaultMaximumSize = 20;
+	[ ASTImageLoader setSharedLoader: loader ];
+	
+	ASTItem* item = [ ASTItem itemWithDict: @{
+		AST_cell_imageView_imageURL : _imageURL,
+	} ];
+	[ item prefetch ];
+	[ self waitForSeconds: 0.5 ];
+	XCTAssertFalse( item.cellLoaded );
+	XCTAssertNotNil( [ loader cachedImageWithURL: _imageURL maximumSize: 20 ] );
+	
+	// The cell finds the prefetched image in the cache.
+	UITableViewCell* cell = item.cell;
+	XCTAssertEqual( cell.imageView.image, [ loader cachedImageWithURL: _imageURL maximumSize: 20 ] );
+}
+
+//------------------------------------------------------------------------------
+
+@end
@@ -35,6 +35,7 @@ NS_ASSUME_NONNULL_BEGIN
 //------------------------------------------------------------------------------
 
 extern NSString* const AST_itemClass;
+extern NSString* const AST_template;
 extern NSString* const AST_cellClass;
 extern NSString* const AST_cellStyle;
 extern NSString* const AST_cellReuseIdentifier;
@@ -46,7 +47,10 @@ extern NSString* const AST_selectActionBlock;
 extern NSString* const AST_deselectAutomatically;
 extern NSString* const AST_representedObject;
 extern NSString* const AST_prefKey;
+extern NSString* const AST_prefStore;
 extern NSString* const AST_minimumHeight;
+extern NSString* const AST_valueDelivery;
+extern NSString* const AST_valueDeliveryInterval;
 
 extern NSString* const AST_cell_indentationLevel;
 extern NSString* const AST_cell_indentationWidth;
@@ -58,6 +62,7 @@ extern NSString* const AST_cell_imageView_image;
 extern NSString* const AST_cell_imageView_imageName;
 extern NSString* const AST_cell_imageView_highlightedImage;
 extern NSString* const AST_cell_imageView_highlightedImageName;
+extern NSString* const AST_cell_imageView_imageURL;
 extern NSString* const AST_cell_textLabel_text;
 extern NSString* const AST_cell_textLabel_textAlignment;
 extern NSString* const AST_cell_textLabel_textColor;
@@ -73,11 +78,29 @@ extern NSString* const AST_targetTableViewController;
 extern NSString* const AST_targetResponderChain;
 
 @class ASTItem;
+@class ASTItemTemplate;
+@class ASTCancellationToken;
 @class ASTSection;
 @class ASTViewController;
+@protocol ASTPreferenceStore;
 
 typedef void (^ASTItemActionBlock)( ASTItem* item );
 
+/// When the value action of an item with a control is sent.
+typedef NS_ENUM( NSInteger, ASTValueDelivery ) {
+	/// The action is sent for every change of the value.
+	ASTValueDeliveryImmediate = 0,
+	/// The action is sent for the first change and then at most once per
+	/// valueDeliveryInterval, with the latest value.
+	ASTValueDeliveryThrottled = 1,
+	/// The action is sent once the value did not change for
+	/// valueDeliveryInterval seconds.
+	ASTValueDeliveryDebounced = 2,
+	/// The action is sent when editing ends, the return key is pressed or the
+	/// control is released.
+	ASTValueDeliveryOnCommit = 3,
+};
+
 //------------------------------------------------------------------------------
 
 @interface ASTItem : NSObject
@@ -131,6 +154,22 @@ typedef void (^ASTItemActionBlock)( ASTItem* item );
 /// @return A new ASTItem.
 - (instancetype) initWithDict: (NSDictionary*) dict NS_DESIGNATED_INITIALIZER;
 
+/// Updates the item from a dictionary of parameters so that the item, its cell
+/// and any text being edited can be kept when the data of a table view is
+/// refreshed. Only the cell properties and selection parameters that changed
+/// are applied. Cell properties that the previous dictionary set and this one
+/// does not have are cleared, or get the values of the template. Cell
+/// properties changed since the item was made or last updated, such as text
+/// typed into its cell, are kept unless the dictionary sets them. Data that is
+/// refreshed while a value is edited should have the current value. If the
+/// dictionary describes a different item class or cell, or has parameters the
+/// item can not change, the item is not changed and NO is returned. Subclasses
+/// that have their own parameters override this, update them and pass the rest
+/// to super.
+/// - parameter dict: A dictionary of parameters as passed to initWithDict:.
+/// @return YES if the item was updated.
+- (BOOL) updateWithDict: (NSDictionary*) dict;
+
 /// The class of the cell for this item. This class must be a subclass of UITableViewCell.
 @property (readonly,nonatomic) Class cellClass;
 
@@ -147,6 +186,11 @@ typedef void (^ASTItemActionBlock)( ASTItem* item );
 @property (nullable,nonatomic) NSString* identifier;
 /// The represented object can be used to hold any kind of arbitrary data.
 @property (nullable,nonatomic) id representedObject;
+/// The store preference items read and write their preference in, set with the
+/// AST_prefStore key. When it is not set the item uses the store of its table
+/// view controller, or the standard user defaults when the controller has none.
+/// See ASTPreferenceStore.h.
+@property (null_resettable,nonatomic) id<ASTPreferenceStore> prefStore;
 
 /// Returns the cell to be used by this item. If the cell is nil then it will
 /// be created and returned.
@@ -155,8 +199,12 @@ typedef void (^ASTItemActionBlock)( ASTItem* item );
 @property (readonly) BOOL cellLoaded;
 
 /// Returns a copy of the cell properties. These are all of the properties that
-/// will be set on a cell when it is created.
+/// will be set on a cell when it is created, including those of the template.
+/// Properties of the template that the item cleared are left out.
 @property (readonly,copy) NSDictionary* cellProperties;
+/// The template the item was created with, set with the AST_template key. See
+/// ASTItemTemplate.h.
+@property (readonly,nullable,nonatomic) ASTItemTemplate* itemTemplate;
 
 /// The minimum height for the row. The default is 0 which indicates the row
 /// height is determined by auto layout. If the row would be taller than the
@@ -188,6 +236,43 @@ typedef void (^ASTItemActionBlock)( ASTItem* item );
 /// Deselect the row for this item.
 - (void) deselectWithAnimation: (BOOL) animated;
 
+// Value Changes
+
+/// When the value action of a text field, text view, slider or switch item is
+/// sent, along with the text change notification of the text items. The cell
+/// properties follow the control on every change either way. Throttled and
+/// debounced changes that are waiting are sent when the value is committed.
+/// The default is ASTValueDeliveryImmediate. Set with the AST_valueDelivery
+/// key.
+@property (nonatomic) ASTValueDelivery valueDelivery;
+/// The interval of throttled and debounced delivery in seconds. The default is
+/// 0.3. Set with the AST_valueDeliveryInterval key.
+@property (nonatomic) NSTimeInterval valueDeliveryInterval;
+/// The token of the value last sent by the value action. It is cancelled as
+/// soon as the value changes again, so work started by the action, like an
+/// asynchronous validation, can capture it and drop its result for stale input.
+/// Nil until a value is sent.
+@property (readonly,nullable,nonatomic) ASTCancellationToken* valueChangeToken;
+/// Sends the value action right away if a change of the value is waiting for
+/// the delivery policy.
+- (void) commitValueChange;
+
+// Prefetching
+
+/// Called when the table view expects to display the row of the item soon,
+/// usually before its cell is loaded. Subclasses can override it to start
+/// expensive work for the row, such as computing its text, on a background
+/// queue, and must call super. The default implementation loads the image of
+/// AST_cell_imageView_imageURL into the cache of the shared ASTImageLoader.
+/// Called on the main thread. A lazy item described by a dictionary is built on
+/// a background queue before it is prefetched, so initWithDict: of item classes
+/// used for lazy items must not require the main thread.
+- (void) prefetch;
+/// Called when the row of the item is no longer expected to be displayed, for
+/// example because the scrolling reversed. Work started by prefetch that is not
+/// done should be dropped. Subclasses that override it must call super.
+- (void) cancelPrefetch;
+
 // Editing
 
 /// Determines if the row is editable. Currently used for row deletion.
@@ -217,6 +302,19 @@ typedef void (^ASTItemActionBlock)( ASTItem* item );
 
 //------------------------------------------------------------------------------
 
+/// Tells work started for a value that the value is stale.
+@interface ASTCancellationToken : NSObject
+
+/// YES once the token is cancelled. Can be read on any thread.
+@property (readonly,getter=isCancelled) BOOL cancelled;
+
+/// Cancels the token.
+- (void) cancel;
+
+@end
+
+//------------------------------------------------------------------------------
+
 @interface UITableViewCell( ASTItem )
 
 @property (nullable,nonatomic,readonly) UITableView* tableView;
@@ -241,6 +339,18 @@ typedef void (^ASTItemActionBlock)( ASTItem* item );
 - (void) setImageName: (NSString* __nullable) imageName;
 - (void) setHighlightedImageName: (NSString* __nullable) imageName;
 
+// Loads the image of a file URL with the shared ASTImageLoader, downsampled to
+// the size of the image view, or to the default maximum size of the loader if
+// the image view was not laid out yet or is the image view of a standard cell
+// style, which takes the size of its image. A cached image is set right away,
+// otherwise the image is cleared until the load completes. Setting another URL
+// or nil cancels the load in progress. The URL can also be a string, either a
+// file URL string or a path.
+- (void) setImageURL: (id __nullable) imageURL;
+// Cancels the load started by setImageURL:, if any. Setting the same URL again
+// restarts it.
+- (void) cancelImageLoad;
+
 @end
 
 //------------------------------------------------------------------------------
@@ -30,23 +30,70 @@
 #import "ASTItemSubclass.h"
 
 #import "ASTViewController.h"
+#import "ASTSectionSubclass.h"
+#import "ASTCellPool.h"
+#import "ASTKeyPathSetter.h"
+#import "ASTItemTemplate.h"
+#import "ASTPreferenceObserver.h"
+#import "ASTImageLoader.h"
+#import "ASTPerformanceSpan.h"
 
+#import <objc/runtime.h>
+
+
+//------------------------------------------------------------------------------
+
+static const NSTimeInterval ASTItemDefaultValueDeliveryInterval = 0.3;
+
+static char UIImageView_imageURLKey;
+static char UIImageView_imageLoadTokenKey;
+
+//------------------------------------------------------------------------------
+
+static UITableViewCell* enclosingCell( UIView* view )
+{
+	UIView* parent = view.superview;
+	while( parent && [ parent isKindOfClass: [ UITableViewCell class ] ] == NO ) {
+		parent = parent.superview;
+	}
+	return (UITableViewCell*)parent;
+}
 
 //------------------------------------------------------------------------------
 
-NSString* const AST_cellPropertiesKeyPathPrefix = @"cellProperties.";
+// Image URLs can also be given as strings, such as those of table definitions
+// and JSON data: file URL strings, or paths.
+
+static NSURL* imageFileURL( id value )
+{
+	if( [ value isKindOfClass: [ NSString class ] ] ) {
+		NSString* string = value;
+		return [ string hasPrefix: @"file://" ]
+				? [ NSURL URLWithString: string ] : [ NSURL fileURLWithPath: string ];
+	}
+	return [ value isKindOfClass: [ NSURL class ] ] ? value : nil;
+}
 
 //------------------------------------------------------------------------------
 
-static NSDictionary* removeNullsFromDictionaryLeavingCellProperties( NSDictionary* dict )
+// The values of the template are added first, so that the dictionary overrides
+// them. A null cell property clears the cell property of the template.
+
+static NSDictionary* removeNullsFromDictionaryLeavingCellProperties( NSDictionary* dict,
+		ASTItemTemplate* template )
 {
-	NSMutableDictionary* result = [ NSMutableDictionary dictionaryWithCapacity: dict.count ];
+	NSMutableDictionary* result = [ NSMutableDictionary
+			dictionaryWithCapacity: dict.count + template.dict.count ];
 	Class nullClass = [ NSNull class ];
-	for( id key in  dict ) {
-		id value = dict[ key ];
-		if( [ key hasPrefix: AST_cellPropertiesKeyPathPrefix ]
-				|| [ value isKindOfClass: nullClass ] == NO ) {
-			result[ key ] = value;
+	for( NSDictionary* sourceDict in @[ template.dict ?: @{}, dict ] ) {
+		for( id key in sourceDict ) {
+			id value = sourceDict[ key ];
+			if( [ key hasPrefix: AST_cellPropertiesKeyPathPrefix ]
+					|| [ value isKindOfClass: nullClass ] == NO ) {
+				result[ key ] = value;
+			} else {
+				[ result removeObjectForKey: key ];
+			}
 		}
 	}
 	return result;
@@ -54,8 +101,73 @@ static NSDictionary* removeNullsFromDictionaryLeavingCellProperties( NSDictionar
 
 //------------------------------------------------------------------------------
 
+static ASTItemTemplate* templateOfDictionary( NSDictionary* dict )
+{
+	ASTItemTemplate* result = dict[ AST_template ];
+	NSCAssert( result == nil || [ result isKindOfClass: [ ASTItemTemplate class ] ],
+			@"%@ should be an ASTItemTemplate", AST_template );
+	return result;
+}
+
+//------------------------------------------------------------------------------
+
+static BOOL objectsAreEqual( id object, id otherObject )
+{
+	return object == otherObject || [ object isEqual: otherObject ];
+}
+
+//------------------------------------------------------------------------------
+
+// The item class can be given by name or, as in table definitions, as a Class
+// object.
+
+static Class itemClassFromValue( id itemClassValue, Class defaultClass )
+{
+	if( itemClassValue == nil ) {
+		return defaultClass;
+	}
+	return [ itemClassValue isKindOfClass: [ NSString class ] ]
+			? NSClassFromString( itemClassValue ) : itemClassValue;
+}
+
+//------------------------------------------------------------------------------
+
+// Returns the cell properties of an item dictionary that differ from those of
+// the template. Immutable dictionaries are much smaller, which adds up over
+// thousands of items. They are copied when a cell property first changes.
+
+static NSDictionary* cellPropertiesOfDictionary( NSDictionary* dict, ASTItemTemplate* template )
+{
+	NSDictionary* templateCellProperties = template.cellProperties;
+	NSMutableDictionary* cellProperties = nil;
+	for( NSString* key in dict ) {
+		if( [ key hasPrefix: AST_cellPropertiesKeyPathPrefix ]
+				&& objectsAreEqual( dict[ key ], templateCellProperties[ key ] ) == NO ) {
+			if( cellProperties == nil ) {
+				cellProperties = [ NSMutableDictionary dictionary ];
+			}
+			cellProperties[ key ] = dict[ key ];
+		}
+	}
+	return [ cellProperties copy ];
+}
+
+//------------------------------------------------------------------------------
+
 @interface ASTItem() {
 	CGFloat _minimumHeight;
+	// Keypaths of cell properties that changed but were not applied to the
+	// loaded cell yet.
+	NSMutableOrderedSet* _staleCellKeyPaths;
+	BOOL _cellPropertiesAreMutable;
+	// YES while a change of the value waits for the delivery policy. A
+	// scheduled delivery only runs if the generation did not change since it
+	// was scheduled.
+	BOOL _valueChangePending;
+	NSUInteger _valueDeliveryGeneration;
+	CFTimeInterval _lastValueDeliveryTime;
+	// The load of the image started by prefetch, until it completes.
+	ASTCancellationToken* _prefetchToken;
 }
 
 @end
@@ -92,10 +204,19 @@ static NSDictionary* removeNullsFromDictionaryLeavingCellProperties( NSDictionar
 
 + (instancetype) itemWithDict: (NSDictionary*) dict
 {
-	NSString* className = dict[ AST_itemClass ];
-	Class class = className ? NSClassFromString( className ) : [ self class ];
+	ASTItemTemplate* template = templateOfDictionary( dict );
+	id className = dict[ AST_itemClass ] ?: template.dict[ AST_itemClass ];
+	Class class = itemClassFromValue( className, [ self class ] );
 	NSAssert( [ class isSubclassOfClass: [ ASTItem class ] ], @"type \"%@\" must be a subclass of ASTItem", className );
+	if( template && class != [ ASTItem class ] ) {
+		// Subclasses read their own keys from the dictionary.
+		NSMutableDictionary* templateDict = [ template.dict mutableCopy ];
+		[ templateDict addEntriesFromDictionary: dict ];
+		dict = templateDict;
+	}
+	ASTPerformanceSpan span = ASTPerformanceSpanBegin( ASTCurrentPerformanceMetrics );
 	ASTItem* result = [ [ class alloc ] initWithDict: dict ];
+	ASTPerformanceSpanEnd( span, ASTPerformanceOperationBuildItem, class );
 	return result;
 }
 
@@ -143,10 +264,12 @@ static NSDictionary* removeNullsFromDictionaryLeavingCellProperties( NSDictionar
 {
 	self = [ super init ];
 	if( self ) {
-		dict = removeNullsFromDictionaryLeavingCellProperties( dict );
+		_itemTemplate = templateOfDictionary( dict );
+		dict = removeNullsFromDictionaryLeavingCellProperties( dict, _itemTemplate );
 
 		_identifier = dict[ AST_id ];
 		_representedObject = dict[ AST_representedObject ];
+		_prefStore = dict[ AST_prefStore ];
 		
 		id selectActionValue = dict[ AST_selectAction ];
 		if( selectActionValue ) {
@@ -202,13 +325,13 @@ static NSDictionary* removeNullsFromDictionaryLeavingCellProperties( NSDictionar
 			_minimumHeight = [ minimumHeightValue floatValue ];
 		}
 		
-		NSMutableDictionary* cellProperties = [ NSMutableDictionary dictionary ];
-		for( NSString* key in dict ) {
-			if( [ key hasPrefix: AST_cellPropertiesKeyPathPrefix ] ) {
-				cellProperties[ key ] = dict[ key ];
-			}
-		}
-		_cellProperties = cellProperties;
+		_valueDelivery = [ dict[ AST_valueDelivery ] integerValue ];
+		id valueDeliveryIntervalValue = dict[ AST_valueDeliveryInterval ];
+		_valueDeliveryInterval = valueDeliveryIntervalValue
+				? [ valueDeliveryIntervalValue doubleValue ] : ASTItemDefaultValueDeliveryInterval;
+		
+		_cellProperties = cellPropertiesOfDictionary( dict, _itemTemplate );
+		_dictCellProperties = _cellProperties;
 	}
 	
 	return self;
@@ -216,9 +339,195 @@ static NSDictionary* removeNullsFromDictionaryLeavingCellProperties( NSDictionar
 
 //------------------------------------------------------------------------------
 
+- (BOOL) updateWithDict: (NSDictionary*) dict
+{
+	if( templateOfDictionary( dict ) != _itemTemplate ) {
+		return NO;
+	}
+	dict = removeNullsFromDictionaryLeavingCellProperties( dict, _itemTemplate );
+	
+	// Everything is checked before anything is changed so that the item is
+	// left alone when it has to be replaced.
+	Class itemClass = itemClassFromValue( dict[ AST_itemClass ], [ ASTItem class ] );
+	if( itemClass != [ self class ] ) {
+		return NO;
+	}
+	
+	// Subclasses pick their own cell class and style when none is given.
+	id cellClassValue = dict[ AST_cellClass ];
+	Class cellClass = [ cellClassValue isKindOfClass: [ NSString class ] ]
+			? NSClassFromString( cellClassValue ) : cellClassValue;
+	id cellStyleValue = dict[ AST_cellStyle ];
+	if( (cellClass && cellClass != _cellClass)
+			|| (cellStyleValue && [ cellStyleValue integerValue ] != _cellStyle)
+			|| objectsAreEqual( dict[ AST_cellReuseIdentifier ], _cellReuseIdentifier ) == NO ) {
+		return NO;
+	}
+	
+	static NSSet* updatableKeys = nil;
+	static dispatch_once_t onceToken;
+	dispatch_once( &onceToken, ^{
+		updatableKeys = [ NSSet setWithObjects: AST_itemClass, AST_template, AST_cellClass,
+				AST_cellStyle, AST_cellReuseIdentifier, AST_id, AST_representedObject,
+				AST_selectable, AST_selectAction, AST_selectActionTarget,
+				AST_selectActionBlock, AST_deselectAutomatically, AST_minimumHeight,
+				AST_valueDelivery, AST_valueDeliveryInterval, nil ];
+	} );
+	for( NSString* key in dict ) {
+		if( [ key hasPrefix: AST_cellPropertiesKeyPathPrefix ] == NO
+				&& [ updatableKeys containsObject: key ] == NO ) {
+			return NO;
+		}
+	}
+	if( objectsAreEqual( dict[ AST_id ], _identifier ) == NO ) {
+		self.identifier = dict[ AST_id ];
+	}
+	if( objectsAreEqual( dict[ AST_representedObject ], _representedObject ) == NO ) {
+		self.representedObject = dict[ AST_representedObject ];
+	}
+	CGFloat minimumHeight = [ dict[ AST_minimumHeight ] floatValue ];
+	if( minimumHeight != _minimumHeight ) {
+		[ self setValue: @(minimumHeight) forKeyPath: AST_minimumHeight ];
+	}
+	
+	// The selection parameters get the values initWithDict: would give them.
+	id selectActionValue = dict[ AST_selectAction ];
+	SEL selectAction = selectActionValue ? NSSelectorFromString( selectActionValue ) : NULL;
+	if( selectAction != _selectAction ) {
+		self.selectAction = selectAction;
+	}
+	ASTItemActionBlock selectBlock = dict[ AST_selectActionBlock ];
+	if( selectBlock != _selectBlock ) {
+		self.selectBlock = selectBlock;
+	}
+	id selectActionTarget = dict[ AST_selectActionTarget ];
+	if( selectActionTarget != _selectActionTarget ) {
+		[ self setValue: selectActionTarget forKeyPath: AST_selectActionTarget ];
+	}
+	id selectableValue = dict[ AST_selectable ];
+	BOOL selectable = selectableValue ? [ selectableValue boolValue ]
+			: selectAction != NULL || selectBlock != nil;
+	if( selectable != _selectable ) {
+		[ self setValue: @(selectable) forKeyPath: AST_selectable ];
+	}
+	BOOL deselectAutomatically = [ dict[ AST_deselectAutomatically ] boolValue ];
+	if( deselectAutomatically != _deselectAutomatically ) {
+		[ self setValue: @(deselectAutomatically) forKeyPath: AST_deselectAutomatically ];
+	}
+	self.valueDelivery = [ dict[ AST_valueDelivery ] integerValue ];
+	id valueDeliveryIntervalValue = dict[ AST_valueDeliveryInterval ];
+	_valueDeliveryInterval = valueDeliveryIntervalValue
+			? [ valueDeliveryIntervalValue doubleValue ] : ASTItemDefaultValueDeliveryInterval;
+	
+	// The cell properties that the previous dictionary set and this one does
+	// not have go back to the values of the template. Those changed since, such
+	// as text typed into the cell, are kept.
+	for( NSString* key in _dictCellProperties ) {
+		if( dict[ key ] == nil ) {
+			[ self setValue: _itemTemplate.cellProperties[ key ] forKeyPath: key ];
+		}
+	}
+	for( NSString* key in dict ) {
+		if( [ key hasPrefix: AST_cellPropertiesKeyPathPrefix ]
+				&& objectsAreEqual( dict[ key ], [ self cellPropertiesValueForKeyPath: key ] ) == NO ) {
+			[ self setValue: dict[ key ] forKeyPath: key ];
+		}
+	}
+	
+	// An item without other changes shares the dictionary again.
+	_dictCellProperties = cellPropertiesOfDictionary( dict, _itemTemplate );
+	if( objectsAreEqual( _cellProperties, _dictCellProperties ) ) {
+		_cellProperties = _dictCellProperties;
+		_cellPropertiesAreMutable = NO;
+	}
+	
+	return YES;
+}
+
+//------------------------------------------------------------------------------
+
 - (void) dealloc
 {
-	[ self didEndDisplayingCell ];
+	// If the cell is still on screen the table view controller puts it back in
+	// the pool when the table view is done displaying it.
+	if( _cell ) {
+		[ self unloadCell ];
+	}
+	if( _observedPrefStore ) {
+		[ [ ASTPreferenceObserver observerForStore: _observedPrefStore ]
+				removeObserver: (id<ASTPreferenceObserving>)self forKey: _observedPrefKey ];
+	}
+}
+
+//------------------------------------------------------------------------------
+
+- (void) setTableViewController: (ASTViewController*) tableViewController
+{
+	ASTViewController* oldTableViewController = _tableViewController;
+	_tableViewController = tableViewController;
+	if( oldTableViewController != tableViewController ) {
+		[ oldTableViewController setNeedsSearchIndexUpdateForItem: self ];
+		[ tableViewController setNeedsSearchIndexUpdateForItem: self ];
+	}
+	
+	// The store of the table view controller is the default store. Items built
+	// on a background queue start observing their key here.
+	if( _observedPrefKey && ( _prefStore == nil || _observedPrefStore == nil ) ) {
+		[ self prefStoreMayHaveChanged ];
+	}
+}
+
+//------------------------------------------------------------------------------
+
+- (id<ASTPreferenceStore>) prefStore
+{
+	return _prefStore ?: self.tableViewController.prefStore
+			?: [ NSUserDefaults standardUserDefaults ];
+}
+
+//------------------------------------------------------------------------------
+
+- (void) setPrefStore: (id<ASTPreferenceStore>) prefStore
+{
+	_prefStore = prefStore;
+	[ self prefStoreMayHaveChanged ];
+}
+
+//------------------------------------------------------------------------------
+
+- (void) observePrefKey: (NSString*) key
+{
+	NSAssert( key == nil || [ self conformsToProtocol: @protocol(ASTPreferenceObserving) ],
+			@"%@ does not observe preferences", self );
+	
+	if( _observedPrefStore ) {
+		[ [ ASTPreferenceObserver observerForStore: _observedPrefStore ]
+				removeObserver: (id<ASTPreferenceObserving>)self forKey: _observedPrefKey ];
+	}
+	_observedPrefKey = [ key copy ];
+	// The observers are only used on the main thread. Items built on a
+	// background queue by buildData:forStyle:completion: keep the key and
+	// register when they are given their table view controller.
+	_observedPrefStore = key && [ NSThread isMainThread ] ? self.prefStore : nil;
+	if( _observedPrefStore ) {
+		[ [ ASTPreferenceObserver observerForStore: _observedPrefStore ]
+				addObserver: (id<ASTPreferenceObserving>)self forKey: _observedPrefKey ];
+	}
+}
+
+//------------------------------------------------------------------------------
+
+- (void) prefStoreMayHaveChanged
+{
+	if( _observedPrefKey == nil || [ NSThread isMainThread ] == NO
+			|| self.prefStore == _observedPrefStore ) {
+		return;
+	}
+	
+	[ self observePrefKey: _observedPrefKey ];
+	[ (id<ASTPreferenceObserving>)self preferenceValue:
+			[ _observedPrefStore objectForKey: _observedPrefKey ]
+			didChangeForKey: _observedPrefKey ];
 }
 
 //------------------------------------------------------------------------------
@@ -230,6 +539,37 @@ static NSDictionary* removeNullsFromDictionaryLeavingCellProperties( NSDictionar
 
 //------------------------------------------------------------------------------
 
+- (void) setIdentifier: (NSString*) identifier
+{
+	NSString* oldIdentifier = _identifier;
+	_identifier = identifier;
+	[ self.indexedContainer indexedObject: self didChangeValueForKey: @"identifier"
+			fromValue: oldIdentifier ];
+	[ self.tableViewController setNeedsSearchIndexUpdateForItem: self ];
+}
+
+//------------------------------------------------------------------------------
+
+- (void) setRepresentedObject: (id) representedObject
+{
+	id oldRepresentedObject = _representedObject;
+	_representedObject = representedObject;
+	[ self.indexedContainer indexedObject: self didChangeValueForKey: @"representedObject"
+			fromValue: oldRepresentedObject ];
+}
+
+//------------------------------------------------------------------------------
+
+// The section, or the table view controller of a plain table view, that keeps
+// an index of the identifiers and represented objects of its items.
+
+- (id<ASTObjectIndexContainer>) indexedContainer
+{
+	return self.section ?: (id<ASTObjectIndexContainer>)self.tableViewController;
+}
+
+//------------------------------------------------------------------------------
+
 - (void) removeFromContainerWithAnimation: (UITableViewRowAnimation) rowAnimation;
 {
 	NSIndexPath* indexPath = self.indexPath;
@@ -245,7 +585,11 @@ static NSDictionary* removeNullsFromDictionaryLeavingCellProperties( NSDictionar
 - (UITableViewCell*) cell
 {
 	if( _cell == nil ) {
+		ASTPerformanceSpan span = ASTPerformanceSpanBegin( self.tableViewController.performanceMetrics );
 		[ self loadCell ];
+		ASTPerformanceSpanEnd( span, ASTPerformanceOperationLoadCell, [ self class ] );
+	} else if( _staleCellKeyPaths ) {
+		[ self applyStaleCellProperties ];
 	}
 	return _cell;
 }
@@ -259,126 +603,34 @@ static NSDictionary* removeNullsFromDictionaryLeavingCellProperties( NSDictionar
 
 //------------------------------------------------------------------------------
 
-- (void) setValue: (id) value forObject: (id) object forFancyKeypath: (NSString*) fancyKeypath
-{
-	NSArray* components = [ fancyKeypath componentsSeparatedByString: @"." ];
-	NSUInteger componentCount = components.count;
-	id currentTarget = object;
-	NSUInteger componentIndex = 0;
-	for( NSString* component in components ) {
-		BOOL lastComponent = componentIndex == componentCount - 1;
-		if( [ component hasPrefix: @"-" ] ) {
-			SEL keySelector = NSSelectorFromString( [ component substringFromIndex: 1 ] );
-			if( lastComponent ) {
-				NSMethodSignature* signature = [ currentTarget methodSignatureForSelector: keySelector ];
-				NSAssert2( signature != nil, @"No signature for selector: %@ with object: %@", component, currentTarget );
-				NSAssert2( [ signature numberOfArguments ] == 3, @"Wrong number of arguments, selector: %@ with object: %@", component, currentTarget );
-
-				__strong NSInvocation* invocation = [ NSInvocation invocationWithMethodSignature: signature ];
-				[ invocation setTarget: currentTarget ];
-				[ invocation setSelector: keySelector ];
-				
-				NSUInteger argIndex = 2;
-				const char * argType = [ signature getArgumentTypeAtIndex: argIndex ];
-				if( strcmp( argType, "@" ) == 0 ) {
-					[ invocation setArgument: &value atIndex: argIndex ];
-				} else if( strcmp( argType, "*" ) == 0 ) {
-					const char* argValue = [ value UTF8String ];
-					[ invocation setArgument: &argValue atIndex: argIndex ];
-				} else if( strcmp( argType, "r*" ) == 0 ) {
-					const char* argValue = [ value UTF8String ];
-					[ invocation setArgument: &argValue atIndex: argIndex ];
-				} else if( strcmp( argType, "c" ) == 0 ) {
-					char argValue = [ value charValue ];
-					[ invocation setArgument: &argValue atIndex: argIndex ];
-				} else if( strcmp( argType, "i" ) == 0 ) {
-					int argValue = [ value intValue ];
-					[ invocation setArgument: &argValue atIndex: argIndex ];
-				} else if( strcmp( argType, "s" ) == 0 ) {
-					short argValue = [ value shortValue ];
-					[ invocation setArgument: &argValue atIndex: argIndex ];
-				} else if( strcmp( argType, "l" ) == 0 ) {
-// LCOV_EXCL_START
-					// On 64 bit systems this appears to never get hit. Not
-					// sure if we should remove it or not.
-					long argValue = [ value longValue ];
-					[ invocation setArgument: &argValue atIndex: argIndex ];
-// LCOV_EXCL_STOP
-				} else if( strcmp( argType, "q" ) == 0 ) {
-					long long argValue = [ value longLongValue ];
-					[ invocation setArgument: &argValue atIndex: argIndex ];
-				} else if( strcmp( argType, "C" ) == 0 ) {
-					unsigned char argValue = [ value unsignedCharValue ];
-					[ invocation setArgument: &argValue atIndex: argIndex ];
-				} else if( strcmp( argType, "I" ) == 0 ) {
-					unsigned int argValue = [ value unsignedIntValue ];
-					[ invocation setArgument: &argValue atIndex: argIndex ];
-				} else if( strcmp( argType, "S" ) == 0 ) {
-					unsigned short argValue = [ value unsignedShortValue ];
-					[ invocation setArgument: &argValue atIndex: argIndex ];
-				} else if( strcmp( argType, "L" ) == 0 ) {
-// LCOV_EXCL_START
-					// On 64 bit systems this appears to never get hit. Not
-					// sure if we should remove it or not.
-					unsigned long argValue = [ value unsignedLongValue ];
-					[ invocation setArgument: &argValue atIndex: argIndex ];
-// LCOV_EXCL_STOP
-				} else if( strcmp( argType, "Q" ) == 0 ) {
-					unsigned long long argValue = [ value unsignedLongLongValue ];
-					[ invocation setArgument: &argValue atIndex: argIndex ];
-				} else if( strcmp( argType, "f" ) == 0 ) {
-					float argValue = [ value floatValue ];
-					[ invocation setArgument: &argValue atIndex: argIndex ];
-				} else if( strcmp( argType, "d" ) == 0 ) {
-					double argValue = [ value doubleValue ];
-					[ invocation setArgument: &argValue atIndex: argIndex ];
-				} else if( strcmp( argType, "B" ) == 0 ) {
-					BOOL argValue = [ value boolValue ];
-					[ invocation setArgument: &argValue atIndex: argIndex ];
-				} else if( strcmp( argType, ":" ) == 0 ) {
-					SEL argValue = NSSelectorFromString( value );
-					[ invocation setArgument: &argValue atIndex: argIndex ];
-				} else if( strcmp( argType, "#" ) == 0 ) {
-					[ invocation setArgument: &value atIndex: argIndex ];
-				} else {
-					[ NSException raise: @"Unknown argument type" format: @"Encountered and unknown argument with type %s", argType ];
-				}
-				[ invocation invoke ];
-			} else {
-#pragma clang diagnostic push
-#pragma clang diagnostic ignored "-Warc-performSelector-leaks"
-				currentTarget = [ currentTarget performSelector: keySelector ];
-#pragma clang diagnostic pop
-			}
-		} else {
-			if( lastComponent ) {
-				[ currentTarget setValue: value forKey: component ];
-			} else {
-				currentTarget = [ currentTarget valueForKey: component ];
-			}
-		}
-		++componentIndex;
-	}
-}
-
-//------------------------------------------------------------------------------
-
 - (void) loadCell
 {
 	UITableViewCell* cell = nil;
+	ASTCellPool* cellPool = self.tableViewController.cellPool;
 	
 	if( _cellReuseIdentifier ) {
 		cell = [ self.tableViewController.tableView
 				dequeueReusableCellWithIdentifier: _cellReuseIdentifier
-				forIndexPath: self.indexPath ];
+				forIndexPath: [ self.tableViewController displayedIndexPathForItem: self ] ];
 		NSAssert( cell != nil, @"Creating cell failed for reuse identifier \"%@\"", _cellReuseIdentifier );
 	} else {
-		cell = [ [ _cellClass alloc ] initWithStyle: _cellStyle reuseIdentifier: nil ];
+		cell = [ cellPool dequeueCellWithClass: _cellClass style: _cellStyle ];
+		if( cell == nil ) {
+			cell = [ [ _cellClass alloc ] initWithStyle: _cellStyle reuseIdentifier: nil ];
+		}
 		NSAssert( cell != nil, @"Creating cell failed for cell class \"%@\"", NSStringFromClass( _cellClass ) );
 	}
 	
 	_cell = cell;
+	_staleCellKeyPaths = nil;
+	[ cellPool bindCell: cell toItem: self ];
 	
+	for( NSString* keyPath in _itemTemplate.cellProperties ) {
+		if( _cellProperties[ keyPath ] == nil ) {
+			id value = _itemTemplate.cellProperties[ keyPath ];
+			[ self setCellPropertyValue: value forKeyPath: keyPath ];
+		}
+	}
 	for( NSString* keyPath in _cellProperties ) {
 		id value = _cellProperties[ keyPath ];
 		[ self setCellPropertyValue: value forKeyPath: keyPath ];
@@ -389,22 +641,111 @@ static NSDictionary* removeNullsFromDictionaryLeavingCellProperties( NSDictionar
 
 //------------------------------------------------------------------------------
 
+- (void) unloadCell
+{
+	if( _cell && [ self cellPropertiesValueForKeyPath: AST_cell_imageView_imageURL ] ) {
+		[ _cell.imageView cancelImageLoad ];
+	}
+	[ self.tableViewController.cellPool unbindCell: _cell fromItem: self ];
+	_cell = nil;
+	_cellDisplayed = NO;
+	_staleCellKeyPaths = nil;
+}
+
+//------------------------------------------------------------------------------
+
+- (void) setCellDisplayed: (BOOL) cellDisplayed
+{
+	_cellDisplayed = cellDisplayed;
+	if( cellDisplayed ) {
+		[ self applyStaleCellProperties ];
+	}
+}
+
+//------------------------------------------------------------------------------
+
+- (void) cellPropertyDidChangeForKeyPath: (NSString*) keyPath
+{
+	if( _staleCellKeyPaths == nil ) {
+		_staleCellKeyPaths = [ NSMutableOrderedSet orderedSet ];
+	}
+	[ _staleCellKeyPaths addObject: keyPath ];
+	
+	// Cells that are not on screen are only updated when they are displayed.
+	if( _cellDisplayed ) {
+		[ self.tableViewController setNeedsCellUpdateForItem: self ];
+	}
+}
+
+//------------------------------------------------------------------------------
+
+- (void) applyStaleCellProperties
+{
+	if( _staleCellKeyPaths == nil || _cell == nil ) {
+		return;
+	}
+	ASTPerformanceSpan span = ASTPerformanceSpanBegin( self.tableViewController.performanceMetrics );
+	NSOrderedSet* keyPaths = _staleCellKeyPaths;
+	_staleCellKeyPaths = nil;
+	for( NSString* keyPath in keyPaths ) {
+		[ self setCellPropertyValue: [ self cellPropertiesValueForKeyPath: keyPath ]
+				forKeyPath: keyPath ];
+	}
+	ASTPerformanceSpanEnd( span, ASTPerformanceOperationApplyCellProperties, [ self class ] );
+}
+
+//------------------------------------------------------------------------------
+
 - (void) setCellPropertiesValue: (id) value forKeyPath: (NSString*) keyPath
 {
 	NSParameterAssert( keyPath );
 	
+	// Values of the template are not copied. A null hides the value of the
+	// template.
+	id templateValue = _itemTemplate.cellProperties[ keyPath ];
+	if( value == nil && templateValue ) {
+		value = [ NSNull null ];
+	}
+	if( objectsAreEqual( value, templateValue ) ) {
+		value = nil;
+	}
+	if( value == nil && _cellProperties[ keyPath ] == nil ) {
+		return;
+	}
+	
+	if( _cellPropertiesAreMutable == NO ) {
+		_cellProperties = [ _cellProperties mutableCopy ] ?: [ NSMutableDictionary dictionary ];
+		_cellPropertiesAreMutable = YES;
+	}
+	NSMutableDictionary* cellProperties = (NSMutableDictionary*)_cellProperties;
 	if( value ) {
-		_cellProperties[ keyPath ] = value;
+		cellProperties[ keyPath ] = value;
 	} else {
-		[ _cellProperties removeObjectForKey: keyPath ];
+		[ cellProperties removeObjectForKey: keyPath ];
+	}
+	
+	if( [ keyPath isEqualToString: AST_cell_textLabel_text ]
+			|| [ keyPath isEqualToString: AST_cell_detailTextLabel_text ] ) {
+		[ self.tableViewController setNeedsSearchIndexUpdateForItem: self ];
 	}
 }
 
 //------------------------------------------------------------------------------
 
+// A null that hides the value of the template reads as nil. Loading the cell
+// reads _cellProperties itself to tell the two apart. Other nulls are values
+// the item was given and are returned as they are.
+
 - (id) cellPropertiesValueForKeyPath: (NSString*) keyPath
 {
-	return _cellProperties[ keyPath ];
+	id result = _cellProperties[ keyPath ];
+	if( result == nil ) {
+		return _itemTemplate.cellProperties[ keyPath ];
+	}
+	if( result == [ NSNull null ] && _itemTemplate.cellProperties[ keyPath ] ) {
+		return nil;
+	}
+	return result;
 }
 
 //------------------------------------------------------------------------------
@@ -417,8 +758,13 @@ static NSDictionary* removeNullsFromDictionaryLeavingCellProperties( NSDictionar
 		if( [ value isEqual: [ NSNull null ] ] ) {
 			value = nil;
 		}
-		NSString* remainder = [ keyPath substringFromIndex: AST_cellPropertiesKeyPathPrefix.length ];
-		[ self setValue: value forObject: _cell forFancyKeypath: remainder ];
+		[ self.tableViewController.cellPool willApplyCellPropertyForKeyPath: keyPath
+				toCell: _cell ];
+		[ [ ASTKeyPathSetter setterForCellClass: [ _cell class ] cellPropertyKeyPath: keyPath ]
+				setValue: value forObject: _cell ];
+		if( ASTCurrentPerformanceMetrics ) {
+			[ ASTCurrentPerformanceMetrics recordAppliedCellProperty ];
+		}
 	}
 }
 
@@ -426,7 +772,16 @@ static NSDictionary* removeNullsFromDictionaryLeavingCellProperties( NSDictionar
 
 - (NSDictionary*) cellProperties
 {
-	return [ _cellProperties copy ];
+	NSDictionary* templateCellProperties = _itemTemplate.cellProperties;
+	NSMutableDictionary* result = [ templateCellProperties mutableCopy ]
+			?: [ NSMutableDictionary dictionaryWithCapacity: _cellProperties.count ];
+	[ result addEntriesFromDictionary: _cellProperties ];
+	for( NSString* keyPath in templateCellProperties ) {
+		if( _cellProperties[ keyPath ] == [ NSNull null ] ) {
+			[ result removeObjectForKey: keyPath ];
+		}
+	}
+	return result;
 }
 
 //------------------------------------------------------------------------------
@@ -435,7 +790,14 @@ static NSDictionary* removeNullsFromDictionaryLeavingCellProperties( NSDictionar
 {
 	if( [ keyPath hasPrefix: AST_cellPropertiesKeyPathPrefix ] ) {
 		[ self setCellPropertiesValue: value forKeyPath: keyPath ];
-		[ self setCellPropertyValue: value forKeyPath: keyPath ];
+		if( _cell && self.tableViewController.defersCellUpdates ) {
+			[ self cellPropertyDidChangeForKeyPath: keyPath ];
+		} else {
+			ASTPerformanceSpan span = ASTPerformanceSpanBegin(
+					_cell ? self.tableViewController.performanceMetrics : nil );
+			[ self setCellPropertyValue: value forKeyPath: keyPath ];
+			ASTPerformanceSpanEnd( span, ASTPerformanceOperationApplyCellProperties, [ self class ] );
+		}
 	} else {
 // LCOV_EXCL_START
 		[ super setValue: value forKeyPath: keyPath ];
@@ -477,8 +839,10 @@ static NSDictionary* removeNullsFromDictionaryLeavingCellProperties( NSDictionar
 
 - (void) minimumHeightChanged
 {
+	// The constraint is installed on the content view, which is also where it
+	// has to be found when a reused cell is configured again.
 	NSLayoutConstraint* minimumHeightConstraint = nil;
-	for( NSLayoutConstraint* constraint in _cell.constraints ) {
+	for( NSLayoutConstraint* constraint in _cell.contentView.constraints ) {
 		if( [ constraint.identifier isEqualToString: @"minimumHeightConstraint" ] ) {
 			minimumHeightConstraint = constraint;
 			break;
@@ -587,7 +951,49 @@ static NSDictionary* removeNullsFromDictionaryLeavingCellProperties( NSDictionar
 - (void) didEndDisplayingCell
 {
 	// The behavior of UITableView has changed so we can no longer depend on
-	// this call to mean the cell is going away.
+	// this call to mean the cell is going away. When the table view controller
+	// reuses cells it unloads the cell after this call and puts it in the pool.
+	
+	// The image of a row that left the screen is not loaded further. It is
+	// loaded again if the row is displayed again.
+	if( _cell && [ self cellPropertiesValueForKeyPath: AST_cell_imageView_imageURL ] ) {
+		[ _cell.imageView cancelImageLoad ];
+		[ self cellPropertyDidChangeForKeyPath: AST_cell_imageView_imageURL ];
+	}
+}
+
+//------------------------------------------------------------------------------
+
+- (void) prefetch
+{
+	NSURL* imageURL = imageFileURL( [ self cellPropertiesValueForKeyPath: AST_cell_imageView_imageURL ] );
+	if( _prefetchToken || imageURL == nil ) {
+		return;
+	}
+	
+	// The image is loaded at the size image views use before they are laid
+	// out, so the image view of the cell finds it in the cache.
+	ASTImageLoader* loader = [ ASTImageLoader sharedLoader ];
+	CGFloat maximumSize = loader.defaultMaximumSize;
+	if( [ loader cachedImageWithURL: imageURL maximumSize: maximumSize ] ) {
+		return;
+	}
+	__weak ASTItem* weakSelf = self;
+	_prefetchToken = [ loader loadImageWithURL: imageURL maximumSize: maximumSize
+			completion: ^( UIImage* image ) {
+		ASTItem* strongSelf = weakSelf;
+		if( strongSelf ) {
+			strongSelf->_prefetchToken = nil;
+		}
+	} ];
+}
+
+//------------------------------------------------------------------------------
+
+- (void) cancelPrefetch
+{
+	[ _prefetchToken cancel ];
+	_prefetchToken = nil;
 }
 
 //------------------------------------------------------------------------------
@@ -595,7 +1001,7 @@ static NSDictionary* removeNullsFromDictionaryLeavingCellProperties( NSDictionar
 - (void) scrollToPosition: (UITableViewScrollPosition) position
 		animated: (BOOL) animated
 {
-	NSIndexPath* indexPath = self.indexPath;
+	NSIndexPath* indexPath = [ self.tableViewController displayedIndexPathForItem: self ];
 	UITableView* tableView = self.tableViewController.tableView;
 	if( tableView && indexPath ) {
 		[ tableView scrollToRowAtIndexPath: indexPath
@@ -606,6 +1012,118 @@ static NSDictionary* removeNullsFromDictionaryLeavingCellProperties( NSDictionar
 
 //------------------------------------------------------------------------------
 
+- (void) setValueDelivery: (ASTValueDelivery) valueDelivery
+{
+	// A change waiting for the old policy is not left behind.
+	if( valueDelivery != _valueDelivery ) {
+		_valueDelivery = valueDelivery;
+		[ self commitValueChange ];
+	}
+}
+
+//------------------------------------------------------------------------------
+
+- (void) valueDidChange
+{
+	[ _valueChangeToken cancel ];
+	
+	switch( _valueDelivery ) {
+		case ASTValueDeliveryImmediate:
+			[ self deliverValueChange ];
+			break;
+		
+		case ASTValueDeliveryThrottled: {
+			// A scheduled delivery sends the latest value.
+			if( _valueChangePending ) {
+				break;
+			}
+			NSTimeInterval delay = _lastValueDeliveryTime + _valueDeliveryInterval
+					- CACurrentMediaTime();
+			if( delay <= 0 ) {
+				[ self deliverValueChange ];
+			} else {
+				_valueChangePending = YES;
+				[ self scheduleValueDeliveryAfterDelay: delay ];
+			}
+			break;
+		}
+		
+		case ASTValueDeliveryDebounced:
+			_valueChangePending = YES;
+			[ self scheduleValueDeliveryAfterDelay: _valueDeliveryInterval ];
+			break;
+		
+		case ASTValueDeliveryOnCommit:
+			_valueChangePending = YES;
+			break;
+	}
+}
+
+//------------------------------------------------------------------------------
+
+- (void) scheduleValueDeliveryAfterDelay: (NSTimeInterval) delay
+{
+	NSUInteger generation = ++_valueDeliveryGeneration;
+	__weak ASTItem* weakSelf = self;
+	dispatch_after( dispatch_time( DISPATCH_TIME_NOW, (int64_t)(delay * NSEC_PER_SEC) ),
+			dispatch_get_main_queue(), ^{
+		ASTItem* strongSelf = weakSelf;
+		if( strongSelf && strongSelf->_valueDeliveryGeneration == generation ) {
+			[ strongSelf deliverValueChange ];
+		}
+	} );
+}
+
+//------------------------------------------------------------------------------
+
+- (void) commitValueChange
+{
+	if( _valueChangePending ) {
+		[ self deliverValueChange ];
+	}
+}
+
+//------------------------------------------------------------------------------
+
+- (void) deliverValueChange
+{
+	// Invalidates the scheduled delivery.
+	++_valueDeliveryGeneration;
+	_valueChangePending = NO;
+	_lastValueDeliveryTime = CACurrentMediaTime();
+	_valueChangeToken = [ [ ASTCancellationToken alloc ] init ];
+	[ self sendValueChange ];
+}
+
+//------------------------------------------------------------------------------
+
+- (void) sendValueChange
+{
+}
+
+//------------------------------------------------------------------------------
+
+- (void) rowHeightDidChange
+{
+}
+
+//------------------------------------------------------------------------------
+
+@end
+
+//------------------------------------------------------------------------------
+
+@implementation ASTCancellationToken
+
+//------------------------------------------------------------------------------
+
+- (void) cancel
+{
+	_cancelled = YES;
+}
+
+//------------------------------------------------------------------------------
+
 @end
 
 //------------------------------------------------------------------------------
@@ -756,6 +1274,69 @@ static NSDictionary* removeNullsFromDictionaryLeavingCellProperties( NSDictionar
 
 //------------------------------------------------------------------------------
 
+- (void) setImageURL: (id) imageURLValue
+{
+	NSURL* imageURL = imageFileURL( imageURLValue );
+	NSURL* currentURL = objc_getAssociatedObject( self, &UIImageView_imageURLKey );
+	ASTCancellationToken* token = objc_getAssociatedObject( self, &UIImageView_imageLoadTokenKey );
+	if( imageURL && [ imageURL isEqual: currentURL ] && ( token || self.image ) ) {
+		return;
+	}
+	
+	[ token cancel ];
+	objc_setAssociatedObject( self, &UIImageView_imageLoadTokenKey, nil,
+			OBJC_ASSOCIATION_RETAIN_NONATOMIC );
+	objc_setAssociatedObject( self, &UIImageView_imageURLKey, imageURL,
+			OBJC_ASSOCIATION_COPY_NONATOMIC );
+	if( imageURL == nil ) {
+		[ self setImage: nil ];
+		return;
+	}
+	
+	// The image view of the standard cell styles takes the size of its image,
+	// so its bounds do not tell the size the image should have.
+	ASTImageLoader* loader = [ ASTImageLoader sharedLoader ];
+	CGSize size = self.bounds.size;
+	BOOL sizedByImage = enclosingCell( self ).imageView == self;
+	CGFloat maximumSize = size.width > 0 && size.height > 0 && sizedByImage == NO ?
+			MAX( size.width, size.height ) : loader.defaultMaximumSize;
+	UIImage* cachedImage = [ loader cachedImageWithURL: imageURL maximumSize: maximumSize ];
+	[ self setImage: cachedImage ];
+	if( cachedImage ) {
+		return;
+	}
+	
+	__weak UIImageView* weakSelf = self;
+	token = [ loader loadImageWithURL: imageURL maximumSize: maximumSize
+			completion: ^( UIImage* image ) {
+		UIImageView* strongSelf = weakSelf;
+		if( strongSelf == nil ) {
+			return;
+		}
+		objc_setAssociatedObject( strongSelf, &UIImageView_imageLoadTokenKey, nil,
+				OBJC_ASSOCIATION_RETAIN_NONATOMIC );
+		[ strongSelf setImage: image ];
+		
+		// The standard cell styles size the image view for its image when
+		// the cell lays out its subviews.
+		[ enclosingCell( strongSelf ) setNeedsLayout ];
+	} ];
+	objc_setAssociatedObject( self, &UIImageView_imageLoadTokenKey, token,
+			OBJC_ASSOCIATION_RETAIN_NONATOMIC );
+}
+
+//------------------------------------------------------------------------------
+
+- (void) cancelImageLoad
+{
+	ASTCancellationToken* token = objc_getAssociatedObject( self, &UIImageView_imageLoadTokenKey );
+	[ token cancel ];
+	objc_setAssociatedObject( self, &UIImageView_imageLoadTokenKey, nil,
+			OBJC_ASSOCIATION_RETAIN_NONATOMIC );
+}
+
+//------------------------------------------------------------------------------
+
 @end
 
 //------------------------------------------------------------------------------
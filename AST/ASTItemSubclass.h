@@ -29,13 +29,29 @@
 // Why are you looking here? It said private!
 
 #import "ASTItem.h"
+#import "ASTViewController.h"
+#import "ASTPreferenceStore.h"
 
 
 NS_ASSUME_NONNULL_BEGIN
 
+extern NSString* const AST_cellPropertiesKeyPathPrefix;
+
 @interface ASTItem() {
-	NSMutableDictionary* _cellProperties;
+	// The cell properties that differ from those of the template. The
+	// dictionary is immutable, or nil, until a cell property is changed.
+	NSDictionary* _cellProperties;
+	// The cell properties set by the dictionary the item was made or last
+	// updated from. It is the same dictionary as _cellProperties until a cell
+	// property is changed, so it costs nothing for most items.
+	NSDictionary* _dictCellProperties;
 	UITableViewCell* _cell;
+	// The store of the item, nil unless it has its own. See prefStore.
+	id<ASTPreferenceStore> _prefStore;
+	// The preference key registered with observePrefKey: and the store it is
+	// observed in, nil while it is not observed yet.
+	NSString* _observedPrefKey;
+	id<ASTPreferenceStore> _observedPrefStore;
 }
 
 @property (nonatomic) Class cellClass;
@@ -43,9 +59,19 @@ NS_ASSUME_NONNULL_BEGIN
 
 @property (weak,nullable,nonatomic) ASTViewController* tableViewController;
 @property (nullable,nonatomic) ASTSection* section;
+// The last known index of the item in its section or plain table view. It is
+// only trusted by the container, which renumbers its items after a mutation.
+@property (nonatomic) NSUInteger containerIndex;
 
 - (void) loadCell;
+// Called when the item gives up its cell so the cell can be bound to another
+// item. Subclasses that add targets or delegates to the cell in loadCell should
+// remove them here and call super.
+- (void) unloadCell;
 - (void) didEndDisplayingCell;
+// YES while the table view displays the cell. Set by the table view
+// controller. Becoming YES applies the stale cell properties.
+@property (nonatomic) BOOL cellDisplayed;
 
 // Cell Attributes
 
@@ -53,10 +79,56 @@ NS_ASSUME_NONNULL_BEGIN
 - (id __nullable) cellPropertiesValueForKeyPath: (NSString*) keyPath;
 
 - (void) setCellPropertyValue: (id __nullable) value forKeyPath: (NSString*) keyPath;
+// Applies the cell properties that changed since the cell was last updated.
+// See defersCellUpdates in ASTViewController.h.
+- (void) applyStaleCellProperties;
+
+// Called after the table view resized the row of the item at the request of
+// setNeedsRowHeightUpdateForItem:.
+- (void) rowHeightDidChange;
+
+// Value Changes
+
+// Called by items with a control each time the control changes the value, after
+// the cell properties are updated. Calls sendValueChange as valueDelivery says.
+- (void) valueDidChange;
+// Sends the value action and whatever else tells about a change of the value.
+// Items with a control override it. Only called by the delivery policy.
+- (void) sendValueChange;
+
+// Preferences
+
+// Registers the item, which must conform to ASTPreferenceObserving, for the
+// changes of the key in its preference store. When the store of the item
+// changes the key is observed in the new store and the item is told its value.
+// Nil unregisters the item. Off the main thread the key is only remembered, and
+// observed once the item is given its table view controller.
+- (void) observePrefKey: (nullable NSString*) key;
+// Moves the registration of observePrefKey: if the store of the item changed.
+- (void) prefStoreMayHaveChanged;
 
 - (id __nullable) resolveTargetObjectReference: (id __nullable) objectReference;
 - (void) sendAction: (SEL) action to: (id) target;
 
 @end
 
+//------------------------------------------------------------------------------
+
+@interface ASTViewController( ASTItem )
+
+// Asks the table view controller to apply the stale cell properties of the
+// item with the changes of other items at the next display frame.
+- (void) setNeedsCellUpdateForItem: (ASTItem*) item;
+// Asks the table view controller to check at the next display frame if the
+// displayed cell of the item still fits its row. The rows that do not are
+// resized together with one table view update, without animation, as rows
+// growing while text is typed in them should be.
+- (void) setNeedsRowHeightUpdateForItem: (ASTItem*) item;
+// Tells the table view controller that the item was added or removed, or that
+// its text, detail text or identifier changed. While filtering, the search
+// index is updated with the item at the next filter update.
+- (void) setNeedsSearchIndexUpdateForItem: (ASTItem*) item;
+
+@end
+
 NS_ASSUME_NONNULL_END
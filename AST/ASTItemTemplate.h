@@ -0,0 +1,67 @@
+//==============================================================================
+//
+//  ASTItemTemplate.h
+//
+//==============================================================================
+//
+//  Copyright (c) 2016 Adobe Systems Incorporated. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a
+//  copy of this software and associated documentation files (the "Software"),
+//  to deal in the Software without restriction, including without limitation
+//  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//  and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//
+//==============================================================================
+
+#import <Foundation/Foundation.h>
+
+
+NS_ASSUME_NONNULL_BEGIN
+
+//------------------------------------------------------------------------------
+
+/// An immutable configuration shared by many items. An item dictionary with a
+/// template under the AST_template key is configured as if it had the values of
+/// the template, and the values of the dictionary take precedence. The items
+/// only store the cell properties that differ from the template and copy them
+/// when they are first changed, so rows that differ only in their text use
+/// much less memory.
+///
+/// Keys of ASTItem subclasses in a template are applied to the items created
+/// with itemWithDict: or from dictionaries in sections and table data.
+
+@interface ASTItemTemplate : NSObject
+
+/// Creates and returns a template with the parameters of an item dictionary.
+/// @param dict A dictionary of item parameters. It must not have a template.
+/// @return A new ASTItemTemplate.
++ (instancetype) templateWithDict: (NSDictionary*) dict;
+
+/// Initializes and returns a template with the parameters of an item
+/// dictionary.
+/// @param dict A dictionary of item parameters. It must not have a template.
+/// @return A new ASTItemTemplate.
+- (instancetype) initWithDict: (NSDictionary*) dict NS_DESIGNATED_INITIALIZER;
+- (instancetype) init NS_UNAVAILABLE;
+
+/// The item parameters of the template.
+@property (readonly,copy,nonatomic) NSDictionary* dict;
+/// The cell properties of the template.
+@property (readonly,copy,nonatomic) NSDictionary* cellProperties;
+
+@end
+
+NS_ASSUME_NONNULL_END
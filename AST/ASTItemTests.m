@@ -30,8 +30,38 @@
 #import <XCTest/XCTest.h>
 
 #import "ASTItem.h"
+#import "ASTItemSubclass.h"
+#import "ASTItemTemplate.h"
+#import "ASTSwitchItem.h"
 #import "ASTViewController.h"
 
+#import <malloc/malloc.h>
+
+
+//------------------------------------------------------------------------------
+
+@interface ASTItem( ASTItemTestsMemory )
+
+// The bytes of the item and of the dictionary of the cell properties that it
+// stores itself. Values and templates shared with other items are not counted.
+@property (readonly) size_t storedBytes;
+
+@end
+
+//------------------------------------------------------------------------------
+
+@implementation ASTItem( ASTItemTestsMemory )
+
+- (size_t) storedBytes
+{
+	size_t result = malloc_size( (__bridge const void*)self );
+	if( _cellProperties ) {
+		result += malloc_size( (__bridge const void*)_cellProperties );
+	}
+	return result;
+}
+
+@end
 
 //------------------------------------------------------------------------------
 
@@ -235,7 +265,202 @@
 	} ];
 	
 	XCTAssertNil( item.cell.textLabel.shadowColor );
+	// Only nulls that hide a value of a template read as nil.
+	XCTAssertEqualObjects( [ item valueForKeyPath: @"cellProperties.textLabel.shadowColor" ],
+			[ NSNull null ] );
+	XCTAssertEqualObjects( item.cellProperties[ @"cellProperties.textLabel.shadowColor" ],
+			[ NSNull null ] );
+}
+
+//------------------------------------------------------------------------------
+
+- (void) testItemTemplate
+{
+	ASTItemTemplate* template = [ ASTItemTemplate templateWithDict: @{
+		AST_selectAction : @"actionThatRecordsSender:",
+		AST_cell_accessoryType : @(UITableViewCellAccessoryDisclosureIndicator),
+		AST_cell_detailTextLabel_text : @"Detail",
+	} ];
+	ASTItem* item = [ ASTItem itemWithDict: @{
+		AST_template : template,
+		AST_cell_textLabel_text : @"Text",
+	} ];
+	ASTItem* otherItem = [ ASTItem itemWithDict: @{
+		AST_template : template,
+		AST_cell_accessoryType : @(UITableViewCellAccessoryCheckmark),
+		AST_cell_detailTextLabel_text : [ NSNull null ],
+	} ];
+	
+	XCTAssertEqual( item.itemTemplate, template );
+	XCTAssertEqual( item.selectAction, @selector( actionThatRecordsSender: ) );
+	XCTAssert( item.selectable );
+	XCTAssertEqual( item.cellProperties.count, 3 );
+	XCTAssertEqualObjects( [ item valueForKeyPath: AST_cell_detailTextLabel_text ], @"Detail" );
+	XCTAssertEqual( item.cell.accessoryType, UITableViewCellAccessoryDisclosureIndicator );
+	XCTAssertEqualObjects( item.cell.textLabel.text, @"Text" );
+	
+	XCTAssertEqual( otherItem.cell.accessoryType, UITableViewCellAccessoryCheckmark );
+	XCTAssertNil( otherItem.cell.detailTextLabel.text );
+	XCTAssertNil( [ otherItem valueForKeyPath: AST_cell_detailTextLabel_text ] );
+	XCTAssertEqualObjects( otherItem.cellProperties,
+			@{ AST_cell_accessoryType : @(UITableViewCellAccessoryCheckmark) } );
+	
+	// Changes only affect the item, and clearing a value of the template hides
+	// it.
+	[ item setValue: nil forKeyPath: AST_cell_detailTextLabel_text ];
+	XCTAssertNil( item.cell.detailTextLabel.text );
+	XCTAssertNil( [ item valueForKeyPath: AST_cell_detailTextLabel_text ] );
+	XCTAssertNil( item.cellProperties[ AST_cell_detailTextLabel_text ] );
+	[ otherItem setValue: @"Detail" forKeyPath: AST_cell_detailTextLabel_text ];
+	XCTAssertEqualObjects( otherItem.cell.detailTextLabel.text, @"Detail" );
+	XCTAssertEqualObjects( template.cellProperties[ AST_cell_detailTextLabel_text ], @"Detail" );
+	
+	// Subclass keys and the item class can come from the template.
+	ASTItemTemplate* switchTemplate = [ ASTItemTemplate templateWithDict: @{
+		AST_itemClass : @"ASTSwitchItem",
+		AST_switchActionKey : @"actionThatRecordsSender:",
+	} ];
+	ASTItem* switchItem = [ ASTItem itemWithDict: @{ AST_template : switchTemplate } ];
+	XCTAssert( [ switchItem isKindOfClass: [ ASTSwitchItem class ] ] );
+	XCTAssertEqual( ((ASTSwitchItem*)switchItem).switchAction, @selector( actionThatRecordsSender: ) );
+	
+	NSDictionary* sameTemplateDict = @{ AST_template : template };
+	NSDictionary* otherTemplateDict = @{ AST_template : switchTemplate };
+	XCTAssert( [ item updateWithDict: sameTemplateDict ] );
+	XCTAssertFalse( [ item updateWithDict: otherTemplateDict ] );
+	// The cell properties that the previous dictionary set and the new one
+	// does not have are cleared, and those of the template shown again. The
+	// detail text hidden since is still hidden.
+	XCTAssertNil( [ item valueForKeyPath: AST_cell_textLabel_text ] );
+	XCTAssertNil( item.cell.textLabel.text );
+	XCTAssertNil( [ item valueForKeyPath: AST_cell_detailTextLabel_text ] );
+	XCTAssert( [ otherItem updateWithDict: sameTemplateDict ] );
+	XCTAssertEqualObjects( [ otherItem valueForKeyPath: AST_cell_detailTextLabel_text ], @"Detail" );
+	XCTAssertEqualObjects( otherItem.cellProperties, template.cellProperties );
+}
+
+//------------------------------------------------------------------------------
+
+// Returns the average bytes that an item and the dictionary of its own cell
+// properties take, for 10,000 items that share all but their text. With
+// mutableCellProperties the items keep their cell properties in a mutable
+// dictionary, as every item did before templates. The storage of a mutable
+// dictionary is a separate allocation that is not counted, so that case is
+// smaller than it really is.
+
+- (size_t) bytesPerItemWithSharedDict: (NSDictionary*) sharedDict
+		usesTemplate: (BOOL) usesTemplate mutableCellProperties: (BOOL) mutableCellProperties
+{
+	ASTItemTemplate* template = usesTemplate ? [ ASTItemTemplate templateWithDict: sharedDict ] : nil;
+	size_t bytes = 0;
+	NSUInteger itemCount = 10000;
+	for( NSUInteger row = 0; row < itemCount; ++row ) {
+		NSMutableDictionary* dict = template
+				? [ NSMutableDictionary dictionaryWithObject: template forKey: AST_template ]
+				: [ sharedDict mutableCopy ];
+		NSString* text = [ NSString stringWithFormat: @"Item %ld", (unsigned long)row ];
+		dict[ AST_cell_textLabel_text ] = text;
+		ASTItem* item = [ ASTItem itemWithDict: dict ];
+		if( mutableCellProperties ) {
+			// Setting a cell property copies the cell properties to a mutable
+			// dictionary.
+			[ item setValue: text forKeyPath: AST_cell_textLabel_text ];
+		}
+		bytes += item.storedBytes;
+	}
+	return bytes / itemCount;
+}
+
+//------------------------------------------------------------------------------
+
+- (void) testItemTemplateMemory
+{
+	// The rows of the big test of the example app share a template that only
+	// sets their reuse identifier. Before templates each item also had a
+	// mutable dictionary for its text.
+	NSDictionary* bigTestDict = @{ AST_cellReuseIdentifier : @"bigcell" };
+	size_t bytesBefore = [ self bytesPerItemWithSharedDict: bigTestDict
+			usesTemplate: NO mutableCellProperties: YES ];
+	size_t bytesAfter = [ self bytesPerItemWithSharedDict: bigTestDict
+			usesTemplate: YES mutableCellProperties: NO ];
+	XCTAssertLessThan( bytesAfter, bytesBefore, @"%zu bytes per item before, %zu after",
+			bytesBefore, bytesAfter );
+	
+	// Cell properties shared through a template are only stored once.
+	NSDictionary* styledDict = @{
+		AST_cellReuseIdentifier : @"bigcell",
+		AST_cell_accessoryType : @(UITableViewCellAccessoryDisclosureIndicator),
+		AST_cell_textLabel_textColor : [ UIColor darkGrayColor ],
+	};
+	size_t bytesWithoutTemplate = [ self bytesPerItemWithSharedDict: styledDict
+			usesTemplate: NO mutableCellProperties: NO ];
+	size_t bytesWithTemplate = [ self bytesPerItemWithSharedDict: styledDict
+			usesTemplate: YES mutableCellProperties: NO ];
+	XCTAssertLessThan( bytesWithTemplate, bytesWithoutTemplate,
+			@"%zu bytes per item without a template, %zu with one",
+			bytesWithoutTemplate, bytesWithTemplate );
+}
+
+//------------------------------------------------------------------------------
+
+- (void) testUpdateWithDict
+{
+	ASTItem* item = [ ASTItem itemWithDict: @{
+		AST_id : @"item",
+		AST_cell_textLabel_text : @"1",
+		AST_cell_detailTextLabel_text : @"2",
+		AST_selectAction : @"actionThatRecordsSender:",
+	} ];
+	UITableViewCell* cell = item.cell;
+	
+	BOOL updated = [ item updateWithDict: @{
+		AST_id : @"item",
+		AST_cell_textLabel_text : @"one",
+		AST_cell_accessoryType : @(UITableViewCellAccessoryCheckmark),
+		AST_deselectAutomatically : @YES,
+		AST_representedObject : @"object",
+	} ];
 	
+	XCTAssert( updated );
+	
+	XCTAssertEqual( item.cell, cell );
+	XCTAssertEqualObjects( cell.textLabel.text, @"one" );
+	XCTAssertEqual( cell.accessoryType, UITableViewCellAccessoryCheckmark );
+	// Cell properties that are not in the dictionary are cleared, as they
+	// would be for a new item.
+	XCTAssertNil( [ item valueForKeyPath: AST_cell_detailTextLabel_text ] );
+	XCTAssertNil( cell.detailTextLabel.text );
+	XCTAssertEqualObjects( item.cellProperties, ( @{
+		AST_cell_textLabel_text : @"one",
+		AST_cell_accessoryType : @(UITableViewCellAccessoryCheckmark),
+	} ) );
+	XCTAssertEqualObjects( item.representedObject, @"object" );
+	XCTAssert( item.deselectAutomatically );
+	XCTAssertEqual( item.selectAction, (SEL)NULL );
+	XCTAssertFalse( item.selectable );
+	
+	// Different items and cells can not be updated in place.
+	NSArray* rejectedDicts = @[
+		@{ AST_itemClass : @"ASTTextFieldItem", AST_cell_textLabel_text : @"two" },
+		@{ AST_cellStyle : @(UITableViewCellStyleSubtitle), AST_cell_textLabel_text : @"two" },
+		@{ AST_prefKey : @"key", AST_cell_textLabel_text : @"two" },
+	];
+	for( NSDictionary* dict in rejectedDicts ) {
+		XCTAssertFalse( [ item updateWithDict: dict ] );
+	}
+	XCTAssertEqualObjects( cell.textLabel.text, @"one" );
+	
+	// Cell properties changed since the last update are kept unless the
+	// dictionary sets them.
+	[ item setValue: @"typed" forKeyPath: AST_cell_detailTextLabel_text ];
+	NSDictionary* textDict = @{ AST_id : @"item", AST_cell_textLabel_text : @"one" };
+	XCTAssert( [ item updateWithDict: textDict ] );
+	XCTAssertEqualObjects( cell.detailTextLabel.text, @"typed" );
+	XCTAssertEqual( cell.accessoryType, UITableViewCellAccessoryNone );
+	NSDictionary* detailDict = @{ AST_id : @"item", AST_cell_detailTextLabel_text : @"two" };
+	XCTAssert( [ item updateWithDict: detailDict ] );
+	XCTAssertEqualObjects( cell.detailTextLabel.text, @"two" );
+	XCTAssertNil( cell.textLabel.text );
 }
 
 //------------------------------------------------------------------------------
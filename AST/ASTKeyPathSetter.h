@@ -0,0 +1,82 @@
+//==============================================================================
+//
+//  ASTKeyPathSetter.h
+//
+//==============================================================================
+//
+//  Copyright (c) 2016 Adobe Systems Incorporated. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a
+//  copy of this software and associated documentation files (the "Software"),
+//  to deal in the Software without restriction, including without limitation
+//  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//  and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//
+//==============================================================================
+
+
+// This is private to the framework. Items use it to apply their cell properties
+// to their cells without parsing the keypaths each time.
+
+#import <Foundation/Foundation.h>
+
+
+NS_ASSUME_NONNULL_BEGIN
+
+// The prefix of the keypaths of the cell properties of items. It is defined
+// here so that the setters only need Foundation.
+extern NSString* const AST_cellPropertiesKeyPathPrefix;
+
+//------------------------------------------------------------------------------
+
+// Sets the value at the end of a keypath that may contain selector components
+// (see AST_cellPropertiesKeyPathPrefix in ASTItem.h). The keypath is split once
+// and the selector, method implementation and argument conversion of each
+// component are looked up the first time the component is reached and again
+// only when the class of the object it is reached on changes.
+@interface ASTKeyPathSetter : NSObject
+
+/// Returns the cached setter for the keypath of objects of the class, creating
+/// it if needed. The cache is not thread safe and must only be used on the main
+/// thread.
+/// @param objectClass The class of the objects the setter is used with.
+/// @param keyPath A keypath, which may contain selector components.
++ (instancetype) setterForClass: (Class) objectClass keyPath: (NSString*) keyPath;
+/// Returns the cached setter for a key path of the cell properties of an item,
+/// which starts with the cell properties prefix, for cells of the class.
+/// @param cellClass The class of the cells the setter is used with.
+/// @param keyPath A keypath starting with AST_cellPropertiesKeyPathPrefix.
++ (instancetype) setterForCellClass: (Class) cellClass cellPropertyKeyPath: (NSString*) keyPath;
+
+/// Initializes an uncached setter for the keypath.
+- (instancetype) initWithKeyPath: (NSString*) keyPath NS_DESIGNATED_INITIALIZER;
+- (instancetype) init NS_UNAVAILABLE;
+
+/// The keypath the setter sets, without the cell properties prefix.
+@property (readonly,nonatomic) NSString* keyPath;
+
+/// Sets the value at the end of the keypath starting at the object. Selector
+/// components in the middle of the keypath call the method and continue with
+/// its result. A selector component at the end calls the method with the value
+/// converted to the argument type of the method. Other components use the
+/// accessor methods directly when they have object or number types and key
+/// value coding otherwise.
+/// @param value The value to set. May be nil.
+/// @param object The object the keypath starts at.
+- (void) setValue: (nullable id) value forObject: (id) object;
+
+@end
+
+NS_ASSUME_NONNULL_END
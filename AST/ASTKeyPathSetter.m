@@ -0,0 +1,322 @@
+//==============================================================================
+//
+//  ASTKeyPathSetter.m
+//
+//==============================================================================
+//
+//  Copyright (c) 2016 Adobe Systems Incorporated. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a
+//  copy of this software and associated documentation files (the "Software"),
+//  to deal in the Software without restriction, including without limitation
+//  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//  and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//
+//==============================================================================
+
+
+#import "ASTKeyPathSetter.h"
+
+#import <objc/runtime.h>
+
+
+//------------------------------------------------------------------------------
+
+NSString* const AST_cellPropertiesKeyPathPrefix = @"cellProperties.";
+
+//------------------------------------------------------------------------------
+
+typedef void (*ASTArgumentSetter)( id target, SEL selector, IMP imp, id value );
+
+static void setObjectArgument( id target, SEL selector, IMP imp, id value )
+{
+	((void (*)( id, SEL, id ))imp)( target, selector, value );
+}
+
+static void setCStringArgument( id target, SEL selector, IMP imp, id value )
+{
+	((void (*)( id, SEL, const char* ))imp)( target, selector, [ value UTF8String ] );
+}
+
+static void setSelectorArgument( id target, SEL selector, IMP imp, id value )
+{
+	((void (*)( id, SEL, SEL ))imp)( target, selector, NSSelectorFromString( value ) );
+}
+
+#define AST_NUMBER_ARGUMENT_SETTER( name, type, getter ) \
+static void name( id target, SEL selector, IMP imp, id value ) \
+{ \
+	((void (*)( id, SEL, type ))imp)( target, selector, [ value getter ] ); \
+}
+
+AST_NUMBER_ARGUMENT_SETTER( setCharArgument, char, charValue )
+AST_NUMBER_ARGUMENT_SETTER( setIntArgument, int, intValue )
+AST_NUMBER_ARGUMENT_SETTER( setShortArgument, short, shortValue )
+AST_NUMBER_ARGUMENT_SETTER( setLongArgument, long, longValue )
+AST_NUMBER_ARGUMENT_SETTER( setLongLongArgument, long long, longLongValue )
+AST_NUMBER_ARGUMENT_SETTER( setUnsignedCharArgument, unsigned char, unsignedCharValue )
+AST_NUMBER_ARGUMENT_SETTER( setUnsignedIntArgument, unsigned int, unsignedIntValue )
+AST_NUMBER_ARGUMENT_SETTER( setUnsignedShortArgument, unsigned short, unsignedShortValue )
+AST_NUMBER_ARGUMENT_SETTER( setUnsignedLongArgument, unsigned long, unsignedLongValue )
+AST_NUMBER_ARGUMENT_SETTER( setUnsignedLongLongArgument, unsigned long long, unsignedLongLongValue )
+AST_NUMBER_ARGUMENT_SETTER( setFloatArgument, float, floatValue )
+AST_NUMBER_ARGUMENT_SETTER( setDoubleArgument, double, doubleValue )
+AST_NUMBER_ARGUMENT_SETTER( setBoolArgument, BOOL, boolValue )
+
+#undef AST_NUMBER_ARGUMENT_SETTER
+
+//------------------------------------------------------------------------------
+
+// Returns the function that converts a value to the argument type and calls
+// the method, or NULL if the type is not supported. Key value coding does not
+// convert strings to C strings or selectors, so those are left to it for
+// accessor methods.
+
+static ASTArgumentSetter argumentSetterForType( const char* argType, BOOL accessor )
+{
+	static const struct {
+		const char* type;
+		ASTArgumentSetter setter;
+		BOOL accessor;
+	} argumentSetters[] = {
+		{ "@", setObjectArgument, YES },
+		{ "#", setObjectArgument, NO },
+		{ "*", setCStringArgument, NO },
+		{ "r*", setCStringArgument, NO },
+		{ ":", setSelectorArgument, NO },
+		{ "c", setCharArgument, YES },
+		{ "i", setIntArgument, YES },
+		{ "s", setShortArgument, YES },
+		{ "l", setLongArgument, YES },
+		{ "q", setLongLongArgument, YES },
+		{ "C", setUnsignedCharArgument, YES },
+		{ "I", setUnsignedIntArgument, YES },
+		{ "S", setUnsignedShortArgument, YES },
+		{ "L", setUnsignedLongArgument, YES },
+		{ "Q", setUnsignedLongLongArgument, YES },
+		{ "f", setFloatArgument, YES },
+		{ "d", setDoubleArgument, YES },
+		{ "B", setBoolArgument, YES },
+	};
+	for( size_t i = 0; i < sizeof( argumentSetters ) / sizeof( argumentSetters[ 0 ] ); ++i ) {
+		if( strcmp( argType, argumentSetters[ i ].type ) == 0 ) {
+			return accessor && argumentSetters[ i ].accessor == NO
+					? NULL : argumentSetters[ i ].setter;
+		}
+	}
+	return NULL;
+}
+
+//------------------------------------------------------------------------------
+
+// A component of the keypath. For selector components the selector is the
+// method named by the component. For keys it is the getter, or the setter for
+// the last component, and the implementation is NULL when key value coding has
+// to be used instead.
+
+typedef struct {
+	SEL selector;
+	BOOL isSelector;
+	__unsafe_unretained Class resolvedClass;
+	IMP imp;
+	ASTArgumentSetter argumentSetter;
+} ASTKeyPathStep;
+
+//------------------------------------------------------------------------------
+
+static NSMapTable* setterCacheForClass( NSMapTable* cache, Class objectClass )
+{
+	NSMapTable* result = [ cache objectForKey: objectClass ];
+	if( result == nil ) {
+		result = [ NSMapTable strongToStrongObjectsMapTable ];
+		[ cache setObject: result forKey: objectClass ];
+	}
+	return result;
+}
+
+//------------------------------------------------------------------------------
+
+@interface ASTKeyPathSetter() {
+	NSArray* _keys;
+	ASTKeyPathStep* _steps;
+	NSUInteger _stepCount;
+}
+
+@end
+
+//------------------------------------------------------------------------------
+
+@implementation ASTKeyPathSetter
+
+//------------------------------------------------------------------------------
+
++ (instancetype) setterForClass: (Class) objectClass keyPath: (NSString*) keyPath
+{
+	static NSMapTable* cache = nil;
+	static dispatch_once_t onceToken;
+	dispatch_once( &onceToken, ^{
+		cache = [ NSMapTable strongToStrongObjectsMapTable ];
+	} );
+	
+	NSMapTable* classCache = setterCacheForClass( cache, objectClass );
+	ASTKeyPathSetter* result = [ classCache objectForKey: keyPath ];
+	if( result == nil ) {
+		result = [ [ ASTKeyPathSetter alloc ] initWithKeyPath: keyPath ];
+		[ classCache setObject: result forKey: keyPath ];
+	}
+	return result;
+}
+
+//------------------------------------------------------------------------------
+
++ (instancetype) setterForCellClass: (Class) cellClass cellPropertyKeyPath: (NSString*) keyPath
+{
+	NSParameterAssert( [ keyPath hasPrefix: AST_cellPropertiesKeyPathPrefix ] );
+	
+	// Keyed by the whole keypath so that looking up a setter does not have to
+	// create a string without the prefix.
+	static NSMapTable* cache = nil;
+	static dispatch_once_t onceToken;
+	dispatch_once( &onceToken, ^{
+		cache = [ NSMapTable strongToStrongObjectsMapTable ];
+	} );
+	
+	NSMapTable* classCache = setterCacheForClass( cache, cellClass );
+	ASTKeyPathSetter* result = [ classCache objectForKey: keyPath ];
+	if( result == nil ) {
+		result = [ [ ASTKeyPathSetter alloc ] initWithKeyPath:
+				[ keyPath substringFromIndex: AST_cellPropertiesKeyPathPrefix.length ] ];
+		[ classCache setObject: result forKey: keyPath ];
+	}
+	return result;
+}
+
+//------------------------------------------------------------------------------
+
+- (instancetype) initWithKeyPath: (NSString*) keyPath
+{
+	NSParameterAssert( keyPath.length > 0 );
+	
+	self = [ super init ];
+	if( self ) {
+		_keyPath = [ keyPath copy ];
+		
+		NSArray* components = [ keyPath componentsSeparatedByString: @"." ];
+		NSMutableArray* keys = [ NSMutableArray arrayWithCapacity: components.count ];
+		_stepCount = components.count;
+		_steps = calloc( _stepCount, sizeof( ASTKeyPathStep ) );
+		NSUInteger stepIndex = 0;
+		for( NSString* component in components ) {
+			ASTKeyPathStep* step = &_steps[ stepIndex ];
+			BOOL lastComponent = stepIndex == _stepCount - 1;
+			if( [ component hasPrefix: @"-" ] ) {
+				step->isSelector = YES;
+				step->selector = NSSelectorFromString( [ component substringFromIndex: 1 ] );
+			} else if( lastComponent ) {
+				step->selector = NSSelectorFromString( [ NSString stringWithFormat: @"set%@%@:",
+						[ [ component substringToIndex: 1 ] uppercaseString ],
+						[ component substringFromIndex: 1 ] ] );
+			} else {
+				step->selector = NSSelectorFromString( component );
+			}
+			[ keys addObject: component ];
+			++stepIndex;
+		}
+		_keys = keys;
+	}
+	return self;
+}
+
+//------------------------------------------------------------------------------
+
+- (void) dealloc
+{
+	free( _steps );
+}
+
+//------------------------------------------------------------------------------
+
+// Looks up the method of the step on the class of the target. Keys whose
+// accessors can not be called directly fall back to key value coding.
+
+- (void) resolveStep: (ASTKeyPathStep*) step forTarget: (id) target
+		lastComponent: (BOOL) lastComponent
+{
+	step->resolvedClass = Nil;
+	step->imp = NULL;
+	step->argumentSetter = NULL;
+	
+	if( step->isSelector ) {
+		NSMethodSignature* signature = [ target methodSignatureForSelector: step->selector ];
+		NSAssert2( signature != nil, @"No signature for selector: %@ with object: %@", NSStringFromSelector( step->selector ), target );
+		if( lastComponent ) {
+			NSAssert2( [ signature numberOfArguments ] == 3, @"Wrong number of arguments, selector: %@ with object: %@", NSStringFromSelector( step->selector ), target );
+			const char* argType = [ signature getArgumentTypeAtIndex: 2 ];
+			step->argumentSetter = argumentSetterForType( argType, NO );
+			if( step->argumentSetter == NULL ) {
+				[ NSException raise: @"Unknown argument type" format: @"Encountered and unknown argument with type %s", argType ];
+			}
+		}
+		step->imp = [ target methodForSelector: step->selector ];
+	} else if( [ target respondsToSelector: step->selector ] ) {
+		NSMethodSignature* signature = [ target methodSignatureForSelector: step->selector ];
+		if( lastComponent ) {
+			if( [ signature numberOfArguments ] == 3 ) {
+				step->argumentSetter = argumentSetterForType(
+						[ signature getArgumentTypeAtIndex: 2 ], YES );
+			}
+			if( step->argumentSetter ) {
+				step->imp = [ target methodForSelector: step->selector ];
+			}
+		} else if( [ signature numberOfArguments ] == 2
+				&& strcmp( [ signature methodReturnType ], "@" ) == 0 ) {
+			step->imp = [ target methodForSelector: step->selector ];
+		}
+	}
+	
+	// Only set once nothing has thrown so that a failed lookup is repeated.
+	step->resolvedClass = object_getClass( target );
+}
+
+//------------------------------------------------------------------------------
+
+- (void) setValue: (id) value forObject: (id) object
+{
+	id currentTarget = object;
+	for( NSUInteger stepIndex = 0; stepIndex < _stepCount; ++stepIndex ) {
+		ASTKeyPathStep* step = &_steps[ stepIndex ];
+		BOOL lastComponent = stepIndex == _stepCount - 1;
+		if( step->resolvedClass != object_getClass( currentTarget ) ) {
+			[ self resolveStep: step forTarget: currentTarget lastComponent: lastComponent ];
+		}
+		
+		if( lastComponent ) {
+			// Key value coding turns nil into setNilValueForKey: for scalars.
+			if( step->imp && (step->isSelector || value || step->argumentSetter == setObjectArgument) ) {
+				step->argumentSetter( currentTarget, step->selector, step->imp, value );
+			} else {
+				[ currentTarget setValue: value forKey: _keys[ stepIndex ] ];
+			}
+		} else if( step->imp ) {
+			currentTarget = ((id (*)( id, SEL ))step->imp)( currentTarget, step->selector );
+		} else {
+			currentTarget = [ currentTarget valueForKey: _keys[ stepIndex ] ];
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+
+@end
@@ -0,0 +1,254 @@
+//==============================================================================
+//
+//  ASTKeyPathSetterTests.m
+//
+//==============================================================================
+//
+//  Copyright (c) 2016 Adobe Systems Incorporated. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a
+//  copy of this software and associated documentation files (the "Software"),
+//  to deal in the Software without restriction, including without limitation
+//  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//  and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//
+//==============================================================================
+
+
+#import <UIKit/UIKit.h>
+#import <XCTest/XCTest.h>
+#import "ASTItemSubclass.h"
+#import "ASTKeyPathSetter.h"
+
+
+//------------------------------------------------------------------------------
+
+// Applies a cell property the way it was done before the setters were cached:
+// the keypath is split for every value, keys go through key value coding and
+// selectors through NSInvocation. Only the argument types of the benchmark
+// properties are converted.
+
+static void setValueWithoutCachedSetter( id value, id object, NSString* keyPath )
+{
+	NSArray* components = [ keyPath componentsSeparatedByString: @"." ];
+	id currentTarget = object;
+	NSUInteger componentIndex = 0;
+	for( NSString* component in components ) {
+		BOOL lastComponent = componentIndex == components.count - 1;
+		if( [ component hasPrefix: @"-" ] ) {
+			SEL keySelector = NSSelectorFromString( [ component substringFromIndex: 1 ] );
+			if( lastComponent ) {
+				NSMethodSignature* signature = [ currentTarget methodSignatureForSelector: keySelector ];
+				NSInvocation* invocation = [ NSInvocation invocationWithMethodSignature: signature ];
+				[ invocation setTarget: currentTarget ];
+				[ invocation setSelector: keySelector ];
+				const char* argType = [ signature getArgumentTypeAtIndex: 2 ];
+				if( strcmp( argType, "@" ) == 0 ) {
+					[ invocation setArgument: &value atIndex: 2 ];
+				} else {
+					BOOL argValue = [ value boolValue ];
+					[ invocation setArgument: &argValue atIndex: 2 ];
+				}
+				[ invocation invoke ];
+			} else {
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Warc-performSelector-leaks"
+				currentTarget = [ currentTarget performSelector: keySelector ];
+#pragma clang diagnostic pop
+			}
+		} else if( lastComponent ) {
+			[ currentTarget setValue: value forKey: component ];
+		} else {
+			currentTarget = [ currentTarget valueForKey: component ];
+		}
+		++componentIndex;
+	}
+}
+
+//------------------------------------------------------------------------------
+
+@interface ASTKeyPathSetterTests : XCTestCase
+
+@end
+
+//------------------------------------------------------------------------------
+
+@implementation ASTKeyPathSetterTests
+
+//------------------------------------------------------------------------------
+
+- (NSDictionary*) benchmarkCellProperties
+{
+	return @{
+		@"textLabel.text" : @"Text",
+		@"textLabel.textColor" : [ UIColor darkGrayColor ],
+		@"textLabel.font" : [ UIFont systemFontOfSize: 15 ],
+		@"textLabel.textAlignment" : @(NSTextAlignmentCenter),
+		@"textLabel.numberOfLines" : @2,
+		@"textLabel.enabled" : @YES,
+		@"textLabel.adjustsFontSizeToFitWidth" : @YES,
+		@"textLabel.minimumScaleFactor" : @0.5,
+		@"textLabel.lineBreakMode" : @(NSLineBreakByTruncatingMiddle),
+		@"-textLabel.-setShadowColor:" : [ UIColor whiteColor ],
+		@"detailTextLabel.text" : @"Detail",
+		@"detailTextLabel.textColor" : [ UIColor grayColor ],
+		@"detailTextLabel.font" : [ UIFont systemFontOfSize: 12 ],
+		@"detailTextLabel.numberOfLines" : @0,
+		@"accessoryType" : @(UITableViewCellAccessoryDisclosureIndicator),
+		@"selectionStyle" : @(UITableViewCellSelectionStyleNone),
+		@"indentationLevel" : @1,
+		@"indentationWidth" : @12,
+		@"backgroundColor" : [ UIColor lightGrayColor ],
+		@"-setUserInteractionEnabled:" : @YES,
+	};
+}
+
+//------------------------------------------------------------------------------
+
+- (NSArray*) benchmarkCells
+{
+	NSMutableArray* result = [ NSMutableArray arrayWithCapacity: 10000 ];
+	for( NSUInteger i = 0; i < 10000; ++i ) {
+		[ result addObject: [ [ UITableViewCell alloc ]
+				initWithStyle: UITableViewCellStyleSubtitle reuseIdentifier: nil ] ];
+	}
+	return result;
+}
+
+//------------------------------------------------------------------------------
+
+- (void) testSettersAreCached
+{
+	ASTKeyPathSetter* setter = [ ASTKeyPathSetter setterForClass: [ UITableViewCell class ]
+			keyPath: @"textLabel.text" ];
+	XCTAssertEqual( [ ASTKeyPathSetter setterForClass: [ UITableViewCell class ]
+			keyPath: @"textLabel.text" ], setter );
+	XCTAssertNotEqual( [ ASTKeyPathSetter setterForClass: [ UILabel class ]
+			keyPath: @"textLabel.text" ], setter );
+	
+	ASTKeyPathSetter* cellSetter = [ ASTKeyPathSetter setterForCellClass: [ UITableViewCell class ]
+			cellPropertyKeyPath: AST_cell_textLabel_text ];
+	XCTAssertEqualObjects( cellSetter.keyPath, @"textLabel.text" );
+	XCTAssertEqual( [ ASTKeyPathSetter setterForCellClass: [ UITableViewCell class ]
+			cellPropertyKeyPath: AST_cell_textLabel_text ], cellSetter );
+}
+
+//------------------------------------------------------------------------------
+
+- (void) testSetValue
+{
+	UITableViewCell* cell = [ [ UITableViewCell alloc ]
+			initWithStyle: UITableViewCellStyleSubtitle reuseIdentifier: nil ];
+	NSDictionary* cellProperties = [ self benchmarkCellProperties ];
+	for( NSString* keyPath in cellProperties ) {
+		[ [ [ ASTKeyPathSetter alloc ] initWithKeyPath: keyPath ]
+				setValue: cellProperties[ keyPath ] forObject: cell ];
+	}
+	
+	XCTAssertEqualObjects( cell.textLabel.text, @"Text" );
+	XCTAssertEqual( cell.textLabel.textAlignment, NSTextAlignmentCenter );
+	XCTAssertEqual( cell.textLabel.numberOfLines, 2 );
+	XCTAssertEqual( cell.textLabel.minimumScaleFactor, 0.5 );
+	XCTAssertEqualObjects( cell.textLabel.shadowColor, [ UIColor whiteColor ] );
+	XCTAssertEqualObjects( cell.detailTextLabel.text, @"Detail" );
+	XCTAssertEqual( cell.accessoryType, UITableViewCellAccessoryDisclosureIndicator );
+	XCTAssertEqual( cell.indentationWidth, 12 );
+}
+
+//------------------------------------------------------------------------------
+
+- (void) testTargetClassChanges
+{
+	ASTKeyPathSetter* setter = [ [ ASTKeyPathSetter alloc ] initWithKeyPath: @"text" ];
+	UILabel* label = [ [ UILabel alloc ] init ];
+	UITextField* textField = [ [ UITextField alloc ] init ];
+	NSMutableDictionary* dict = [ NSMutableDictionary dictionary ];
+	
+	[ setter setValue: @"label" forObject: label ];
+	[ setter setValue: @"field" forObject: textField ];
+	[ setter setValue: @"dict" forObject: dict ];
+	
+	XCTAssertEqualObjects( label.text, @"label" );
+	XCTAssertEqualObjects( textField.text, @"field" );
+	XCTAssertEqualObjects( dict[ @"text" ], @"dict" );
+}
+
+//------------------------------------------------------------------------------
+
+- (void) testKeyValueCodingFallback
+{
+	// Dictionaries have no accessors for their keys.
+	NSDictionary* dict = @{ @"inner" : [ NSMutableDictionary dictionary ] };
+	[ [ ASTKeyPathSetter setterForClass: [ dict class ] keyPath: @"inner.key" ]
+			setValue: @"value" forObject: dict ];
+	XCTAssertEqualObjects( dict[ @"inner" ][ @"key" ], @"value" );
+	
+	// Nil is not converted to zero for scalar properties.
+	UILabel* label = [ [ UILabel alloc ] init ];
+	XCTAssertThrows( [ [ ASTKeyPathSetter setterForClass: [ UILabel class ]
+			keyPath: @"numberOfLines" ] setValue: nil forObject: label ] );
+}
+
+//------------------------------------------------------------------------------
+
+- (void) testFailedLookupIsRepeated
+{
+	ASTKeyPathSetter* setter = [ [ ASTKeyPathSetter alloc ]
+			initWithKeyPath: @"-setSlartibartfast:" ];
+	UILabel* label = [ [ UILabel alloc ] init ];
+	XCTAssertThrows( [ setter setValue: @"foo" forObject: label ] );
+	XCTAssertThrows( [ setter setValue: @"foo" forObject: label ] );
+}
+
+//------------------------------------------------------------------------------
+
+// Applies 20 cell properties to 10000 cells with the cached setters, which is
+// what loading cells does.
+
+- (void) testCachedSetterPerformance
+{
+	NSArray* cells = [ self benchmarkCells ];
+	NSDictionary* cellProperties = [ self benchmarkCellProperties ];
+	[ self measureBlock: ^{
+		for( UITableViewCell* cell in cells ) {
+			for( NSString* keyPath in cellProperties ) {
+				[ [ ASTKeyPathSetter setterForClass: [ cell class ] keyPath: keyPath ]
+						setValue: cellProperties[ keyPath ] forObject: cell ];
+			}
+		}
+	} ];
+}
+
+//------------------------------------------------------------------------------
+
+// The same work with key value coding and NSInvocation, as was done before
+// the setters were cached.
+
+- (void) testUncachedSetterPerformance
+{
+	NSArray* cells = [ self benchmarkCells ];
+	NSDictionary* cellProperties = [ self benchmarkCellProperties ];
+	[ self measureBlock: ^{
+		for( UITableViewCell* cell in cells ) {
+			for( NSString* keyPath in cellProperties ) {
+				setValueWithoutCachedSetter( cellProperties[ keyPath ], cell, keyPath );
+			}
+		}
+	} ];
+}
+
+//------------------------------------------------------------------------------
+
+@end
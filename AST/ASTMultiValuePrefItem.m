@@ -30,6 +30,7 @@
 
 #import "ASTItemSubclass.h"
 #import "ASTPrefGroupItem.h"
+#import "ASTPreferenceObserver.h"
 #import "ASTViewController.h"
 
 #import <UIKit/UIKit.h>
@@ -37,11 +38,7 @@
 
 //------------------------------------------------------------------------------
 
-const void* ASTMultiValuePrefItem_prefObservationContext;
-
-//------------------------------------------------------------------------------
-
-@interface ASTMultiValuePrefItem() <UIActionSheetDelegate>
+@interface ASTMultiValuePrefItem() <UIActionSheetDelegate, ASTPreferenceObserving>
 
 @end
 
@@ -73,22 +70,11 @@ const void* ASTMultiValuePrefItem_prefObservationContext;
 
 //------------------------------------------------------------------------------
 
-- (void) dealloc
-{
-	if( _prefKey ) {
-		[ [ NSUserDefaults standardUserDefaults ] removeObserver: self
-				forKeyPath: _prefKey context: &ASTMultiValuePrefItem_prefObservationContext ];
-	}
-}
-
-//------------------------------------------------------------------------------
-
 - (id) resolvedPrefValue
 {
 	id prefValue = nil;
 	if( _prefKey ) {
-		prefValue = [ [ NSUserDefaults standardUserDefaults ]
-			valueForKey: _prefKey ];
+		prefValue = [ self.prefStore objectForKey: _prefKey ];
 	}
 	if( prefValue == nil ) {
 		prefValue = _prefDefaultValue;
@@ -101,20 +87,9 @@ const void* ASTMultiValuePrefItem_prefObservationContext;
 
 - (void) setPrefKey: (NSString*) prefKey
 {
-	NSUserDefaults* prefs = [ NSUserDefaults standardUserDefaults ];
-	
-	if( _prefKey ) {
-		[ prefs removeObserver: self forKeyPath: _prefKey ];
-	}
-	
 	_prefKey = prefKey;
+	[ self observePrefKey: prefKey ];
 	self.value = [ self resolvedPrefValue ];
-	
-	if( _prefKey ) {
-		[ prefs addObserver: self forKeyPath: _prefKey
-				options: NSKeyValueObservingOptionInitial
-				context: &ASTMultiValuePrefItem_prefObservationContext ];
-	}
 }
 
 //------------------------------------------------------------------------------
@@ -122,23 +97,14 @@ const void* ASTMultiValuePrefItem_prefObservationContext;
 - (void) selectedValue: (id) value
 {
 	[ super selectedValue: value ];
-	[ [ NSUserDefaults standardUserDefaults ] setObject: value forKey: _prefKey ];
+	[ self.prefStore setObject: value forKey: _prefKey ];
 }
 
 //------------------------------------------------------------------------------
 
-- (void) observeValueForKeyPath: (NSString*) keyPath ofObject: (id) object
-		change: (NSDictionary*) change context: (void*) context
+- (void) preferenceValue: (id) value didChangeForKey: (NSString*) key
 {
-	if( context == &ASTMultiValuePrefItem_prefObservationContext ) {
-		self.value = [ self resolvedPrefValue ];
-		return;
-	}
-	
-// LCOV_EXCL_START
-	[ super observeValueForKeyPath: keyPath ofObject: object
-			change: change context: context ];
-// LCOV_EXCL_STOP
+	self.value = value ?: _prefDefaultValue;
 }
 
 //------------------------------------------------------------------------------
@@ -0,0 +1,87 @@
+//==============================================================================
+//
+//  ASTObjectIndex.h
+//
+//==============================================================================
+//
+//  Copyright (c) 2016 Adobe Systems Incorporated. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a
+//  copy of this software and associated documentation files (the "Software"),
+//  to deal in the Software without restriction, including without limitation
+//  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//  and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//
+//==============================================================================
+
+// This is private to the framework. Sections and the table view controller use
+// it to find items and sections by identifier or represented object without
+// searching all of them.
+
+#import <Foundation/Foundation.h>
+
+
+NS_ASSUME_NONNULL_BEGIN
+
+//------------------------------------------------------------------------------
+
+// Implemented by the sections and the table view controller so that items and
+// sections can report changes to the properties that are indexed.
+@protocol ASTObjectIndexContainer <NSObject>
+
+- (void) indexedObject: (id) object didChangeValueForKey: (NSString*) key
+		fromValue: (nullable id) oldValue;
+
+@end
+
+//------------------------------------------------------------------------------
+
+@interface ASTObjectIndex : NSObject
+
+/// Creates an index of the value of the key of the objects in a container. The
+/// values are compared with isEqual: and hash, so the hash of a value must not
+/// change while it is indexed.
+- (instancetype) initWithKey: (NSString*) key NS_DESIGNATED_INITIALIZER;
+- (instancetype) init NS_UNAVAILABLE;
+
+/// The key of the indexed property.
+@property (readonly,nonatomic) NSString* key;
+
+/// Returns the object with the value closest to the start of the container or
+/// nil if there is no such object. The index is built from the container the
+/// first time it is needed and after invalidate is called.
+/// @param value The value to find. Must not be nil.
+/// @param container The array of objects that is indexed.
+/// @param firstStaleIndex The first stale containerIndex of the objects. It is
+/// only used if more than one object has the value.
+- (nullable id) firstObjectWithValue: (id) value inContainer: (NSArray*) container
+		firstStaleIndex: (NSUInteger*) firstStaleIndex;
+
+/// Must be called when an object is added to the container.
+- (void) addObject: (id) object;
+/// Must be called when an object is removed from the container.
+- (void) removeObject: (id) object;
+/// Must be called when the value of the key of an object in the container
+/// changes.
+- (void) object: (id) object didChangeValueFrom: (nullable id) oldValue;
+/// Discards the index so it is built again by the next lookup. This is cheaper
+/// than adding or removing every object when the whole container is replaced.
+- (void) invalidate;
+
+@end
+
+//------------------------------------------------------------------------------
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,197 @@
+//==============================================================================
+//
+//  ASTObjectIndex.m
+//
+//==============================================================================
+//
+//  Copyright (c) 2016 Adobe Systems Incorporated. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a
+//  copy of this software and associated documentation files (the "Software"),
+//  to deal in the Software without restriction, including without limitation
+//  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//  and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//
+//==============================================================================
+
+#import "ASTObjectIndex.h"
+
+#import "ASTSectionSubclass.h"
+
+
+//------------------------------------------------------------------------------
+
+// Holds the objects that share a value. Most values are unique so a single
+// object is stored directly in the map table.
+
+@interface ASTObjectIndexBucket : NSObject
+
+@property (readonly,nonatomic) NSMutableArray* objects;
+
+@end
+
+//------------------------------------------------------------------------------
+
+@implementation ASTObjectIndexBucket
+
+- (instancetype) init
+{
+	self = [ super init ];
+	if( self ) {
+		_objects = [ NSMutableArray array ];
+	}
+	return self;
+}
+
+@end
+
+//------------------------------------------------------------------------------
+
+@interface ASTObjectIndex() {
+	NSMapTable* _objects;
+}
+
+@end
+
+//------------------------------------------------------------------------------
+
+@implementation ASTObjectIndex
+
+//------------------------------------------------------------------------------
+
+- (instancetype) initWithKey: (NSString*) key
+{
+	self = [ super init ];
+	if( self ) {
+		_key = [ key copy ];
+	}
+	return self;
+}
+
+//------------------------------------------------------------------------------
+
+- (id) firstObjectWithValue: (id) value inContainer: (NSArray*) container
+		firstStaleIndex: (NSUInteger*) firstStaleIndex
+{
+	NSParameterAssert( value );
+	
+	if( _objects == nil ) {
+		// Map tables do not copy their keys, so any represented object works.
+		_objects = [ NSMapTable strongToStrongObjectsMapTable ];
+		for( id object in container ) {
+			[ self addObject: object forValue: [ object valueForKey: _key ] ];
+		}
+	}
+	
+	id result = [ _objects objectForKey: value ];
+	if( [ result isKindOfClass: [ ASTObjectIndexBucket class ] ] ) {
+		NSUInteger firstIndex = NSNotFound;
+		id firstObject = nil;
+		for( id object in [ result objects ] ) {
+			NSUInteger index = containerIndexOfObject( container, object, firstStaleIndex );
+			if( index < firstIndex ) {
+				firstIndex = index;
+				firstObject = object;
+			}
+		}
+		result = firstObject;
+	} else if( result
+			&& containerIndexOfObject( container, result, firstStaleIndex ) == NSNotFound ) {
+		// The object left the container without being removed from the index.
+		[ _objects removeObjectForKey: value ];
+		result = nil;
+	}
+	return result;
+}
+
+//------------------------------------------------------------------------------
+
+- (void) addObject: (id) object
+{
+	if( _objects ) {
+		[ self addObject: object forValue: [ object valueForKey: _key ] ];
+	}
+}
+
+//------------------------------------------------------------------------------
+
+- (void) addObject: (id) object forValue: (id) value
+{
+	if( value == nil ) {
+		return;
+	}
+	
+	id existing = [ _objects objectForKey: value ];
+	if( existing == nil ) {
+		[ _objects setObject: object forKey: value ];
+	} else if( [ existing isKindOfClass: [ ASTObjectIndexBucket class ] ] ) {
+		[ [ existing objects ] addObject: object ];
+	} else if( existing != object ) {
+		ASTObjectIndexBucket* bucket = [ [ ASTObjectIndexBucket alloc ] init ];
+		[ bucket.objects addObject: existing ];
+		[ bucket.objects addObject: object ];
+		[ _objects setObject: bucket forKey: value ];
+	}
+}
+
+//------------------------------------------------------------------------------
+
+- (void) removeObject: (id) object
+{
+	if( _objects ) {
+		[ self removeObject: object forValue: [ object valueForKey: _key ] ];
+	}
+}
+
+//------------------------------------------------------------------------------
+
+- (void) removeObject: (id) object forValue: (id) value
+{
+	if( value == nil ) {
+		return;
+	}
+	
+	id existing = [ _objects objectForKey: value ];
+	if( existing == object ) {
+		[ _objects removeObjectForKey: value ];
+	} else if( [ existing isKindOfClass: [ ASTObjectIndexBucket class ] ] ) {
+		NSMutableArray* objects = [ existing objects ];
+		[ objects removeObjectIdenticalTo: object ];
+		if( objects.count == 1 ) {
+			[ _objects setObject: objects.firstObject forKey: value ];
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+
+- (void) object: (id) object didChangeValueFrom: (id) oldValue
+{
+	if( _objects ) {
+		[ self removeObject: object forValue: oldValue ];
+		[ self addObject: object forValue: [ object valueForKey: _key ] ];
+	}
+}
+
+//------------------------------------------------------------------------------
+
+- (void) invalidate
+{
+	_objects = nil;
+}
+
+//------------------------------------------------------------------------------
+
+@end
@@ -0,0 +1,132 @@
+//==============================================================================
+//
+//  ASTPerformanceMetrics.h
+//
+//==============================================================================
+//
+//  Copyright (c) 2016 Adobe Systems Incorporated. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a
+//  copy of this software and associated documentation files (the "Software"),
+//  to deal in the Software without restriction, including without limitation
+//  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//  and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//
+//==============================================================================
+
+#import <Foundation/Foundation.h>
+
+
+NS_ASSUME_NONNULL_BEGIN
+
+//------------------------------------------------------------------------------
+
+// The operations recorded by ASTPerformanceMetrics.
+
+/// Setting the data of a table view controller, including building its
+/// sections and items.
+extern NSString* const ASTPerformanceOperationSetData;
+/// Setting the items of a section.
+extern NSString* const ASTPerformanceOperationSetItems;
+/// Building an item from a dictionary with itemWithDict:.
+extern NSString* const ASTPerformanceOperationBuildItem;
+/// Creating or binding the cell of an item and applying its cell properties.
+extern NSString* const ASTPerformanceOperationLoadCell;
+/// Applying cell properties that changed to a loaded cell, either when they are
+/// set or, when cell updates are deferred, when the cell is displayed or read.
+extern NSString* const ASTPerformanceOperationApplyCellProperties;
+/// Returning the cell of a row to the table view.
+extern NSString* const ASTPerformanceOperationCellForRow;
+/// Measuring the height of a section header or footer view.
+extern NSString* const ASTPerformanceOperationMeasureSectionView;
+/// Finding the index path of an item.
+extern NSString* const ASTPerformanceOperationIndexPathForItem;
+/// Inserting, removing or moving sections or rows, or performing batch updates.
+/// The changes made in a batch update are recorded as part of it.
+extern NSString* const ASTPerformanceOperationBatchUpdate;
+
+//------------------------------------------------------------------------------
+
+/// The durations recorded for an operation.
+@interface ASTPerformanceStatistics : NSObject
+
+/// The number of times the operation was recorded.
+@property (readonly,nonatomic) NSUInteger count;
+/// The sum of the durations in seconds.
+@property (readonly,nonatomic) NSTimeInterval totalDuration;
+/// The longest duration in seconds.
+@property (readonly,nonatomic) NSTimeInterval maximumDuration;
+/// The mean duration in seconds, 0 if the count is 0.
+@property (readonly,nonatomic) NSTimeInterval averageDuration;
+/// The latency histogram. The count at index 0 is of durations under one
+/// microsecond, and the count at index i of durations from 2^(i-1) up to 2^i
+/// microseconds. The last count also includes all longer durations.
+@property (readonly,nonatomic) NSArray<NSNumber*>* histogram;
+
+/// Returns an upper bound of the duration that the percentage of the recorded
+/// durations do not exceed, from the histogram.
+/// @param percentile A number from 0 to 100.
+/// @return The duration in seconds.
+- (NSTimeInterval) durationAtPercentile: (double) percentile;
+
+@end
+
+//------------------------------------------------------------------------------
+
+/// Records how long the operations of a table view controller, and those of
+/// its sections and items, take. Set it as the performanceMetrics of an
+/// ASTViewController to start recording. Nothing is recorded while a controller
+/// has no metrics. The instrumented code of the controller and its sections
+/// then only tests its metrics for nil, and that of items gets them from the
+/// controller first.
+/// Items built from dictionaries on the main thread while an operation of the
+/// controller is recorded are recorded too. Used on the main thread.
+@interface ASTPerformanceMetrics : NSObject
+
+/// Determines if each recorded operation is also kept as a span for
+/// chromeTraceData. The default is NO.
+@property (nonatomic) BOOL recordsSpans;
+/// The number of spans kept. Spans recorded after the limit is reached are
+/// dropped. The default is 100000.
+@property (nonatomic) NSUInteger maximumNumberOfSpans;
+
+/// The operations that were recorded.
+@property (readonly,nonatomic) NSArray<NSString*>* operations;
+/// The number of cell property values set on cells.
+@property (readonly,nonatomic) NSUInteger appliedCellPropertyCount;
+
+/// Returns the durations recorded for an operation.
+/// @param operation One of the ASTPerformanceOperation strings.
+/// @return The statistics of the operation or nil if it was not recorded.
+- (nullable ASTPerformanceStatistics*) statisticsForOperation: (NSString*) operation;
+/// Returns the durations recorded for an operation by item class, for the
+/// operations that are done for an item, such as building items, loading cells
+/// and returning cells to the table view.
+/// @param operation One of the ASTPerformanceOperation strings.
+/// @return A dictionary of statistics by item class name.
+- (NSDictionary<NSString*,ASTPerformanceStatistics*>*) statisticsByItemClassForOperation:
+		(NSString*) operation;
+
+/// Returns the recorded spans in the Chrome trace event format, which can be
+/// opened in chrome://tracing or Perfetto. Empty unless recordsSpans is set.
+/// @return JSON data.
+- (NSData*) chromeTraceData;
+
+/// Forgets everything that was recorded.
+- (void) reset;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,274 @@
+//==============================================================================
+//
+//  ASTPerformanceMetrics.m
+//
+//==============================================================================
+//
+//  Copyright (c) 2016 Adobe Systems Incorporated. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a
+//  copy of this software and associated documentation files (the "Software"),
+//  to deal in the Software without restriction, including without limitation
+//  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//  and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//
+//==============================================================================
+
+#import "ASTPerformanceMetrics.h"
+#import "ASTPerformanceSpan.h"
+
+
+//------------------------------------------------------------------------------
+
+// Durations of 2^22 microseconds, about four seconds, and longer share the
+// last bucket.
+#define ASTPerformanceHistogramBucketCount 24
+
+static const NSUInteger ASTPerformanceMetricsDefaultMaximumNumberOfSpans = 100000;
+
+__thread __unsafe_unretained ASTPerformanceMetrics* ASTCurrentPerformanceMetrics;
+
+//------------------------------------------------------------------------------
+
+static NSUInteger histogramBucketOfDuration( NSTimeInterval duration )
+{
+	NSUInteger result = 0;
+	double microseconds = duration * 1e6;
+	double bound = 1;
+	while( microseconds >= bound && result < ASTPerformanceHistogramBucketCount - 1 ) {
+		bound *= 2;
+		++result;
+	}
+	return result;
+}
+
+//------------------------------------------------------------------------------
+
+// The operation and class names are constants or class names, which are never
+// deallocated, so the spans do not retain them.
+
+typedef struct {
+	__unsafe_unretained NSString* operation;
+	__unsafe_unretained Class itemClass;
+	CFTimeInterval startTime;
+	CFTimeInterval duration;
+} ASTRecordedSpan;
+
+//------------------------------------------------------------------------------
+
+@interface ASTPerformanceStatistics() {
+	NSUInteger _histogram[ ASTPerformanceHistogramBucketCount ];
+}
+
+- (void) addDuration: (NSTimeInterval) duration;
+
+@end
+
+//------------------------------------------------------------------------------
+
+@interface ASTPerformanceMetrics() {
+	NSMutableDictionary* _statistics;
+	// Dictionaries of statistics by item class name, by operation.
+	NSMutableDictionary* _statisticsByItemClass;
+	NSMutableData* _spans;
+}
+
+@end
+
+//------------------------------------------------------------------------------
+
+@implementation ASTPerformanceMetrics
+
+//------------------------------------------------------------------------------
+
+- (instancetype) init
+{
+	self = [ super init ];
+	if( self ) {
+		_maximumNumberOfSpans = ASTPerformanceMetricsDefaultMaximumNumberOfSpans;
+		_statistics = [ NSMutableDictionary dictionary ];
+		_statisticsByItemClass = [ NSMutableDictionary dictionary ];
+		_spans = [ NSMutableData data ];
+	}
+	return self;
+}
+
+//------------------------------------------------------------------------------
+
+- (NSArray*) operations
+{
+	return [ _statistics.allKeys sortedArrayUsingSelector: @selector(compare:) ];
+}
+
+//------------------------------------------------------------------------------
+
+- (ASTPerformanceStatistics*) statisticsForOperation: (NSString*) operation
+{
+	return _statistics[ operation ];
+}
+
+//------------------------------------------------------------------------------
+
+- (NSDictionary*) statisticsByItemClassForOperation: (NSString*) operation
+{
+	return [ _statisticsByItemClass[ operation ] copy ] ?: @{};
+}
+
+//------------------------------------------------------------------------------
+
+- (void) recordOperation: (NSString*) operation itemClass: (Class) itemClass
+		startTime: (CFTimeInterval) startTime endTime: (CFTimeInterval) endTime
+{
+	NSTimeInterval duration = endTime - startTime;
+	
+	ASTPerformanceStatistics* statistics = _statistics[ operation ];
+	if( statistics == nil ) {
+		statistics = [ [ ASTPerformanceStatistics alloc ] init ];
+		_statistics[ operation ] = statistics;
+	}
+	[ statistics addDuration: duration ];
+	
+	if( itemClass ) {
+		NSMutableDictionary* statisticsByItemClass = _statisticsByItemClass[ operation ];
+		if( statisticsByItemClass == nil ) {
+			statisticsByItemClass = [ NSMutableDictionary dictionary ];
+			_statisticsByItemClass[ operation ] = statisticsByItemClass;
+		}
+		NSString* className = NSStringFromClass( itemClass );
+		ASTPerformanceStatistics* classStatistics = statisticsByItemClass[ className ];
+		if( classStatistics == nil ) {
+			classStatistics = [ [ ASTPerformanceStatistics alloc ] init ];
+			statisticsByItemClass[ className ] = classStatistics;
+		}
+		[ classStatistics addDuration: duration ];
+	}
+	
+	if( _recordsSpans && _spans.length / sizeof( ASTRecordedSpan ) < _maximumNumberOfSpans ) {
+		ASTRecordedSpan span = { operation, itemClass, startTime, duration };
+		[ _spans appendBytes: &span length: sizeof( span ) ];
+	}
+}
+
+//------------------------------------------------------------------------------
+
+- (void) recordAppliedCellProperty
+{
+	++_appliedCellPropertyCount;
+}
+
+//------------------------------------------------------------------------------
+
+// Spans are complete events. Nested operations are drawn inside the operations
+// that started them since they all happen on the main thread.
+
+- (NSData*) chromeTraceData
+{
+	const ASTRecordedSpan* spans = _spans.bytes;
+	NSUInteger spanCount = _spans.length / sizeof( ASTRecordedSpan );
+	CFTimeInterval firstStartTime = spanCount ? spans[ 0 ].startTime : 0;
+	for( NSUInteger i = 1; i < spanCount; ++i ) {
+		firstStartTime = MIN( firstStartTime, spans[ i ].startTime );
+	}
+	
+	NSMutableArray* events = [ NSMutableArray arrayWithCapacity: spanCount ];
+	for( NSUInteger i = 0; i < spanCount; ++i ) {
+		const ASTRecordedSpan* span = &spans[ i ];
+		NSMutableDictionary* event = [ @{
+			@"name" : span->operation,
+			@"cat" : @"AST",
+			@"ph" : @"X",
+			@"ts" : @( ( span->startTime - firstStartTime ) * 1e6 ),
+			@"dur" : @( span->duration * 1e6 ),
+			@"pid" : @1,
+			@"tid" : @1,
+		} mutableCopy ];
+		if( span->itemClass ) {
+			event[ @"args" ] = @{ @"itemClass" : NSStringFromClass( span->itemClass ) };
+		}
+		[ events addObject: event ];
+	}
+	
+	NSDictionary* trace = @{ @"traceEvents" : events, @"displayTimeUnit" : @"ms" };
+	return [ NSJSONSerialization dataWithJSONObject: trace options: 0 error: NULL ];
+}
+
+//------------------------------------------------------------------------------
+
+- (void) reset
+{
+	[ _statistics removeAllObjects ];
+	[ _statisticsByItemClass removeAllObjects ];
+	_spans.length = 0;
+	_appliedCellPropertyCount = 0;
+}
+
+//------------------------------------------------------------------------------
+
+@end
+
+//------------------------------------------------------------------------------
+
+@implementation ASTPerformanceStatistics
+
+//------------------------------------------------------------------------------
+
+- (void) addDuration: (NSTimeInterval) duration
+{
+	++_count;
+	_totalDuration += duration;
+	_maximumDuration = MAX( _maximumDuration, duration );
+	++_histogram[ histogramBucketOfDuration( duration ) ];
+}
+
+//------------------------------------------------------------------------------
+
+- (NSTimeInterval) averageDuration
+{
+	return _count ? _totalDuration / _count : 0;
+}
+
+//------------------------------------------------------------------------------
+
+- (NSArray*) histogram
+{
+	NSMutableArray* result = [ NSMutableArray arrayWithCapacity: ASTPerformanceHistogramBucketCount ];
+	for( NSUInteger i = 0; i < ASTPerformanceHistogramBucketCount; ++i ) {
+		[ result addObject: @( _histogram[ i ] ) ];
+	}
+	return result;
+}
+
+//------------------------------------------------------------------------------
+
+- (NSTimeInterval) durationAtPercentile: (double) percentile
+{
+	NSParameterAssert( percentile >= 0 && percentile <= 100 );
+	
+	double threshold = _count * percentile / 100;
+	NSUInteger count = 0;
+	double bound = 1;
+	for( NSUInteger i = 0; i < ASTPerformanceHistogramBucketCount - 1; ++i ) {
+		count += _histogram[ i ];
+		if( count > 0 && count >= threshold ) {
+			return MIN( bound / 1e6, _maximumDuration );
+		}
+		bound *= 2;
+	}
+	return _maximumDuration;
+}
+
+//------------------------------------------------------------------------------
+
+@end
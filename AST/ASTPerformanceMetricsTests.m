@@ -0,0 +1,194 @@
+//==============================================================================
+//
+//  ASTPerformanceMetricsTests.m
+//
+//==============================================================================
+//
+//  Copyright (c) 2016 Adobe Systems Incorporated. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a
+//  copy of this software and associated documentation files (the "Software"),
+//  to deal in the Software without restriction, including without limitation
+//  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//  and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//
+//==============================================================================
+
+#import "ASTPerformanceMetrics.h"
+#import "ASTPerformanceSpan.h"
+
+#import "ASTSwitchItem.h"
+#import "ASTViewController.h"
+
+#import <UIKit/UIKit.h>
+#import <XCTest/XCTest.h>
+
+
+//------------------------------------------------------------------------------
+
+@interface ASTPerformanceMetricsTests : XCTestCase
+
+@end
+
+//------------------------------------------------------------------------------
+
+@implementation ASTPerformanceMetricsTests
+
+//------------------------------------------------------------------------------
+
+- (void) testNothingRecordedWithoutMetrics
+{
+	ASTViewController* vc = [ [ ASTViewController alloc ] init ];
+	XCTAssertNil( vc.performanceMetrics );
+	vc.data = @[ @{ AST_items : @[ @{ AST_cell_textLabel_text : @"Text" } ] } ];
+	XCTAssertNotNil( [ vc tableView: vc.tableView
+			cellForRowAtIndexPath: [ NSIndexPath indexPathForRow: 0 inSection: 0 ] ] );
+	XCTAssertNil( ASTCurrentPerformanceMetrics );
+}
+
+//------------------------------------------------------------------------------
+
+- (void) testRecordsOperations
+{
+	ASTPerformanceMetrics* metrics = [ [ ASTPerformanceMetrics alloc ] init ];
+	ASTViewController* vc = [ [ ASTViewController alloc ] init ];
+	vc.tableView.frame = CGRectMake( 0, 0, 320, 480 );
+	vc.performanceMetrics = metrics;
+	
+	UILabel* headerView = [ [ UILabel alloc ] init ];
+	headerView.text = @"Header";
+	vc.data = @[
+		@{
+			AST_headerView : headerView,
+			AST_items : @[
+				@{ AST_cell_textLabel_text : @"Text" },
+				@{ AST_itemClass : @"ASTSwitchItem", AST_cell_textLabel_text : @"Switch" },
+			],
+		},
+	];
+	XCTAssertEqual( [ metrics statisticsForOperation: ASTPerformanceOperationSetData ].count, 1 );
+	NSDictionary* buildStatistics = [ metrics
+			statisticsByItemClassForOperation: ASTPerformanceOperationBuildItem ];
+	XCTAssertEqual( [ buildStatistics[ @"ASTItem" ] count ], 1 );
+	XCTAssertEqual( [ buildStatistics[ @"ASTSwitchItem" ] count ], 1 );
+	
+	for( NSInteger row = 0; row < 2; ++row ) {
+		[ vc tableView: vc.tableView
+				cellForRowAtIndexPath: [ NSIndexPath indexPathForRow: row inSection: 0 ] ];
+	}
+	XCTAssertEqual( [ metrics statisticsForOperation: ASTPerformanceOperationCellForRow ].count, 2 );
+	NSDictionary* loadStatistics = [ metrics
+			statisticsByItemClassForOperation: ASTPerformanceOperationLoadCell ];
+	XCTAssertEqual( [ loadStatistics[ @"ASTSwitchItem" ] count ], 1 );
+	XCTAssertGreaterThan( metrics.appliedCellPropertyCount, 0 );
+	
+	[ vc tableView: vc.tableView heightForHeaderInSection: 0 ];
+	XCTAssertEqual( [ metrics statisticsForOperation: ASTPerformanceOperationMeasureSectionView ].count, 1 );
+	
+	ASTItem* item = [ vc sectionAtIndex: 0 ].items.lastObject;
+	XCTAssertNotNil( [ vc indexPathForItem: item ] );
+	XCTAssertEqual( [ metrics statisticsForOperation: ASTPerformanceOperationIndexPathForItem ].count, 1 );
+	
+	[ vc insertItems: @[ [ ASTItem item ] ]
+			atIndexPaths: @[ [ NSIndexPath indexPathForRow: 0 inSection: 0 ] ]
+			withRowAnimation: UITableViewRowAnimationNone ];
+	XCTAssertEqual( [ metrics statisticsForOperation: ASTPerformanceOperationBatchUpdate ].count, 1 );
+	
+	// The changes of a batch are recorded as one batch update.
+	[ vc performBatchUpdates: ^{
+		[ vc insertItems: @[ [ ASTItem item ] ]
+				atIndexPaths: @[ [ NSIndexPath indexPathForRow: 0 inSection: 0 ] ]
+				withRowAnimation: UITableViewRowAnimationNone ];
+		[ vc removeItemsAtIndexPaths: @[ [ NSIndexPath indexPathForRow: 1 inSection: 0 ] ]
+				withRowAnimation: UITableViewRowAnimationNone ];
+	} withRowAnimation: UITableViewRowAnimationNone ];
+	XCTAssertEqual( [ metrics statisticsForOperation: ASTPerformanceOperationBatchUpdate ].count, 2 );
+	
+	// Properties set on a loaded cell are applied right away and recorded.
+	[ item setValue: @"Changed" forKeyPath: AST_cell_textLabel_text ];
+	XCTAssertEqual( [ [ metrics statisticsByItemClassForOperation:
+			ASTPerformanceOperationApplyCellProperties ][ @"ASTSwitchItem" ] count ], 1 );
+	
+	ASTPerformanceStatistics* statistics = [ metrics
+			statisticsForOperation: ASTPerformanceOperationCellForRow ];
+	XCTAssertGreaterThanOrEqual( statistics.maximumDuration, statistics.averageDuration );
+	XCTAssertTrue( [ metrics.operations containsObject: ASTPerformanceOperationCellForRow ] );
+	XCTAssertNil( ASTCurrentPerformanceMetrics );
+	
+	[ metrics reset ];
+	XCTAssertEqual( metrics.operations.count, 0 );
+	XCTAssertEqual( metrics.appliedCellPropertyCount, 0 );
+}
+
+//------------------------------------------------------------------------------
+
+- (void) testStatistics
+{
+	ASTPerformanceMetrics* metrics = [ [ ASTPerformanceMetrics alloc ] init ];
+	for( NSNumber* duration in @[ @0.5e-6, @3e-6, @100e-6 ] ) {
+		[ metrics recordOperation: ASTPerformanceOperationLoadCell itemClass: nil
+				startTime: 10 endTime: 10 + duration.doubleValue ];
+	}
+	
+	ASTPerformanceStatistics* statistics = [ metrics
+			statisticsForOperation: ASTPerformanceOperationLoadCell ];
+	XCTAssertEqual( statistics.count, 3 );
+	XCTAssertEqualWithAccuracy( statistics.totalDuration, 103.5e-6, 1e-9 );
+	XCTAssertEqualWithAccuracy( statistics.maximumDuration, 100e-6, 1e-9 );
+	XCTAssertEqualWithAccuracy( statistics.averageDuration, 34.5e-6, 1e-9 );
+	XCTAssertEqualObjects( statistics.histogram[ 0 ], @1 );
+	XCTAssertEqualObjects( statistics.histogram[ 2 ], @1 );
+	XCTAssertEqualObjects( statistics.histogram[ 7 ], @1 );
+	XCTAssertEqualWithAccuracy( [ statistics durationAtPercentile: 50 ], 4e-6, 1e-9 );
+	XCTAssertEqualWithAccuracy( [ statistics durationAtPercentile: 100 ], 100e-6, 1e-9 );
+	XCTAssertEqual( [ metrics statisticsByItemClassForOperation: ASTPerformanceOperationLoadCell ].count, 0 );
+}
+
+//------------------------------------------------------------------------------
+
+- (void) testChromeTrace
+{
+	ASTPerformanceMetrics* metrics = [ [ ASTPerformanceMetrics alloc ] init ];
+	[ metrics recordOperation: ASTPerformanceOperationSetData itemClass: nil
+			startTime: 10 endTime: 11 ];
+	NSDictionary* trace = [ NSJSONSerialization JSONObjectWithData: metrics.chromeTraceData
+			options: 0 error: NULL ];
+	XCTAssertEqual( [ trace[ @"traceEvents" ] count ], 0 );
+	
+	metrics.recordsSpans = YES;
+	metrics.maximumNumberOfSpans = 2;
+	[ metrics recordOperation: ASTPerformanceOperationSetData itemClass: nil
+			startTime: 10 endTime: 11 ];
+	[ metrics recordOperation: ASTPerformanceOperationLoadCell itemClass: [ ASTSwitchItem class ]
+			startTime: 10.5 endTime: 10.75 ];
+	[ metrics recordOperation: ASTPerformanceOperationLoadCell itemClass: nil
+			startTime: 12 endTime: 13 ];
+	
+	trace = [ NSJSONSerialization JSONObjectWithData: metrics.chromeTraceData
+			options: 0 error: NULL ];
+	NSArray* events = trace[ @"traceEvents" ];
+	XCTAssertEqual( events.count, 2 );
+	NSDictionary* event = events[ 1 ];
+	XCTAssertEqualObjects( event[ @"name" ], ASTPerformanceOperationLoadCell );
+	XCTAssertEqualObjects( event[ @"ph" ], @"X" );
+	XCTAssertEqualWithAccuracy( [ event[ @"ts" ] doubleValue ], 500000, 1 );
+	XCTAssertEqualWithAccuracy( [ event[ @"dur" ] doubleValue ], 250000, 1 );
+	XCTAssertEqualObjects( event[ @"args" ][ @"itemClass" ], @"ASTSwitchItem" );
+	XCTAssertEqual( [ metrics statisticsForOperation: ASTPerformanceOperationLoadCell ].count, 2 );
+}
+
+//------------------------------------------------------------------------------
+
+@end
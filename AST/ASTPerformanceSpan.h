@@ -0,0 +1,88 @@
+//==============================================================================
+//
+//  ASTPerformanceSpan.h
+//
+//==============================================================================
+//
+//  Copyright (c) 2016 Adobe Systems Incorporated. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a
+//  copy of this software and associated documentation files (the "Software"),
+//  to deal in the Software without restriction, including without limitation
+//  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//  and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//
+//==============================================================================
+
+// This is private to the framework. The table view controller, sections and
+// items use it to record their operations in ASTPerformanceMetrics.
+
+#import <QuartzCore/QuartzCore.h>
+
+#import "ASTPerformanceMetrics.h"
+
+
+NS_ASSUME_NONNULL_BEGIN
+
+//------------------------------------------------------------------------------
+
+// The metrics of the operation being recorded on the current thread, nil when
+// none is. Items built during an operation are recorded in them.
+extern __thread __unsafe_unretained ASTPerformanceMetrics* __nullable ASTCurrentPerformanceMetrics;
+
+//------------------------------------------------------------------------------
+
+@interface ASTPerformanceMetrics( ASTPerformanceSpan )
+
+- (void) recordOperation: (NSString*) operation itemClass: (nullable Class) itemClass
+		startTime: (CFTimeInterval) startTime endTime: (CFTimeInterval) endTime;
+- (void) recordAppliedCellProperty;
+
+@end
+
+//------------------------------------------------------------------------------
+
+typedef struct {
+	ASTPerformanceMetrics* __nullable metrics;
+	__unsafe_unretained ASTPerformanceMetrics* __nullable outerMetrics;
+	CFTimeInterval startTime;
+} ASTPerformanceSpan;
+
+// Starts recording an operation. Nil metrics record nothing.
+
+static inline ASTPerformanceSpan ASTPerformanceSpanBegin( ASTPerformanceMetrics* __nullable metrics )
+{
+	ASTPerformanceSpan result = { metrics, nil, 0 };
+	if( metrics ) {
+		result.outerMetrics = ASTCurrentPerformanceMetrics;
+		ASTCurrentPerformanceMetrics = metrics;
+		result.startTime = CACurrentMediaTime();
+	}
+	return result;
+}
+
+// Ends recording an operation. Spans must end in the reverse order they began.
+
+static inline void ASTPerformanceSpanEnd( ASTPerformanceSpan span, NSString* operation,
+		Class __nullable itemClass )
+{
+	if( span.metrics ) {
+		[ span.metrics recordOperation: operation itemClass: itemClass
+				startTime: span.startTime endTime: CACurrentMediaTime() ];
+		ASTCurrentPerformanceMetrics = span.outerMetrics;
+	}
+}
+
+NS_ASSUME_NONNULL_END
@@ -29,12 +29,15 @@
 #import "ASTPrefGroupItem.h"
 
 #import "ASTItemSubclass.h"
+#import "ASTPreferenceObserver.h"
 #import "ASTViewController.h"
 
 
 //------------------------------------------------------------------------------
 
-void* _Nullable ASTItemPrefGroupItem_prefObservationContext = &ASTItemPrefGroupItem_prefObservationContext;
+@interface ASTPrefGroupItem() <ASTPreferenceObserving>
+
+@end
 
 //------------------------------------------------------------------------------
 
@@ -86,16 +89,6 @@ void* _Nullable ASTItemPrefGroupItem_prefObservationContext = &ASTItemPrefGroupI
 
 //------------------------------------------------------------------------------
 
-- (void) dealloc
-{
-	if( _prefKey ) {
-		[ [ NSUserDefaults standardUserDefaults ] removeObserver: self
-				forKeyPath: _prefKey context: ASTItemPrefGroupItem_prefObservationContext ];
-	}
-}
-
-//------------------------------------------------------------------------------
-
 - (id) resolvedPrefValue
 {
 // LCOV_EXCL_START
@@ -106,8 +99,7 @@ void* _Nullable ASTItemPrefGroupItem_prefObservationContext = &ASTItemPrefGroupI
 	
 	id prefValue = nil;
 	if( _prefKey ) {
-		prefValue = [ [ NSUserDefaults standardUserDefaults ]
-				valueForKey: _prefKey ];
+		prefValue = [ self.prefStore objectForKey: _prefKey ];
 	}
 	if( prefValue == nil && _itemIsDefault ) {
 		prefValue = _itemPrefValue;
@@ -120,11 +112,23 @@ void* _Nullable ASTItemPrefGroupItem_prefObservationContext = &ASTItemPrefGroupI
 
 - (void) syncCheckedStateWithPrefValue
 {
-	id prefValue = [ self resolvedPrefValue ];
+	[ self syncCheckedStateWithResolvedPrefValue: [ self resolvedPrefValue ] ];
+}
+
+//------------------------------------------------------------------------------
+
+// Only the items of a group whose checkmark changes touch their cell properties,
+// so a change of the preference does not update every item of the group.
+
+- (void) syncCheckedStateWithResolvedPrefValue: (id) prefValue
+{
 	UITableViewCellAccessoryType accessoryType = [ prefValue isEqual: _itemPrefValue ]
 			? UITableViewCellAccessoryCheckmark
 			: UITableViewCellAccessoryNone;
-	[ self setValue: @(accessoryType) forKeyPath: AST_cell_accessoryType ];
+	NSNumber* oldAccessoryType = [ self valueForKeyPath: AST_cell_accessoryType ];
+	if( oldAccessoryType == nil || oldAccessoryType.integerValue != accessoryType ) {
+		[ self setValue: @(accessoryType) forKeyPath: AST_cell_accessoryType ];
+	}
 }
 
 //------------------------------------------------------------------------------
@@ -133,7 +137,7 @@ void* _Nullable ASTItemPrefGroupItem_prefObservationContext = &ASTItemPrefGroupI
 {
 	id prefValue = [ self resolvedPrefValue ];
 	if( [ prefValue isEqual: _itemPrefValue ] == NO ) {
-		[ [ NSUserDefaults standardUserDefaults ] setObject: _itemPrefValue forKey: _prefKey ];
+		[ self.prefStore setObject: _itemPrefValue forKey: _prefKey ];
 	}
 	
 	[ self deselectWithAnimation: YES ];
@@ -143,20 +147,8 @@ void* _Nullable ASTItemPrefGroupItem_prefObservationContext = &ASTItemPrefGroupI
 
 - (void) setPrefKey: (NSString*) prefKey
 {
-	NSUserDefaults* prefs = [ NSUserDefaults standardUserDefaults ];
-	
-	if( _prefKey ) {
-		[ prefs removeObserver: self forKeyPath: _prefKey ];
-	}
-	
 	_prefKey = prefKey;
-	
-	if( _prefKey ) {
-		[ prefs addObserver: self forKeyPath: _prefKey
-				options: NSKeyValueObservingOptionInitial
-				context: ASTItemPrefGroupItem_prefObservationContext ];
-	}
-	
+	[ self observePrefKey: prefKey ];
 	[ self syncCheckedStateWithPrefValue ];
 }
 
@@ -178,18 +170,12 @@ void* _Nullable ASTItemPrefGroupItem_prefObservationContext = &ASTItemPrefGroupI
 
 //------------------------------------------------------------------------------
 
-- (void) observeValueForKeyPath: (NSString*) keyPath ofObject: (id) object
-		change: (NSDictionary*) change context: (void*) context
+- (void) preferenceValue: (id) value didChangeForKey: (NSString*) key
 {
-	if( context == ASTItemPrefGroupItem_prefObservationContext ) {
-		[ self syncCheckedStateWithPrefValue ];
-		return;
+	if( value == nil && _itemIsDefault ) {
+		value = _itemPrefValue;
 	}
-	
-// LCOV_EXCL_START
-	[ super observeValueForKeyPath: keyPath ofObject: object
-			change: change context: context ];
-// LCOV_EXCL_STOP
+	[ self syncCheckedStateWithResolvedPrefValue: value ];
 }
 
 //------------------------------------------------------------------------------
@@ -27,6 +27,7 @@
 //==============================================================================
 
 #import "ASTPrefGroupItem.h"
+#import "ASTPreferenceObserver.h"
 #import "ASTSection.h"
 #import "ASTViewController.h"
 
@@ -153,6 +154,32 @@ NSString* const testPrefKey = @"testGroupPrefKey";
 
 //------------------------------------------------------------------------------
 
+- (void) testPreferenceChangeMovesCheckmark
+{
+	NSUserDefaults* prefs = [ NSUserDefaults standardUserDefaults ];
+	[ prefs removeObjectForKey: testPrefKey ];
+	
+	ASTSection* section = [ self buildTestSection ];
+	ASTItem* firstItem = [ section itemAtIndex: 0 ];
+	ASTItem* lastItem = [ section itemAtIndex: 3 ];
+	XCTAssertEqual( firstItem.cell.accessoryType, UITableViewCellAccessoryCheckmark );
+	
+	// A burst of writes is delivered to the items of the group once.
+	[ prefs setObject: @"fi" forKey: testPrefKey ];
+	[ prefs setObject: @"fum" forKey: testPrefKey ];
+	[ [ ASTPreferenceObserver sharedObserver ] deliverPendingChanges ];
+	XCTAssertEqual( firstItem.cell.accessoryType, UITableViewCellAccessoryNone );
+	XCTAssertEqual( lastItem.cell.accessoryType, UITableViewCellAccessoryCheckmark );
+	
+	// Removing the preference checks the default item again.
+	[ prefs removeObjectForKey: testPrefKey ];
+	[ [ ASTPreferenceObserver sharedObserver ] deliverPendingChanges ];
+	XCTAssertEqual( firstItem.cell.accessoryType, UITableViewCellAccessoryCheckmark );
+	XCTAssertEqual( lastItem.cell.accessoryType, UITableViewCellAccessoryNone );
+}
+
+//------------------------------------------------------------------------------
+
 - (void) testSelection
 {
 	NSUserDefaults* prefs = [ NSUserDefaults standardUserDefaults ];
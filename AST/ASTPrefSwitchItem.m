@@ -29,17 +29,14 @@
 #import "ASTPrefSwitchItem.h"
 
 #import "ASTItemSubclass.h"
+#import "ASTPreferenceObserver.h"
 
 #import <Foundation/NSException.h>
 
 
 //------------------------------------------------------------------------------
 
-void* ASTItemPrefSwitch_prefObservationContext = &ASTItemPrefSwitch_prefObservationContext;
-
-//------------------------------------------------------------------------------
-
-@interface ASTPrefSwitchItem()
+@interface ASTPrefSwitchItem() <ASTPreferenceObserving>
 
 @end
 
@@ -49,16 +46,6 @@ void* ASTItemPrefSwitch_prefObservationContext = &ASTItemPrefSwitch_prefObservat
 
 //------------------------------------------------------------------------------
 
-- (void) dealloc
-{
-	if( _prefKey ) {
-		[ [ NSUserDefaults standardUserDefaults ] removeObserver: self
-				forKeyPath: _prefKey context: ASTItemPrefSwitch_prefObservationContext ];
-	}
-}
-
-//------------------------------------------------------------------------------
-
 - (instancetype) initWithDict: (NSDictionary*) initialDict
 {
 	NSMutableDictionary* dict = [ initialDict mutableCopy ];
@@ -83,9 +70,15 @@ void* ASTItemPrefSwitch_prefObservationContext = &ASTItemPrefSwitch_prefObservat
 {
 	id prefValue = nil;
 	if( _prefKey ) {
-		prefValue = [ [ NSUserDefaults standardUserDefaults ]
-				valueForKey: _prefKey ] ?: _prefDefaultValue;
+		prefValue = [ self.prefStore objectForKey: _prefKey ] ?: _prefDefaultValue;
 	}
+	[ self updateSwitchStateWithPrefValue: prefValue ];
+}
+
+//------------------------------------------------------------------------------
+
+- (void) updateSwitchStateWithPrefValue: (id) prefValue
+{
 	BOOL newSwitchState = [ _prefOnValue isEqual: prefValue ];
 	[ self setValue: @(newSwitchState) forKeyPath: AST_cell_switch_on ];
 }
@@ -96,26 +89,15 @@ void* ASTItemPrefSwitch_prefObservationContext = &ASTItemPrefSwitch_prefObservat
 {
 	ASTSwitchItemCell* switchCell = (ASTSwitchItemCell*)self.cell;
 	id newPrefValue = switchCell.itemSwitch.on ? _prefOnValue : _prefOffValue;
-	[ [ NSUserDefaults standardUserDefaults ] setValue: newPrefValue
-			forKey: _prefKey ];
+	[ self.prefStore setObject: newPrefValue forKey: _prefKey ];
 }
 
 //------------------------------------------------------------------------------
 
 - (void) setPrefKey: (NSString*) prefKey
 {
-	NSUserDefaults* prefs = [ NSUserDefaults standardUserDefaults ];
-	
-	if( _prefKey ) {
-		[ prefs removeObserver: self forKeyPath: _prefKey ];
-	}
 	_prefKey = prefKey;
-	if( _prefKey ) {
-		[ prefs addObserver: self forKeyPath: _prefKey
-				options: NSKeyValueObservingOptionInitial
-				context: ASTItemPrefSwitch_prefObservationContext ];
-	}
-	
+	[ self observePrefKey: prefKey ];
 	[ self updateSwitchState ];
 }
 
@@ -137,18 +119,9 @@ void* ASTItemPrefSwitch_prefObservationContext = &ASTItemPrefSwitch_prefObservat
 
 //------------------------------------------------------------------------------
 
-- (void) observeValueForKeyPath: (NSString*) keyPath ofObject: (id) object
-		change: (NSDictionary*) change context: (void*) context
+- (void) preferenceValue: (id) value didChangeForKey: (NSString*) key
 {
-	if( context == ASTItemPrefSwitch_prefObservationContext ) {
-		[ self updateSwitchState ];
-		return;
-	}
-	
-// LCOV_EXCL_START
-	[ super observeValueForKeyPath: keyPath ofObject: object
-			change: change context: context ];
-// LCOV_EXCL_STOP
+	[ self updateSwitchStateWithPrefValue: value ?: _prefDefaultValue ];
 }
 
 //------------------------------------------------------------------------------
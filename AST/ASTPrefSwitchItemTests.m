@@ -27,6 +27,7 @@
 //==============================================================================
 
 #import "ASTPrefSwitchItem.h"
+#import "ASTPreferenceObserver.h"
 #import <UIKit/UIKit.h>
 #import <XCTest/XCTest.h>
 
@@ -188,6 +189,7 @@
 
 	// Test pref change is detected
 	[ prefs setObject: offValue forKey: prefKey ];
+	[ [ ASTPreferenceObserver sharedObserver ] deliverPendingChanges ];
 	XCTAssertEqual( prefSwitch.on, NO );
 	
 	// Test change to pref key
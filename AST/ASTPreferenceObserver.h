@@ -0,0 +1,83 @@
+//==============================================================================
+//
+//  ASTPreferenceObserver.h
+//
+//==============================================================================
+//
+//  Copyright (c) 2016 Adobe Systems Incorporated. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a
+//  copy of this software and associated documentation files (the "Software"),
+//  to deal in the Software without restriction, including without limitation
+//  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//  and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//
+//==============================================================================
+
+// This is private to the framework. The preference items use it so that each
+// preference key is observed once however many items display it.
+
+#import "ASTPreferenceStore.h"
+
+
+NS_ASSUME_NONNULL_BEGIN
+
+//------------------------------------------------------------------------------
+
+// Implemented by the items that display a preference.
+@protocol ASTPreferenceObserving <NSObject>
+
+- (void) preferenceValue: (nullable id) value didChangeForKey: (NSString*) key;
+
+@end
+
+//------------------------------------------------------------------------------
+
+@interface ASTPreferenceObserver : NSObject
+
+/// The observer of the standard user defaults.
++ (instancetype) sharedObserver;
+/// Returns the observer of a preference store, creating it the first time.
+/// There is one observer for each store. It keeps the store alive until the
+/// last observer of its last key is removed.
+/// @param store The preference store.
++ (instancetype) observerForStore: (id<ASTPreferenceStore>) store;
+
+/// Creates an observer of the keys of a preference store.
+/// @param store The preference store. It is retained.
+- (instancetype) initWithStore: (id<ASTPreferenceStore>) store NS_DESIGNATED_INITIALIZER;
+- (instancetype) init NS_UNAVAILABLE;
+
+/// The observed preference store.
+@property (readonly,nonatomic) id<ASTPreferenceStore> store;
+
+/// Registers an object to be told when the value of the key changes. The key is
+/// observed once for all of its observers. Observers are not retained and must
+/// be removed before they are deallocated. Nothing is delivered for the current
+/// value.
+- (void) addObserver: (id<ASTPreferenceObserving>) observer forKey: (NSString*) key;
+/// Unregisters an object for the key. The key stops being observed when its
+/// last observer is removed. Once no key is observed, observerForStore: no
+/// longer returns this observer.
+- (void) removeObserver: (id<ASTPreferenceObserving>) observer forKey: (NSString*) key;
+
+/// The changes of a key are collected and delivered once on the main queue, so
+/// a burst of writes only updates the observers once, with the last value.
+/// This delivers the collected changes right away.
+- (void) deliverPendingChanges;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,209 @@
+//==============================================================================
+//
+//  ASTPreferenceObserver.m
+//
+//==============================================================================
+//
+//  Copyright (c) 2016 Adobe Systems Incorporated. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a
+//  copy of this software and associated documentation files (the "Software"),
+//  to deal in the Software without restriction, including without limitation
+//  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//  and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//
+//==============================================================================
+
+#import "ASTPreferenceObserver.h"
+
+
+//------------------------------------------------------------------------------
+
+static void* ASTPreferenceObserver_observationContext = &ASTPreferenceObserver_observationContext;
+
+// The observers returned by observerForStore:. An observer is only kept while
+// it observes keys, so the stores of items that went away are released.
+static NSMapTable* observersByStore;
+
+//------------------------------------------------------------------------------
+
+@interface ASTPreferenceObserver() {
+	// The observers of each observed key. Observers are not retained, like
+	// those of key-value observing.
+	NSMutableDictionary* _observersByKey;
+	// The keys that changed since the last delivery. Only used on the main
+	// thread.
+	NSMutableOrderedSet* _changedKeys;
+}
+
+@end
+
+//------------------------------------------------------------------------------
+
+@implementation ASTPreferenceObserver
+
+//------------------------------------------------------------------------------
+
++ (instancetype) sharedObserver
+{
+	return [ self observerForStore: [ NSUserDefaults standardUserDefaults ] ];
+}
+
+//------------------------------------------------------------------------------
+
++ (instancetype) observerForStore: (id<ASTPreferenceStore>) store
+{
+	NSParameterAssert( store );
+	NSAssert( [ NSThread isMainThread ], @"Preference stores are used on the main thread" );
+	
+	if( observersByStore == nil ) {
+		observersByStore = [ NSMapTable mapTableWithKeyOptions:
+				NSPointerFunctionsStrongMemory | NSPointerFunctionsObjectPointerPersonality
+				valueOptions: NSPointerFunctionsStrongMemory ];
+	}
+	ASTPreferenceObserver* observer = [ observersByStore objectForKey: store ];
+	if( observer == nil ) {
+		observer = [ [ ASTPreferenceObserver alloc ] initWithStore: store ];
+		[ observersByStore setObject: observer forKey: store ];
+	}
+	return observer;
+}
+
+//------------------------------------------------------------------------------
+
+- (instancetype) initWithStore: (id<ASTPreferenceStore>) store
+{
+	NSParameterAssert( store );
+	
+	self = [ super init ];
+	if( self ) {
+		_store = store;
+		_observersByKey = [ NSMutableDictionary dictionary ];
+		_changedKeys = [ NSMutableOrderedSet orderedSet ];
+	}
+	return self;
+}
+
+//------------------------------------------------------------------------------
+
+- (void) dealloc
+{
+	for( NSString* key in _observersByKey ) {
+		[ (NSObject*)_store removeObserver: self forKeyPath: key
+				context: ASTPreferenceObserver_observationContext ];
+	}
+}
+
+//------------------------------------------------------------------------------
+
+- (void) addObserver: (id<ASTPreferenceObserving>) observer forKey: (NSString*) key
+{
+	NSParameterAssert( observer );
+	NSParameterAssert( key );
+	
+	NSHashTable* observers = _observersByKey[ key ];
+	if( observers == nil ) {
+		observers = [ NSHashTable hashTableWithOptions:
+				NSPointerFunctionsOpaqueMemory | NSPointerFunctionsObjectPointerPersonality ];
+		_observersByKey[ key ] = observers;
+		[ (NSObject*)_store addObserver: self forKeyPath: key options: 0
+				context: ASTPreferenceObserver_observationContext ];
+	}
+	[ observers addObject: observer ];
+}
+
+//------------------------------------------------------------------------------
+
+- (void) removeObserver: (id<ASTPreferenceObserving>) observer forKey: (NSString*) key
+{
+	NSHashTable* observers = _observersByKey[ key ];
+	[ observers removeObject: observer ];
+	if( observers && observers.count == 0 ) {
+		[ _observersByKey removeObjectForKey: key ];
+		[ _changedKeys removeObject: key ];
+		[ (NSObject*)_store removeObserver: self forKeyPath: key
+				context: ASTPreferenceObserver_observationContext ];
+	}
+	
+	// Last, as this may release the observer.
+	if( _observersByKey.count == 0 && [ observersByStore objectForKey: _store ] == self ) {
+		[ observersByStore removeObjectForKey: _store ];
+	}
+}
+
+//------------------------------------------------------------------------------
+
+- (void) setNeedsDeliveryForKey: (NSString*) key
+{
+	if( _observersByKey[ key ] == nil ) {
+		return;
+	}
+	
+	BOOL scheduled = _changedKeys.count > 0;
+	[ _changedKeys addObject: key ];
+	if( scheduled == NO ) {
+		__weak ASTPreferenceObserver* weakSelf = self;
+		dispatch_async( dispatch_get_main_queue(), ^{
+			[ weakSelf deliverPendingChanges ];
+		} );
+	}
+}
+
+//------------------------------------------------------------------------------
+
+- (void) deliverPendingChanges
+{
+	// Observers may change the store, which schedules another delivery.
+	NSArray* keys = _changedKeys.array;
+	[ _changedKeys removeAllObjects ];
+	for( NSString* key in keys ) {
+		id value = [ _store objectForKey: key ];
+		NSHashTable* observers = _observersByKey[ key ];
+		for( id<ASTPreferenceObserving> observer in observers.allObjects ) {
+			// An earlier observer may have removed it.
+			if( [ observers containsObject: observer ] ) {
+				[ observer preferenceValue: value didChangeForKey: key ];
+			}
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+
+- (void) observeValueForKeyPath: (NSString*) keyPath ofObject: (id) object
+		change: (NSDictionary*) change context: (void*) context
+{
+	if( context == ASTPreferenceObserver_observationContext ) {
+		// NSUserDefaults can be changed on any thread.
+		if( [ NSThread isMainThread ] ) {
+			[ self setNeedsDeliveryForKey: keyPath ];
+		} else {
+			__weak ASTPreferenceObserver* weakSelf = self;
+			dispatch_async( dispatch_get_main_queue(), ^{
+				[ weakSelf setNeedsDeliveryForKey: keyPath ];
+			} );
+		}
+		return;
+	}
+	
+// LCOV_EXCL_START
+	[ super observeValueForKeyPath: keyPath ofObject: object
+			change: change context: context ];
+// LCOV_EXCL_STOP
+}
+
+//------------------------------------------------------------------------------
+
+@end
@@ -0,0 +1,203 @@
+//==============================================================================
+//
+//  ASTPreferenceObserverTests.m
+//
+//==============================================================================
+//
+//  Copyright (c) 2016 Adobe Systems Incorporated. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a
+//  copy of this software and associated documentation files (the "Software"),
+//  to deal in the Software without restriction, including without limitation
+//  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//  and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//
+//==============================================================================
+
+#import "ASTPreferenceObserver.h"
+
+#import <XCTest/XCTest.h>
+
+
+//------------------------------------------------------------------------------
+
+// Keeps values in memory and reports changes like NSUserDefaults.
+
+@interface PreferenceTestDefaults : NSObject <ASTPreferenceStore>
+
+@end
+
+//------------------------------------------------------------------------------
+
+@interface PreferenceTestObserver : NSObject <ASTPreferenceObserving>
+
+@property (nonatomic) NSUInteger changeCount;
+@property (nonatomic) id lastValue;
+@property (copy,nonatomic) void (^changeBlock)( void );
+
+@end
+
+//------------------------------------------------------------------------------
+
+@interface ASTPreferenceObserverTests : XCTestCase
+
+@end
+
+//------------------------------------------------------------------------------
+
+@implementation ASTPreferenceObserverTests
+
+//------------------------------------------------------------------------------
+
+- (void) testChangesAreCoalesced
+{
+	PreferenceTestDefaults* defaults = [ [ PreferenceTestDefaults alloc ] init ];
+	ASTPreferenceObserver* preferenceObserver = [ [ ASTPreferenceObserver alloc ]
+			initWithStore: defaults ];
+	PreferenceTestObserver* observer1 = [ [ PreferenceTestObserver alloc ] init ];
+	PreferenceTestObserver* observer2 = [ [ PreferenceTestObserver alloc ] init ];
+	PreferenceTestObserver* otherObserver = [ [ PreferenceTestObserver alloc ] init ];
+	[ preferenceObserver addObserver: observer1 forKey: @"key" ];
+	[ preferenceObserver addObserver: observer2 forKey: @"key" ];
+	[ preferenceObserver addObserver: otherObserver forKey: @"otherKey" ];
+	
+	[ defaults setObject: @1 forKey: @"key" ];
+	[ defaults setObject: @2 forKey: @"key" ];
+	[ defaults setObject: @3 forKey: @"key" ];
+	XCTAssertEqual( observer1.changeCount, 0 );
+	
+	[ preferenceObserver deliverPendingChanges ];
+	XCTAssertEqual( observer1.changeCount, 1 );
+	XCTAssertEqualObjects( observer1.lastValue, @3 );
+	XCTAssertEqual( observer2.changeCount, 1 );
+	XCTAssertEqualObjects( observer2.lastValue, @3 );
+	XCTAssertEqual( otherObserver.changeCount, 0 );
+	
+	// Nothing is left to deliver.
+	[ preferenceObserver deliverPendingChanges ];
+	XCTAssertEqual( observer1.changeCount, 1 );
+	
+	// Removed observers are not told about changes.
+	[ preferenceObserver removeObserver: observer1 forKey: @"key" ];
+	[ defaults setObject: @4 forKey: @"key" ];
+	[ defaults setObject: @5 forKey: @"otherKey" ];
+	[ preferenceObserver deliverPendingChanges ];
+	XCTAssertEqual( observer1.changeCount, 1 );
+	XCTAssertEqual( observer2.changeCount, 2 );
+	XCTAssertEqualObjects( observer2.lastValue, @4 );
+	XCTAssertEqual( otherObserver.changeCount, 1 );
+	
+	[ preferenceObserver removeObserver: observer2 forKey: @"key" ];
+	[ preferenceObserver removeObserver: otherObserver forKey: @"otherKey" ];
+	[ defaults setObject: @6 forKey: @"key" ];
+	[ preferenceObserver deliverPendingChanges ];
+	XCTAssertEqual( observer2.changeCount, 2 );
+}
+
+//------------------------------------------------------------------------------
+
+- (void) testChangesAreDeliveredOnMainQueue
+{
+	PreferenceTestDefaults* defaults = [ [ PreferenceTestDefaults alloc ] init ];
+	ASTPreferenceObserver* preferenceObserver = [ [ ASTPreferenceObserver alloc ]
+			initWithStore: defaults ];
+	PreferenceTestObserver* observer = [ [ PreferenceTestObserver alloc ] init ];
+	[ preferenceObserver addObserver: observer forKey: @"key" ];
+	
+	XCTestExpectation* expectation = [ self expectationWithDescription: @"delivered" ];
+	observer.changeBlock = ^{
+		XCTAssertTrue( [ NSThread isMainThread ] );
+		[ expectation fulfill ];
+	};
+	dispatch_async( dispatch_get_global_queue( QOS_CLASS_USER_INITIATED, 0 ), ^{
+		[ defaults setObject: @"a" forKey: @"key" ];
+	} );
+	[ self waitForExpectationsWithTimeout: 10 handler: nil ];
+	
+	XCTAssertEqual( observer.changeCount, 1 );
+	XCTAssertEqualObjects( observer.lastValue, @"a" );
+	[ preferenceObserver removeObserver: observer forKey: @"key" ];
+}
+
+//------------------------------------------------------------------------------
+
+@end
+
+//------------------------------------------------------------------------------
+
+@implementation PreferenceTestDefaults {
+	NSMutableDictionary* _values;
+}
+
+//------------------------------------------------------------------------------
+
+- (instancetype) init
+{
+	self = [ super init ];
+	if( self ) {
+		_values = [ NSMutableDictionary dictionary ];
+	}
+	return self;
+}
+
+//------------------------------------------------------------------------------
+
+- (id) objectForKey: (NSString*) key
+{
+	@synchronized( self ) {
+		return _values[ key ];
+	}
+}
+
+//------------------------------------------------------------------------------
+
+- (void) setObject: (id) value forKey: (NSString*) key
+{
+	[ self willChangeValueForKey: key ];
+	@synchronized( self ) {
+		_values[ key ] = value;
+	}
+	[ self didChangeValueForKey: key ];
+}
+
+//------------------------------------------------------------------------------
+
+- (id) valueForKey: (NSString*) key
+{
+	return [ self objectForKey: key ];
+}
+
+//------------------------------------------------------------------------------
+
+@end
+
+//------------------------------------------------------------------------------
+
+@implementation PreferenceTestObserver
+
+//------------------------------------------------------------------------------
+
+- (void) preferenceValue: (id) value didChangeForKey: (NSString*) key
+{
+	++self.changeCount;
+	self.lastValue = value;
+	if( self.changeBlock ) {
+		self.changeBlock();
+	}
+}
+
+//------------------------------------------------------------------------------
+
+@end
@@ -0,0 +1,113 @@
+//==============================================================================
+//
+//  ASTPreferenceStore.h
+//
+//==============================================================================
+//
+//  Copyright (c) 2016 Adobe Systems Incorporated. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a
+//  copy of this software and associated documentation files (the "Software"),
+//  to deal in the Software without restriction, including without limitation
+//  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//  and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//
+//==============================================================================
+
+#import <Foundation/Foundation.h>
+
+
+NS_ASSUME_NONNULL_BEGIN
+
+//------------------------------------------------------------------------------
+
+/// A store of the values displayed and changed by the preference items. A store
+/// must report the changes of the value of each key with key-value observing,
+/// as NSUserDefaults does, so that the items can follow changes made by others.
+/// Stores are used on the main thread.
+@protocol ASTPreferenceStore <NSObject>
+
+/// Returns the value of the key or nil if the key has no value.
+- (nullable id) objectForKey: (NSString*) key;
+/// Sets the value of the key. A nil value removes the value of the key.
+- (void) setObject: (nullable id) value forKey: (NSString*) key;
+
+@end
+
+//------------------------------------------------------------------------------
+
+@interface NSUserDefaults( ASTPreferenceStore ) <ASTPreferenceStore>
+
+@end
+
+//------------------------------------------------------------------------------
+
+/// A preference store that keeps its values in memory, for tests or for values
+/// that are saved by the app, for example as a property list file.
+@interface ASTMemoryPreferenceStore : NSObject <ASTPreferenceStore>
+
+/// Initializes and returns an empty store.
+/// @return A new ASTMemoryPreferenceStore.
+- (instancetype) init;
+/// Initializes and returns a store with the values of a dictionary.
+/// @param dict The initial values of the store keyed by preference key.
+/// @return A new ASTMemoryPreferenceStore.
+- (instancetype) initWithDictionary: (NSDictionary*) dict NS_DESIGNATED_INITIALIZER;
+
+/// A copy of the values of the store keyed by preference key.
+@property (readonly,copy,nonatomic) NSDictionary* dictionaryRepresentation;
+
+@end
+
+//------------------------------------------------------------------------------
+
+/// A preference store that holds the values written to it and writes them to
+/// another store later. Reading a key returns the value written last, and
+/// observers of the buffered store are told about the change right away, but
+/// the other store is only written when no value was written for flushDelay
+/// seconds, when flush is called, when the app resigns active, enters the
+/// background or terminates, or when the buffered store is deallocated. This
+/// keeps rapid changes, for example from a slider, from writing the other store
+/// many times. Changes made to the other store directly are reported by the
+/// buffered store unless the key has a value that is not written yet.
+@interface ASTBufferedPreferenceStore : NSObject <ASTPreferenceStore>
+
+/// Initializes and returns a store that buffers the writes to another store.
+/// @param store The store the values are written to.
+/// @return A new ASTBufferedPreferenceStore.
+- (instancetype) initWithStore: (id<ASTPreferenceStore>) store NS_DESIGNATED_INITIALIZER;
+- (instancetype) init NS_UNAVAILABLE;
+
+/// The store the values are written to.
+@property (readonly,nonatomic) id<ASTPreferenceStore> store;
+/// The number of seconds without writes after which the values are written to
+/// the store. The default is 1.
+@property (nonatomic) NSTimeInterval flushDelay;
+/// YES if some values were not written to the store yet.
+@property (readonly,nonatomic) BOOL hasPendingWrites;
+
+/// Performs the writes made by the block as one transaction. Nothing is written
+/// to the store while the block runs, and the values written by the block are
+/// written together, flushDelay seconds after the outermost transaction ends.
+/// Transactions can be nested.
+/// @param block The block writing values.
+- (void) performTransaction: (void (^)( void )) block;
+/// Writes the values that were not written yet to the store, unless a
+/// transaction is in progress.
+- (void) flush;
+
+@end
+
+NS_ASSUME_NONNULL_END
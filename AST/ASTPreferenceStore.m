@@ -0,0 +1,341 @@
+//==============================================================================
+//
+//  ASTPreferenceStore.m
+//
+//==============================================================================
+//
+//  Copyright (c) 2016 Adobe Systems Incorporated. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a
+//  copy of this software and associated documentation files (the "Software"),
+//  to deal in the Software without restriction, including without limitation
+//  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//  and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//
+//==============================================================================
+
+#import "ASTPreferenceStore.h"
+
+#import <UIKit/UIKit.h>
+
+
+//------------------------------------------------------------------------------
+
+static void* ASTBufferedPreferenceStore_storeObservationContext = &ASTBufferedPreferenceStore_storeObservationContext;
+
+//------------------------------------------------------------------------------
+
+@implementation NSUserDefaults( ASTPreferenceStore )
+
+@end
+
+//------------------------------------------------------------------------------
+
+@implementation ASTMemoryPreferenceStore {
+	NSMutableDictionary* _values;
+}
+
+//------------------------------------------------------------------------------
+
+- (instancetype) init
+{
+	return [ self initWithDictionary: @{} ];
+}
+
+//------------------------------------------------------------------------------
+
+- (instancetype) initWithDictionary: (NSDictionary*) dict
+{
+	self = [ super init ];
+	if( self ) {
+		_values = [ dict mutableCopy ];
+	}
+	return self;
+}
+
+//------------------------------------------------------------------------------
+
+- (id) objectForKey: (NSString*) key
+{
+	return _values[ key ];
+}
+
+//------------------------------------------------------------------------------
+
+- (void) setObject: (id) value forKey: (NSString*) key
+{
+	NSParameterAssert( key );
+	
+	[ self willChangeValueForKey: key ];
+	if( value ) {
+		_values[ key ] = value;
+	} else {
+		[ _values removeObjectForKey: key ];
+	}
+	[ self didChangeValueForKey: key ];
+}
+
+//------------------------------------------------------------------------------
+
+// Key-value observing reads the values of the keys it observes with
+// valueForKey:.
+
+- (id) valueForKey: (NSString*) key
+{
+	return [ self objectForKey: key ];
+}
+
+//------------------------------------------------------------------------------
+
+- (NSDictionary*) dictionaryRepresentation
+{
+	return [ _values copy ];
+}
+
+//------------------------------------------------------------------------------
+
+@end
+
+//------------------------------------------------------------------------------
+
+@interface ASTBufferedPreferenceStore() {
+	// The values that were not written to the store yet. NSNull stands for a
+	// removed value.
+	NSMutableDictionary* _pendingValues;
+	// The keys observed by observers of the buffered store, which observes
+	// them in the store.
+	NSCountedSet* _observedKeys;
+	NSUInteger _transactionDepth;
+	// Incremented by each write so that a scheduled flush can tell if another
+	// write came after it was scheduled.
+	NSUInteger _writeGeneration;
+	BOOL _flushing;
+}
+
+@end
+
+//------------------------------------------------------------------------------
+
+@implementation ASTBufferedPreferenceStore
+
+//------------------------------------------------------------------------------
+
+- (instancetype) initWithStore: (id<ASTPreferenceStore>) store
+{
+	NSParameterAssert( store );
+	
+	self = [ super init ];
+	if( self ) {
+		_store = store;
+		_flushDelay = 1;
+		_pendingValues = [ NSMutableDictionary dictionary ];
+		_observedKeys = [ NSCountedSet set ];
+		
+		NSNotificationCenter* center = [ NSNotificationCenter defaultCenter ];
+		for( NSString* name in @[ UIApplicationWillResignActiveNotification,
+				UIApplicationDidEnterBackgroundNotification,
+				UIApplicationWillTerminateNotification ] ) {
+			[ center addObserver: self selector: @selector(applicationStateWillChange:)
+					name: name object: nil ];
+		}
+	}
+	return self;
+}
+
+//------------------------------------------------------------------------------
+
+- (void) dealloc
+{
+	[ [ NSNotificationCenter defaultCenter ] removeObserver: self ];
+	
+	_transactionDepth = 0;
+	[ self flush ];
+	for( NSString* key in _observedKeys ) {
+		[ (NSObject*)_store removeObserver: self forKeyPath: key
+				context: ASTBufferedPreferenceStore_storeObservationContext ];
+	}
+}
+
+//------------------------------------------------------------------------------
+
+- (id) objectForKey: (NSString*) key
+{
+	id value = _pendingValues[ key ];
+	if( value ) {
+		return value == [ NSNull null ] ? nil : value;
+	}
+	return [ _store objectForKey: key ];
+}
+
+//------------------------------------------------------------------------------
+
+- (void) setObject: (id) value forKey: (NSString*) key
+{
+	NSParameterAssert( key );
+	
+	[ self willChangeValueForKey: key ];
+	_pendingValues[ key ] = value ?: [ NSNull null ];
+	[ self didChangeValueForKey: key ];
+	
+	NSUInteger generation = ++_writeGeneration;
+	if( _transactionDepth ) {
+		return;
+	}
+	__weak ASTBufferedPreferenceStore* weakSelf = self;
+	dispatch_after( dispatch_time( DISPATCH_TIME_NOW, (int64_t)(_flushDelay * NSEC_PER_SEC) ),
+			dispatch_get_main_queue(), ^{
+		ASTBufferedPreferenceStore* strongSelf = weakSelf;
+		if( strongSelf && strongSelf->_writeGeneration == generation ) {
+			[ strongSelf flush ];
+		}
+	} );
+}
+
+//------------------------------------------------------------------------------
+
+- (id) valueForKey: (NSString*) key
+{
+	return [ self objectForKey: key ];
+}
+
+//------------------------------------------------------------------------------
+
+- (BOOL) hasPendingWrites
+{
+	return _pendingValues.count > 0;
+}
+
+//------------------------------------------------------------------------------
+
+- (void) performTransaction: (void (^)( void )) block
+{
+	NSParameterAssert( block );
+	
+	++_transactionDepth;
+	@try {
+		block();
+	} @finally {
+		--_transactionDepth;
+	}
+	if( _transactionDepth == 0 && _pendingValues.count ) {
+		// The writes of the transaction wait for the flush delay like a single
+		// write.
+		NSUInteger generation = ++_writeGeneration;
+		__weak ASTBufferedPreferenceStore* weakSelf = self;
+		dispatch_after( dispatch_time( DISPATCH_TIME_NOW, (int64_t)(_flushDelay * NSEC_PER_SEC) ),
+				dispatch_get_main_queue(), ^{
+			ASTBufferedPreferenceStore* strongSelf = weakSelf;
+			if( strongSelf && strongSelf->_writeGeneration == generation ) {
+				[ strongSelf flush ];
+			}
+		} );
+	}
+}
+
+//------------------------------------------------------------------------------
+
+- (void) flush
+{
+	if( _transactionDepth || _pendingValues.count == 0 ) {
+		return;
+	}
+	
+	NSDictionary* values = [ _pendingValues copy ];
+	[ _pendingValues removeAllObjects ];
+	_flushing = YES;
+	[ values enumerateKeysAndObjectsUsingBlock: ^( NSString* key, id value, BOOL* stop ) {
+		[ self->_store setObject: value == [ NSNull null ] ? nil : value forKey: key ];
+	} ];
+	_flushing = NO;
+}
+
+//------------------------------------------------------------------------------
+
+- (void) applicationStateWillChange: (NSNotification*) notification
+{
+	[ self flush ];
+}
+
+//------------------------------------------------------------------------------
+
+// The keys observed in the buffered store are observed in the store, so that
+// changes made to the store directly are reported.
+
+- (void) addObserver: (NSObject*) observer forKeyPath: (NSString*) keyPath
+		options: (NSKeyValueObservingOptions) options context: (void*) context
+{
+	[ super addObserver: observer forKeyPath: keyPath options: options context: context ];
+	if( [ _observedKeys countForObject: keyPath ] == 0 ) {
+		[ (NSObject*)_store addObserver: self forKeyPath: keyPath options: 0
+				context: ASTBufferedPreferenceStore_storeObservationContext ];
+	}
+	[ _observedKeys addObject: keyPath ];
+}
+
+//------------------------------------------------------------------------------
+
+- (void) removeObserver: (NSObject*) observer forKeyPath: (NSString*) keyPath
+		context: (void*) context
+{
+	[ super removeObserver: observer forKeyPath: keyPath context: context ];
+	[ self stopObservingKeyInStore: keyPath ];
+}
+
+//------------------------------------------------------------------------------
+
+- (void) removeObserver: (NSObject*) observer forKeyPath: (NSString*) keyPath
+{
+	[ super removeObserver: observer forKeyPath: keyPath ];
+	[ self stopObservingKeyInStore: keyPath ];
+}
+
+//------------------------------------------------------------------------------
+
+- (void) stopObservingKeyInStore: (NSString*) key
+{
+	if( [ _observedKeys countForObject: key ] == 0 ) {
+		return;
+	}
+	[ _observedKeys removeObject: key ];
+	if( [ _observedKeys countForObject: key ] == 0 ) {
+		[ (NSObject*)_store removeObserver: self forKeyPath: key
+				context: ASTBufferedPreferenceStore_storeObservationContext ];
+	}
+}
+
+//------------------------------------------------------------------------------
+
+- (void) observeValueForKeyPath: (NSString*) keyPath ofObject: (id) object
+		change: (NSDictionary*) change context: (void*) context
+{
+	if( context == ASTBufferedPreferenceStore_storeObservationContext ) {
+		// Writes of the buffered store were reported when they were made, and
+		// pending values hide the value of the store.
+		if( _flushing == NO && _pendingValues[ keyPath ] == nil ) {
+			[ self willChangeValueForKey: keyPath ];
+			[ self didChangeValueForKey: keyPath ];
+		}
+		return;
+	}
+	
+// LCOV_EXCL_START
+	[ super observeValueForKeyPath: keyPath ofObject: object
+			change: change context: context ];
+// LCOV_EXCL_STOP
+}
+
+//------------------------------------------------------------------------------
+
+@end
@@ -0,0 +1,326 @@
+//==============================================================================
+//
+//  ASTPreferenceStoreTests.m
+//
+//==============================================================================
+//
+//  Copyright (c) 2016 Adobe Systems Incorporated. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a
+//  copy of this software and associated documentation files (the "Software"),
+//  to deal in the Software without restriction, including without limitation
+//  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//  and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//
+//==============================================================================
+
+#import "ASTPreferenceStore.h"
+#import "ASTPreferenceObserver.h"
+#import "ASTMultiValuePrefItem.h"
+#import "ASTPrefSwitchItem.h"
+#import "ASTViewController.h"
+
+#import <XCTest/XCTest.h>
+
+
+//------------------------------------------------------------------------------
+
+@interface StoreTestObserver : NSObject <ASTPreferenceObserving>
+
+@property (nonatomic) NSUInteger changeCount;
+@property (nonatomic) id lastValue;
+
+@end
+
+//------------------------------------------------------------------------------
+
+@interface ASTPreferenceStoreTests : XCTestCase
+
+@end
+
+//------------------------------------------------------------------------------
+
+@implementation ASTPreferenceStoreTests
+
+//------------------------------------------------------------------------------
+
+- (void) testMemoryStore
+{
+	NSDictionary* initialValues = @{ @"key" : @1 };
+	ASTMemoryPreferenceStore* store = [ [ ASTMemoryPreferenceStore alloc ]
+			initWithDictionary: initialValues ];
+	ASTPreferenceObserver* preferenceObserver = [ [ ASTPreferenceObserver alloc ]
+			initWithStore: store ];
+	StoreTestObserver* observer = [ [ StoreTestObserver alloc ] init ];
+	[ preferenceObserver addObserver: observer forKey: @"key" ];
+	XCTAssertEqualObjects( [ store objectForKey: @"key" ], @1 );
+	
+	[ store setObject: @2 forKey: @"key" ];
+	[ preferenceObserver deliverPendingChanges ];
+	XCTAssertEqual( observer.changeCount, 1 );
+	XCTAssertEqualObjects( observer.lastValue, @2 );
+	
+	[ store setObject: nil forKey: @"key" ];
+	[ preferenceObserver deliverPendingChanges ];
+	XCTAssertEqual( observer.changeCount, 2 );
+	XCTAssertNil( observer.lastValue );
+	XCTAssertEqual( store.dictionaryRepresentation.count, 0 );
+	
+	[ preferenceObserver removeObserver: observer forKey: @"key" ];
+}
+
+//------------------------------------------------------------------------------
+
+- (void) testBufferedStoreFlush
+{
+	ASTMemoryPreferenceStore* store = [ [ ASTMemoryPreferenceStore alloc ] init ];
+	ASTBufferedPreferenceStore* bufferedStore = [ [ ASTBufferedPreferenceStore alloc ]
+			initWithStore: store ];
+	
+	[ bufferedStore setObject: @1 forKey: @"key" ];
+	[ bufferedStore setObject: @2 forKey: @"key" ];
+	[ bufferedStore setObject: @3 forKey: @"otherKey" ];
+	[ bufferedStore setObject: nil forKey: @"otherKey" ];
+	XCTAssertEqualObjects( [ bufferedStore objectForKey: @"key" ], @2 );
+	XCTAssertNil( [ bufferedStore objectForKey: @"otherKey" ] );
+	XCTAssertNil( [ store objectForKey: @"key" ] );
+	XCTAssertTrue( bufferedStore.hasPendingWrites );
+	
+	[ bufferedStore flush ];
+	XCTAssertFalse( bufferedStore.hasPendingWrites );
+	NSDictionary* expectedValues = @{ @"key" : @2 };
+	XCTAssertEqualObjects( store.dictionaryRepresentation, expectedValues );
+	
+	// The app going to the background flushes the writes.
+	[ bufferedStore setObject: @4 forKey: @"key" ];
+	[ [ NSNotificationCenter defaultCenter ]
+			postNotificationName: UIApplicationDidEnterBackgroundNotification object: nil ];
+	XCTAssertEqualObjects( [ store objectForKey: @"key" ], @4 );
+}
+
+//------------------------------------------------------------------------------
+
+- (void) testBufferedStoreWritesAfterDelay
+{
+	ASTMemoryPreferenceStore* store = [ [ ASTMemoryPreferenceStore alloc ] init ];
+	ASTBufferedPreferenceStore* bufferedStore = [ [ ASTBufferedPreferenceStore alloc ]
+			initWithStore: store ];
+	bufferedStore.flushDelay = 0.1;
+	
+	for( NSUInteger i = 0; i < 10; ++i ) {
+		[ bufferedStore setObject: @(i) forKey: @"key" ];
+	}
+	XCTAssertNil( [ store objectForKey: @"key" ] );
+	
+	XCTestExpectation* expectation = [ self expectationWithDescription: @"written" ];
+	dispatch_after( dispatch_time( DISPATCH_TIME_NOW, (int64_t)(0.5 * NSEC_PER_SEC) ),
+			dispatch_get_main_queue(), ^{
+		[ expectation fulfill ];
+	} );
+	[ self waitForExpectationsWithTimeout: 10 handler: nil ];
+	
+	XCTAssertEqualObjects( [ store objectForKey: @"key" ], @9 );
+	XCTAssertFalse( bufferedStore.hasPendingWrites );
+}
+
+//------------------------------------------------------------------------------
+
+- (void) testTransaction
+{
+	ASTMemoryPreferenceStore* store = [ [ ASTMemoryPreferenceStore alloc ] init ];
+	ASTBufferedPreferenceStore* bufferedStore = [ [ ASTBufferedPreferenceStore alloc ]
+			initWithStore: store ];
+	
+	[ bufferedStore performTransaction: ^{
+		[ bufferedStore setObject: @1 forKey: @"key" ];
+		[ bufferedStore performTransaction: ^{
+			[ bufferedStore setObject: @2 forKey: @"otherKey" ];
+		} ];
+		// Nothing is written while the transaction is in progress.
+		[ bufferedStore flush ];
+		XCTAssertEqual( store.dictionaryRepresentation.count, 0 );
+	} ];
+	
+	[ bufferedStore flush ];
+	NSDictionary* expectedValues = @{ @"key" : @1, @"otherKey" : @2 };
+	XCTAssertEqualObjects( store.dictionaryRepresentation, expectedValues );
+}
+
+//------------------------------------------------------------------------------
+
+- (void) testBufferedStoreReportsChanges
+{
+	ASTMemoryPreferenceStore* store = [ [ ASTMemoryPreferenceStore alloc ] init ];
+	ASTBufferedPreferenceStore* bufferedStore = [ [ ASTBufferedPreferenceStore alloc ]
+			initWithStore: store ];
+	ASTPreferenceObserver* preferenceObserver = [ [ ASTPreferenceObserver alloc ]
+			initWithStore: bufferedStore ];
+	StoreTestObserver* observer = [ [ StoreTestObserver alloc ] init ];
+	[ preferenceObserver addObserver: observer forKey: @"key" ];
+	
+	// Writes are reported when they are made, and not again when flushed.
+	[ bufferedStore setObject: @1 forKey: @"key" ];
+	[ preferenceObserver deliverPendingChanges ];
+	XCTAssertEqual( observer.changeCount, 1 );
+	XCTAssertEqualObjects( observer.lastValue, @1 );
+	[ bufferedStore flush ];
+	[ preferenceObserver deliverPendingChanges ];
+	XCTAssertEqual( observer.changeCount, 1 );
+	
+	// Changes made to the store directly are reported.
+	[ store setObject: @2 forKey: @"key" ];
+	[ preferenceObserver deliverPendingChanges ];
+	XCTAssertEqual( observer.changeCount, 2 );
+	XCTAssertEqualObjects( observer.lastValue, @2 );
+	
+	// Unless the key has a value that is not written yet.
+	[ bufferedStore setObject: @3 forKey: @"key" ];
+	[ store setObject: @4 forKey: @"key" ];
+	[ preferenceObserver deliverPendingChanges ];
+	XCTAssertEqual( observer.changeCount, 3 );
+	XCTAssertEqualObjects( observer.lastValue, @3 );
+	
+	[ preferenceObserver removeObserver: observer forKey: @"key" ];
+}
+
+//------------------------------------------------------------------------------
+
+- (void) testItemsUseStore
+{
+	ASTMemoryPreferenceStore* itemStore = [ [ ASTMemoryPreferenceStore alloc ]
+			initWithDictionary: @{ @"key" : @YES } ];
+	ASTPrefSwitchItem* item = [ ASTPrefSwitchItem itemWithDict: @{
+		AST_prefKey : @"key",
+		AST_prefStore : itemStore,
+	} ];
+	UISwitch* prefSwitch = (UISwitch*)item.cell.accessoryView;
+	XCTAssertEqual( prefSwitch.on, YES );
+	
+	[ itemStore setObject: @NO forKey: @"key" ];
+	[ [ ASTPreferenceObserver observerForStore: itemStore ] deliverPendingChanges ];
+	XCTAssertEqual( prefSwitch.on, NO );
+	
+	// Items without a store use the store of the table view controller.
+	ASTMemoryPreferenceStore* tableStore = [ [ ASTMemoryPreferenceStore alloc ]
+			initWithDictionary: @{ @"key" : @YES } ];
+	ASTViewController* vc = [ [ ASTViewController alloc ] initWithStyle: UITableViewStylePlain ];
+	vc.prefStore = tableStore;
+	item.prefStore = nil;
+	vc.data = @[ item ];
+	XCTAssertEqual( item.prefStore, tableStore );
+	XCTAssertEqual( prefSwitch.on, YES );
+	
+	vc.prefStore = nil;
+	XCTAssertEqual( item.prefStore, [ NSUserDefaults standardUserDefaults ] );
+}
+
+//------------------------------------------------------------------------------
+
+- (void) testStoreIsReleasedWithItems
+{
+	__weak ASTMemoryPreferenceStore* weakStore = nil;
+	__weak ASTPreferenceObserver* weakPreferenceObserver = nil;
+	@autoreleasepool {
+		ASTMemoryPreferenceStore* store = [ [ ASTMemoryPreferenceStore alloc ] init ];
+		weakStore = store;
+		NSMutableArray* items = [ NSMutableArray array ];
+		@autoreleasepool {
+			for( NSString* key in @[ @"key", @"otherKey" ] ) {
+				[ items addObject: [ ASTPrefSwitchItem itemWithDict: @{
+					AST_prefKey : key,
+					AST_prefStore : store,
+				} ] ];
+			}
+			weakPreferenceObserver = [ ASTPreferenceObserver observerForStore: store ];
+		}
+		
+		// The observer is kept while any key is observed.
+		[ items removeObjectAtIndex: 0 ];
+		XCTAssertEqual( [ ASTPreferenceObserver observerForStore: store ], weakPreferenceObserver );
+		[ items removeAllObjects ];
+	}
+	XCTAssertNil( weakPreferenceObserver );
+	XCTAssertNil( weakStore );
+}
+
+//------------------------------------------------------------------------------
+
+- (void) testItemsBuiltInBackground
+{
+	ASTMemoryPreferenceStore* tableStore = [ [ ASTMemoryPreferenceStore alloc ]
+			initWithDictionary: @{ @"key" : @YES, @"choice" : @2 } ];
+	ASTViewController* vc = [ [ ASTViewController alloc ] initWithStyle: UITableViewStylePlain ];
+	vc.prefStore = tableStore;
+	
+	NSMutableArray* data = [ NSMutableArray array ];
+	for( NSUInteger i = 0; i < 200; ++i ) {
+		[ data addObject: @{
+			AST_id : [ NSString stringWithFormat: @"switch%lu", (unsigned long)i ],
+			AST_itemClass : @"ASTPrefSwitchItem",
+			AST_prefKey : @"key",
+		} ];
+		[ data addObject: @{
+			AST_id : [ NSString stringWithFormat: @"choice%lu", (unsigned long)i ],
+			AST_itemClass : @"ASTMultiValuePrefItem",
+			AST_prefKey : @"choice",
+			AST_values : @[
+				@{ AST_title : @"One", AST_value : @1 },
+				@{ AST_title : @"Two", AST_value : @2 },
+			],
+		} ];
+	}
+	
+	XCTestExpectation* expectation = [ self expectationWithDescription: @"data set" ];
+	[ vc setDataInBackground: data completion: ^( NSError* error ) {
+		XCTAssertNil( error );
+		[ expectation fulfill ];
+	} ];
+	[ self waitForExpectationsWithTimeout: 10 handler: nil ];
+	XCTAssertEqual( vc.numberOfItems, 400 );
+	
+	// The items observe the store of the table view controller once they are
+	// in the table.
+	ASTPrefSwitchItem* item = (ASTPrefSwitchItem*)[ vc itemWithIdentifier: @"switch199" ];
+	UISwitch* prefSwitch = (UISwitch*)item.cell.accessoryView;
+	XCTAssertEqual( prefSwitch.on, YES );
+	ASTItem* choiceItem = [ vc itemWithIdentifier: @"choice0" ];
+	XCTAssertEqualObjects( choiceItem.cell.detailTextLabel.text, @"Two" );
+	
+	[ tableStore setObject: @NO forKey: @"key" ];
+	[ tableStore setObject: @1 forKey: @"choice" ];
+	[ [ ASTPreferenceObserver observerForStore: tableStore ] deliverPendingChanges ];
+	XCTAssertEqual( prefSwitch.on, NO );
+	XCTAssertEqualObjects( choiceItem.cell.detailTextLabel.text, @"One" );
+}
+
+//------------------------------------------------------------------------------
+
+@end
+
+//------------------------------------------------------------------------------
+
+@implementation StoreTestObserver
+
+//------------------------------------------------------------------------------
+
+- (void) preferenceValue: (id) value didChangeForKey: (NSString*) key
+{
+	++_changeCount;
+	_lastValue = value;
+}
+
+//------------------------------------------------------------------------------
+
+@end
@@ -0,0 +1,77 @@
+//==============================================================================
+//
+//  ASTRowHeightCache.h
+//
+//==============================================================================
+//
+//  Copyright (c) 2016 Adobe Systems Incorporated. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a
+//  copy of this software and associated documentation files (the "Software"),
+//  to deal in the Software without restriction, including without limitation
+//  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//  and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//
+//==============================================================================
+
+
+// This is private to the framework. The table view controller uses it to
+// remember the heights of rows that were laid out so that it can estimate
+// their heights accurately.
+
+#import <UIKit/UIKit.h>
+
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class ASTItem;
+
+//------------------------------------------------------------------------------
+
+@interface ASTRowHeightCache : NSObject
+
+/// Initializes a cache. If the key is not nil the heights previously saved
+/// under the key are loaded, and save writes the heights of the items with
+/// identifiers under the key.
+/// @param key A string identifying the saved heights or nil.
+- (instancetype) initWithKey: (nullable NSString*) key NS_DESIGNATED_INITIALIZER;
+- (instancetype) init;
+
+/// The key the heights are saved under or nil.
+@property (readonly,nullable,nonatomic) NSString* key;
+
+/// Selects the heights for a table width and content size category. Heights
+/// recorded for other widths and categories are kept but not returned until
+/// they are selected again.
+- (void) selectWidth: (CGFloat) width
+		contentSizeCategory: (nullable NSString*) contentSizeCategory;
+
+/// Returns the height of the row of the item or a negative number if it is
+/// not known. Items without a recorded height use the saved height for their
+/// identifier if there is one.
+- (CGFloat) heightForItem: (ASTItem*) item;
+/// Records the height of the row of the item.
+- (void) setHeight: (CGFloat) height forItem: (ASTItem*) item;
+
+/// Writes the heights of the items with identifiers under the key. Does
+/// nothing if the key is nil.
+- (void) save;
+
+/// Deletes the heights saved under the key.
++ (void) removeSavedHeightsForKey: (NSString*) key;
+
+@end
+
+NS_ASSUME_NONNULL_END
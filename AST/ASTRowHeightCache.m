@@ -0,0 +1,179 @@
+//==============================================================================
+//
+//  ASTRowHeightCache.m
+//
+//==============================================================================
+//
+//  Copyright (c) 2016 Adobe Systems Incorporated. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a
+//  copy of this software and associated documentation files (the "Software"),
+//  to deal in the Software without restriction, including without limitation
+//  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//  and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//
+//==============================================================================
+
+
+#import "ASTRowHeightCache.h"
+
+#import "ASTItem.h"
+
+
+//------------------------------------------------------------------------------
+
+static NSString* heightsKey( CGFloat width, NSString* contentSizeCategory )
+{
+	return [ NSString stringWithFormat: @"%g %@", (double)width,
+			contentSizeCategory ?: @"" ];
+}
+
+//------------------------------------------------------------------------------
+
+static NSURL* savedHeightsURL( NSString* key )
+{
+	NSURL* cachesURL = [ [ NSFileManager defaultManager ] URLsForDirectory: NSCachesDirectory
+			inDomains: NSUserDomainMask ].firstObject;
+	NSString* fileName = [ [ key stringByReplacingOccurrencesOfString: @"/" withString: @"_" ]
+			stringByAppendingPathExtension: @"plist" ];
+	return [ [ cachesURL URLByAppendingPathComponent: @"ASTRowHeights" isDirectory: YES ]
+			URLByAppendingPathComponent: fileName ];
+}
+
+//------------------------------------------------------------------------------
+
+@interface ASTRowHeightCache() {
+	// Heights by item for each width and content size category.
+	NSMutableDictionary* _heightsByKey;
+	// Heights by item identifier for each width and content size category.
+	// These are the ones that are saved.
+	NSMutableDictionary* _savedHeightsByKey;
+	
+	CGFloat _width;
+	NSString* _contentSizeCategory;
+	NSMapTable* _heights;
+	NSMutableDictionary* _savedHeights;
+}
+
+@end
+
+//------------------------------------------------------------------------------
+
+@implementation ASTRowHeightCache
+
+//------------------------------------------------------------------------------
+
+- (instancetype) init
+{
+	return [ self initWithKey: nil ];
+}
+
+//------------------------------------------------------------------------------
+
+- (instancetype) initWithKey: (NSString*) key
+{
+	self = [ super init ];
+	if( self ) {
+		_key = [ key copy ];
+		_heightsByKey = [ NSMutableDictionary dictionary ];
+		_savedHeightsByKey = [ NSMutableDictionary dictionary ];
+		_width = -1;
+		
+		if( key ) {
+			NSDictionary* saved = [ NSDictionary dictionaryWithContentsOfURL:
+					savedHeightsURL( key ) ];
+			for( NSString* savedKey in saved ) {
+				NSDictionary* heights = saved[ savedKey ];
+				if( [ heights isKindOfClass: [ NSDictionary class ] ] ) {
+					_savedHeightsByKey[ savedKey ] = [ heights mutableCopy ];
+				}
+			}
+		}
+	}
+	return self;
+}
+
+//------------------------------------------------------------------------------
+
+- (void) selectWidth: (CGFloat) width contentSizeCategory: (NSString*) contentSizeCategory
+{
+	if( width == _width && (contentSizeCategory == _contentSizeCategory
+			|| [ contentSizeCategory isEqualToString: _contentSizeCategory ]) ) {
+		return;
+	}
+	_width = width;
+	_contentSizeCategory = [ contentSizeCategory copy ];
+	
+	NSString* key = heightsKey( width, contentSizeCategory );
+	_heights = _heightsByKey[ key ];
+	if( _heights == nil ) {
+		_heights = [ NSMapTable weakToStrongObjectsMapTable ];
+		_heightsByKey[ key ] = _heights;
+	}
+	_savedHeights = _savedHeightsByKey[ key ];
+	if( _savedHeights == nil && _key ) {
+		_savedHeights = [ NSMutableDictionary dictionary ];
+		_savedHeightsByKey[ key ] = _savedHeights;
+	}
+}
+
+//------------------------------------------------------------------------------
+
+- (CGFloat) heightForItem: (ASTItem*) item
+{
+	NSNumber* height = [ _heights objectForKey: item ];
+	if( height == nil && item.identifier ) {
+		height = _savedHeights[ item.identifier ];
+	}
+	return height ? [ height doubleValue ] : -1;
+}
+
+//------------------------------------------------------------------------------
+
+- (void) setHeight: (CGFloat) height forItem: (ASTItem*) item
+{
+	NSParameterAssert( item );
+	
+	[ _heights setObject: @(height) forKey: item ];
+	if( item.identifier ) {
+		_savedHeights[ item.identifier ] = @(height);
+	}
+}
+
+//------------------------------------------------------------------------------
+
+- (void) save
+{
+	if( _key == nil ) {
+		return;
+	}
+	
+	NSURL* url = savedHeightsURL( _key );
+	[ [ NSFileManager defaultManager ] createDirectoryAtURL:
+			[ url URLByDeletingLastPathComponent ] withIntermediateDirectories: YES
+			attributes: nil error: nil ];
+	[ _savedHeightsByKey writeToURL: url atomically: YES ];
+}
+
+//------------------------------------------------------------------------------
+
++ (void) removeSavedHeightsForKey: (NSString*) key
+{
+	[ [ NSFileManager defaultManager ] removeItemAtURL: savedHeightsURL( key ) error: nil ];
+}
+
+//------------------------------------------------------------------------------
+
+@end
@@ -0,0 +1,72 @@
+//==============================================================================
+//
+//  ASTSearchIndex.h
+//
+//==============================================================================
+//
+//  Copyright (c) 2016 Adobe Systems Incorporated. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a
+//  copy of this software and associated documentation files (the "Software"),
+//  to deal in the Software without restriction, including without limitation
+//  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//  and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//
+//==============================================================================
+
+// This is private to the framework. The table view controller uses it to find
+// the items matching the filter text without comparing the text of every item.
+
+#import <Foundation/Foundation.h>
+
+
+NS_ASSUME_NONNULL_BEGIN
+
+//------------------------------------------------------------------------------
+
+@class ASTItem;
+
+//------------------------------------------------------------------------------
+
+@interface ASTSearchIndex : NSObject
+
+/// Returns the words of a string folded to lowercase without diacritics. These
+/// are the tokens of items and queries.
++ (NSArray*) tokensOfString: (nullable NSString*) string;
+
+/// The number of indexed items.
+@property (readonly,nonatomic) NSUInteger count;
+
+/// Indexes the tokens of the text, detail text and identifier of the item.
+/// Items that are already indexed are indexed again.
+- (void) addItem: (ASTItem*) item;
+/// Removes an item. Items that are not indexed are ignored.
+- (void) removeItem: (ASTItem*) item;
+/// Removes all of the items.
+- (void) removeAllItems;
+
+/// Returns the indexed items that have a token starting with each of the query
+/// tokens. The first query token is looked up with a binary search of the
+/// sorted tokens, and the items found are then checked for the other tokens.
+/// @param queryTokens An array of tokens returned by tokensOfString:.
+/// @return A set of items compared by pointer.
+- (NSHashTable*) itemsMatchingTokens: (NSArray*) queryTokens;
+/// Returns YES if the item has a token starting with each of the query tokens.
+/// Items that are not indexed do not match.
+- (BOOL) item: (ASTItem*) item matchesTokens: (NSArray*) queryTokens;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,215 @@
+//==============================================================================
+//
+//  ASTSearchIndex.m
+//
+//==============================================================================
+//
+//  Copyright (c) 2016 Adobe Systems Incorporated. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a
+//  copy of this software and associated documentation files (the "Software"),
+//  to deal in the Software without restriction, including without limitation
+//  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//  and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//
+//==============================================================================
+
+#import "ASTSearchIndex.h"
+
+#import "ASTItem.h"
+
+
+//------------------------------------------------------------------------------
+
+static BOOL tokensMatchQueryTokens( NSArray* tokens, NSArray* queryTokens )
+{
+	for( NSString* queryToken in queryTokens ) {
+		BOOL found = NO;
+		for( NSString* token in tokens ) {
+			if( [ token hasPrefix: queryToken ] ) {
+				found = YES;
+				break;
+			}
+		}
+		if( found == NO ) {
+			return NO;
+		}
+	}
+	return YES;
+}
+
+//------------------------------------------------------------------------------
+
+@interface ASTSearchIndex() {
+	// The tokens of each item.
+	NSMapTable* _tokensByItem;
+	// The items with each token, and the tokens in sorted order. The sorted
+	// tokens are only sorted again when a lookup needs them.
+	NSMutableDictionary* _itemsByToken;
+	NSMutableArray* _sortedTokens;
+	BOOL _sortedTokensAreStale;
+}
+
+@end
+
+//------------------------------------------------------------------------------
+
+@implementation ASTSearchIndex
+
+//------------------------------------------------------------------------------
+
++ (NSArray*) tokensOfString: (NSString*) string
+{
+	if( string.length == 0 ) {
+		return @[];
+	}
+	
+	NSString* foldedString = [ string stringByFoldingWithOptions:
+			NSCaseInsensitiveSearch | NSDiacriticInsensitiveSearch locale: nil ];
+	NSCharacterSet* separators = [ NSCharacterSet alphanumericCharacterSet ].invertedSet;
+	NSMutableArray* result = [ NSMutableArray array ];
+	for( NSString* word in [ foldedString componentsSeparatedByCharactersInSet: separators ] ) {
+		if( word.length ) {
+			[ result addObject: word ];
+		}
+	}
+	return result;
+}
+
+//------------------------------------------------------------------------------
+
+- (instancetype) init
+{
+	self = [ super init ];
+	if( self ) {
+		_tokensByItem = [ NSMapTable
+				mapTableWithKeyOptions: NSPointerFunctionsObjectPointerPersonality
+				valueOptions: NSPointerFunctionsStrongMemory ];
+		_itemsByToken = [ NSMutableDictionary dictionary ];
+		_sortedTokens = [ NSMutableArray array ];
+	}
+	return self;
+}
+
+//------------------------------------------------------------------------------
+
+- (NSUInteger) count
+{
+	return _tokensByItem.count;
+}
+
+//------------------------------------------------------------------------------
+
+- (void) addItem: (ASTItem*) item
+{
+	[ self removeItem: item ];
+	
+	NSMutableArray* tokens = [ NSMutableArray array ];
+	for( NSString* keyPath in @[ AST_cell_textLabel_text, AST_cell_detailTextLabel_text ] ) {
+		id text = [ item valueForKeyPath: keyPath ];
+		if( [ text isKindOfClass: [ NSString class ] ] ) {
+			[ tokens addObjectsFromArray: [ ASTSearchIndex tokensOfString: text ] ];
+		}
+	}
+	[ tokens addObjectsFromArray: [ ASTSearchIndex tokensOfString: item.identifier ] ];
+	[ _tokensByItem setObject: tokens forKey: item ];
+	
+	for( NSString* token in tokens ) {
+		NSHashTable* items = _itemsByToken[ token ];
+		if( items == nil ) {
+			items = [ NSHashTable hashTableWithOptions: NSPointerFunctionsObjectPointerPersonality ];
+			_itemsByToken[ token ] = items;
+			[ _sortedTokens addObject: token ];
+			_sortedTokensAreStale = YES;
+		}
+		[ items addObject: item ];
+	}
+}
+
+//------------------------------------------------------------------------------
+
+- (void) removeItem: (ASTItem*) item
+{
+	// The tokens of the item stay in the sorted tokens with an empty set of
+	// items, so that removing an item never needs to sort the tokens again.
+	for( NSString* token in [ _tokensByItem objectForKey: item ] ) {
+		[ _itemsByToken[ token ] removeObject: item ];
+	}
+	[ _tokensByItem removeObjectForKey: item ];
+}
+
+//------------------------------------------------------------------------------
+
+- (void) removeAllItems
+{
+	[ _tokensByItem removeAllObjects ];
+	[ _itemsByToken removeAllObjects ];
+	[ _sortedTokens removeAllObjects ];
+	_sortedTokensAreStale = NO;
+}
+
+//------------------------------------------------------------------------------
+
+- (NSHashTable*) itemsMatchingTokens: (NSArray*) queryTokens
+{
+	NSHashTable* result = [ NSHashTable
+			hashTableWithOptions: NSPointerFunctionsObjectPointerPersonality ];
+	NSString* firstToken = queryTokens.firstObject;
+	if( firstToken == nil ) {
+		for( ASTItem* item in _tokensByItem ) {
+			[ result addObject: item ];
+		}
+		return result;
+	}
+	
+	if( _sortedTokensAreStale ) {
+		[ _sortedTokens sortUsingSelector: @selector(compare:) ];
+		_sortedTokensAreStale = NO;
+	}
+	
+	// The tokens starting with the first query token follow it in sorted order.
+	NSUInteger index = [ _sortedTokens indexOfObject: firstToken
+			inSortedRange: NSMakeRange( 0, _sortedTokens.count )
+			options: NSBinarySearchingInsertionIndex | NSBinarySearchingFirstEqual
+			usingComparator: ^NSComparisonResult( NSString* token1, NSString* token2 ) {
+		return [ token1 compare: token2 ];
+	} ];
+	NSArray* otherTokens = queryTokens.count > 1
+			? [ queryTokens subarrayWithRange: NSMakeRange( 1, queryTokens.count - 1 ) ] : nil;
+	for( ; index < _sortedTokens.count; ++index ) {
+		NSString* token = _sortedTokens[ index ];
+		if( [ token hasPrefix: firstToken ] == NO ) {
+			break;
+		}
+		for( ASTItem* item in _itemsByToken[ token ] ) {
+			if( otherTokens == nil || [ self item: item matchesTokens: otherTokens ] ) {
+				[ result addObject: item ];
+			}
+		}
+	}
+	return result;
+}
+
+//------------------------------------------------------------------------------
+
+- (BOOL) item: (ASTItem*) item matchesTokens: (NSArray*) queryTokens
+{
+	NSArray* tokens = [ _tokensByItem objectForKey: item ];
+	return tokens != nil && tokensMatchQueryTokens( tokens, queryTokens );
+}
+
+//------------------------------------------------------------------------------
+
+@end
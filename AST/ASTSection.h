@@ -38,6 +38,13 @@ extern NSString* const AST_footerText;
 extern NSString* const AST_headerView;
 extern NSString* const AST_footerView;
 extern NSString* const AST_items;
+extern NSString* const AST_lazyItems;
+
+//------------------------------------------------------------------------------
+
+/// Returns the item at an index of a section with lazy items, or a dictionary
+/// describing it. Called on the main thread.
+typedef id __nonnull (^ASTItemProvider)( NSUInteger index );
 
 //------------------------------------------------------------------------------
 
@@ -67,6 +74,13 @@ extern NSString* const AST_items;
 /// @param dict The dictionary of configuration parameters for the section.
 /// @return A new ASTSection.
 + (instancetype) sectionWithDict: (NSDictionary*) dict;
+/// Creates and returns an ASTSection with lazy items built by a provider. See
+/// setNumberOfItems:itemProvider:.
+/// @param numberOfItems The number of items in the section.
+/// @param itemProvider The block building the item at an index.
+/// @return A new ASTSection.
++ (instancetype) sectionWithNumberOfItems: (NSUInteger) numberOfItems
+		itemProvider: (ASTItemProvider) itemProvider;
 
 /// Initializes and returns an ASTSection.
 /// @return A new ASTSection.
@@ -95,9 +109,12 @@ extern NSString* const AST_items;
 @property (nullable,nonatomic) NSString* headerText;
 /// The text to be displayed in the footer.
 @property (nullable,nonatomic) NSString* footerText;
-/// The view to be used as the header view.
+/// The view to be used as the header view. The height of the view is measured
+/// once for each table width and content size category, so set the view again
+/// after changing what it displays.
 @property (nullable,nonatomic) UIView* headerView;
-/// The view to be used as the footer view.
+/// The view to be used as the footer view. Its height is cached like the height
+/// of the header view.
 @property (nullable,nonatomic) UIView* footerView;
 
 // Containment
@@ -112,15 +129,60 @@ extern NSString* const AST_items;
 /// Removes the section from its container using the specified row animation.
 - (void) removeFromContainerWithRowAnimation: (UITableViewRowAnimation) animation;
 
-/// Returns a copy of the sections items.
+/// Returns a copy of the sections items, building all lazy items. Setting the items reloads the table
+/// view unless the table view controller animates data changes, in which case
+/// the items are set with setItems:withRowAnimation:. Either way dictionaries
+/// reuse the items of the section as setItems:withRowAnimation: describes.
 @property (copy,nonatomic) NSArray* items;
+/// Replaces the items and updates the rows of the section with one batch
+/// update. Items match when they are the same object or have the same
+/// identifier. Unmatched items are deleted or inserted, matched ones are moved
+/// if their order changed, and matched ones that are different objects are
+/// reloaded. A dictionary with the identifier of an item in the section reuses
+/// the item if updateWithDict: accepts it. A section with lazy items is
+/// reloaded instead, because comparing the items would build all of them.
+/// @param items An array of ASTItem objects or dictionaries describing them.
+/// @param animation A constant that either specifies the kind of animation to
+/// perform when updating the rows or requests no animation.
+- (void) setItems: (NSArray*) items withRowAnimation: (UITableViewRowAnimation) animation;
 /// The number of items in the section.
 @property (readonly,nonatomic) NSUInteger numberOfItems;
 
+// Lazy Items
+
+/// Replaces the items with items that are built from the dictionaries in the
+/// array when they are first needed, usually when their rows are displayed.
+/// ASTItem objects in the array are used as they are. This can also be set with
+/// the AST_lazyItems key. Getting the items property builds all of them.
+/// Items about to be displayed are built on a background queue when the table
+/// view prefetches their rows.
+/// @param items An array of dictionaries describing items or ASTItem objects.
+- (void) setLazyItems: (NSArray*) items;
+/// Replaces the items with numberOfItems items that are built by calling the
+/// provider with their index when they are first needed. Items inserted,
+/// removed or moved later do not change the index the provider is called with
+/// for the other items. Finding an item by identifier or represented object
+/// builds the items that are searched.
+/// @param numberOfItems The number of items in the section.
+/// @param itemProvider The block building the item at an index.
+- (void) setNumberOfItems: (NSUInteger) numberOfItems
+		itemProvider: (ASTItemProvider) itemProvider;
+/// The number of lazy items that are kept after they are built. Built items
+/// over the limit whose cells are not loaded are discarded, oldest first, and
+/// built again when needed, so changes made to them are lost. Items that were
+/// not lazy are never discarded. The default is 1000.
+@property (nonatomic) NSUInteger maximumNumberOfBuiltItems;
+
 /// Returns the item at the specified index or nil if the index is invalid.
 /// @param index An index number identifying an item of section.
 /// @return The item at the index or nil if the index is invalid.
 - (ASTItem* __nullable) itemAtIndex: (NSUInteger) index;
+/// Returns the index of the item in the section or NSNotFound if the item is
+/// not in the section. This does not search the section unless it has changed
+/// since the last lookup.
+/// @param item An item to find in the section.
+/// @return The index of the item or NSNotFound.
+- (NSUInteger) indexOfItem: (ASTItem*) item;
 /// Returns the first item with the identifier or nil if there is no
 /// item with the identifier.
 /// @param identifier A string identifying the item to return.
@@ -128,7 +190,8 @@ extern NSString* const AST_items;
 /// if no matching item is found.
 - (ASTItem* __nullable) itemWithIdentifier: (NSString*) identifier;
 /// Returns the first item with a representedObject that matches the parameter.
-/// The objects are compared with isEqual:. The parameter may be nil.
+/// The objects are compared with isEqual: and hash, so the hash of a represented
+/// object must not change while its item is in use. The parameter may be nil.
 /// @param representedObject An object to compare to the representedObject of
 /// each of the items. May be nil.
 /// @return The first item with a represented object matching the parameter or
@@ -143,6 +206,15 @@ extern NSString* const AST_items;
 /// perform when inserting the items or requests no animation.
 - (void) insertItems: (NSArray*) items atIndexes: (NSArray*) indexes
 		withRowAnimation: (UITableViewRowAnimation) animation;
+/// Inserts items in the section so that they end up at the indexes of the index
+/// set, with an option to animate the insertion. The items are spliced in with
+/// one pass over the existing items.
+/// @param items An array of ASTItem objects in the order of the indexes.
+/// @param indexes The indexes of the items after the insertion.
+/// @param animation A constant that either specifies the kind of animation to
+/// perform when inserting the items or requests no animation.
+- (void) insertItems: (NSArray*) items atIndexSet: (NSIndexSet*) indexes
+		withRowAnimation: (UITableViewRowAnimation) animation;
 /// Removes the items specified by an array of indexes, with an option to
 /// animate the removal.
 /// @param indexes An array of NSNumber objects.
@@ -150,6 +222,13 @@ extern NSString* const AST_items;
 /// perform when removing the items or requests no animation.
 - (void) removeItemsAtIndexes: (NSArray*) indexes
 		withRowAnimation: (UITableViewRowAnimation) animation;
+/// Removes the items at the indexes of the index set with one pass over the
+/// items, with an option to animate the removal.
+/// @param indexes The indexes of the items to remove.
+/// @param animation A constant that either specifies the kind of animation to
+/// perform when removing the items or requests no animation.
+- (void) removeItemsAtIndexSet: (NSIndexSet*) indexes
+		withRowAnimation: (UITableViewRowAnimation) animation;
 /// Moves an item from one location to another within the section.
 /// @param index An index identifying the item to move.
 /// @param newIndex An index identifying the item that is the destination of the
@@ -31,8 +31,68 @@
 
 #import "ASTItemSubclass.h"
 #import "ASTViewController.h"
+#import "ASTTableViewUpdate.h"
+#import "ASTPerformanceSpan.h"
 
 
+//------------------------------------------------------------------------------
+
+static ASTItem* itemFromValue( id itemValue )
+{
+	ASTItem* item = nil;
+	
+	if( [ itemValue isKindOfClass: [ ASTItem class ] ] ) {
+		item = itemValue;
+	} else if( [ itemValue isKindOfClass: [ NSDictionary class ] ] ) {
+		item = [ ASTItem itemWithDict: itemValue ];
+	} else if( [ itemValue isKindOfClass: [ NSNull class ] ] ) {
+		// It's null, skip it.
+	} else {
+		[ NSException raise: @"ASTSection unexpected item"
+				format: @"An item with an unexpected type was encountered: %@",
+				itemValue ];
+	}
+	
+	return item;
+}
+
+//------------------------------------------------------------------------------
+
+static NSArray* itemsFromValues( NSArray* itemValues )
+{
+	NSMutableArray* result = [ NSMutableArray arrayWithCapacity: itemValues.count ];
+	for( id itemValue in itemValues ) {
+		ASTItem* item = itemFromValue( itemValue );
+		if( item ) {
+			[ result addObject: item ];
+		}
+	}
+	return result;
+}
+
+//------------------------------------------------------------------------------
+
+// Replaces each dictionary describing one of the items with that item, updated
+// in place, so that it keeps its cell.
+
+static NSArray* itemValuesReusingItems( NSArray* itemValues, NSArray* items )
+{
+	if( items.count == 0 ) {
+		return itemValues;
+	}
+	
+	NSMutableDictionary* itemsByIdentifier = [ NSMutableDictionary dictionary ];
+	addItemsByIdentifier( items, itemsByIdentifier );
+	return reuseItemsForItemValues( itemValues, itemsByIdentifier );
+}
+
+//------------------------------------------------------------------------------
+
+static inline BOOL isItem( id itemOrPlaceholder )
+{
+	return [ itemOrPlaceholder isKindOfClass: [ ASTItem class ] ];
+}
+
 //------------------------------------------------------------------------------
 
 @implementation ASTSection
@@ -69,6 +129,16 @@
 
 //------------------------------------------------------------------------------
 
++ (instancetype) sectionWithNumberOfItems: (NSUInteger) numberOfItems
+		itemProvider: (ASTItemProvider) itemProvider
+{
+	ASTSection* result = [ [ ASTSection alloc ] init ];
+	[ result setNumberOfItems: numberOfItems itemProvider: itemProvider ];
+	return result;
+}
+
+//------------------------------------------------------------------------------
+
 - (instancetype) init
 {
 	self = [ self initWithDict: @{} ];
@@ -107,6 +177,10 @@
 	self = [ super init ];
 	if( self ) {
 		_items = [ NSMutableArray array ];
+		_maximumNumberOfBuiltItems = 1000;
+		_identifierIndex = [ [ ASTObjectIndex alloc ] initWithKey: @"identifier" ];
+		_representedObjectIndex = [ [ ASTObjectIndex alloc ]
+				initWithKey: @"representedObject" ];
 		[ self setupSectionWithDict: dict ];
 	}
 	return self;
@@ -124,6 +198,11 @@
 	self.footerView = dict[ AST_footerView ];
 	
 	self.items = dict[ AST_items ];
+	
+	NSArray* lazyItems = dict[ AST_lazyItems ];
+	if( lazyItems ) {
+		[ self setLazyItems: lazyItems ];
+	}
 }
 
 //------------------------------------------------------------------------------
@@ -149,18 +228,54 @@
 - (ASTItem*) itemAtIndex: (NSUInteger) index
 {
 	if( index < _items.count ) {
-		return _items[ index ];
+		id itemOrPlaceholder = _items[ index ];
+		if( _placeholdersOfBuiltItems && isItem( itemOrPlaceholder ) == NO ) {
+			return [ self buildItemAtIndex: index ];
+		}
+		return itemOrPlaceholder;
+	}
+	return nil;
+}
+
+//------------------------------------------------------------------------------
+
+- (ASTItem*) builtItemAtIndex: (NSUInteger) index
+{
+	if( index < _items.count ) {
+		id itemOrPlaceholder = _items[ index ];
+		if( isItem( itemOrPlaceholder ) ) {
+			return itemOrPlaceholder;
+		}
 	}
 	return nil;
 }
 
 //------------------------------------------------------------------------------
 
+- (NSUInteger) indexOfItem: (ASTItem*) item
+{
+	if( item == nil || item.section != self ) {
+		return NSNotFound;
+	}
+	return containerIndexOfObject( _items, item, &_firstStaleItemIndex );
+}
+
+//------------------------------------------------------------------------------
+
 - (ASTItem*) itemWithIdentifier: (NSString*) identifier
 {
+	if( _placeholdersOfBuiltItems ) {
+		return [ self lazyItemWithValue: identifier forKey: @"identifier"
+				dictKey: AST_id ];
+	}
+	
+	if( identifier ) {
+		return [ _identifierIndex firstObjectWithValue: identifier
+				inContainer: _items firstStaleIndex: &_firstStaleItemIndex ];
+	}
+	
 	for( ASTItem* item in _items ) {
-		if( item.identifier == identifier
-				|| [ item.identifier isEqualToString: identifier ] ) {
+		if( item.identifier == nil ) {
 			return item;
 		}
 	}
@@ -172,9 +287,46 @@
 
 - (ASTItem*) itemWithRepresentedObject: (id) representedObject
 {
+	if( _placeholdersOfBuiltItems ) {
+		return [ self lazyItemWithValue: representedObject forKey: @"representedObject"
+				dictKey: AST_representedObject ];
+	}
+	
+	if( representedObject ) {
+		return [ _representedObjectIndex firstObjectWithValue: representedObject
+				inContainer: _items firstStaleIndex: &_firstStaleItemIndex ];
+	}
+	
 	for( ASTItem* item in _items ) {
-		if( [ item.representedObject isEqual: representedObject ]
-				|| (representedObject == nil && item.representedObject == nil ) ) {
+		if( item.representedObject == nil ) {
+			return item;
+		}
+	}
+	
+	return nil;
+}
+
+//------------------------------------------------------------------------------
+
+// The object indexes are not used for lazy items because they would build all
+// of them. Dictionaries are searched without building their items.
+
+- (ASTItem*) lazyItemWithValue: (id) value forKey: (NSString*) key
+		dictKey: (NSString*) dictKey
+{
+	for( NSUInteger i = 0; i < _items.count; ++i ) {
+		id itemOrPlaceholder = _items[ i ];
+		if( [ itemOrPlaceholder isKindOfClass: [ NSDictionary class ] ] ) {
+			id dictValue = itemOrPlaceholder[ dictKey ];
+			if( dictValue == value || [ dictValue isEqual: value ] ) {
+				return [ self itemAtIndex: i ];
+			}
+			continue;
+		}
+		
+		ASTItem* item = [ self itemAtIndex: i ];
+		id itemValue = [ item valueForKey: key ];
+		if( itemValue == value || [ itemValue isEqual: value ] ) {
 			return item;
 		}
 	}
@@ -184,19 +336,43 @@
 
 //------------------------------------------------------------------------------
 
+- (void) indexedObject: (id) object didChangeValueForKey: (NSString*) key
+		fromValue: (id) oldValue
+{
+	if( [ key isEqualToString: _identifierIndex.key ] ) {
+		[ _identifierIndex object: object didChangeValueFrom: oldValue ];
+	} else if( [ key isEqualToString: _representedObjectIndex.key ] ) {
+		[ _representedObjectIndex object: object didChangeValueFrom: oldValue ];
+	}
+}
+
+//------------------------------------------------------------------------------
+
 - (void) insertItemReferences: (NSArray*) items atIndexes: (NSArray*) indexes
 {
 	NSParameterAssert( items.count == indexes.count );
-	NSArray* sortedIndexes = sortIndexesOfArray( indexes,
-			@"unsignedIntegerValue", SortDescending );
 	
-	for( NSNumber* indexValue in sortedIndexes ) {
-		NSUInteger index = [ indexValue unsignedIntegerValue ];
-		ASTItem* sortedItem = items[ index ];
-		NSUInteger sortedIndex = [ indexes[ index ] unsignedIntegerValue ];
-		[ _items insertObject: sortedItem atIndex: sortedIndex ];
-		sortedItem.tableViewController = self.tableViewController;
-		sortedItem.section = self;
+	NSArray* sortedItems = nil;
+	NSIndexSet* indexSet = indexSetFromIndexes( indexes, items, &sortedItems );
+	[ self insertItemReferences: sortedItems atIndexSet: indexSet ];
+}
+
+//------------------------------------------------------------------------------
+
+- (void) insertItemReferences: (NSArray*) items atIndexSet: (NSIndexSet*) indexes
+{
+	NSParameterAssert( items.count == indexes.count );
+	if( indexes.count == 0 ) {
+		return;
+	}
+	
+	insertObjectsAtIndexSet( _items, items, indexes );
+	_firstStaleItemIndex = MIN( _firstStaleItemIndex, indexes.firstIndex );
+	for( ASTItem* item in items ) {
+		[ _identifierIndex addObject: item ];
+		[ _representedObjectIndex addObject: item ];
+		item.tableViewController = self.tableViewController;
+		item.section = self;
 	}
 }
 
@@ -204,11 +380,27 @@
 
 - (void) removeItemReferencesAtIndexes: (NSArray*) indexes
 {
-	NSArray* sortedIndexes = sortArray( indexes, @"unsignedIntegerValue", NO );
-	for( NSNumber* indexValue in sortedIndexes ) {
-		NSUInteger index = [ indexValue unsignedIntegerValue ];
-		ASTItem* item = _items[ index ];
-		[ _items removeObjectAtIndex: index ];
+	[ self removeItemReferencesAtIndexSet: indexSetFromIndexes( indexes, nil, NULL ) ];
+}
+
+//------------------------------------------------------------------------------
+
+- (void) removeItemReferencesAtIndexSet: (NSIndexSet*) indexes
+{
+	if( indexes.count == 0 ) {
+		return;
+	}
+	
+	NSArray* removedItems = [ _items objectsAtIndexes: indexes ];
+	removeObjectsAtIndexSet( _items, indexes );
+	_firstStaleItemIndex = MIN( _firstStaleItemIndex, indexes.firstIndex );
+	for( ASTItem* item in removedItems ) {
+		if( isItem( item ) == NO ) {
+			continue;
+		}
+		[ _placeholdersOfBuiltItems removeObjectForKey: item ];
+		[ _identifierIndex removeObject: item ];
+		[ _representedObjectIndex removeObject: item ];
 		item.tableViewController = nil;
 		item.section = nil;
 	}
@@ -221,6 +413,7 @@
 	ASTItem* item = _items[ index ];
 	[ _items removeObjectAtIndex: index ];
 	[ _items insertObject: item atIndex: newIndex ];
+	_firstStaleItemIndex = MIN( _firstStaleItemIndex, MIN( index, newIndex ) );
 }
 
 //------------------------------------------------------------------------------
@@ -228,11 +421,24 @@
 - (void) insertItems: (NSArray*) items atIndexes: (NSArray*) indexes
 		withRowAnimation: (UITableViewRowAnimation) animation
 {
-	UITableView* tableView = self.tableViewController.tableView;
+	NSParameterAssert( items.count == indexes.count );
 	
-	[ self insertItemReferences: items atIndexes: indexes ];
+	NSArray* sortedItems = nil;
+	NSIndexSet* indexSet = indexSetFromIndexes( indexes, items, &sortedItems );
+	[ self insertItems: sortedItems atIndexSet: indexSet withRowAnimation: animation ];
+}
+
+//------------------------------------------------------------------------------
+
+- (void) insertItems: (NSArray*) items atIndexSet: (NSIndexSet*) indexes
+		withRowAnimation: (UITableViewRowAnimation) animation
+{
+	UITableView* tableView = _tableViewController.tableViewForUpdates;
 	
-	[ tableView insertRowsAtIndexPaths: [ self indexPathsWithIndexes: indexes ]
+	[ _tableViewController recordBatchChangeOfSection: self ];
+	[ self insertItemReferences: items atIndexSet: indexes ];
+	
+	[ tableView insertRowsAtIndexPaths: [ self indexPathsWithIndexSet: indexes ]
 			withRowAnimation: animation ];
 }
 
@@ -241,11 +447,21 @@
 - (void) removeItemsAtIndexes: (NSArray*) indexes
 		withRowAnimation: (UITableViewRowAnimation) animation
 {
-	UITableView* tableView = self.tableViewController.tableView;
+	[ self removeItemsAtIndexSet: indexSetFromIndexes( indexes, nil, NULL )
+			withRowAnimation: animation ];
+}
+
+//------------------------------------------------------------------------------
+
+- (void) removeItemsAtIndexSet: (NSIndexSet*) indexes
+		withRowAnimation: (UITableViewRowAnimation) animation
+{
+	UITableView* tableView = _tableViewController.tableViewForUpdates;
 	
-	[ self removeItemReferencesAtIndexes: indexes ];
+	[ _tableViewController recordBatchChangeOfSection: self ];
+	[ self removeItemReferencesAtIndexSet: indexes ];
 	
-	[ tableView deleteRowsAtIndexPaths: [ self indexPathsWithIndexes: indexes ]
+	[ tableView deleteRowsAtIndexPaths: [ self indexPathsWithIndexSet: indexes ]
 			withRowAnimation: animation ];
 }
 
@@ -253,10 +469,11 @@
 
 - (void) moveItemAtIndex: (NSUInteger) index toIndex: (NSUInteger) newIndex
 {
-	UITableView* tableView = self.tableViewController.tableView;
+	UITableView* tableView = _tableViewController.tableViewForUpdates;
 	
 	NSIndexPath* indexPath = [ NSIndexPath indexPathForRow: index inSection: self.index ];
 	
+	[ _tableViewController recordBatchChangeOfSection: self ];
 	[ self moveItemReferenceAtIndex: index toIndex: newIndex ];
 	
 	NSIndexPath* newIndexPath = [ NSIndexPath indexPathForRow: newIndex inSection: self.index ];
@@ -267,44 +484,336 @@
 
 - (void) setItems: (NSArray*) items
 {
-	// Remove existing items
+	if( _tableViewController.animatesDataChanges || _tableViewController.batchingUpdates ) {
+		[ self setItems: items withRowAnimation: UITableViewRowAnimationAutomatic ];
+		return;
+	}
+	
+	ASTPerformanceSpan span = ASTPerformanceSpanBegin( _tableViewController.performanceMetrics );
+	NSArray* itemValues = _items.count ? itemValuesReusingItems( items, self.builtItems ) : items;
+	[ self replaceItemReferences: itemsFromValues( itemValues ) ];
+
+	UITableView* tableView = _tableViewController.tableViewForUpdates;
+	[ tableView reloadData ];
+	ASTPerformanceSpanEnd( span, ASTPerformanceOperationSetItems, nil );
+}
+
+//------------------------------------------------------------------------------
+
+- (void) setItems: (NSArray*) items withRowAnimation: (UITableViewRowAnimation) animation
+{
+	ASTPerformanceSpan span = ASTPerformanceSpanBegin( _tableViewController.performanceMetrics );
+	NSArray* oldItems = self.builtItems;
+	NSArray* newItems = itemsFromValues( itemValuesReusingItems( items, oldItems ) );
+	
+	NSUInteger index = self.index;
+	UITableView* tableView = index != NSNotFound ? _tableViewController.tableViewForUpdates : nil;
+	
+	[ _tableViewController recordBatchChangeOfSection: self ];
+	if( _placeholdersOfBuiltItems ) {
+		[ self replaceItemReferences: newItems ];
+		[ tableView reloadSections: [ NSIndexSet indexSetWithIndex: index ]
+				withRowAnimation: animation ];
+		ASTPerformanceSpanEnd( span, ASTPerformanceOperationSetItems, nil );
+		return;
+	}
+	
+	ASTTableViewUpdate* update = [ [ ASTTableViewUpdate alloc ] init ];
+	[ update addRowsOfDiff: [ ASTDiff diffFromObjects: oldItems toObjects: newItems ]
+			oldItems: oldItems newItems: newItems section: index newSection: index ];
+	
+	[ tableView beginUpdates ];
+	[ self replaceItemReferences: newItems ];
+	[ update applyToTableView: tableView withRowAnimation: animation ];
+	[ tableView endUpdates ];
+	ASTPerformanceSpanEnd( span, ASTPerformanceOperationSetItems, nil );
+}
+
+//------------------------------------------------------------------------------
+
+- (void) replaceItemReferences: (NSArray*) items
+{
+	// Only the items that leave the section are detached.
+	NSHashTable* keptItems = [ NSHashTable
+			hashTableWithOptions: NSPointerFunctionsObjectPointerPersonality ];
+	for( ASTItem* item in items ) {
+		[ keptItems addObject: item ];
+	}
 	for( ASTItem* item in _items ) {
-		item.tableViewController = nil;
-		item.section = nil;
+		if( isItem( item ) && [ keptItems containsObject: item ] == NO ) {
+			item.tableViewController = nil;
+			item.section = nil;
+		}
 	}
-	[ _items removeAllObjects ];
 	
+	[ _items setArray: items ];
+	_firstStaleItemIndex = 0;
+	[ _identifierIndex invalidate ];
+	[ _representedObjectIndex invalidate ];
+	_itemProvider = nil;
+	_builtLazyItems = nil;
+	_placeholdersOfBuiltItems = nil;
+	_placeholdersBuildingInBackground = nil;
+	
+	for( ASTItem* item in items ) {
+		if( isItem( item ) ) {
+			item.tableViewController = self.tableViewController;
+			item.section = self;
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+
+- (NSArray*) items
+{
+	if( _placeholdersOfBuiltItems == nil ) {
+		return [ _items copy ];
+	}
+	
+	// Nothing is discarded until all items are built, so that the result only
+	// has items of the section.
+	NSUInteger maximumNumberOfBuiltItems = _maximumNumberOfBuiltItems;
+	_maximumNumberOfBuiltItems = NSUIntegerMax;
+	NSMutableArray* result = [ NSMutableArray arrayWithCapacity: _items.count ];
+	for( NSUInteger i = 0; i < _items.count; ++i ) {
+		[ result addObject: [ self itemAtIndex: i ] ];
+	}
+	_maximumNumberOfBuiltItems = maximumNumberOfBuiltItems;
+	[ self discardBuiltItemsOverLimit: maximumNumberOfBuiltItems ];
+	return result;
+}
+
+//------------------------------------------------------------------------------
+
+- (NSArray*) builtItems
+{
+	if( _placeholdersOfBuiltItems == nil ) {
+		return [ _items copy ];
+	}
+	
+	NSMutableArray* result = [ NSMutableArray array ];
+	for( id itemOrPlaceholder in _items ) {
+		if( isItem( itemOrPlaceholder ) ) {
+			[ result addObject: itemOrPlaceholder ];
+		}
+	}
+	return result;
+}
+
+//------------------------------------------------------------------------------
+
+- (BOOL) hasLazyItems
+{
+	return _placeholdersOfBuiltItems != nil;
+}
+
+//------------------------------------------------------------------------------
+
+- (void) setLazyItems: (NSArray*) items
+{
+	NSMutableArray* itemsAndPlaceholders = [ NSMutableArray arrayWithCapacity: items.count ];
 	for( id itemValue in items ) {
-		ASTItem* item = nil;
-		
-		if( [ itemValue isKindOfClass: [ ASTItem class ] ] ) {
-			item = itemValue;
-		} else if( [ itemValue isKindOfClass: [ NSDictionary class ] ] ) {
-			item = [ ASTItem itemWithDict: itemValue ];
-		} else if( [ itemValue isKindOfClass: [ NSNull class ] ] ) {
-			// It's null, skip it.
-		} else {
+		if( isItem( itemValue ) || [ itemValue isKindOfClass: [ NSDictionary class ] ] ) {
+			[ itemsAndPlaceholders addObject: itemValue ];
+		} else if( [ itemValue isKindOfClass: [ NSNull class ] ] == NO ) {
 			[ NSException raise: @"ASTSection unexpected item"
 					format: @"An item with an unexpected type was encountered: %@",
 					itemValue ];
 		}
+	}
+	
+	[ self replaceWithLazyItems: itemsAndPlaceholders itemProvider: nil ];
+}
+
+//------------------------------------------------------------------------------
+
+- (void) setNumberOfItems: (NSUInteger) numberOfItems
+		itemProvider: (ASTItemProvider) itemProvider
+{
+	NSParameterAssert( itemProvider );
+	
+	// Small NSNumber objects are tagged pointers, so the placeholders do not
+	// allocate memory.
+	NSMutableArray* placeholders = [ NSMutableArray arrayWithCapacity: numberOfItems ];
+	for( NSUInteger i = 0; i < numberOfItems; ++i ) {
+		[ placeholders addObject: @(i) ];
+	}
+	
+	[ self replaceWithLazyItems: placeholders itemProvider: itemProvider ];
+}
+
+//------------------------------------------------------------------------------
+
+- (void) replaceWithLazyItems: (NSArray*) itemsAndPlaceholders
+		itemProvider: (ASTItemProvider) itemProvider
+{
+	[ _tableViewController recordBatchChangeOfSection: self ];
+	[ self replaceItemReferences: itemsAndPlaceholders ];
+	_itemProvider = [ itemProvider copy ];
+	_builtLazyItems = [ NSMutableArray array ];
+	// Equal dictionaries are different placeholders.
+	_placeholdersOfBuiltItems = [ [ NSMapTable alloc ]
+			initWithKeyOptions: NSPointerFunctionsStrongMemory
+					| NSPointerFunctionsObjectPointerPersonality
+			valueOptions: NSPointerFunctionsStrongMemory capacity: 0 ];
+	
+	UITableView* tableView = _tableViewController.tableViewForUpdates;
+	[ tableView reloadData ];
+}
+
+//------------------------------------------------------------------------------
+
+- (ASTItem*) buildItemAtIndex: (NSUInteger) index
+{
+	id placeholder = _items[ index ];
+	id itemValue = [ placeholder isKindOfClass: [ NSNumber class ] ]
+			? _itemProvider( [ placeholder unsignedIntegerValue ] ) : placeholder;
+	ASTItem* item = itemFromValue( itemValue );
+	NSAssert( item != nil, @"No item for index %lu", (unsigned long)index );
+	
+	[ self addBuiltItem: item atIndex: index ];
+	return item;
+}
+
+//------------------------------------------------------------------------------
+
+// Replaces the placeholder at the index with the item built from it.
+
+- (void) addBuiltItem: (ASTItem*) item atIndex: (NSUInteger) index
+{
+	id placeholder = _items[ index ];
+	[ _placeholdersBuildingInBackground removeObject: placeholder ];
+	
+	// Room is made before the item is added, so that it is not discarded
+	// before it is used.
+	[ self discardBuiltItemsOverLimit: _maximumNumberOfBuiltItems > 0
+			? _maximumNumberOfBuiltItems - 1 : 0 ];
+	
+	_items[ index ] = item;
+	item.containerIndex = index;
+	[ _builtLazyItems addObject: item ];
+	[ _placeholdersOfBuiltItems setObject: placeholder forKey: item ];
+	item.tableViewController = self.tableViewController;
+	item.section = self;
+}
+
+//------------------------------------------------------------------------------
+
+- (void) buildItemInBackgroundAtIndex: (NSUInteger) index
+		completion: (void (^)( ASTItem* item )) completion
+{
+	NSParameterAssert( completion );
+	
+	if( index >= _items.count ) {
+		return;
+	}
+	id placeholder = _items[ index ];
+	if( [ placeholder isKindOfClass: [ NSDictionary class ] ] == NO ) {
+		completion( [ self itemAtIndex: index ] );
+		return;
+	}
+	if( [ _placeholdersBuildingInBackground containsObject: placeholder ] ) {
+		return;
+	}
+	
+	if( _placeholdersBuildingInBackground == nil ) {
+		// Equal dictionaries are different placeholders.
+		_placeholdersBuildingInBackground = [ NSHashTable
+				hashTableWithOptions: NSPointerFunctionsObjectPointerPersonality ];
+	}
+	[ _placeholdersBuildingInBackground addObject: placeholder ];
+	
+	__weak ASTSection* weakSelf = self;
+	dispatch_async( dispatch_get_global_queue( QOS_CLASS_USER_INITIATED, 0 ), ^{
+		// A dictionary that can not be built is left to the main thread, which
+		// reports it when the row is displayed.
+		ASTItem* item = nil;
+		@try {
+			item = [ ASTItem itemWithDict: placeholder ];
+		} @catch( NSException* exception ) {
+		}
 		
-		if( item ) {
-			[ _items addObject: item ];
-			item.tableViewController = self.tableViewController;
-			item.section = self;
+		dispatch_async( dispatch_get_main_queue(), ^{
+			ASTSection* strongSelf = weakSelf;
+			if( strongSelf == nil || [ strongSelf->_placeholdersBuildingInBackground
+					containsObject: placeholder ] == NO ) {
+				return;
+			}
+			[ strongSelf->_placeholdersBuildingInBackground removeObject: placeholder ];
+			
+			// Rows may have moved while the item was built.
+			NSMutableArray* items = strongSelf->_items;
+			NSUInteger placeholderIndex = index < items.count && items[ index ] == placeholder
+					? index : [ items indexOfObjectIdenticalTo: placeholder ];
+			if( item == nil || placeholderIndex == NSNotFound ) {
+				return;
+			}
+			[ strongSelf addBuiltItem: item atIndex: placeholderIndex ];
+			completion( item );
+		} );
+	} );
+}
+
+//------------------------------------------------------------------------------
+
+- (void) cancelBackgroundBuildOfItemAtIndex: (NSUInteger) index
+{
+	if( index < _items.count ) {
+		[ _placeholdersBuildingInBackground removeObject: _items[ index ] ];
+	}
+}
+
+//------------------------------------------------------------------------------
+
+- (void) discardBuiltItemsOverLimit: (NSUInteger) limit
+{
+	// The filter results of the table view controller display built items
+	// directly, so they are kept until filtering stops.
+	if( _tableViewController.filtering ) {
+		return;
+	}
+	
+	// Items with loaded cells are kept, so each item is only looked at once.
+	NSUInteger remaining = _builtLazyItems.count;
+	while( _builtLazyItems.count > limit && remaining > 0 ) {
+		--remaining;
+		ASTItem* item = _builtLazyItems.firstObject;
+		[ _builtLazyItems removeObjectAtIndex: 0 ];
+		
+		id placeholder = [ _placeholdersOfBuiltItems objectForKey: item ];
+		if( placeholder == nil ) {
+			// The item was removed from the section.
+			continue;
 		}
+		if( item.cellLoaded ) {
+			[ _builtLazyItems addObject: item ];
+			continue;
+		}
+		
+		_items[ [ self indexOfItem: item ] ] = placeholder;
+		[ _placeholdersOfBuiltItems removeObjectForKey: item ];
+		item.tableViewController = nil;
+		item.section = nil;
 	}
+}
 
-	UITableView* tableView = self.tableViewController.tableView;
-	[ tableView reloadData ];
+//------------------------------------------------------------------------------
+
+- (void) setMaximumNumberOfBuiltItems: (NSUInteger) maximumNumberOfBuiltItems
+{
+	_maximumNumberOfBuiltItems = maximumNumberOfBuiltItems;
+	[ self discardBuiltItemsOverLimit: maximumNumberOfBuiltItems ];
 }
 
 //------------------------------------------------------------------------------
 
-- (NSArray*) items
+- (void) setIdentifier: (NSString*) identifier
 {
-	return [ _items copy ];
+	NSString* oldIdentifier = _identifier;
+	_identifier = identifier;
+	[ (id<ASTObjectIndexContainer>)_tableViewController indexedObject: self
+			didChangeValueForKey: @"identifier" fromValue: oldIdentifier ];
 }
 
 //------------------------------------------------------------------------------
@@ -314,7 +823,9 @@
 	_tableViewController = tableViewController;
 	
 	for( ASTItem* item in _items ) {
-		item.tableViewController = tableViewController;
+		if( isItem( item ) ) {
+			item.tableViewController = tableViewController;
+		}
 	}
 }
 
@@ -327,33 +838,84 @@
 
 //------------------------------------------------------------------------------
 
-- (NSArray*) indexPathsWithIndexes: (NSArray*) indexes
+- (NSArray*) indexPathsWithIndexSet: (NSIndexSet*) indexes
 {
 	NSUInteger index = self.index;
 	NSMutableArray* result = [ NSMutableArray arrayWithCapacity: indexes.count ];
-	for( NSNumber* indexValue in indexes ) {
-		[ result addObject: [ NSIndexPath
-				indexPathForItem: [ indexValue unsignedIntegerValue ]
-				inSection: index ] ];
-	}
+	[ indexes enumerateIndexesUsingBlock: ^( NSUInteger row, BOOL* stop ) {
+		[ result addObject: [ NSIndexPath indexPathForItem: row inSection: index ] ];
+	} ];
 	return result;
 }
 
 //------------------------------------------------------------------------------
 
+- (CGFloat) measuredHeightOfFooter: (BOOL) footer forWidth: (CGFloat) width
+		contentSizeCategory: (NSString*) contentSizeCategory
+{
+	if( width != _measuredWidth || (contentSizeCategory != _measuredContentSizeCategory
+			&& [ contentSizeCategory isEqualToString: _measuredContentSizeCategory ] == NO) ) {
+		return -1;
+	}
+	return footer ? _measuredFooterHeight : _measuredHeaderHeight;
+}
+
+//------------------------------------------------------------------------------
+
+- (void) setMeasuredHeight: (CGFloat) height ofFooter: (BOOL) footer
+		forWidth: (CGFloat) width contentSizeCategory: (NSString*) contentSizeCategory
+{
+	if( [ self measuredHeightOfFooter: !footer forWidth: width
+			contentSizeCategory: contentSizeCategory ] < 0 ) {
+		[ self invalidateMeasuredHeights ];
+		_measuredWidth = width;
+		_measuredContentSizeCategory = [ contentSizeCategory copy ];
+	}
+	if( footer ) {
+		_measuredFooterHeight = height;
+	} else {
+		_measuredHeaderHeight = height;
+	}
+}
+
+//------------------------------------------------------------------------------
+
+- (void) invalidateMeasuredHeights
+{
+	_measuredHeaderHeight = -1;
+	_measuredFooterHeight = -1;
+}
+
+//------------------------------------------------------------------------------
+
+- (void) setHeaderView: (UIView*) headerView
+{
+	_headerView = headerView;
+	_measuredHeaderHeight = -1;
+}
+
+//------------------------------------------------------------------------------
+
 - (void) setFooterText: (NSString*) footerText
 {
 	NSString* originalFooterText = _footerText;
 	
 	_footerText = footerText;
+	_measuredFooterHeight = -1;
+	
+	if( _tableViewController.batchingUpdates ) {
+		[ _tableViewController reloadSectionAfterBatchUpdates: self ];
+		return;
+	}
 	
 	UITableView* tableView = self.tableViewController.tableView;
 	
 	// Check to see if the tableView has been shown yet, if not then do not
 	// bother to reload or invalidate the layout. Doing a reload before the
 	// view is shown can cause some strange animations when the table is first
-	// shown.
-	if( tableView.window == nil ) {
+	// shown. While filtering the section may be displayed at another index, or
+	// not at all.
+	if( tableView.window == nil || _tableViewController.filtering ) {
 		// We need to call reloadData here to inform the table that the data
 		// has changed.
 		[ tableView reloadData ];
@@ -385,14 +947,21 @@
 - (void) setFooterView: (UIView*) footerView
 {
 	_footerView = footerView;
+	_measuredFooterHeight = -1;
+	
+	if( _tableViewController.batchingUpdates ) {
+		[ _tableViewController reloadSectionAfterBatchUpdates: self ];
+		return;
+	}
 	
 	UITableView* tableView = self.tableViewController.tableView;
 
 	// Check to see if the tableView has been shown yet, if not then do not
 	// bother to reload or invalidate the layout. Doing a reload before the
 	// view is shown can cause some strange animations when the table is first
-	// shown.
-	if( tableView.window == nil ) {
+	// shown. While filtering the section may be displayed at another index, or
+	// not at all.
+	if( tableView.window == nil || _tableViewController.filtering ) {
 		// We need to call reloadData here to inform the table that the data
 		// has changed.
 		[ tableView reloadData ];
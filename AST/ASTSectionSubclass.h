@@ -27,20 +27,126 @@
 //==============================================================================
 
 #import "ASTSection.h"
+#import "ASTObjectIndex.h"
+#import "ASTViewController.h"
 
 
 NS_ASSUME_NONNULL_BEGIN
 
-@interface ASTSection() {
+@interface ASTSection() <ASTObjectIndexContainer> {
+	// The items of the section. In a section with lazy items, the items that
+	// are not built are represented by the dictionary describing them or by
+	// their provider index as an NSNumber.
 	NSMutableArray* _items;
+	ASTItemProvider _itemProvider;
+	// The lazy items that are built, oldest first, and the placeholder each of
+	// them replaced in _items.
+	NSMutableArray* _builtLazyItems;
+	NSMapTable* _placeholdersOfBuiltItems;
+	// The placeholders whose items are being built on a background queue.
+	NSHashTable* _placeholdersBuildingInBackground;
+	// Items at or after this index have a stale containerIndex. Code that
+	// changes _items must lower it to the first index that changed.
+	NSUInteger _firstStaleItemIndex;
+	// Code that changes _items must also update these.
+	ASTObjectIndex* _identifierIndex;
+	ASTObjectIndex* _representedObjectIndex;
+	// Heights of the header and footer views measured by the table view
+	// controller for a table width and content size category. The heights are
+	// negative when the views have to be measured.
+	CGFloat _measuredHeaderHeight;
+	CGFloat _measuredFooterHeight;
+	CGFloat _measuredWidth;
+	NSString* _measuredContentSizeCategory;
 }
 
 @property (weak,nonatomic) ASTViewController* tableViewController;
+// The last known index of the section in its table view controller. It is
+// only trusted by the table view controller, which renumbers its sections
+// after a mutation.
+@property (nonatomic) NSUInteger containerIndex;
+
+// YES if the section has lazy items, built or not.
+@property (readonly,nonatomic) BOOL hasLazyItems;
+// Returns the item at the index if it is built, without building it.
+- (nullable ASTItem*) builtItemAtIndex: (NSUInteger) index;
+// Builds the lazy item at the index on a background queue if it is described
+// by a dictionary, puts it in the section on the main thread and calls the
+// completion block with it. Built items, and items of an item provider, which
+// is called on the main thread, are passed to the block right away. The block
+// is not called if the build is cancelled, or if the item was built on the main
+// thread or left the section in the meantime.
+- (void) buildItemInBackgroundAtIndex: (NSUInteger) index
+		completion: (void (^)( ASTItem* item )) completion;
+// Drops the background build of the item at the index, if there is one.
+- (void) cancelBackgroundBuildOfItemAtIndex: (NSUInteger) index;
+// The items that are built, in order. The same as items in a section without
+// lazy items.
+@property (readonly,nonatomic) NSArray* builtItems;
 
 - (void) insertItemReferences: (NSArray*) items atIndexes: (NSArray*) indexes;
+- (void) insertItemReferences: (NSArray*) items atIndexSet: (NSIndexSet*) indexes;
 - (void) removeItemReferencesAtIndexes: (NSArray*) indexes;
+- (void) removeItemReferencesAtIndexSet: (NSIndexSet*) indexes;
 - (void) moveItemReferenceAtIndex: (NSUInteger) index toIndex: (NSUInteger) newIndex;
 
+// Returns the height of the header or footer view measured for the table width
+// and content size category, or a negative number if the view has to be
+// measured. The content size category is nil before iOS 10.
+- (CGFloat) measuredHeightOfFooter: (BOOL) footer forWidth: (CGFloat) width
+		contentSizeCategory: (nullable NSString*) contentSizeCategory;
+// Remembers the height of the header or footer view. Heights measured for a
+// different width or content size category are forgotten.
+- (void) setMeasuredHeight: (CGFloat) height ofFooter: (BOOL) footer
+		forWidth: (CGFloat) width contentSizeCategory: (nullable NSString*) contentSizeCategory;
+// Forgets the measured heights, so the views are measured again.
+- (void) invalidateMeasuredHeights;
+
 @end
 
+//------------------------------------------------------------------------------
+
+@interface ASTViewController( ASTSection )
+
+// The number of times a header or footer view was measured. Used by tests to
+// check that measurements are cached.
+@property (readonly,nonatomic) NSUInteger sectionViewMeasurementCount;
+
+// YES while performBatchUpdates: runs its block.
+@property (readonly,nonatomic,getter=isBatchingUpdates) BOOL batchingUpdates;
+// The table view, or nil while batch updates are recorded, so that changes to
+// the model are sent to the table view once at the end of the batch.
+@property (readonly,nullable,nonatomic) UITableView* tableViewForUpdates;
+// Remembers the items of the section before it is first changed by a batch,
+// so they can be compared with the items after the batch. Does nothing when
+// updates are not batched.
+- (void) recordBatchChangeOfSection: (ASTSection*) section;
+// Reloads the section at the end of the batch.
+- (void) reloadSectionAfterBatchUpdates: (ASTSection*) section;
+
+@end
+
+//------------------------------------------------------------------------------
+
+// Returns the index of an item or section in the array using the containerIndex
+// of the object. The objects from firstStaleIndex to the end of the array are
+// renumbered first if the cached index can not be trusted, and firstStaleIndex
+// is updated. Placeholders of lazy items that are not built are skipped.
+// Returns NSNotFound if the object is not in the array.
+NSUInteger containerIndexOfObject( NSArray* container, id object,
+		NSUInteger* firstStaleIndex );
+
+// Returns the NSNumber indexes, or the rows of NSIndexPath indexes, as an index
+// set. The indexes are sorted without boxing and must not repeat. If objects is
+// not nil, sortedObjects is set to the objects paired with the indexes in the
+// order of the index set.
+NSIndexSet* indexSetFromIndexes( NSArray* __nullable indexes,
+		NSArray* __nullable objects, NSArray* __nullable * __nullable sortedObjects );
+// Inserts the objects so that they end up at the indexes, with one pass over the
+// array. Indexes past the end of the array append the objects.
+void insertObjectsAtIndexSet( NSMutableArray* array, NSArray* objects,
+		NSIndexSet* indexes );
+// Removes the objects at the indexes with one pass over the array.
+void removeObjectsAtIndexSet( NSMutableArray* array, NSIndexSet* indexes );
+
 NS_ASSUME_NONNULL_END
@@ -181,6 +181,72 @@
 
 //------------------------------------------------------------------------------
 
+- (void) testItemLookupFollowsChanges
+{
+	ASTItem* first = [ ASTItem itemWithDict: @{ AST_id : @"dup", AST_representedObject : @1 } ];
+	ASTItem* second = [ ASTItem itemWithDict: @{ AST_id : @"dup", AST_representedObject : @1 } ];
+	ASTSection* section = [ ASTSection sectionWithItems: @[ first, second ] ];
+	
+	// The first match wins.
+	XCTAssertEqual( [ section itemWithIdentifier: @"dup" ], first );
+	XCTAssertEqual( [ section itemWithRepresentedObject: @1 ], first );
+	
+	[ section moveItemAtIndex: 1 toIndex: 0 ];
+	XCTAssertEqual( [ section itemWithIdentifier: @"dup" ], second );
+	
+	[ section removeItemsAtIndexes: @[ @0 ] withRowAnimation: UITableViewRowAnimationNone ];
+	XCTAssertEqual( [ section itemWithIdentifier: @"dup" ], first );
+	XCTAssertEqual( [ section itemWithRepresentedObject: @1 ], first );
+	
+	first.identifier = @"renamed";
+	first.representedObject = @2;
+	XCTAssertNil( [ section itemWithIdentifier: @"dup" ] );
+	XCTAssertNil( [ section itemWithRepresentedObject: @1 ] );
+	XCTAssertEqual( [ section itemWithIdentifier: @"renamed" ], first );
+	XCTAssertEqual( [ section itemWithRepresentedObject: @2 ], first );
+	
+	[ section insertItems: @[ second ] atIndexes: @[ @0 ]
+			withRowAnimation: UITableViewRowAnimationNone ];
+	second.identifier = @"renamed";
+	XCTAssertEqual( [ section itemWithIdentifier: @"renamed" ], second );
+	
+	section.items = @[ first ];
+	XCTAssertEqual( [ section itemWithIdentifier: @"renamed" ], first );
+	
+	// Items that left the section no longer update it.
+	second.identifier = @"second";
+	XCTAssertNil( [ section itemWithIdentifier: @"second" ] );
+}
+
+//------------------------------------------------------------------------------
+
+- (void) testItemLookupWithEqualRepresentedObjects
+{
+	NSMutableDictionary* model = [ NSMutableDictionary dictionaryWithObject: @"A" forKey: @"name" ];
+	NSMutableDictionary* otherModel = [ NSMutableDictionary dictionaryWithObject: @"B" forKey: @"name" ];
+	ASTItem* item = [ ASTItem itemWithDict: @{ AST_representedObject : model } ];
+	ASTItem* otherItem = [ ASTItem itemWithDict: @{ AST_representedObject : otherModel } ];
+	ASTSection* section = [ ASTSection sectionWithItems: @[ item, otherItem ] ];
+	XCTAssertEqual( [ section itemWithRepresentedObject: model ], item );
+	
+	// Equal objects that are not the represented object are found by hash.
+	XCTAssertEqual( [ section itemWithRepresentedObject: [ otherModel mutableCopy ] ], otherItem );
+	XCTAssertNil( [ section itemWithRepresentedObject: @{ @"name" : @"C" } ] );
+	
+	// Changing the represented object moves the item in the index.
+	NSDictionary* newModel = @{ @"name" : @"C" };
+	item.representedObject = newModel;
+	XCTAssertNil( [ section itemWithRepresentedObject: model ] );
+	XCTAssertEqual( [ section itemWithRepresentedObject: [ newModel mutableCopy ] ], item );
+	
+	// Removed items are not found.
+	[ section removeItemsAtIndexes: @[ @0 ] withRowAnimation: UITableViewRowAnimationNone ];
+	XCTAssertNil( [ section itemWithRepresentedObject: newModel ] );
+	XCTAssertEqual( [ section itemWithRepresentedObject: otherModel ], otherItem );
+}
+
+//------------------------------------------------------------------------------
+
 - (void) testItemAtIndex
 {
 	ASTSection* section = [ ASTSection sectionWithDict: @{
@@ -197,6 +263,34 @@
 
 //------------------------------------------------------------------------------
 
+- (void) testIndexOfItem
+{
+	ASTItem* item = [ ASTItem itemWithText: @"2" ];
+	ASTItem* itemNotInSection = [ ASTItem itemWithText: @"2" ];
+	ASTSection* section = [ ASTSection sectionWithItems: @[
+		[ ASTItem itemWithText: @"1" ],
+		item,
+	] ];
+	
+	XCTAssertEqual( [ section indexOfItem: item ], 1 );
+	XCTAssertEqual( [ section indexOfItem: itemNotInSection ], NSNotFound );
+	
+	[ section insertItems: @[ [ ASTItem itemWithText: @"0" ] ] atIndexes: @[ @0 ]
+			withRowAnimation: UITableViewRowAnimationNone ];
+	XCTAssertEqual( [ section indexOfItem: item ], 2 );
+	
+	[ section moveItemAtIndex: 2 toIndex: 0 ];
+	XCTAssertEqual( [ section indexOfItem: item ], 0 );
+	
+	[ section removeItemsAtIndexes: @[ @0 ] withRowAnimation: UITableViewRowAnimationNone ];
+	XCTAssertEqual( [ section indexOfItem: item ], NSNotFound );
+	
+	section.items = @[ [ ASTItem item ], item ];
+	XCTAssertEqual( [ section indexOfItem: item ], 1 );
+}
+
+//------------------------------------------------------------------------------
+
 - (void) testRemoveFromContainerWithRowAnimation
 {
 	ASTSection* section = [ ASTSection sectionWithDict: @{
@@ -246,6 +340,77 @@
 
 //------------------------------------------------------------------------------
 
+- (void) testInsertAndRemoveItemsAtIndexSet
+{
+	ASTItem* item0 = [ ASTItem item ];
+	ASTItem* item1 = [ ASTItem item ];
+	ASTItem* item2 = [ ASTItem item ];
+	ASTItem* item3 = [ ASTItem item ];
+	ASTItem* item4 = [ ASTItem item ];
+	ASTSection* section = [ ASTSection sectionWithItems: @[ item1, item3 ] ];
+	
+	// The indexes are where the items end up. Indexes past the end append.
+	NSMutableIndexSet* indexes = [ NSMutableIndexSet indexSet ];
+	[ indexes addIndex: 0 ];
+	[ indexes addIndex: 2 ];
+	[ indexes addIndex: 4 ];
+	[ section insertItems: @[ item0, item2, item4 ] atIndexSet: indexes
+			withRowAnimation: UITableViewRowAnimationNone ];
+	NSArray* expectedItems = @[ item0, item1, item2, item3, item4 ];
+	XCTAssertEqualObjects( section.items, expectedItems );
+	XCTAssertEqual( [ section indexOfItem: item3 ], 3 );
+	XCTAssertEqual( item2.section, section );
+	
+	// The array variant pairs each item with its index in any order.
+	[ section removeItemsAtIndexes: @[ @4, @0, @2 ]
+			withRowAnimation: UITableViewRowAnimationNone ];
+	[ section insertItems: @[ item4, item0, item2 ] atIndexes: @[ @4, @0, @2 ]
+			withRowAnimation: UITableViewRowAnimationNone ];
+	XCTAssertEqualObjects( section.items, expectedItems );
+	
+	[ indexes removeAllIndexes ];
+	[ indexes addIndexesInRange: NSMakeRange( 1, 2 ) ];
+	[ indexes addIndex: 4 ];
+	[ section removeItemsAtIndexSet: indexes withRowAnimation: UITableViewRowAnimationNone ];
+	expectedItems = @[ item0, item3 ];
+	XCTAssertEqualObjects( section.items, expectedItems );
+	XCTAssertNil( item1.section );
+	XCTAssertEqual( [ section indexOfItem: item3 ], 1 );
+}
+
+//------------------------------------------------------------------------------
+
+- (void) testInsertAndRemoveItemsAtIndexSetPerformance
+{
+	// 10k rows at random positions of a 100k row section.
+	NSMutableArray* items = [ NSMutableArray array ];
+	for( NSUInteger i = 0; i < 100000; ++i ) {
+		[ items addObject: [ ASTItem item ] ];
+	}
+	ASTSection* section = [ ASTSection sectionWithItems: items ];
+	
+	NSMutableIndexSet* indexes = [ NSMutableIndexSet indexSet ];
+	while( indexes.count < 10000 ) {
+		[ indexes addIndex: arc4random_uniform( 110000 ) ];
+	}
+	NSMutableArray* insertedItems = [ NSMutableArray array ];
+	for( NSUInteger i = 0; i < indexes.count; ++i ) {
+		[ insertedItems addObject: [ ASTItem item ] ];
+	}
+	
+	[ self measureBlock: ^{
+		[ section insertItems: insertedItems atIndexSet: indexes
+				withRowAnimation: UITableViewRowAnimationNone ];
+		[ section removeItemsAtIndexSet: indexes
+				withRowAnimation: UITableViewRowAnimationNone ];
+	} ];
+	
+	XCTAssertEqual( section.numberOfItems, 100000 );
+	XCTAssertEqual( [ section indexOfItem: items.lastObject ], 99999 );
+}
+
+//------------------------------------------------------------------------------
+
 - (void) testMoveItemAtIndexWithRowAnimation
 {
 	ASTSection* section = [ ASTSection sectionWithDict: @{
@@ -282,6 +447,39 @@
 
 //------------------------------------------------------------------------------
 
+- (void) testSetItemsWithRowAnimation
+{
+	ASTItem* keptItem = [ ASTItem itemWithDict: @{ AST_id : @"kept" } ];
+	ASTItem* removedItem = [ ASTItem itemWithDict: @{ AST_id : @"removed" } ];
+	ASTSection* section = [ ASTSection sectionWithItems: @[ removedItem, keptItem ] ];
+	ASTViewController* vc = [ [ ASTViewController alloc ] init ];
+	vc.data = @[ [ ASTSection section ], section ];
+	
+	[ section setItems: @[ keptItem, @{ AST_id : @"added" }, @{} ]
+			withRowAnimation: UITableViewRowAnimationNone ];
+	
+	XCTAssertEqual( section.numberOfItems, 3 );
+	XCTAssertEqual( [ vc.tableView numberOfRowsInSection: 1 ], 3 );
+	XCTAssertEqual( [ section indexOfItem: keptItem ], 0 );
+	XCTAssertEqual( keptItem.section, section );
+	XCTAssertNil( removedItem.section );
+	XCTAssertNil( removedItem.tableViewController );
+	XCTAssertNotNil( [ section itemWithIdentifier: @"added" ] );
+	
+	// The items property diffs when the table view controller asks for it.
+	vc.animatesDataChanges = YES;
+	section.items = @[ [ section itemWithIdentifier: @"added" ], keptItem ];
+	XCTAssertEqual( [ vc.tableView numberOfRowsInSection: 1 ], 2 );
+	XCTAssertEqual( [ section indexOfItem: keptItem ], 1 );
+	
+	// A section that is not in a table view just takes the items.
+	ASTSection* detachedSection = [ ASTSection section ];
+	[ detachedSection setItems: @[ removedItem ] withRowAnimation: UITableViewRowAnimationFade ];
+	XCTAssertEqual( removedItem.section, detachedSection );
+}
+
+//------------------------------------------------------------------------------
+
 - (void) testIdentifierProperty
 {
 	ASTSection* section = [ ASTSection sectionWithDict: @{
@@ -322,4 +520,101 @@
 
 //------------------------------------------------------------------------------
 
+- (void) testLazyItems
+{
+	NSMutableArray* itemDicts = [ NSMutableArray array ];
+	for( NSUInteger i = 0; i < 1000; ++i ) {
+		[ itemDicts addObject: @{
+			AST_id : [ NSString stringWithFormat: @"%lu", (unsigned long)i ],
+		} ];
+	}
+	ASTItem* item = [ ASTItem itemWithText: @"Not lazy" ];
+	[ itemDicts addObject: item ];
+	
+	ASTSection* section = [ ASTSection sectionWithDict: @{
+		AST_lazyItems : itemDicts,
+	} ];
+	section.maximumNumberOfBuiltItems = 10;
+	XCTAssertEqual( section.numberOfItems, 1001 );
+	
+	ASTItem* firstItem = [ section itemAtIndex: 0 ];
+	XCTAssertEqualObjects( firstItem.identifier, @"0" );
+	XCTAssertEqual( [ section itemAtIndex: 0 ], firstItem );
+	XCTAssertEqual( firstItem.section, section );
+	XCTAssertEqual( [ section itemAtIndex: 1000 ], item );
+	
+	ASTItem* foundItem = [ section itemWithIdentifier: @"500" ];
+	XCTAssertEqualObjects( foundItem.identifier, @"500" );
+	XCTAssertEqual( [ section indexOfItem: foundItem ], 500 );
+	
+	// Built items over the limit are discarded, oldest first.
+	for( NSUInteger i = 1; i < 20; ++i ) {
+		[ section itemAtIndex: i ];
+	}
+	XCTAssertNil( firstItem.section );
+	XCTAssertEqual( [ section indexOfItem: firstItem ], NSNotFound );
+	XCTAssertNotEqual( [ section itemAtIndex: 0 ], firstItem );
+	XCTAssertEqualObjects( [ section itemAtIndex: 0 ].identifier, @"0" );
+	XCTAssertEqual( item.section, section );
+	
+	[ section removeItemsAtIndexes: @[ @0, @1 ] withRowAnimation: UITableViewRowAnimationNone ];
+	XCTAssertEqual( section.numberOfItems, 999 );
+	XCTAssertEqualObjects( [ section itemAtIndex: 0 ].identifier, @"2" );
+	XCTAssertEqual( [ section indexOfItem: item ], 998 );
+	
+	NSArray* items = section.items;
+	XCTAssertEqual( items.count, 999 );
+	XCTAssertEqualObjects( [ items[ 100 ] identifier ], @"102" );
+	
+	section.items = @[ @{ AST_id : @"plain" } ];
+	XCTAssertEqual( section.numberOfItems, 1 );
+	XCTAssertNotNil( [ section itemWithIdentifier: @"plain" ] );
+}
+
+//------------------------------------------------------------------------------
+
+- (void) testItemProvider
+{
+	__block NSUInteger providedItemCount = 0;
+	ASTSection* section = [ ASTSection sectionWithNumberOfItems: 200000
+			itemProvider: ^id( NSUInteger index ) {
+		++providedItemCount;
+		return @{
+			AST_id : [ NSString stringWithFormat: @"%lu", (unsigned long)index ],
+		};
+	} ];
+	section.maximumNumberOfBuiltItems = 1;
+	XCTAssertEqual( section.numberOfItems, 200000 );
+	XCTAssertEqual( providedItemCount, 0 );
+	
+	ASTItem* lastItem = [ section itemAtIndex: 199999 ];
+	XCTAssertEqualObjects( lastItem.identifier, @"199999" );
+	XCTAssertEqual( [ section itemAtIndex: 199999 ], lastItem );
+	XCTAssertEqual( providedItemCount, 1 );
+	
+	[ section itemAtIndex: 0 ];
+	XCTAssertEqual( providedItemCount, 2 );
+	XCTAssertNil( lastItem.section );
+	
+	// Inserting items does not change the index the provider is called with.
+	ASTItem* insertedItem = [ ASTItem itemWithDict: @{ AST_id : @"inserted" } ];
+	[ section insertItems: @[ insertedItem ] atIndexes: @[ @0 ]
+			withRowAnimation: UITableViewRowAnimationNone ];
+	XCTAssertEqual( section.numberOfItems, 200001 );
+	XCTAssertEqualObjects( [ section itemAtIndex: 200000 ].identifier, @"199999" );
+	XCTAssertEqual( [ section itemAtIndex: 0 ], insertedItem );
+	
+	ASTItem* foundItem = [ section itemWithIdentifier: @"3" ];
+	XCTAssertEqual( [ section indexOfItem: foundItem ], 4 );
+	
+	ASTViewController* vc = [ [ ASTViewController alloc ]
+			initWithStyle: UITableViewStyleGrouped ];
+	vc.data = @[ section ];
+	XCTAssertEqual( [ vc itemWithIdentifier: @"2" ].tableViewController, vc );
+	XCTAssertEqualObjects( [ vc indexPathForItem: [ vc itemWithIdentifier: @"2" ] ],
+			[ NSIndexPath indexPathForRow: 3 inSection: 0 ] );
+}
+
+//------------------------------------------------------------------------------
+
 @end
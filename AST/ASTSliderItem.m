@@ -51,6 +51,25 @@
 
 //------------------------------------------------------------------------------
 
+- (BOOL) updateWithDict: (NSDictionary*) dict
+{
+	NSMutableDictionary* itemDict = [ dict mutableCopy ];
+	[ itemDict removeObjectsForKeys: @[
+		AST_sliderActionKey,
+		AST_sliderTargetKey,
+	] ];
+	if( [ super updateWithDict: itemDict ] == NO ) {
+		return NO;
+	}
+	
+	[ self setValue: dict[ AST_sliderActionKey ] forKey: AST_sliderActionKey ];
+	self.sliderValueTarget = dict[ AST_sliderTargetKey ];
+	
+	return YES;
+}
+
+//------------------------------------------------------------------------------
+
 - (void) loadCell
 {
 	[ super loadCell ];
@@ -60,20 +79,53 @@
 		[ sliderCell.slider addTarget: self
 				action: @selector(sliderValueChangedAction:)
 				forControlEvents: UIControlEventValueChanged ];
-		// Note that we never remove the target/action for the slider. Since we
-		// own the slider and the control holds the target weakly and controls
-		// auto release and/or don't care if the target/action is removed it
-		// would seem to be unnecessary.
+		[ sliderCell.slider addTarget: self
+				action: @selector(sliderTouchEndedAction:)
+				forControlEvents: UIControlEventTouchUpInside | UIControlEventTouchUpOutside
+						| UIControlEventTouchCancel ];
+		// The target/action is removed in unloadCell so that a reused cell
+		// does not send actions to the item that previously owned it.
 	}
 }
 
 //------------------------------------------------------------------------------
 
+- (void) unloadCell
+{
+	if( self.cellLoaded ) {
+		ASTSliderItemCell* sliderCell = (ASTSliderItemCell*)self.cell;
+		[ sliderCell.slider removeTarget: self
+				action: @selector(sliderValueChangedAction:)
+				forControlEvents: UIControlEventValueChanged ];
+		[ sliderCell.slider removeTarget: self
+				action: @selector(sliderTouchEndedAction:)
+				forControlEvents: UIControlEventTouchUpInside | UIControlEventTouchUpOutside
+						| UIControlEventTouchCancel ];
+	}
+	
+	[ super unloadCell ];
+}
+
+//------------------------------------------------------------------------------
+
 - (void) sliderValueChangedAction: (id) sender
 {
 	ASTSliderItemCell* sliderCell = (ASTSliderItemCell*)self.cell;
 	[ self setCellPropertiesValue: @(sliderCell.slider.value) forKeyPath: AST_cell_slider_value ];
-	
+	[ self valueDidChange ];
+}
+
+//------------------------------------------------------------------------------
+
+- (void) sliderTouchEndedAction: (id) sender
+{
+	[ self commitValueChange ];
+}
+
+//------------------------------------------------------------------------------
+
+- (void) sendValueChange
+{
 	if( _sliderValueAction ) {
 		[ self sendAction: _sliderValueAction to: _sliderValueTarget ];
 	}
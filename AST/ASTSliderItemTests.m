@@ -36,6 +36,7 @@
 @interface SliderItemTestTarget : NSObject
 
 @property (nonatomic) BOOL actionSent;
+@property (nonatomic) NSUInteger actionCount;
 
 - (void) sliderTestAction: (id) sender;
 
@@ -232,6 +233,28 @@
 
 //------------------------------------------------------------------------------
 
+- (void) testSliderValueDeliveredOnTouchUp
+{
+	SliderItemTestTarget* target = [ [ SliderItemTestTarget alloc ] init ];
+	ASTSliderItem* item = [ ASTSliderItem item ];
+	item.sliderValueAction = @selector(sliderTestAction:);
+	item.sliderValueTarget = target;
+	item.valueDelivery = ASTValueDeliveryOnCommit;
+	ASTSliderItemCell* cell = (ASTSliderItemCell*)item.cell;
+	
+	cell.slider.value = 0.25;
+	[ cell.slider sendActionsForControlEvents: UIControlEventValueChanged ];
+	cell.slider.value = 0.5;
+	[ cell.slider sendActionsForControlEvents: UIControlEventValueChanged ];
+	XCTAssertEqual( target.actionCount, 0 );
+	XCTAssertEqual( [ [ item valueForKeyPath: AST_cell_slider_value ] floatValue ], 0.5 );
+	
+	[ cell.slider sendActionsForControlEvents: UIControlEventTouchUpInside ];
+	XCTAssertEqual( target.actionCount, 1 );
+}
+
+//------------------------------------------------------------------------------
+
 - (void) testSliderItemActionPropertiesViaKey
 {
 	ASTSliderItem* item = [ ASTSliderItem item ];
@@ -284,6 +307,7 @@
 - (void) sliderTestAction: (id) sender
 {
 	self.actionSent = YES;
+	++self.actionCount;
 }
 
 //------------------------------------------------------------------------------
@@ -0,0 +1,121 @@
+//==============================================================================
+//
+//  ASTSortedObjectsController.h
+//
+//==============================================================================
+//
+//  Copyright (c) 2016 Adobe Systems Incorporated. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a
+//  copy of this software and associated documentation files (the "Software"),
+//  to deal in the Software without restriction, including without limitation
+//  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//  and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//
+//==============================================================================
+
+#import <UIKit/UIKit.h>
+
+
+NS_ASSUME_NONNULL_BEGIN
+
+//------------------------------------------------------------------------------
+
+@class ASTItem;
+@class ASTViewController;
+
+//------------------------------------------------------------------------------
+
+/// Returns the item displaying a model object.
+typedef ASTItem* __nonnull (^ASTItemBuilder)( id object );
+/// Returns the header text of the section of a group.
+typedef NSString* __nullable (^ASTGroupHeaderTextBuilder)( id __nullable groupValue );
+
+//------------------------------------------------------------------------------
+
+/// Keeps the data of a table view controller sorted and grouped from a flat
+/// array of model objects. Each object gets an item built by the item builder,
+/// with the object as its represented object unless the builder sets another.
+/// In a grouped table view each distinct value of the group key gets a section,
+/// ordered by that value. Rows are ordered by the value of the sort key, and
+/// objects with equal values keep the order they were added in. nil and NSNull
+/// values are ordered first. Values are compared with compare:.
+///
+/// After the objects are set, an object that is inserted, removed or changed
+/// is placed with a binary search and its row is inserted, removed or moved
+/// with an animation, instead of sorting and reloading the table. The key
+/// values of each object are remembered when it is placed, so objectDidChange:
+/// must be called after the sort or group key of an object changes.
+///
+/// The sorted objects controller owns the data of the table view controller,
+/// which must not be changed by other means while it is used.
+
+@interface ASTSortedObjectsController : NSObject
+
+/// Initializes and returns an ASTSortedObjectsController.
+/// @param tableViewController The table view controller displaying the
+/// objects. It is not retained.
+/// @param sortKey The key of the values the rows are sorted by.
+/// @param groupKey The key of the values the rows are grouped by or nil to put
+/// all of the rows in one section. Must be nil for a plain table view.
+/// @param itemBuilder The block building the item of an object.
+/// @return A new ASTSortedObjectsController.
+- (instancetype) initWithTableViewController: (ASTViewController*) tableViewController
+		sortKey: (NSString*) sortKey groupKey: (nullable NSString*) groupKey
+		itemBuilder: (ASTItemBuilder) itemBuilder NS_DESIGNATED_INITIALIZER;
+- (instancetype) init NS_UNAVAILABLE;
+
+@property (readonly,weak,nullable,nonatomic) ASTViewController* tableViewController;
+@property (readonly,nonatomic) NSString* sortKey;
+@property (readonly,nullable,nonatomic) NSString* groupKey;
+
+/// YES to sort the rows in ascending order of the sort key. Changing it sorts
+/// the objects again and reloads the table view. The default is YES.
+@property (nonatomic) BOOL ascending;
+/// YES to order the sections in ascending order of the group key. Changing it
+/// sorts the objects again and reloads the table view. The default is YES.
+@property (nonatomic) BOOL groupsAscending;
+/// Builds the header text of the section of a group. By default the header
+/// text is the description of the group value. Set it before the objects.
+@property (nullable,copy,nonatomic) ASTGroupHeaderTextBuilder headerTextBuilder;
+/// The animation used for the rows and sections that are inserted, removed or
+/// moved. The default is UITableViewRowAnimationAutomatic.
+@property (nonatomic) UITableViewRowAnimation rowAnimation;
+
+/// The objects in the order of the rows. Setting the objects builds all of the
+/// items, sorts them and sets the data of the table view controller.
+@property (copy,nonatomic) NSArray* objects;
+/// The number of objects.
+@property (readonly,nonatomic) NSUInteger numberOfObjects;
+
+/// Adds an object, inserting its row at its sorted position.
+/// @param object The object to add. It must not already be added.
+- (void) insertObject: (id) object;
+/// Removes an object and its row. Does nothing if the object was not added.
+/// @param object The object to remove.
+- (void) removeObject: (id) object;
+/// Moves the row of an object to the position given by the current values of
+/// its sort and group keys. Does nothing if they did not change.
+/// @param object An object whose key values may have changed.
+- (void) objectDidChange: (id) object;
+
+/// Returns the item built for an object or nil if the object was not added.
+/// @param object An added object.
+/// @return The item of the object or nil.
+- (nullable ASTItem*) itemForObject: (id) object;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,543 @@
+//==============================================================================
+//
+//  ASTSortedObjectsController.m
+//
+//==============================================================================
+//
+//  Copyright (c) 2016 Adobe Systems Incorporated. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a
+//  copy of this software and associated documentation files (the "Software"),
+//  to deal in the Software without restriction, including without limitation
+//  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//  and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//
+//==============================================================================
+
+#import "ASTSortedObjectsController.h"
+
+#import "ASTItem.h"
+#import "ASTSection.h"
+#import "ASTViewController.h"
+
+
+//------------------------------------------------------------------------------
+
+// nil and NSNull are ordered before any other value.
+
+static NSComparisonResult compareKeyValues( id value1, id value2, BOOL ascending )
+{
+	if( value1 == value2 ) {
+		return NSOrderedSame;
+	}
+	
+	BOOL isNull1 = value1 == nil || value1 == [ NSNull null ];
+	BOOL isNull2 = value2 == nil || value2 == [ NSNull null ];
+	NSComparisonResult result;
+	if( isNull1 || isNull2 ) {
+		result = isNull1 == isNull2 ? NSOrderedSame
+				: isNull1 ? NSOrderedAscending : NSOrderedDescending;
+	} else {
+		result = [ value1 compare: value2 ];
+	}
+	return ascending ? result : -result;
+}
+
+//------------------------------------------------------------------------------
+
+// The key values are copied when they can be, so that a mutable value changed
+// in place does not reorder an object behind the controller's back.
+
+static id keyValueOfObject( id object, NSString* key )
+{
+	id value = key ? [ object valueForKey: key ] : nil;
+	if( [ value conformsToProtocol: @protocol( NSCopying ) ] ) {
+		return [ value copy ];
+	}
+	return value;
+}
+
+//------------------------------------------------------------------------------
+
+// An added object with its item and the key values it was placed with.
+
+@interface ASTSortedEntry : NSObject
+
+@property (nonatomic) id object;
+@property (nonatomic) ASTItem* item;
+@property (nullable,nonatomic) id sortValue;
+@property (nullable,nonatomic) id groupValue;
+
+@end
+
+//------------------------------------------------------------------------------
+
+@implementation ASTSortedEntry
+
+@end
+
+//------------------------------------------------------------------------------
+
+// The entries with one group value, in the order of their rows, and the
+// section displaying them in a grouped table view.
+
+@interface ASTSortedGroup : NSObject
+
+@property (nullable,nonatomic) id groupValue;
+@property (nullable,nonatomic) ASTSection* section;
+@property (readonly,nonatomic) NSMutableArray* entries;
+
+@end
+
+//------------------------------------------------------------------------------
+
+@implementation ASTSortedGroup
+
+- (instancetype) init
+{
+	self = [ super init ];
+	if( self ) {
+		_entries = [ NSMutableArray array ];
+	}
+	return self;
+}
+
+@end
+
+//------------------------------------------------------------------------------
+
+@interface ASTSortedObjectsController() {
+	ASTItemBuilder _itemBuilder;
+	BOOL _grouped;
+	// The groups in the order of their sections. A plain table view has at
+	// most one group.
+	NSMutableArray* _groups;
+	NSMapTable* _entriesByObject;
+}
+
+@end
+
+//------------------------------------------------------------------------------
+
+@implementation ASTSortedObjectsController
+
+//------------------------------------------------------------------------------
+
+- (instancetype) initWithTableViewController: (ASTViewController*) tableViewController
+		sortKey: (NSString*) sortKey groupKey: (NSString*) groupKey
+		itemBuilder: (ASTItemBuilder) itemBuilder
+{
+	NSParameterAssert( tableViewController );
+	NSParameterAssert( sortKey );
+	NSParameterAssert( itemBuilder );
+	
+	self = [ super init ];
+	if( self ) {
+		_tableViewController = tableViewController;
+		_sortKey = [ sortKey copy ];
+		_groupKey = [ groupKey copy ];
+		_itemBuilder = [ itemBuilder copy ];
+		_grouped = tableViewController.tableView.style == UITableViewStyleGrouped;
+		NSAssert( _groupKey == nil || _grouped, @"A plain table view can not be grouped" );
+		_ascending = YES;
+		_groupsAscending = YES;
+		_rowAnimation = UITableViewRowAnimationAutomatic;
+		_groups = [ NSMutableArray array ];
+		_entriesByObject = [ NSMapTable
+				mapTableWithKeyOptions: NSPointerFunctionsObjectPointerPersonality
+				valueOptions: NSPointerFunctionsStrongMemory ];
+	}
+	return self;
+}
+
+//------------------------------------------------------------------------------
+
+#pragma mark - Objects
+
+//------------------------------------------------------------------------------
+
+- (NSArray*) objects
+{
+	NSMutableArray* result = [ NSMutableArray arrayWithCapacity: _entriesByObject.count ];
+	for( ASTSortedGroup* group in _groups ) {
+		for( ASTSortedEntry* entry in group.entries ) {
+			[ result addObject: entry.object ];
+		}
+	}
+	return result;
+}
+
+//------------------------------------------------------------------------------
+
+- (void) setObjects: (NSArray*) objects
+{
+	// Objects that are already added keep their items.
+	NSMutableArray* entries = [ NSMutableArray arrayWithCapacity: objects.count ];
+	for( id object in objects ) {
+		ASTSortedEntry* entry = [ _entriesByObject objectForKey: object ];
+		if( entry == nil ) {
+			entry = [ self entryForObject: object ];
+		} else {
+			entry.sortValue = keyValueOfObject( object, _sortKey );
+			entry.groupValue = keyValueOfObject( object, _groupKey );
+		}
+		[ entries addObject: entry ];
+	}
+	
+	[ self replaceEntries: entries ];
+}
+
+//------------------------------------------------------------------------------
+
+- (NSUInteger) numberOfObjects
+{
+	return _entriesByObject.count;
+}
+
+//------------------------------------------------------------------------------
+
+- (void) setAscending: (BOOL) ascending
+{
+	if( _ascending != ascending ) {
+		_ascending = ascending;
+		[ self replaceEntries: [ self allEntries ] ];
+	}
+}
+
+//------------------------------------------------------------------------------
+
+- (void) setGroupsAscending: (BOOL) groupsAscending
+{
+	if( _groupsAscending != groupsAscending ) {
+		_groupsAscending = groupsAscending;
+		[ self replaceEntries: [ self allEntries ] ];
+	}
+}
+
+//------------------------------------------------------------------------------
+
+- (void) insertObject: (id) object
+{
+	NSAssert( [ _entriesByObject objectForKey: object ] == nil,
+			@"The object is already added %@", object );
+	
+	ASTSortedEntry* entry = [ self entryForObject: object ];
+	[ _entriesByObject setObject: entry forKey: object ];
+	[ self placeEntry: entry ];
+}
+
+//------------------------------------------------------------------------------
+
+- (void) removeObject: (id) object
+{
+	ASTSortedEntry* entry = [ _entriesByObject objectForKey: object ];
+	if( entry == nil ) {
+		return;
+	}
+	
+	[ _entriesByObject removeObjectForKey: object ];
+	[ self removeEntry: entry ];
+}
+
+//------------------------------------------------------------------------------
+
+- (void) objectDidChange: (id) object
+{
+	ASTSortedEntry* entry = [ _entriesByObject objectForKey: object ];
+	if( entry == nil ) {
+		return;
+	}
+	
+	id sortValue = keyValueOfObject( object, _sortKey );
+	id groupValue = keyValueOfObject( object, _groupKey );
+	BOOL sameGroup = compareKeyValues( groupValue, entry.groupValue, YES ) == NSOrderedSame;
+	if( sameGroup && compareKeyValues( sortValue, entry.sortValue, YES ) == NSOrderedSame ) {
+		return;
+	}
+	
+	if( sameGroup == NO ) {
+		// The row changes section, so the removal and insertion are sent to
+		// the table view together.
+		[ _tableViewController performBatchUpdates: ^{
+			[ self removeEntry: entry ];
+			entry.sortValue = sortValue;
+			entry.groupValue = groupValue;
+			[ self placeEntry: entry ];
+		} withRowAnimation: _rowAnimation ];
+		return;
+	}
+	
+	NSUInteger groupIndex = [ self indexOfGroupWithValue: entry.groupValue insertionIndex: NULL ];
+	ASTSortedGroup* group = _groups[ groupIndex ];
+	NSUInteger row = [ self rowOfEntry: entry inGroup: group ];
+	[ group.entries removeObjectAtIndex: row ];
+	entry.sortValue = sortValue;
+	NSUInteger newRow = [ self insertionRowOfEntry: entry inGroup: group ];
+	[ group.entries insertObject: entry atIndex: newRow ];
+	if( row == newRow ) {
+		return;
+	}
+	
+	if( group.section ) {
+		[ group.section moveItemAtIndex: row toIndex: newRow ];
+	} else {
+		[ _tableViewController
+				moveItemWithAnimationAtIndexPath: [ NSIndexPath indexPathForRow: row inSection: 0 ]
+				toIndexPath: [ NSIndexPath indexPathForRow: newRow inSection: 0 ] ];
+	}
+}
+
+//------------------------------------------------------------------------------
+
+- (ASTItem*) itemForObject: (id) object
+{
+	ASTSortedEntry* entry = [ _entriesByObject objectForKey: object ];
+	return entry.item;
+}
+
+//------------------------------------------------------------------------------
+
+#pragma mark - Entries
+
+//------------------------------------------------------------------------------
+
+- (ASTSortedEntry*) entryForObject: (id) object
+{
+	ASTItem* item = _itemBuilder( object );
+	NSAssert( item != nil, @"No item for object %@", object );
+	if( item.representedObject == nil ) {
+		item.representedObject = object;
+	}
+	
+	ASTSortedEntry* entry = [ [ ASTSortedEntry alloc ] init ];
+	entry.object = object;
+	entry.item = item;
+	entry.sortValue = keyValueOfObject( object, _sortKey );
+	entry.groupValue = keyValueOfObject( object, _groupKey );
+	return entry;
+}
+
+//------------------------------------------------------------------------------
+
+- (NSArray*) allEntries
+{
+	NSMutableArray* result = [ NSMutableArray arrayWithCapacity: _entriesByObject.count ];
+	for( ASTSortedGroup* group in _groups ) {
+		[ result addObjectsFromArray: group.entries ];
+	}
+	return result;
+}
+
+//------------------------------------------------------------------------------
+
+// Sorts all of the entries and sets the data of the table view controller.
+
+- (void) replaceEntries: (NSArray*) entries
+{
+	BOOL ascending = _ascending;
+	BOOL groupsAscending = _groupsAscending;
+	NSArray* sortedEntries = [ entries sortedArrayWithOptions: NSSortStable
+			usingComparator: ^NSComparisonResult( ASTSortedEntry* entry1, ASTSortedEntry* entry2 ) {
+		NSComparisonResult result = compareKeyValues( entry1.groupValue,
+				entry2.groupValue, groupsAscending );
+		if( result == NSOrderedSame ) {
+			result = compareKeyValues( entry1.sortValue, entry2.sortValue, ascending );
+		}
+		return result;
+	} ];
+	
+	[ _entriesByObject removeAllObjects ];
+	[ _groups removeAllObjects ];
+	ASTSortedGroup* group = nil;
+	for( ASTSortedEntry* entry in sortedEntries ) {
+		[ _entriesByObject setObject: entry forKey: entry.object ];
+		if( group == nil || compareKeyValues( group.groupValue,
+				entry.groupValue, YES ) != NSOrderedSame ) {
+			group = [ [ ASTSortedGroup alloc ] init ];
+			group.groupValue = entry.groupValue;
+			[ _groups addObject: group ];
+		}
+		[ group.entries addObject: entry ];
+	}
+	
+	NSMutableArray* data = [ NSMutableArray arrayWithCapacity: _groups.count ];
+	for( group in _groups ) {
+		NSArray* items = [ group.entries valueForKey: @"item" ];
+		if( _grouped ) {
+			group.section = [ self sectionWithItems: items groupValue: group.groupValue ];
+			[ data addObject: group.section ];
+		} else {
+			[ data addObjectsFromArray: items ];
+		}
+	}
+	_tableViewController.data = data;
+}
+
+//------------------------------------------------------------------------------
+
+- (ASTSection*) sectionWithItems: (NSArray*) items groupValue: (id) groupValue
+{
+	ASTSection* section = [ ASTSection sectionWithItems: items ];
+	if( _groupKey ) {
+		section.headerText = _headerTextBuilder ? _headerTextBuilder( groupValue )
+				: [ groupValue description ];
+	}
+	return section;
+}
+
+//------------------------------------------------------------------------------
+
+// Inserts the entry in its group and its row in the table view, adding the
+// group and its section if it is the first entry with its group value.
+
+- (void) placeEntry: (ASTSortedEntry*) entry
+{
+	NSUInteger insertionIndex = 0;
+	NSUInteger groupIndex = [ self indexOfGroupWithValue: entry.groupValue
+			insertionIndex: &insertionIndex ];
+	if( groupIndex == NSNotFound ) {
+		groupIndex = insertionIndex;
+		ASTSortedGroup* group = [ [ ASTSortedGroup alloc ] init ];
+		group.groupValue = entry.groupValue;
+		[ group.entries addObject: entry ];
+		[ _groups insertObject: group atIndex: groupIndex ];
+		if( _grouped ) {
+			group.section = [ self sectionWithItems: @[ entry.item ] groupValue: entry.groupValue ];
+			[ _tableViewController insertSections: @[ group.section ]
+					atIndexSet: [ NSIndexSet indexSetWithIndex: groupIndex ]
+					withRowAnimation: _rowAnimation ];
+		} else {
+			[ _tableViewController insertItems: @[ entry.item ]
+					atIndexPaths: @[ [ NSIndexPath indexPathForRow: 0 inSection: 0 ] ]
+					withRowAnimation: _rowAnimation ];
+		}
+		return;
+	}
+	
+	ASTSortedGroup* group = _groups[ groupIndex ];
+	NSUInteger row = [ self insertionRowOfEntry: entry inGroup: group ];
+	[ group.entries insertObject: entry atIndex: row ];
+	if( group.section ) {
+		[ group.section insertItems: @[ entry.item ]
+				atIndexSet: [ NSIndexSet indexSetWithIndex: row ]
+				withRowAnimation: _rowAnimation ];
+	} else {
+		[ _tableViewController insertItems: @[ entry.item ]
+				atIndexPaths: @[ [ NSIndexPath indexPathForRow: row inSection: 0 ] ]
+				withRowAnimation: _rowAnimation ];
+	}
+}
+
+//------------------------------------------------------------------------------
+
+// Removes the entry from its group and its row from the table view, removing
+// the group and its section if it was the last entry of the group.
+
+- (void) removeEntry: (ASTSortedEntry*) entry
+{
+	NSUInteger groupIndex = [ self indexOfGroupWithValue: entry.groupValue insertionIndex: NULL ];
+	NSAssert( groupIndex != NSNotFound, @"No group for %@", entry.object );
+	ASTSortedGroup* group = _groups[ groupIndex ];
+	NSUInteger row = [ self rowOfEntry: entry inGroup: group ];
+	[ group.entries removeObjectAtIndex: row ];
+	
+	if( group.section && group.entries.count == 0 ) {
+		[ _groups removeObjectAtIndex: groupIndex ];
+		[ _tableViewController removeSectionsAtIndexSet: [ NSIndexSet indexSetWithIndex: groupIndex ]
+				withRowAnimation: _rowAnimation ];
+	} else if( group.section ) {
+		[ group.section removeItemsAtIndexSet: [ NSIndexSet indexSetWithIndex: row ]
+				withRowAnimation: _rowAnimation ];
+	} else {
+		if( group.entries.count == 0 ) {
+			[ _groups removeObjectAtIndex: groupIndex ];
+		}
+		[ _tableViewController removeItemsAtIndexPaths:
+				@[ [ NSIndexPath indexPathForRow: row inSection: 0 ] ]
+				withRowAnimation: _rowAnimation ];
+	}
+}
+
+//------------------------------------------------------------------------------
+
+#pragma mark - Binary Search
+
+//------------------------------------------------------------------------------
+
+// Returns the index of the group with the value or NSNotFound, and sets
+// insertionIndex to the index a group with the value would be inserted at.
+
+- (NSUInteger) indexOfGroupWithValue: (id) groupValue
+		insertionIndex: (NSUInteger*) insertionIndex
+{
+	BOOL groupsAscending = _groupsAscending;
+	ASTSortedGroup* probe = [ [ ASTSortedGroup alloc ] init ];
+	probe.groupValue = groupValue;
+	NSComparator comparator = ^NSComparisonResult( ASTSortedGroup* group1, ASTSortedGroup* group2 ) {
+		return compareKeyValues( group1.groupValue, group2.groupValue, groupsAscending );
+	};
+	
+	NSRange range = NSMakeRange( 0, _groups.count );
+	if( insertionIndex ) {
+		*insertionIndex = [ _groups indexOfObject: probe inSortedRange: range
+				options: NSBinarySearchingInsertionIndex usingComparator: comparator ];
+	}
+	return [ _groups indexOfObject: probe inSortedRange: range
+			options: NSBinarySearchingFirstEqual usingComparator: comparator ];
+}
+
+//------------------------------------------------------------------------------
+
+- (NSComparator) entryComparator
+{
+	BOOL ascending = _ascending;
+	return ^NSComparisonResult( ASTSortedEntry* entry1, ASTSortedEntry* entry2 ) {
+		return compareKeyValues( entry1.sortValue, entry2.sortValue, ascending );
+	};
+}
+
+//------------------------------------------------------------------------------
+
+// Entries with equal sort values are inserted after the existing ones, so they
+// keep the order they were added in.
+
+- (NSUInteger) insertionRowOfEntry: (ASTSortedEntry*) entry inGroup: (ASTSortedGroup*) group
+{
+	return [ group.entries indexOfObject: entry
+			inSortedRange: NSMakeRange( 0, group.entries.count )
+			options: NSBinarySearchingInsertionIndex | NSBinarySearchingLastEqual
+			usingComparator: [ self entryComparator ] ];
+}
+
+//------------------------------------------------------------------------------
+
+- (NSUInteger) rowOfEntry: (ASTSortedEntry*) entry inGroup: (ASTSortedGroup*) group
+{
+	NSMutableArray* entries = group.entries;
+	NSUInteger count = entries.count;
+	NSUInteger row = [ entries indexOfObject: entry inSortedRange: NSMakeRange( 0, count )
+			options: NSBinarySearchingFirstEqual usingComparator: [ self entryComparator ] ];
+	
+	// Scan the entries with an equal sort value.
+	while( row < count && entries[ row ] != entry ) {
+		++row;
+	}
+	NSAssert( row < count, @"The entry of %@ is not in its group", entry.object );
+	return row;
+}
+
+//------------------------------------------------------------------------------
+
+@end
@@ -0,0 +1,165 @@
+//==============================================================================
+//
+//  ASTSortedObjectsControllerTests.m
+//
+//==============================================================================
+//
+//  Copyright (c) 2016 Adobe Systems Incorporated. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a
+//  copy of this software and associated documentation files (the "Software"),
+//  to deal in the Software without restriction, including without limitation
+//  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//  and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//
+//==============================================================================
+
+#import "ASTItem.h"
+#import "ASTSection.h"
+#import "ASTSortedObjectsController.h"
+#import "ASTViewController.h"
+
+#import <UIKit/UIKit.h>
+#import <XCTest/XCTest.h>
+
+
+//------------------------------------------------------------------------------
+
+static NSMutableDictionary* person( NSString* name, NSString* team )
+{
+	return [ @{ @"name" : name, @"team" : team } mutableCopy ];
+}
+
+//------------------------------------------------------------------------------
+
+@interface ASTSortedObjectsControllerTests : XCTestCase
+
+@end
+
+//------------------------------------------------------------------------------
+
+@implementation ASTSortedObjectsControllerTests
+
+//------------------------------------------------------------------------------
+
+- (ASTSortedObjectsController*) controllerWithStyle: (UITableViewStyle) style
+		groupKey: (NSString*) groupKey
+{
+	ASTViewController* vc = [ [ ASTViewController alloc ] initWithStyle: style ];
+	return [ [ ASTSortedObjectsController alloc ] initWithTableViewController: vc
+			sortKey: @"name" groupKey: groupKey itemBuilder: ^ASTItem*( id object ) {
+		return [ ASTItem itemWithText: object[ @"name" ] ];
+	} ];
+}
+
+//------------------------------------------------------------------------------
+
+- (NSArray*) namesInSection: (ASTSection*) section
+{
+	NSMutableArray* names = [ NSMutableArray array ];
+	for( ASTItem* item in section.items ) {
+		[ names addObject: item.representedObject[ @"name" ] ];
+	}
+	return names;
+}
+
+//------------------------------------------------------------------------------
+
+- (void) testGroupedObjects
+{
+	ASTSortedObjectsController* controller = [ self
+			controllerWithStyle: UITableViewStyleGrouped groupKey: @"team" ];
+	ASTViewController* vc = controller.tableViewController;
+	NSMutableDictionary* carol = person( @"Carol", @"Red" );
+	NSMutableDictionary* bob = person( @"Bob", @"Blue" );
+	controller.objects = @[ carol, person( @"Alice", @"Red" ), bob ];
+	
+	XCTAssertEqual( vc.numberOfItems, 2 );
+	XCTAssertEqualObjects( [ vc sectionAtIndex: 0 ].headerText, @"Blue" );
+	XCTAssertEqualObjects( [ vc sectionAtIndex: 1 ].headerText, @"Red" );
+	NSArray* expectedNames = @[ @"Alice", @"Carol" ];
+	XCTAssertEqualObjects( [ self namesInSection: [ vc sectionAtIndex: 1 ] ], expectedNames );
+	XCTAssertEqual( [ controller itemForObject: carol ].representedObject, carol );
+	
+	// A new group value adds a section in order.
+	[ controller insertObject: person( @"Dave", @"Green" ) ];
+	[ controller insertObject: person( @"Bea", @"Red" ) ];
+	XCTAssertEqual( vc.numberOfItems, 3 );
+	XCTAssertEqualObjects( [ vc sectionAtIndex: 1 ].headerText, @"Green" );
+	expectedNames = @[ @"Alice", @"Bea", @"Carol" ];
+	XCTAssertEqualObjects( [ self namesInSection: [ vc sectionAtIndex: 2 ] ], expectedNames );
+	
+	// Changing the sort key moves the row, changing the group key moves it to
+	// another section and removes the section it leaves empty.
+	ASTItem* carolItem = [ controller itemForObject: carol ];
+	carol[ @"name" ] = @"Aaron";
+	[ controller objectDidChange: carol ];
+	XCTAssertEqualObjects( [ vc indexPathForItem: carolItem ],
+			[ NSIndexPath indexPathForRow: 0 inSection: 2 ] );
+	bob[ @"team" ] = @"Red";
+	[ controller objectDidChange: bob ];
+	XCTAssertEqual( vc.numberOfItems, 2 );
+	XCTAssertEqualObjects( [ vc sectionAtIndex: 0 ].headerText, @"Green" );
+	expectedNames = @[ @"Aaron", @"Alice", @"Bea", @"Bob" ];
+	XCTAssertEqualObjects( [ self namesInSection: [ vc sectionAtIndex: 1 ] ], expectedNames );
+	XCTAssertEqual( [ vc.tableView numberOfRowsInSection: 1 ], 4 );
+	
+	[ controller removeObject: carol ];
+	XCTAssertNil( [ controller itemForObject: carol ] );
+	XCTAssertNil( carolItem.tableViewController );
+	XCTAssertEqual( controller.numberOfObjects, 4 );
+	
+	controller.groupsAscending = NO;
+	XCTAssertEqualObjects( [ vc sectionAtIndex: 0 ].headerText, @"Red" );
+}
+
+//------------------------------------------------------------------------------
+
+- (void) testPlainObjects
+{
+	ASTSortedObjectsController* controller = [ self
+			controllerWithStyle: UITableViewStylePlain groupKey: nil ];
+	ASTViewController* vc = controller.tableViewController;
+	NSMutableDictionary* first = person( @"B", @"" );
+	NSMutableDictionary* second = person( @"B", @"" );
+	controller.objects = @[ person( @"C", @"" ), first ];
+	
+	// Equal sort values keep the order the objects were added in.
+	[ controller insertObject: second ];
+	[ controller insertObject: person( @"A", @"" ) ];
+	XCTAssertEqual( vc.numberOfItems, 4 );
+	XCTAssertEqualObjects( [ vc indexPathForItem: [ controller itemForObject: first ] ],
+			[ NSIndexPath indexPathForRow: 1 inSection: 0 ] );
+	XCTAssertEqualObjects( [ vc indexPathForItem: [ controller itemForObject: second ] ],
+			[ NSIndexPath indexPathForRow: 2 inSection: 0 ] );
+	
+	first[ @"name" ] = @"D";
+	[ controller objectDidChange: first ];
+	XCTAssertEqualObjects( [ vc indexPathForItem: [ controller itemForObject: first ] ],
+			[ NSIndexPath indexPathForRow: 3 inSection: 0 ] );
+	XCTAssertEqual( controller.objects.lastObject, first );
+	
+	controller.ascending = NO;
+	XCTAssertEqual( controller.objects.firstObject, first );
+	XCTAssertEqual( [ vc.tableView numberOfRowsInSection: 0 ], 4 );
+	
+	[ controller removeObject: first ];
+	[ controller removeObject: first ];
+	XCTAssertEqual( vc.numberOfItems, 3 );
+}
+
+//------------------------------------------------------------------------------
+
+@end
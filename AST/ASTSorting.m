@@ -0,0 +1,61 @@
+//==============================================================================
+//
+//  ASTSorting.m
+//
+//==============================================================================
+//
+//  Copyright (c) 2016 Adobe Systems Incorporated. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a
+//  copy of this software and associated documentation files (the "Software"),
+//  to deal in the Software without restriction, including without limitation
+//  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//  and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//
+//==============================================================================
+
+#import "ASTSorting.h"
+
+
+//------------------------------------------------------------------------------
+
+NSArray* sortArray( NSArray* indexArray, NSString* key, BOOL ascending )
+{
+	NSSortDescriptor* descriptor = [ NSSortDescriptor
+			sortDescriptorWithKey: key
+			ascending: ascending ];
+	return [ indexArray sortedArrayUsingDescriptors: @[ descriptor ] ];
+}
+
+//------------------------------------------------------------------------------
+
+NSArray* sortIndexesOfArray( NSArray* array, NSString* key, BOOL ascending )
+{
+	NSSortDescriptor* descriptor = [ NSSortDescriptor
+			sortDescriptorWithKey: key
+			ascending: ascending ];
+	NSMutableArray* result = [ NSMutableArray arrayWithCapacity: array.count ];
+	for( NSUInteger i = 0; i < array.count; ++i ) {
+		[ result addObject: @(i) ];
+	}
+	
+	[ result sortUsingComparator: ^NSComparisonResult( id index1, id index2 ) {
+		id value1 = array[ [ index1 unsignedIntegerValue ] ];
+		id value2 = array[ [ index2 unsignedIntegerValue ] ];
+		return [ descriptor compareObject: value1 toObject: value2 ];
+	} ];
+	
+	return [ result copy ];
+}
@@ -30,6 +30,7 @@
 #import "ASTSection.h"
 
 #import "ASTTextFieldItem.h"
+#import "ASTPerformanceMetrics.h"
 
 
 //------------------------------------------------------------------------------
@@ -39,6 +40,7 @@
 
 NSString* const AST_id = @"id";
 NSString* const AST_itemClass = @"type";
+NSString* const AST_template = @"template";
 NSString* const AST_cellClass = @"cellClass";
 NSString* const AST_cellStyle = @"cellStyle";
 NSString* const AST_cellReuseIdentifier = @"cellReuseIdentifier";
@@ -54,8 +56,11 @@ NSString* const AST_targetTableViewController = @"AST_targetTableViewController"
 NSString* const AST_targetResponderChain = @"responderChain";
 
 NSString* const AST_prefKey = @"prefKey";
+NSString* const AST_prefStore = @"prefStore";
 
 NSString* const AST_minimumHeight = @"minimumHeight";
+NSString* const AST_valueDelivery = @"valueDelivery";
+NSString* const AST_valueDeliveryInterval = @"valueDeliveryInterval";
 
 NSString* const AST_representedObject = @"representedObject";
 
@@ -87,6 +92,7 @@ NSString* const AST_cell_imageView_image = @"cellProperties.imageView.image";
 NSString* const AST_cell_imageView_imageName = @"cellProperties.imageView.imageName";
 NSString* const AST_cell_imageView_highlightedImage = @"cellProperties.imageView.highlightedImage";
 NSString* const AST_cell_imageView_highlightedImageName = @"cellProperties.imageView.highlightedImageName";
+NSString* const AST_cell_imageView_imageURL = @"cellProperties.imageView.imageURL";
 
 //------------------------------------------------------------------------------
 
@@ -95,6 +101,7 @@ NSString* const AST_footerText = @"footerText";
 NSString* const AST_headerView = @"headerView";
 NSString* const AST_footerView = @"footerView";
 NSString* const AST_items = @"items";
+NSString* const AST_lazyItems = @"lazyItems";
 
 //------------------------------------------------------------------------------
 
@@ -168,3 +175,20 @@ NSString* const AST_defaultValue = @"defaultValue";
 NSString* const AST_values = @"values";
 NSString* const AST_presentation = @"presentation";
 
+
+//------------------------------------------------------------------------------
+
+NSString* const ASTDataErrorDomain = @"ASTDataErrorDomain";
+NSString* const ASTDataExceptionKey = @"exception";
+
+//------------------------------------------------------------------------------
+
+NSString* const ASTPerformanceOperationSetData = @"setData";
+NSString* const ASTPerformanceOperationSetItems = @"setItems";
+NSString* const ASTPerformanceOperationBuildItem = @"buildItem";
+NSString* const ASTPerformanceOperationLoadCell = @"loadCell";
+NSString* const ASTPerformanceOperationApplyCellProperties = @"applyCellProperties";
+NSString* const ASTPerformanceOperationCellForRow = @"cellForRow";
+NSString* const ASTPerformanceOperationMeasureSectionView = @"measureSectionView";
+NSString* const ASTPerformanceOperationIndexPathForItem = @"indexPathForItem";
+NSString* const ASTPerformanceOperationBatchUpdate = @"batchUpdate";
@@ -51,6 +51,25 @@
 
 //------------------------------------------------------------------------------
 
+- (BOOL) updateWithDict: (NSDictionary*) dict
+{
+	NSMutableDictionary* itemDict = [ dict mutableCopy ];
+	[ itemDict removeObjectsForKeys: @[
+		AST_switchActionKey,
+		AST_switchTargetKey,
+	] ];
+	if( [ super updateWithDict: itemDict ] == NO ) {
+		return NO;
+	}
+	
+	[ self setValue: dict[ AST_switchActionKey ] forKey: AST_switchActionKey ];
+	self.switchTarget = dict[ AST_switchTargetKey ];
+	
+	return YES;
+}
+
+//------------------------------------------------------------------------------
+
 - (void) loadCell
 {
 	[ super loadCell ];
@@ -60,11 +79,23 @@
 		[ switchCell.itemSwitch addTarget: self
 				action: @selector(switchValueChangedAction:)
 				forControlEvents: UIControlEventValueChanged ];
-		// Note that we never remove the target/action for the slider. Since we
-		// own the slider and the control holds the target weakly and controls
-		// auto release and/or don't care if the target/action is removed it
-		// would seem to be unnecessary.
+		// The target/action is removed in unloadCell so that a reused cell
+		// does not send actions to the item that previously owned it.
+	}
+}
+
+//------------------------------------------------------------------------------
+
+- (void) unloadCell
+{
+	if( self.cellLoaded ) {
+		ASTSwitchItemCell* switchCell = (ASTSwitchItemCell*)self.cell;
+		[ switchCell.itemSwitch removeTarget: self
+				action: @selector(switchValueChangedAction:)
+				forControlEvents: UIControlEventValueChanged ];
 	}
+	
+	[ super unloadCell ];
 }
 
 //------------------------------------------------------------------------------
@@ -73,7 +104,17 @@
 {
 	ASTSwitchItemCell* switchCell = (ASTSwitchItemCell*)self.cell;
 	[ self setCellPropertiesValue: @(switchCell.itemSwitch.on) forKeyPath: AST_cell_switch_on ];
-	
+	[ self valueDidChange ];
+	// The switch is released by the time its value changes.
+	if( self.valueDelivery == ASTValueDeliveryOnCommit ) {
+		[ self commitValueChange ];
+	}
+}
+
+//------------------------------------------------------------------------------
+
+- (void) sendValueChange
+{
 	if( _switchAction ) {
 		[ self sendAction: _switchAction to: _switchTarget ];
 	}
@@ -0,0 +1,101 @@
+//==============================================================================
+//
+//  ASTTableDefinition.h
+//
+//==============================================================================
+//
+//  Copyright (c) 2016 Adobe Systems Incorporated. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a
+//  copy of this software and associated documentation files (the "Software"),
+//  to deal in the Software without restriction, including without limitation
+//  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//  and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//
+//==============================================================================
+
+#import <UIKit/UIKit.h>
+
+
+NS_ASSUME_NONNULL_BEGIN
+
+//------------------------------------------------------------------------------
+
+/// A table definition is the data of an ASTViewController stored in a compact
+/// binary file that is memory mapped when it is loaded. Only the sections are
+/// decoded when the data is loaded. The items of a section are decoded when
+/// they are first needed, see setNumberOfItems:itemProvider: in ASTSection.h.
+///
+/// The data may contain arrays, dictionaries with string keys, strings,
+/// numbers, NSData and NSNull, which covers plists and JSON. The keys and
+/// values that are AST_ string constants are stored as small integers and
+/// decoded to the constants themselves. Other strings are stored once per
+/// file and decoded once per table definition.
+///
+/// A table definition is not thread safe. It must only be used on the main
+/// thread once its data is installed in a table view controller.
+
+@interface ASTTableDefinition : NSObject
+
+/// Encodes the data of a table view controller in the table definition format.
+/// @param data An array of section or item dictionaries as accepted by the
+/// data property of ASTViewController.
+/// @param error Set to an error in the ASTDataErrorDomain if the data contains
+/// an unsupported value.
+/// @return The encoded data or nil if the data contains an unsupported value.
++ (nullable NSData*) dataWithTableData: (NSArray*) data
+		error: (NSError* __autoreleasing __nullable * __nullable) error;
+/// Encodes the data of a table view controller and writes it to a file. Build
+/// scripts can use this to convert plists to table definitions.
+/// @param data An array of section or item dictionaries.
+/// @param url The URL of the file to write.
+/// @param error Set to an error if the data could not be encoded or written.
+/// @return YES if the file was written.
++ (BOOL) writeTableData: (NSArray*) data toURL: (NSURL*) url
+		error: (NSError* __autoreleasing __nullable * __nullable) error;
+
+/// Loads a table definition by memory mapping a file.
+/// @param url The URL of a file written by writeTableData:toURL:error:.
+/// @param error Set to an error if the file could not be read or is invalid.
+/// @return A new ASTTableDefinition or nil if the file could not be loaded.
+- (nullable instancetype) initWithContentsOfURL: (NSURL*) url
+		error: (NSError* __autoreleasing __nullable * __nullable) error;
+/// Loads a table definition from encoded data. All of the values are checked,
+/// so that decoding them later can not fail.
+/// @param data Data returned by dataWithTableData:error:. It is not copied.
+/// @param error Set to an error in the ASTDataErrorDomain if the data is
+/// invalid.
+/// @return A new ASTTableDefinition or nil if the data is invalid.
+- (nullable instancetype) initWithData: (NSData*) data
+		error: (NSError* __autoreleasing __nullable * __nullable) error
+		NS_DESIGNATED_INITIALIZER;
+- (instancetype) init NS_UNAVAILABLE;
+
+/// Returns the data for a table view controller with the style. For the
+/// grouped style, the result holds an ASTSection for each section dictionary
+/// whose items are decoded when needed. For the plain style, it holds the
+/// decoded item dictionaries.
+/// @param style The style of the table view the data is installed in.
+/// @return The data to set on an ASTViewController.
+- (NSArray*) dataForStyle: (UITableViewStyle) style;
+
+/// Decodes all of the data, giving the same arrays and dictionaries that were
+/// encoded.
+/// @return The decoded data.
+- (NSArray*) decodedData;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,824 @@
+//==============================================================================
+//
+//  ASTTableDefinition.m
+//
+//==============================================================================
+//
+//  Copyright (c) 2016 Adobe Systems Incorporated. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a
+//  copy of this software and associated documentation files (the "Software"),
+//  to deal in the Software without restriction, including without limitation
+//  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//  and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//
+//==============================================================================
+
+#import "ASTTableDefinition.h"
+
+#import "ASTViewController.h"
+#import "ASTItem.h"
+#import "ASTSection.h"
+#import "ASTMultiValueItem.h"
+#import "ASTMultiValuePrefItem.h"
+#import "ASTPrefGroupItem.h"
+#import "ASTPrefSwitchItem.h"
+#import "ASTSliderItem.h"
+#import "ASTSwitchItem.h"
+#import "ASTTextFieldItem.h"
+#import "ASTTextViewItem.h"
+
+
+//------------------------------------------------------------------------------
+// A table definition file starts with a header, followed by the string table
+// and the values. All numbers are stored in the byte order of the devices the
+// framework runs on, which is little endian.
+//
+// The string table has an offset and a length for each string, relative to the
+// UTF-8 bytes of the strings that follow them.
+//
+// Each value starts with its type byte. Arrays and dictionaries refer to their
+// elements by offset, so that an element can be decoded without decoding the
+// others, and are written after their elements, so that decoding a damaged
+// file can not loop. Strings are referred to by their index in the string
+// table or, with the high bit set, by their index in knownStrings().
+
+static const char ASTTableDefinitionMagic[ 4 ] = { 'A', 'S', 'T', 'D' };
+static const uint32_t ASTTableDefinitionVersion = 1;
+static const uint32_t ASTKnownStringFlag = 0x80000000;
+
+typedef struct {
+	char magic[ 4 ];
+	uint32_t version;
+	// The number of known strings when the file was written.
+	uint32_t knownStringCount;
+	uint32_t stringCount;
+	uint32_t stringTableOffset;
+	uint32_t valuesOffset;
+	uint32_t valuesLength;
+	// The offset of the root array from the start of the values.
+	uint32_t rootOffset;
+} ASTTableDefinitionHeader;
+
+typedef struct {
+	uint32_t offset;
+	uint32_t length;
+} ASTStringTableEntry;
+
+typedef NS_ENUM( uint8_t, ASTValueType ) {
+	ASTValueTypeNull,
+	ASTValueTypeFalse,
+	ASTValueTypeTrue,
+	// Followed by an int64_t.
+	ASTValueTypeInteger,
+	// Followed by a double.
+	ASTValueTypeDouble,
+	// Followed by a string reference.
+	ASTValueTypeString,
+	// Followed by the length and the bytes.
+	ASTValueTypeData,
+	// Followed by the count and the offsets of the elements.
+	ASTValueTypeArray,
+	// Followed by the count, the string references of the keys and the offsets
+	// of the values.
+	ASTValueTypeDictionary,
+};
+
+// Raised for data that can not be encoded, and for damaged files, which
+// initWithData:error: reports as errors after checking all of their values.
+static NSString* const ASTTableDefinitionException = @"ASTTableDefinition invalid data";
+
+//------------------------------------------------------------------------------
+
+// Strings stored as their index in this array. Strings must only be added at
+// the end, so that files written before keep their meaning.
+
+static NSArray* knownStrings()
+{
+	static NSArray* result;
+	static dispatch_once_t onceToken;
+	dispatch_once( &onceToken, ^{
+		result = @[
+			AST_id, AST_itemClass, AST_cellClass, AST_cellStyle,
+			AST_cellReuseIdentifier, AST_selectable, AST_selectAction,
+			AST_selectActionTarget, AST_selectActionBlock, AST_deselectAutomatically,
+			AST_targetSelf, AST_targetTableViewController, AST_targetResponderChain,
+			AST_prefKey, AST_minimumHeight, AST_representedObject,
+			AST_cell_accessoryType, AST_cell_accessoryView, AST_cell_backgroundColor,
+			AST_cell_selectedBackgroundColor, AST_cell_indentationLevel,
+			AST_cell_indentationWidth, AST_cell_textLabel_text,
+			AST_cell_textLabel_textAlignment, AST_cell_textLabel_textColor,
+			AST_cell_textLabel_highlightedTextColor, AST_cell_textLabel_font,
+			AST_cell_detailTextLabel_text, AST_cell_detailTextLabel_textColor,
+			AST_cell_detailTextLabel_highlightedTextColor,
+			AST_cell_detailTextLabel_font, AST_cell_imageView_image,
+			AST_cell_imageView_imageName, AST_cell_imageView_highlightedImage,
+			AST_cell_imageView_highlightedImageName,
+			AST_headerText, AST_footerText, AST_headerView, AST_footerView,
+			AST_items, AST_lazyItems,
+			AST_textFieldValueActionKey, AST_textFieldValueTargetKey,
+			AST_textFieldReturnKeyActionKey, AST_textFieldReturnKeyTargetKey,
+			AST_cell_textInput_text, AST_cell_textInput_font,
+			AST_cell_textInput_placeholder, AST_cell_textInput_placeholderColor,
+			AST_cell_textInput_placeholderFont, AST_cell_textInput_clearButtonMode,
+			AST_cell_textInput_returnKeyType, AST_cell_textInput_keyboardType,
+			AST_cell_textInput_secureTextEntry,
+			AST_cell_textInput_autocapitalizationType,
+			AST_cell_textInput_autocorrectionType, AST_cell_textInput_delegate,
+			AST_textViewValueActionKey, AST_textViewValueTargetKey,
+			AST_textViewReturnKeyActionKey, AST_textViewReturnKeyTargetKey,
+			AST_cell_textInput_minHeightInLines, AST_cell_textInput_maxHeightInLines,
+			AST_sliderActionKey, AST_sliderTargetKey, AST_cell_slider_value,
+			AST_cell_slider_minimumValue, AST_cell_slider_maximumValue,
+			AST_cell_slider_minimumValueImage, AST_cell_slider_minimumValueImageName,
+			AST_cell_slider_maximumValueImage, AST_cell_slider_maximumValueImageName,
+			AST_cell_slider_continuous, AST_cell_slider_minimumTrackTintColor,
+			AST_cell_slider_maximumTrackTintColor, AST_cell_slider_thumbTintColor,
+			AST_cell_slider_label_text,
+			AST_switchActionKey, AST_switchTargetKey, AST_cell_switch_on,
+			AST_cell_switch_onTintColor, AST_cell_switch_tintColor,
+			AST_cell_switch_thumbTintColor,
+			AST_prefDefaultValue, AST_prefOnValue, AST_prefOffValue,
+			AST_itemIsDefault, AST_itemPrefValue,
+			AST_title, AST_value, AST_defaultValue, AST_values, AST_presentation,
+			AST_template,
+		];
+	} );
+	return result;
+}
+
+//------------------------------------------------------------------------------
+
+static inline uint32_t readUInt32( const uint8_t* bytes )
+{
+	uint32_t result;
+	memcpy( &result, bytes, sizeof( result ) );
+	return result;
+}
+
+//------------------------------------------------------------------------------
+
+static NSError* tableDefinitionError( ASTDataError code, NSString* description )
+{
+	return [ NSError errorWithDomain: ASTDataErrorDomain code: code
+			userInfo: @{ NSLocalizedDescriptionKey : description } ];
+}
+
+//------------------------------------------------------------------------------
+
+@interface ASTTableDefinitionEncoder : NSObject {
+	NSMutableData* _values;
+	NSMutableArray* _strings;
+	NSMutableDictionary* _stringReferences;
+}
+
+- (NSData*) encodeTableData: (NSArray*) data;
+
+@end
+
+//------------------------------------------------------------------------------
+
+@implementation ASTTableDefinitionEncoder
+
+//------------------------------------------------------------------------------
+
+- (instancetype) init
+{
+	self = [ super init ];
+	if( self ) {
+		_values = [ NSMutableData data ];
+		_strings = [ NSMutableArray array ];
+		_stringReferences = [ NSMutableDictionary dictionary ];
+		NSArray* strings = knownStrings();
+		for( uint32_t i = 0; i < strings.count; ++i ) {
+			_stringReferences[ strings[ i ] ] = @(i | ASTKnownStringFlag);
+		}
+	}
+	return self;
+}
+
+//------------------------------------------------------------------------------
+
+- (NSData*) encodeTableData: (NSArray*) data
+{
+	// NSNull sections and items are skipped by the table view controller, so
+	// they are left out.
+	NSMutableArray* rootObjects = [ NSMutableArray arrayWithCapacity: data.count ];
+	for( id object in data ) {
+		if( [ object isKindOfClass: [ NSDictionary class ] ]
+				&& [ object[ AST_items ] isKindOfClass: [ NSArray class ] ] ) {
+			NSMutableDictionary* sectionDict = [ object mutableCopy ];
+			NSMutableArray* items = [ sectionDict[ AST_items ] mutableCopy ];
+			[ items removeObjectIdenticalTo: [ NSNull null ] ];
+			sectionDict[ AST_items ] = items;
+			[ rootObjects addObject: sectionDict ];
+		} else if( object != [ NSNull null ] ) {
+			[ rootObjects addObject: object ];
+		}
+	}
+	uint32_t rootOffset = [ self encodeValue: rootObjects ];
+	
+	NSMutableData* stringBytes = [ NSMutableData data ];
+	NSMutableData* stringTable = [ NSMutableData dataWithCapacity:
+			_strings.count * sizeof( ASTStringTableEntry ) ];
+	for( NSString* string in _strings ) {
+		NSData* utf8 = [ string dataUsingEncoding: NSUTF8StringEncoding ];
+		ASTStringTableEntry entry = { (uint32_t)stringBytes.length, (uint32_t)utf8.length };
+		[ stringTable appendBytes: &entry length: sizeof( entry ) ];
+		[ stringBytes appendData: utf8 ];
+	}
+	
+	ASTTableDefinitionHeader header = { { 0 } };
+	memcpy( header.magic, ASTTableDefinitionMagic, sizeof( header.magic ) );
+	header.version = ASTTableDefinitionVersion;
+	header.knownStringCount = (uint32_t)knownStrings().count;
+	header.stringCount = (uint32_t)_strings.count;
+	header.stringTableOffset = sizeof( header );
+	header.valuesOffset = (uint32_t)(sizeof( header ) + stringTable.length + stringBytes.length);
+	header.valuesLength = (uint32_t)_values.length;
+	header.rootOffset = rootOffset;
+	if( (uint64_t)header.valuesOffset + _values.length > UINT32_MAX ) {
+		[ NSException raise: ASTTableDefinitionException
+				format: @"The table data is too large" ];
+	}
+	
+	NSMutableData* result = [ NSMutableData dataWithBytes: &header length: sizeof( header ) ];
+	[ result appendData: stringTable ];
+	[ result appendData: stringBytes ];
+	[ result appendData: _values ];
+	return result;
+}
+
+//------------------------------------------------------------------------------
+
+- (uint32_t) referenceOfString: (NSString*) string
+{
+	NSNumber* reference = _stringReferences[ string ];
+	if( reference == nil ) {
+		reference = @((uint32_t)_strings.count);
+		[ _strings addObject: [ string copy ] ];
+		_stringReferences[ string ] = reference;
+	}
+	return [ reference unsignedIntValue ];
+}
+
+//------------------------------------------------------------------------------
+
+- (uint32_t) encodeValue: (id) value
+{
+	// Elements are written before their container, which needs their offsets.
+	NSMutableData* elements = nil;
+	ASTValueType type;
+	if( value == [ NSNull null ] ) {
+		type = ASTValueTypeNull;
+	} else if( [ value isKindOfClass: [ @YES class ] ] ) {
+		type = [ value boolValue ] ? ASTValueTypeTrue : ASTValueTypeFalse;
+	} else if( [ value isKindOfClass: [ NSNumber class ] ] ) {
+		const char* objCType = [ value objCType ];
+		type = strcmp( objCType, @encode( double ) ) == 0 || strcmp( objCType, @encode( float ) ) == 0
+				? ASTValueTypeDouble : ASTValueTypeInteger;
+	} else if( [ value isKindOfClass: [ NSString class ] ] ) {
+		type = ASTValueTypeString;
+	} else if( [ value isKindOfClass: [ NSData class ] ] ) {
+		type = ASTValueTypeData;
+	} else if( [ value isKindOfClass: [ NSArray class ] ] ) {
+		type = ASTValueTypeArray;
+		elements = [ NSMutableData dataWithCapacity: [ value count ] * sizeof( uint32_t ) ];
+		for( id element in value ) {
+			uint32_t offset = [ self encodeValue: element ];
+			[ elements appendBytes: &offset length: sizeof( offset ) ];
+		}
+	} else if( [ value isKindOfClass: [ NSDictionary class ] ] ) {
+		type = ASTValueTypeDictionary;
+		NSMutableData* valueOffsets = [ NSMutableData data ];
+		elements = [ NSMutableData data ];
+		for( id key in value ) {
+			if( [ key isKindOfClass: [ NSString class ] ] == NO ) {
+				[ NSException raise: ASTTableDefinitionException
+						format: @"The dictionary key %@ is not a string", key ];
+			}
+			uint32_t keyReference = [ self referenceOfString: key ];
+			uint32_t offset = [ self encodeValue: value[ key ] ];
+			[ elements appendBytes: &keyReference length: sizeof( keyReference ) ];
+			[ valueOffsets appendBytes: &offset length: sizeof( offset ) ];
+		}
+		[ elements appendData: valueOffsets ];
+	} else {
+		[ NSException raise: ASTTableDefinitionException
+				format: @"The value %@ can not be stored in a table definition", value ];
+		return 0;
+	}
+	
+	uint32_t result = (uint32_t)_values.length;
+	[ _values appendBytes: &type length: sizeof( type ) ];
+	switch( type ) {
+		case ASTValueTypeInteger: {
+			int64_t number = [ value longLongValue ];
+			[ _values appendBytes: &number length: sizeof( number ) ];
+			break;
+		}
+		case ASTValueTypeDouble: {
+			double number = [ value doubleValue ];
+			[ _values appendBytes: &number length: sizeof( number ) ];
+			break;
+		}
+		case ASTValueTypeString: {
+			uint32_t reference = [ self referenceOfString: value ];
+			[ _values appendBytes: &reference length: sizeof( reference ) ];
+			break;
+		}
+		case ASTValueTypeData: {
+			uint32_t length = (uint32_t)[ value length ];
+			[ _values appendBytes: &length length: sizeof( length ) ];
+			[ _values appendData: value ];
+			break;
+		}
+		case ASTValueTypeArray:
+		case ASTValueTypeDictionary: {
+			uint32_t count = (uint32_t)[ value count ];
+			[ _values appendBytes: &count length: sizeof( count ) ];
+			[ _values appendData: elements ];
+			break;
+		}
+		default:
+			break;
+	}
+	return result;
+}
+
+//------------------------------------------------------------------------------
+
+@end
+
+//------------------------------------------------------------------------------
+
+@interface ASTTableDefinition() {
+	NSData* _data;
+	const uint8_t* _values;
+	uint32_t _valuesLength;
+	uint32_t _rootOffset;
+	const uint8_t* _stringTable;
+	const uint8_t* _stringBytes;
+	uint32_t _stringBytesLength;
+	uint32_t _stringCount;
+	// The strings decoded so far, NSNull for the others.
+	NSMutableArray* _strings;
+	// Classes resolved for AST_itemClass and AST_cellClass values, by string
+	// reference.
+	NSMutableDictionary* _classes;
+}
+
+@end
+
+//------------------------------------------------------------------------------
+
+@implementation ASTTableDefinition
+
+//------------------------------------------------------------------------------
+
++ (NSData*) dataWithTableData: (NSArray*) data error: (NSError**) error
+{
+	@try {
+		return [ [ [ ASTTableDefinitionEncoder alloc ] init ] encodeTableData: data ];
+	} @catch( NSException* exception ) {
+		if( [ exception.name isEqualToString: ASTTableDefinitionException ] == NO ) {
+			@throw;
+		}
+		if( error ) {
+			*error = tableDefinitionError( ASTDataErrorUnsupportedValue, exception.reason );
+		}
+		return nil;
+	}
+}
+
+//------------------------------------------------------------------------------
+
++ (BOOL) writeTableData: (NSArray*) data toURL: (NSURL*) url error: (NSError**) error
+{
+	NSData* encodedData = [ self dataWithTableData: data error: error ];
+	return [ encodedData writeToURL: url options: NSDataWritingAtomic error: error ];
+}
+
+//------------------------------------------------------------------------------
+
+- (instancetype) initWithContentsOfURL: (NSURL*) url error: (NSError**) error
+{
+	// Mapping the file means that only the pages of the rows that are decoded
+	// are read.
+	NSData* data = [ NSData dataWithContentsOfURL: url
+			options: NSDataReadingMappedAlways error: error ];
+	if( data == nil ) {
+		return nil;
+	}
+	return [ self initWithData: data error: error ];
+}
+
+//------------------------------------------------------------------------------
+
+- (instancetype) initWithData: (NSData*) data error: (NSError**) error
+{
+	self = [ super init ];
+	if( self ) {
+		ASTTableDefinitionHeader header;
+		if( data.length < sizeof( header ) ) {
+			if( error ) {
+				*error = tableDefinitionError( ASTDataErrorInvalidTableDefinition,
+						@"The table definition is too short" );
+			}
+			return nil;
+		}
+		memcpy( &header, data.bytes, sizeof( header ) );
+		
+		const uint8_t* bytes = data.bytes;
+		uint64_t stringTableEnd = (uint64_t)header.stringTableOffset
+				+ (uint64_t)header.stringCount * sizeof( ASTStringTableEntry );
+		uint64_t valuesEnd = (uint64_t)header.valuesOffset + header.valuesLength;
+		NSString* problem = nil;
+		if( memcmp( header.magic, ASTTableDefinitionMagic, sizeof( header.magic ) ) != 0 ) {
+			problem = @"The data is not a table definition";
+		} else if( header.version != ASTTableDefinitionVersion
+				|| header.knownStringCount > knownStrings().count ) {
+			problem = @"The table definition was written by a newer version";
+		} else if( header.stringTableOffset < sizeof( header )
+				|| stringTableEnd > header.valuesOffset || valuesEnd > data.length
+				|| header.rootOffset >= header.valuesLength
+				|| bytes[ header.valuesOffset + header.rootOffset ] != ASTValueTypeArray ) {
+			problem = @"The table definition is damaged";
+		}
+		if( problem ) {
+			if( error ) {
+				*error = tableDefinitionError( ASTDataErrorInvalidTableDefinition, problem );
+			}
+			return nil;
+		}
+		
+		_data = data;
+		_values = bytes + header.valuesOffset;
+		_valuesLength = header.valuesLength;
+		_rootOffset = header.rootOffset;
+		_stringTable = bytes + header.stringTableOffset;
+		_stringBytes = bytes + stringTableEnd;
+		_stringBytesLength = (uint32_t)(header.valuesOffset - stringTableEnd);
+		_stringCount = header.stringCount;
+		_strings = [ NSMutableArray arrayWithCapacity: _stringCount ];
+		for( uint32_t i = 0; i < _stringCount; ++i ) {
+			[ _strings addObject: [ NSNull null ] ];
+		}
+		_classes = [ NSMutableDictionary dictionary ];
+		
+		// Everything is checked once here so that decoding the items later,
+		// while the table view scrolls, can not fail.
+		@try {
+			[ self validateStrings ];
+			[ self validateValues ];
+		} @catch( NSException* exception ) {
+			if( [ exception.name isEqualToString: ASTTableDefinitionException ] == NO ) {
+				@throw;
+			}
+			if( error ) {
+				*error = tableDefinitionError( ASTDataErrorInvalidTableDefinition,
+						exception.reason );
+			}
+			return nil;
+		}
+	}
+	return self;
+}
+
+//------------------------------------------------------------------------------
+
+- (void) validateStrings
+{
+	for( uint32_t reference = 0; reference < _stringCount; ++reference ) {
+		ASTStringTableEntry entry;
+		memcpy( &entry, _stringTable + reference * sizeof( entry ), sizeof( entry ) );
+		NSString* string = nil;
+		if( (uint64_t)entry.offset + entry.length <= _stringBytesLength ) {
+			string = [ [ NSString alloc ] initWithBytesNoCopy: (void*)(_stringBytes + entry.offset)
+					length: entry.length encoding: NSUTF8StringEncoding freeWhenDone: NO ];
+		}
+		if( string == nil ) {
+			[ NSException raise: ASTTableDefinitionException
+					format: @"The table definition has a damaged string %u", reference ];
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+
+// Walks the values reachable from the root without recursion, since a damaged
+// file could nest them deeply, checking each value once even if it is shared.
+
+- (void) validateValues
+{
+	NSMutableIndexSet* validatedOffsets = [ NSMutableIndexSet indexSetWithIndex: _rootOffset ];
+	NSMutableData* pendingOffsets = [ NSMutableData dataWithBytes: &_rootOffset
+			length: sizeof( _rootOffset ) ];
+	while( pendingOffsets.length ) {
+		uint32_t offset;
+		memcpy( &offset, (const uint8_t*)pendingOffsets.bytes + pendingOffsets.length - sizeof( offset ),
+				sizeof( offset ) );
+		pendingOffsets.length -= sizeof( offset );
+		
+		ASTValueType type = [ self typeAtOffset: offset ];
+		switch( type ) {
+			case ASTValueTypeNull:
+			case ASTValueTypeFalse:
+			case ASTValueTypeTrue:
+				break;
+			case ASTValueTypeInteger:
+			case ASTValueTypeDouble:
+				[ self bytesAtOffset: (uint64_t)offset + 1 length: 8 ];
+				break;
+			case ASTValueTypeString:
+				[ self validateStringReference: readUInt32(
+						[ self bytesAtOffset: (uint64_t)offset + 1 length: 4 ] ) ];
+				break;
+			case ASTValueTypeData:
+				[ self bytesAtOffset: (uint64_t)offset + 5 length: [ self countAtOffset: offset ] ];
+				break;
+			case ASTValueTypeArray:
+			case ASTValueTypeDictionary: {
+				uint32_t count = [ self countAtOffset: offset ];
+				uint32_t firstElementIndex = 0;
+				if( type == ASTValueTypeDictionary ) {
+					const uint8_t* keyReferences = [ self bytesAtOffset: (uint64_t)offset + 5
+							length: (uint64_t)count * 8 ];
+					for( uint32_t i = 0; i < count; ++i ) {
+						[ self validateStringReference: readUInt32( keyReferences + i * 4 ) ];
+					}
+					firstElementIndex = count;
+				} else {
+					[ self bytesAtOffset: (uint64_t)offset + 5 length: (uint64_t)count * 4 ];
+				}
+				for( uint32_t i = 0; i < count; ++i ) {
+					uint32_t elementOffset = [ self elementOffsetAtIndex: firstElementIndex + i
+							ofArrayAtOffset: offset ];
+					if( [ validatedOffsets containsIndex: elementOffset ] == NO ) {
+						[ validatedOffsets addIndex: elementOffset ];
+						[ pendingOffsets appendBytes: &elementOffset length: sizeof( elementOffset ) ];
+					}
+				}
+				break;
+			}
+			default:
+				[ NSException raise: ASTTableDefinitionException
+						format: @"The table definition has an unknown value type %u", type ];
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+
+- (void) validateStringReference: (uint32_t) reference
+{
+	uint32_t index = reference & ~ASTKnownStringFlag;
+	uint32_t count = reference & ASTKnownStringFlag ? (uint32_t)knownStrings().count : _stringCount;
+	if( index >= count ) {
+		[ NSException raise: ASTTableDefinitionException
+				format: @"The table definition has an unknown string %u", index ];
+	}
+}
+
+//------------------------------------------------------------------------------
+
+- (NSArray*) dataForStyle: (UITableViewStyle) style
+{
+	if( style != UITableViewStyleGrouped ) {
+		return [ self valueAtOffset: _rootOffset resolvingClasses: YES ];
+	}
+	
+	uint32_t count = [ self countAtOffset: _rootOffset ];
+	NSMutableArray* result = [ NSMutableArray arrayWithCapacity: count ];
+	for( uint32_t i = 0; i < count; ++i ) {
+		uint32_t offset = [ self elementOffsetAtIndex: i ofArrayAtOffset: _rootOffset ];
+		if( [ self typeAtOffset: offset ] != ASTValueTypeDictionary ) {
+			[ result addObject: [ self valueAtOffset: offset resolvingClasses: YES ] ];
+			continue;
+		}
+		
+		NSMutableDictionary* sectionDict = [ NSMutableDictionary dictionary ];
+		uint32_t itemsOffset = 0;
+		BOOL hasItems = NO;
+		uint32_t keyCount = [ self countAtOffset: offset ];
+		const uint8_t* keyReferences = [ self bytesAtOffset: (uint64_t)offset + 5
+				length: (uint64_t)keyCount * 8 ];
+		for( uint32_t keyIndex = 0; keyIndex < keyCount; ++keyIndex ) {
+			NSString* key = [ self stringWithReference: readUInt32(
+					keyReferences + keyIndex * 4 ) ];
+			uint32_t valueOffset = [ self elementOffsetAtIndex: keyCount + keyIndex
+					ofArrayAtOffset: offset ];
+			// Known strings decode to the constants, so they can be compared
+			// by pointer.
+			if( key == AST_items && [ self typeAtOffset: valueOffset ] == ASTValueTypeArray ) {
+				itemsOffset = valueOffset;
+				hasItems = YES;
+			} else {
+				sectionDict[ key ] = [ self valueAtOffset: valueOffset resolvingClasses: YES ];
+			}
+		}
+		
+		ASTSection* section = [ ASTSection sectionWithDict: sectionDict ];
+		if( hasItems ) {
+			// The provider keeps the table definition, and with it the mapped
+			// file, alive as long as the section.
+			[ section setNumberOfItems: [ self countAtOffset: itemsOffset ]
+					itemProvider: ^id( NSUInteger index ) {
+				uint32_t itemOffset = [ self elementOffsetAtIndex: (uint32_t)index
+						ofArrayAtOffset: itemsOffset ];
+				return [ self valueAtOffset: itemOffset resolvingClasses: YES ];
+			} ];
+		}
+		[ result addObject: section ];
+	}
+	return result;
+}
+
+//------------------------------------------------------------------------------
+
+- (NSArray*) decodedData
+{
+	return [ self valueAtOffset: _rootOffset resolvingClasses: NO ];
+}
+
+//------------------------------------------------------------------------------
+
+- (const uint8_t*) bytesAtOffset: (uint64_t) offset length: (uint64_t) length
+{
+	if( offset + length > _valuesLength ) {
+		[ NSException raise: ASTTableDefinitionException
+				format: @"The table definition is damaged at offset %llu", offset ];
+	}
+	return _values + offset;
+}
+
+//------------------------------------------------------------------------------
+
+- (ASTValueType) typeAtOffset: (uint32_t) offset
+{
+	return *[ self bytesAtOffset: offset length: 1 ];
+}
+
+//------------------------------------------------------------------------------
+
+- (uint32_t) countAtOffset: (uint32_t) offset
+{
+	return readUInt32( [ self bytesAtOffset: (uint64_t)offset + 1 length: 4 ] );
+}
+
+//------------------------------------------------------------------------------
+
+// Returns the offset of an element of an array or, for dictionaries, of a key
+// reference followed by a value offset.
+
+- (uint32_t) elementOffsetAtIndex: (uint32_t) index ofArrayAtOffset: (uint32_t) offset
+{
+	uint32_t result = readUInt32( [ self bytesAtOffset: (uint64_t)offset + 5 + (uint64_t)index * 4
+			length: 4 ] );
+	if( result >= offset ) {
+		[ NSException raise: ASTTableDefinitionException
+				format: @"The table definition is damaged at offset %u", offset ];
+	}
+	return result;
+}
+
+//------------------------------------------------------------------------------
+
+- (NSString*) stringWithReference: (uint32_t) reference
+{
+	if( reference & ASTKnownStringFlag ) {
+		NSArray* strings = knownStrings();
+		uint32_t index = reference & ~ASTKnownStringFlag;
+		if( index >= strings.count ) {
+			[ NSException raise: ASTTableDefinitionException
+					format: @"The table definition has an unknown string %u", index ];
+		}
+		return strings[ index ];
+	}
+	
+	if( reference >= _stringCount ) {
+		[ NSException raise: ASTTableDefinitionException
+				format: @"The table definition has an unknown string %u", reference ];
+	}
+	NSString* result = _strings[ reference ];
+	if( result == (id)[ NSNull null ] ) {
+		ASTStringTableEntry entry;
+		memcpy( &entry, _stringTable + reference * sizeof( entry ), sizeof( entry ) );
+		if( (uint64_t)entry.offset + entry.length <= _stringBytesLength ) {
+			result = [ [ NSString alloc ] initWithBytes: _stringBytes + entry.offset
+					length: entry.length encoding: NSUTF8StringEncoding ];
+		} else {
+			result = nil;
+		}
+		if( result == nil ) {
+			[ NSException raise: ASTTableDefinitionException
+					format: @"The table definition has a damaged string %u", reference ];
+		}
+		_strings[ reference ] = result;
+	}
+	return result;
+}
+
+//------------------------------------------------------------------------------
+
+- (id) valueAtOffset: (uint32_t) offset resolvingClasses: (BOOL) resolvingClasses
+{
+	ASTValueType type = [ self typeAtOffset: offset ];
+	const uint8_t* payload = _values + offset + 1;
+	switch( type ) {
+		case ASTValueTypeNull:
+			return [ NSNull null ];
+		case ASTValueTypeFalse:
+			return @NO;
+		case ASTValueTypeTrue:
+			return @YES;
+		case ASTValueTypeInteger: {
+			int64_t number;
+			memcpy( &number, [ self bytesAtOffset: (uint64_t)offset + 1 length: sizeof( number ) ],
+					sizeof( number ) );
+			return @(number);
+		}
+		case ASTValueTypeDouble: {
+			double number;
+			memcpy( &number, [ self bytesAtOffset: (uint64_t)offset + 1 length: sizeof( number ) ],
+					sizeof( number ) );
+			return @(number);
+		}
+		case ASTValueTypeString:
+			return [ self stringWithReference: readUInt32(
+					[ self bytesAtOffset: (uint64_t)offset + 1 length: 4 ] ) ];
+		case ASTValueTypeData: {
+			uint32_t length = [ self countAtOffset: offset ];
+			return [ NSData dataWithBytes: [ self bytesAtOffset: (uint64_t)offset + 5 length: length ]
+					length: length ];
+		}
+		case ASTValueTypeArray: {
+			uint32_t count = [ self countAtOffset: offset ];
+			[ self bytesAtOffset: (uint64_t)offset + 5 length: (uint64_t)count * 4 ];
+			NSMutableArray* result = [ NSMutableArray arrayWithCapacity: count ];
+			for( uint32_t i = 0; i < count; ++i ) {
+				[ result addObject: [ self valueAtOffset:
+						[ self elementOffsetAtIndex: i ofArrayAtOffset: offset ]
+						resolvingClasses: resolvingClasses ] ];
+			}
+			return result;
+		}
+		case ASTValueTypeDictionary: {
+			uint32_t count = [ self countAtOffset: offset ];
+			[ self bytesAtOffset: (uint64_t)offset + 5 length: (uint64_t)count * 8 ];
+			NSMutableDictionary* result = [ NSMutableDictionary dictionaryWithCapacity: count ];
+			for( uint32_t i = 0; i < count; ++i ) {
+				uint32_t keyReference = readUInt32( payload + 4 + i * 4 );
+				NSString* key = [ self stringWithReference: keyReference ];
+				uint32_t valueOffset = [ self elementOffsetAtIndex: count + i
+						ofArrayAtOffset: offset ];
+				id value = nil;
+				if( resolvingClasses && (key == AST_itemClass || key == AST_cellClass)
+						&& [ self typeAtOffset: valueOffset ] == ASTValueTypeString ) {
+					value = [ self classAtOffset: valueOffset ];
+				}
+				result[ key ] = value ?: [ self valueAtOffset: valueOffset
+						resolvingClasses: resolvingClasses ];
+			}
+			return result;
+		}
+	}
+	
+	[ NSException raise: ASTTableDefinitionException
+			format: @"The table definition has an unknown value type %u", type ];
+	return nil;
+}
+
+//------------------------------------------------------------------------------
+
+// Class names are looked up once per table definition rather than once per
+// item. Returns nil if there is no class with the name, so that the item
+// reports the name.
+
+- (Class) classAtOffset: (uint32_t) offset
+{
+	uint32_t reference = readUInt32( [ self bytesAtOffset: (uint64_t)offset + 1 length: 4 ] );
+	id result = _classes[ @(reference) ];
+	if( result == nil ) {
+		result = NSClassFromString( [ self stringWithReference: reference ] )
+				?: (id)[ NSNull null ];
+		_classes[ @(reference) ] = result;
+	}
+	return result != [ NSNull null ] ? result : nil;
+}
+
+//------------------------------------------------------------------------------
+
+@end
@@ -0,0 +1,239 @@
+//==============================================================================
+//
+//  ASTTableDefinitionTests.m
+//
+//==============================================================================
+//
+//  Copyright (c) 2016 Adobe Systems Incorporated. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a
+//  copy of this software and associated documentation files (the "Software"),
+//  to deal in the Software without restriction, including without limitation
+//  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//  and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//
+//==============================================================================
+
+#import <UIKit/UIKit.h>
+#import <XCTest/XCTest.h>
+#import "ASTTableDefinition.h"
+#import "ASTViewController.h"
+#import "ASTSection.h"
+#import "ASTItem.h"
+#import "ASTSwitchItem.h"
+
+
+//------------------------------------------------------------------------------
+
+@interface ASTTableDefinitionTests : XCTestCase
+
+@end
+
+//------------------------------------------------------------------------------
+
+@implementation ASTTableDefinitionTests
+
+//------------------------------------------------------------------------------
+
+- (NSArray*) tableData
+{
+	return @[
+		@{
+			AST_id : @"first",
+			AST_headerText : @"Header",
+			AST_items : @[
+				@{
+					AST_id : @"switch",
+					AST_itemClass : @"ASTSwitchItem",
+					AST_cell_textLabel_text : @"Switch",
+					AST_cell_switch_on : @YES,
+				},
+				[ NSNull null ],
+				@{
+					AST_id : @"numbers",
+					AST_cell_textLabel_text : @"Numbers",
+					AST_minimumHeight : @44.5,
+					AST_cell_indentationLevel : @2,
+					@"custom" : @{ @"negative" : @(-7), @"data" : [ NSData dataWithBytes: "ab" length: 2 ] },
+					@"null" : [ NSNull null ],
+				},
+			],
+		},
+		[ NSNull null ],
+		@{
+			AST_footerText : @"Footer",
+			AST_items : @[],
+		},
+	];
+}
+
+//------------------------------------------------------------------------------
+
+- (void) testDecodedData
+{
+	NSError* error = nil;
+	NSData* data = [ ASTTableDefinition dataWithTableData: [ self tableData ] error: &error ];
+	XCTAssertNotNil( data );
+	XCTAssertNil( error );
+	
+	ASTTableDefinition* definition = [ [ ASTTableDefinition alloc ] initWithData: data
+			error: &error ];
+	XCTAssertNotNil( definition );
+	
+	// NSNull sections and items are left out.
+	NSArray* decodedData = [ definition decodedData ];
+	XCTAssertEqual( decodedData.count, 2 );
+	NSArray* items = decodedData[ 0 ][ AST_items ];
+	XCTAssertEqual( items.count, 2 );
+	XCTAssertEqualObjects( items[ 0 ], [ self tableData ][ 0 ][ AST_items ][ 0 ] );
+	XCTAssertEqualObjects( items[ 1 ], [ self tableData ][ 0 ][ AST_items ][ 2 ] );
+	XCTAssertEqualObjects( decodedData[ 1 ], [ self tableData ][ 2 ] );
+	
+	// Keys that are string constants decode to the constants.
+	XCTAssertEqual( [ items[ 0 ] allKeys ].count, 4 );
+	for( NSString* key in items[ 0 ] ) {
+		XCTAssert( key == AST_id || key == AST_itemClass
+				|| key == AST_cell_textLabel_text || key == AST_cell_switch_on );
+	}
+}
+
+//------------------------------------------------------------------------------
+
+- (void) testDataForStyle
+{
+	NSData* data = [ ASTTableDefinition dataWithTableData: [ self tableData ] error: nil ];
+	ASTTableDefinition* definition = [ [ ASTTableDefinition alloc ] initWithData: data
+			error: nil ];
+	
+	ASTViewController* vc = [ [ ASTViewController alloc ]
+			initWithStyle: UITableViewStyleGrouped ];
+	vc.data = [ definition dataForStyle: UITableViewStyleGrouped ];
+	XCTAssertEqual( vc.numberOfItems, 2 );
+	
+	ASTSection* section = [ vc sectionAtIndex: 0 ];
+	XCTAssertEqualObjects( section.identifier, @"first" );
+	XCTAssertEqualObjects( section.headerText, @"Header" );
+	XCTAssertEqual( section.numberOfItems, 2 );
+	XCTAssertEqualObjects( [ vc sectionAtIndex: 1 ].footerText, @"Footer" );
+	
+	ASTItem* switchItem = [ section itemAtIndex: 0 ];
+	XCTAssert( [ switchItem isKindOfClass: [ ASTSwitchItem class ] ] );
+	XCTAssertEqualObjects( switchItem.identifier, @"switch" );
+	XCTAssertEqualObjects( [ switchItem valueForKeyPath: AST_cell_textLabel_text ], @"Switch" );
+	XCTAssertEqualObjects( [ vc itemWithIdentifier: @"numbers" ].indexPath,
+			[ NSIndexPath indexPathForRow: 1 inSection: 0 ] );
+	
+	ASTViewController* plainVC = [ [ ASTViewController alloc ]
+			initWithStyle: UITableViewStylePlain ];
+	NSData* plainData = [ ASTTableDefinition dataWithTableData:
+			[ self tableData ][ 0 ][ AST_items ] error: nil ];
+	ASTTableDefinition* plainDefinition = [ [ ASTTableDefinition alloc ]
+			initWithData: plainData error: nil ];
+	plainVC.data = [ plainDefinition dataForStyle: UITableViewStylePlain ];
+	XCTAssertEqual( plainVC.numberOfItems, 2 );
+	XCTAssert( [ [ plainVC itemWithIdentifier: @"switch" ] isKindOfClass: [ ASTSwitchItem class ] ] );
+}
+
+//------------------------------------------------------------------------------
+
+- (void) testContentsOfURL
+{
+	NSURL* url = [ [ NSURL fileURLWithPath: NSTemporaryDirectory() ]
+			URLByAppendingPathComponent: @"ASTTableDefinitionTests.astd" ];
+	NSError* error = nil;
+	XCTAssert( [ ASTTableDefinition writeTableData: [ self tableData ] toURL: url
+			error: &error ] );
+	
+	ASTTableDefinition* definition = [ [ ASTTableDefinition alloc ]
+			initWithContentsOfURL: url error: &error ];
+	XCTAssertNotNil( definition );
+	XCTAssertEqualObjects( [ definition decodedData ][ 1 ], [ self tableData ][ 2 ] );
+	
+	[ [ NSFileManager defaultManager ] removeItemAtURL: url error: nil ];
+	
+	NSURL* missingURL = [ url URLByAppendingPathExtension: @"missing" ];
+	XCTAssertNil( [ [ ASTTableDefinition alloc ] initWithContentsOfURL: missingURL
+			error: &error ] );
+	XCTAssertNotNil( error );
+}
+
+//------------------------------------------------------------------------------
+
+- (void) testErrors
+{
+	NSError* error = nil;
+	NSArray* unsupportedData = @[ @{ AST_items : @[ @{ @"date" : [ NSDate date ] } ] } ];
+	XCTAssertNil( [ ASTTableDefinition dataWithTableData: unsupportedData error: &error ] );
+	XCTAssertEqualObjects( error.domain, ASTDataErrorDomain );
+	XCTAssertEqual( error.code, ASTDataErrorUnsupportedValue );
+	
+	error = nil;
+	NSData* notADefinition = [ @"Not a table definition at all" dataUsingEncoding: NSUTF8StringEncoding ];
+	XCTAssertNil( [ [ ASTTableDefinition alloc ] initWithData: notADefinition error: &error ] );
+	XCTAssertEqual( error.code, ASTDataErrorInvalidTableDefinition );
+	
+	error = nil;
+	NSData* data = [ ASTTableDefinition dataWithTableData: [ self tableData ] error: nil ];
+	NSData* truncatedData = [ data subdataWithRange: NSMakeRange( 0, data.length - 1 ) ];
+	XCTAssertNil( [ [ ASTTableDefinition alloc ] initWithData: truncatedData error: &error ] );
+	XCTAssertEqual( error.code, ASTDataErrorInvalidTableDefinition );
+}
+
+//------------------------------------------------------------------------------
+
+// Damage in the values is found when the data is loaded rather than when the
+// rows are displayed.
+
+- (void) testDamagedValues
+{
+	NSData* data = [ ASTTableDefinition dataWithTableData: [ self tableData ] error: nil ];
+	uint32_t valuesOffset;
+	uint32_t valuesLength;
+	[ data getBytes: &valuesOffset range: NSMakeRange( 20, 4 ) ];
+	[ data getBytes: &valuesLength range: NSMakeRange( 24, 4 ) ];
+	
+	// The first value is a leaf of the first section, so its type byte is
+	// replaced with an unknown type.
+	NSMutableData* corruptedData = [ data mutableCopy ];
+	uint8_t unknownType = 0xFF;
+	[ corruptedData replaceBytesInRange: NSMakeRange( valuesOffset, 1 ) withBytes: &unknownType ];
+	NSError* error = nil;
+	XCTAssertNil( [ [ ASTTableDefinition alloc ] initWithData: corruptedData error: &error ] );
+	XCTAssertEqualObjects( error.domain, ASTDataErrorDomain );
+	XCTAssertEqual( error.code, ASTDataErrorInvalidTableDefinition );
+	
+	// The values end in the middle of the root array.
+	NSMutableData* truncatedData = [ data mutableCopy ];
+	uint32_t truncatedLength = valuesLength - 1;
+	[ truncatedData replaceBytesInRange: NSMakeRange( 24, 4 ) withBytes: &truncatedLength ];
+	error = nil;
+	XCTAssertNil( [ [ ASTTableDefinition alloc ] initWithData: truncatedData error: &error ] );
+	XCTAssertEqual( error.code, ASTDataErrorInvalidTableDefinition );
+	
+	// The items of a section refer to a string that is not in the file.
+	NSMutableData* badStringData = [ data mutableCopy ];
+	uint32_t stringCount = 0;
+	[ badStringData replaceBytesInRange: NSMakeRange( 12, 4 ) withBytes: &stringCount ];
+	error = nil;
+	XCTAssertNil( [ [ ASTTableDefinition alloc ] initWithData: badStringData error: &error ] );
+	XCTAssertEqual( error.code, ASTDataErrorInvalidTableDefinition );
+	
+	ASTTableDefinition* definition = [ [ ASTTableDefinition alloc ] initWithData: data error: &error ];
+	XCTAssertNotNil( definition );
+}
+
+//------------------------------------------------------------------------------
+
+@end
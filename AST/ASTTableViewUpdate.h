@@ -0,0 +1,89 @@
+//==============================================================================
+//
+//  ASTTableViewUpdate.h
+//
+//==============================================================================
+//
+//  Copyright (c) 2016 Adobe Systems Incorporated. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a
+//  copy of this software and associated documentation files (the "Software"),
+//  to deal in the Software without restriction, including without limitation
+//  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//  and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//
+//==============================================================================
+
+// This is private to the framework. The table view controller and sections use
+// it to apply the diffs of their items and sections to the table view, and to
+// reuse items when their data is replaced.
+
+#import <UIKit/UIKit.h>
+
+#import "ASTDiff.h"
+
+
+NS_ASSUME_NONNULL_BEGIN
+
+//------------------------------------------------------------------------------
+
+// Collects section and row changes so they can be applied to a table view
+// together between beginUpdates and endUpdates.
+
+@interface ASTTableViewUpdate : NSObject
+
+/// YES if no changes have been added.
+@property (readonly,nonatomic,getter=isEmpty) BOOL empty;
+
+- (void) deleteSection: (NSUInteger) section;
+- (void) insertSection: (NSUInteger) section;
+- (void) reloadSection: (NSUInteger) section;
+- (void) moveSection: (NSUInteger) section toSection: (NSUInteger) newSection;
+
+/// Adds the row changes of a diff of the items of a section. Matched items that
+/// are different objects have their rows reloaded, or deleted and inserted if
+/// they move. The section itself must not be moved by the same update.
+/// @param diff The diff of the old and new items.
+/// @param oldItems The items the diff was made from.
+/// @param newItems The items the diff was made to.
+/// @param section The index of the section before the update.
+/// @param newSection The index of the section after the update.
+- (void) addRowsOfDiff: (ASTDiff*) diff oldItems: (NSArray*) oldItems
+		newItems: (NSArray*) newItems section: (NSUInteger) section
+		newSection: (NSUInteger) newSection;
+
+/// Sends the changes to the table view. This must be called between
+/// beginUpdates and endUpdates after the model has been changed.
+- (void) applyToTableView: (nullable UITableView*) tableView
+		withRowAnimation: (UITableViewRowAnimation) animation;
+
+@end
+
+//------------------------------------------------------------------------------
+
+// Adds the items that have an identifier to a dictionary keyed by identifier.
+// Identifiers that are already in the dictionary keep their item.
+void addItemsByIdentifier( NSArray* items, NSMutableDictionary* itemsByIdentifier );
+
+// Replaces each dictionary in the item values that has the identifier of one of
+// the items in itemsByIdentifier with that item, if the item can be updated
+// from the dictionary with updateWithDict:. Reused items are removed from
+// itemsByIdentifier so that an item is only used once.
+NSArray* reuseItemsForItemValues( NSArray* itemValues,
+		NSMutableDictionary* itemsByIdentifier );
+
+//------------------------------------------------------------------------------
+
+NS_ASSUME_NONNULL_END
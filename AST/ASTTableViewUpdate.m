@@ -0,0 +1,211 @@
+//==============================================================================
+//
+//  ASTTableViewUpdate.m
+//
+//==============================================================================
+//
+//  Copyright (c) 2016 Adobe Systems Incorporated. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a
+//  copy of this software and associated documentation files (the "Software"),
+//  to deal in the Software without restriction, including without limitation
+//  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//  and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//
+//==============================================================================
+
+#import "ASTTableViewUpdate.h"
+
+#import "ASTItem.h"
+
+
+//------------------------------------------------------------------------------
+
+void addItemsByIdentifier( NSArray* items, NSMutableDictionary* itemsByIdentifier )
+{
+	for( ASTItem* item in items ) {
+		NSString* identifier = item.identifier;
+		if( identifier && itemsByIdentifier[ identifier ] == nil ) {
+			itemsByIdentifier[ identifier ] = item;
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+
+NSArray* reuseItemsForItemValues( NSArray* itemValues,
+		NSMutableDictionary* itemsByIdentifier )
+{
+	NSMutableArray* result = [ NSMutableArray arrayWithCapacity: itemValues.count ];
+	for( id itemValue in itemValues ) {
+		id resultValue = itemValue;
+		if( [ itemValue isKindOfClass: [ NSDictionary class ] ] ) {
+			id identifier = itemValue[ AST_id ];
+			ASTItem* item = [ identifier isKindOfClass: [ NSString class ] ]
+					? itemsByIdentifier[ identifier ] : nil;
+			if( [ item updateWithDict: itemValue ] ) {
+				[ itemsByIdentifier removeObjectForKey: identifier ];
+				resultValue = item;
+			}
+		}
+		[ result addObject: resultValue ];
+	}
+	return result;
+}
+
+//------------------------------------------------------------------------------
+
+@interface ASTTableViewUpdate() {
+	NSMutableIndexSet* _deletedSections;
+	NSMutableIndexSet* _insertedSections;
+	NSMutableIndexSet* _reloadedSections;
+	NSMutableArray* _movedSections;
+	NSMutableArray* _deletedRows;
+	NSMutableArray* _insertedRows;
+	NSMutableArray* _reloadedRows;
+	NSMutableArray* _movedRows;
+}
+
+@end
+
+//------------------------------------------------------------------------------
+
+@implementation ASTTableViewUpdate
+
+//------------------------------------------------------------------------------
+
+- (instancetype) init
+{
+	self = [ super init ];
+	if( self ) {
+		_deletedSections = [ NSMutableIndexSet indexSet ];
+		_insertedSections = [ NSMutableIndexSet indexSet ];
+		_reloadedSections = [ NSMutableIndexSet indexSet ];
+		_movedSections = [ NSMutableArray array ];
+		_deletedRows = [ NSMutableArray array ];
+		_insertedRows = [ NSMutableArray array ];
+		_reloadedRows = [ NSMutableArray array ];
+		_movedRows = [ NSMutableArray array ];
+	}
+	return self;
+}
+
+//------------------------------------------------------------------------------
+
+- (BOOL) isEmpty
+{
+	return _deletedSections.count == 0 && _insertedSections.count == 0
+			&& _reloadedSections.count == 0 && _movedSections.count == 0
+			&& _deletedRows.count == 0 && _insertedRows.count == 0
+			&& _reloadedRows.count == 0 && _movedRows.count == 0;
+}
+
+//------------------------------------------------------------------------------
+
+- (void) deleteSection: (NSUInteger) section
+{
+	[ _deletedSections addIndex: section ];
+}
+
+//------------------------------------------------------------------------------
+
+- (void) insertSection: (NSUInteger) section
+{
+	[ _insertedSections addIndex: section ];
+}
+
+//------------------------------------------------------------------------------
+
+- (void) reloadSection: (NSUInteger) section
+{
+	[ _reloadedSections addIndex: section ];
+}
+
+//------------------------------------------------------------------------------
+
+- (void) moveSection: (NSUInteger) section toSection: (NSUInteger) newSection
+{
+	[ _movedSections addObject: @[ @(section), @(newSection) ] ];
+}
+
+//------------------------------------------------------------------------------
+
+- (void) addRowsOfDiff: (ASTDiff*) diff oldItems: (NSArray*) oldItems
+		newItems: (NSArray*) newItems section: (NSUInteger) section
+		newSection: (NSUInteger) newSection
+{
+	[ diff.deletedIndexes enumerateIndexesUsingBlock: ^( NSUInteger index, BOOL* stop ) {
+		[ _deletedRows addObject: [ NSIndexPath indexPathForRow: index inSection: section ] ];
+	} ];
+	
+	for( NSUInteger i = 0; i < newItems.count; ++i ) {
+		NSIndexPath* newIndexPath = [ NSIndexPath indexPathForRow: i inSection: newSection ];
+		NSUInteger oldIndex = [ diff oldIndexForNewIndex: i ];
+		if( oldIndex == NSNotFound ) {
+			[ _insertedRows addObject: newIndexPath ];
+			continue;
+		}
+		
+		NSIndexPath* indexPath = [ NSIndexPath indexPathForRow: oldIndex inSection: section ];
+		BOOL sameItem = oldItems[ oldIndex ] == newItems[ i ];
+		BOOL moved = [ diff.movedIndexes containsIndex: i ];
+		if( sameItem && moved ) {
+			[ _movedRows addObject: @[ indexPath, newIndexPath ] ];
+		} else if( sameItem == NO && moved ) {
+			// A row can not be both moved and reloaded.
+			[ _deletedRows addObject: indexPath ];
+			[ _insertedRows addObject: newIndexPath ];
+		} else if( sameItem == NO ) {
+			[ _reloadedRows addObject: indexPath ];
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+
+- (void) applyToTableView: (UITableView*) tableView
+		withRowAnimation: (UITableViewRowAnimation) animation
+{
+	if( _deletedSections.count ) {
+		[ tableView deleteSections: _deletedSections withRowAnimation: animation ];
+	}
+	if( _insertedSections.count ) {
+		[ tableView insertSections: _insertedSections withRowAnimation: animation ];
+	}
+	if( _reloadedSections.count ) {
+		[ tableView reloadSections: _reloadedSections withRowAnimation: animation ];
+	}
+	for( NSArray* move in _movedSections ) {
+		[ tableView moveSection: [ move[ 0 ] integerValue ]
+				toSection: [ move[ 1 ] integerValue ] ];
+	}
+	
+	if( _deletedRows.count ) {
+		[ tableView deleteRowsAtIndexPaths: _deletedRows withRowAnimation: animation ];
+	}
+	if( _insertedRows.count ) {
+		[ tableView insertRowsAtIndexPaths: _insertedRows withRowAnimation: animation ];
+	}
+	if( _reloadedRows.count ) {
+		[ tableView reloadRowsAtIndexPaths: _reloadedRows withRowAnimation: animation ];
+	}
+	for( NSArray* move in _movedRows ) {
+		[ tableView moveRowAtIndexPath: move[ 0 ] toIndexPath: move[ 1 ] ];
+	}
+}
+
+//------------------------------------------------------------------------------
+
+@end
@@ -71,6 +71,32 @@
 
 //------------------------------------------------------------------------------
 
+- (BOOL) updateWithDict: (NSDictionary*) dict
+{
+	NSMutableDictionary* itemDict = [ dict mutableCopy ];
+	[ itemDict removeObjectsForKeys: @[
+		AST_textFieldValueActionKey,
+		AST_textFieldValueTargetKey,
+		AST_textFieldReturnKeyActionKey,
+		AST_textFieldReturnKeyTargetKey,
+	] ];
+	if( [ super updateWithDict: itemDict ] == NO ) {
+		return NO;
+	}
+	
+	id actionValue = dict[ AST_textFieldValueActionKey ];
+	_textFieldValueAction = actionValue ? NSSelectorFromString( actionValue ) : NULL;
+	_textFieldValueTarget = dict[ AST_textFieldValueTargetKey ];
+	
+	id returnActionValue = dict[ AST_textFieldReturnKeyActionKey ];
+	_textFieldReturnKeyAction = returnActionValue ? NSSelectorFromString( returnActionValue ) : NULL;
+	_textFieldReturnKeyTarget = dict[ AST_textFieldReturnKeyTargetKey ];
+	
+	return YES;
+}
+
+//------------------------------------------------------------------------------
+
 - (void) loadCell
 {
 	[ super loadCell ];
@@ -80,17 +106,53 @@
 		[ textFieldCell.textInput addTarget: self
 				action: @selector(textFieldEditingChangedAction:)
 				forControlEvents: UIControlEventEditingChanged ];
+		[ textFieldCell.textInput addTarget: self
+				action: @selector(textFieldEditingDidEndAction:)
+				forControlEvents: UIControlEventEditingDidEnd ];
 		textFieldCell.textInput.delegate = self;
 	}
 }
 
 //------------------------------------------------------------------------------
 
+- (void) unloadCell
+{
+	if( self.cellLoaded ) {
+		ASTTextFieldItemCell* textFieldCell = (ASTTextFieldItemCell*)self.cell;
+		[ textFieldCell.textInput removeTarget: self
+				action: @selector(textFieldEditingChangedAction:)
+				forControlEvents: UIControlEventEditingChanged ];
+		[ textFieldCell.textInput removeTarget: self
+				action: @selector(textFieldEditingDidEndAction:)
+				forControlEvents: UIControlEventEditingDidEnd ];
+		if( textFieldCell.textInput.delegate == self ) {
+			textFieldCell.textInput.delegate = nil;
+		}
+	}
+	
+	[ super unloadCell ];
+}
+
+//------------------------------------------------------------------------------
+
 - (void) textFieldEditingChangedAction: (id) sender
 {
 	ASTTextFieldItemCell* textFieldCell = (ASTTextFieldItemCell*)self.cell;
 	[ self setCellPropertiesValue: textFieldCell.textInput.text forKeyPath: AST_cell_textInput_text ];
-	
+	[ self valueDidChange ];
+}
+
+//------------------------------------------------------------------------------
+
+- (void) textFieldEditingDidEndAction: (id) sender
+{
+	[ self commitValueChange ];
+}
+
+//------------------------------------------------------------------------------
+
+- (void) sendValueChange
+{
 	if( _textFieldValueAction ) {
 		[ self sendAction: _textFieldValueAction
 				to: [ self resolveTargetObjectReference: _textFieldValueTarget ] ];
@@ -104,6 +166,8 @@
 
 - (BOOL) textFieldShouldReturn: (UITextField*) textField
 {
+	// The return key action sees the value action first.
+	[ self commitValueChange ];
 	if( _textFieldReturnKeyAction ) {
 		[ self sendAction: _textFieldReturnKeyAction
 				to: [ self resolveTargetObjectReference: _textFieldReturnKeyTarget ] ];
@@ -27,6 +27,7 @@
 //==============================================================================
 
 #import "ASTTextFieldItem.h"
+#import "ASTViewController.h"
 
 #import <UIKit/UIKit.h>
 #import <XCTest/XCTest.h>
@@ -37,6 +38,7 @@
 @interface TextFieldItemTestTarget : NSObject
 
 @property (nonatomic) BOOL actionSent;
+@property (nonatomic) NSUInteger actionCount;
 
 - (void) textFieldTestAction: (id) sender;
 
@@ -82,6 +84,149 @@
 
 //------------------------------------------------------------------------------
 
+- (void) testValueDeliveredOnCommit
+{
+	TextFieldItemTestTarget* target = [ [ TextFieldItemTestTarget alloc ] init ];
+	ASTTextFieldItem* item = [ ASTTextFieldItem itemWithDict: @{
+		AST_textFieldValueActionKey : @"textFieldTestAction:",
+		AST_textFieldValueTargetKey : target,
+		AST_valueDelivery : @(ASTValueDeliveryOnCommit),
+	} ];
+	ASTTextFieldItemCell* cell = (ASTTextFieldItemCell*)item.cell;
+	
+	// The text follows the field while the action waits for the end of editing.
+	for( NSString* text in @[ @"f", @"fo", @"foo" ] ) {
+		cell.textInput.text = text;
+		[ cell.textInput sendActionsForControlEvents: UIControlEventEditingChanged ];
+	}
+	XCTAssertEqual( target.actionCount, 0 );
+	XCTAssertNil( item.valueChangeToken );
+	XCTAssertEqualObjects( [ item valueForKeyPath: AST_cell_textInput_text ], @"foo" );
+	
+	[ cell.textInput sendActionsForControlEvents: UIControlEventEditingDidEnd ];
+	XCTAssertEqual( target.actionCount, 1 );
+	ASTCancellationToken* token = item.valueChangeToken;
+	XCTAssertNotNil( token );
+	XCTAssertFalse( token.cancelled );
+	
+	// Nothing is left to commit.
+	[ item commitValueChange ];
+	XCTAssertEqual( target.actionCount, 1 );
+	
+	// New input makes the delivered value stale.
+	cell.textInput.text = @"food";
+	[ cell.textInput sendActionsForControlEvents: UIControlEventEditingChanged ];
+	XCTAssertTrue( token.cancelled );
+	[ item commitValueChange ];
+	XCTAssertEqual( target.actionCount, 2 );
+	XCTAssertNotEqual( item.valueChangeToken, token );
+}
+
+//------------------------------------------------------------------------------
+
+- (void) testThrottledAndDebouncedValueDelivery
+{
+	TextFieldItemTestTarget* target = [ [ TextFieldItemTestTarget alloc ] init ];
+	ASTTextFieldItem* item = [ ASTTextFieldItem item ];
+	item.textFieldValueAction = @selector(textFieldTestAction:);
+	item.textFieldValueTarget = target;
+	item.valueDelivery = ASTValueDeliveryThrottled;
+	item.valueDeliveryInterval = 60;
+	ASTTextFieldItemCell* cell = (ASTTextFieldItemCell*)item.cell;
+	
+	// The first change is sent and the next ones wait for the interval.
+	[ cell.textInput sendActionsForControlEvents: UIControlEventEditingChanged ];
+	[ cell.textInput sendActionsForControlEvents: UIControlEventEditingChanged ];
+	[ cell.textInput sendActionsForControlEvents: UIControlEventEditingChanged ];
+	XCTAssertEqual( target.actionCount, 1 );
+	[ item commitValueChange ];
+	XCTAssertEqual( target.actionCount, 2 );
+	
+	item.valueDelivery = ASTValueDeliveryDebounced;
+	item.valueDeliveryInterval = 0.05;
+	[ cell.textInput sendActionsForControlEvents: UIControlEventEditingChanged ];
+	[ cell.textInput sendActionsForControlEvents: UIControlEventEditingChanged ];
+	XCTAssertEqual( target.actionCount, 2 );
+	
+	XCTestExpectation* expectation = [ self expectationWithDescription: @"delivered" ];
+	dispatch_after( dispatch_time( DISPATCH_TIME_NOW, (int64_t)(0.5 * NSEC_PER_SEC) ),
+			dispatch_get_main_queue(), ^{
+		[ expectation fulfill ];
+	} );
+	[ self waitForExpectationsWithTimeout: 10 handler: nil ];
+	XCTAssertEqual( target.actionCount, 3 );
+}
+
+//------------------------------------------------------------------------------
+
+- (void) testTextSurvivesCellReuse
+{
+	ASTViewController* vc = [ [ ASTViewController alloc ]
+			initWithStyle: UITableViewStylePlain ];
+	vc.reusesCells = YES;
+	
+	ASTTextFieldItem* firstItem = [ ASTTextFieldItem item ];
+	ASTTextFieldItem* secondItem = [ ASTTextFieldItem item ];
+	vc.data = @[ firstItem, secondItem ];
+	
+	ASTTextFieldItemCell* cell = (ASTTextFieldItemCell*)firstItem.cell;
+	cell.textInput.text = @"foo";
+	[ cell.textInput sendActionsForControlEvents: UIControlEventEditingChanged ];
+	
+	[ vc tableView: vc.tableView didEndDisplayingCell: cell
+			forRowAtIndexPath: [ NSIndexPath indexPathForRow: 0 inSection: 0 ] ];
+	
+	XCTAssertEqual( secondItem.cell, cell );
+	XCTAssertEqualObjects( cell.textInput.text, @"" );
+	
+	// Edits in the reused cell only go to the item that owns it now.
+	cell.textInput.text = @"bar";
+	[ cell.textInput sendActionsForControlEvents: UIControlEventEditingChanged ];
+	XCTAssertEqualObjects( [ firstItem valueForKeyPath: AST_cell_textInput_text ], @"foo" );
+	XCTAssertEqualObjects( [ secondItem valueForKeyPath: AST_cell_textInput_text ], @"bar" );
+	
+	ASTTextFieldItemCell* newCell = (ASTTextFieldItemCell*)firstItem.cell;
+	XCTAssertEqualObjects( newCell.textInput.text, @"foo" );
+}
+
+//------------------------------------------------------------------------------
+
+- (void) testRefreshKeepsItemBeingEdited
+{
+	ASTViewController* vc = [ [ ASTViewController alloc ]
+			initWithStyle: UITableViewStylePlain ];
+	vc.animatesDataChanges = YES;
+	vc.data = @[
+		@{
+			AST_itemClass : @"ASTTextFieldItem",
+			AST_id : @"name",
+			AST_cell_textInput_placeholder : @"Name",
+			AST_textFieldValueActionKey : @"valueChanged:",
+		},
+	];
+	ASTTextFieldItem* item = (ASTTextFieldItem*)[ vc itemWithIdentifier: @"name" ];
+	ASTTextFieldItemCell* cell = (ASTTextFieldItemCell*)item.cell;
+	cell.textInput.text = @"foo";
+	[ cell.textInput sendActionsForControlEvents: UIControlEventEditingChanged ];
+	
+	vc.data = @[
+		@{
+			AST_itemClass : @"ASTTextFieldItem",
+			AST_id : @"name",
+			AST_cell_textInput_placeholder : @"Full name",
+			AST_textFieldValueActionKey : @"otherValueChanged:",
+		},
+	];
+	
+	XCTAssertEqual( [ vc itemWithIdentifier: @"name" ], item );
+	XCTAssertEqual( item.cell, cell );
+	XCTAssertEqualObjects( cell.textInput.text, @"foo" );
+	XCTAssertEqualObjects( cell.textInput.placeholder, @"Full name" );
+	XCTAssertEqual( item.textFieldValueAction, NSSelectorFromString( @"otherValueChanged:" ) );
+}
+
+//------------------------------------------------------------------------------
+
 - (void) testPlaceholderKey
 {
 	ASTTextFieldItem* item = [ ASTTextFieldItem itemWithDict: @{
@@ -214,6 +359,7 @@
 - (void) textFieldTestAction: (id) sender
 {
 	self.actionSent = YES;
+	++self.actionCount;
 }
 
 //------------------------------------------------------------------------------
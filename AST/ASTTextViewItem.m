@@ -34,11 +34,40 @@
 
 //------------------------------------------------------------------------------
 
-static void* ASTTextViewItemCellTextContext;
+// Measuring the line height lays out text, so it is done once for each font.
+
+static CGFloat lineHeightOfFont( UIFont* font )
+{
+	static NSCache* lineHeights;
+	static dispatch_once_t onceToken;
+	dispatch_once( &onceToken, ^{
+		lineHeights = [ [ NSCache alloc ] init ];
+	} );
+	
+	NSNumber* lineHeight = [ lineHeights objectForKey: font ];
+	if( lineHeight == nil ) {
+		NSDictionary* attributes = @{
+			NSFontAttributeName : font,
+		};
+		lineHeight = @([ @"Line Height" sizeWithAttributes: attributes ].height);
+		[ lineHeights setObject: lineHeight forKey: font ];
+	}
+	return lineHeight.doubleValue;
+}
 
 //------------------------------------------------------------------------------
 
-@interface ASTTextViewItem() <UITextViewDelegate>
+@interface ASTTextViewItem() <UITextViewDelegate> {
+	// The text of the item while it is edited. It is the cell property, which
+	// is edited in place with the edit reported to the delegate instead of
+	// being copied from the text view on every change. It is copied when it is
+	// read.
+	NSMutableString* _editedText;
+	// The edits reported since the last change of the text.
+	NSRange _pendingEditRange;
+	NSString* _pendingEditText;
+	NSUInteger _pendingEditCount;
+}
 
 @end
 
@@ -75,6 +104,32 @@ static void* ASTTextViewItemCellTextContext;
 
 //------------------------------------------------------------------------------
 
+- (BOOL) updateWithDict: (NSDictionary*) dict
+{
+	NSMutableDictionary* itemDict = [ dict mutableCopy ];
+	[ itemDict removeObjectsForKeys: @[
+		AST_textViewValueActionKey,
+		AST_textViewValueTargetKey,
+		AST_textViewReturnKeyActionKey,
+		AST_textViewReturnKeyTargetKey,
+	] ];
+	if( [ super updateWithDict: itemDict ] == NO ) {
+		return NO;
+	}
+	
+	id actionValue = dict[ AST_textViewValueActionKey ];
+	_textViewValueAction = actionValue ? NSSelectorFromString( actionValue ) : NULL;
+	_textViewValueTarget = dict[ AST_textViewValueTargetKey ];
+	
+	id returnActionValue = dict[ AST_textViewReturnKeyActionKey ];
+	_textViewReturnKeyAction = returnActionValue ? NSSelectorFromString( returnActionValue ) : NULL;
+	_textViewReturnKeyTarget = dict[ AST_textViewReturnKeyTargetKey ];
+	
+	return YES;
+}
+
+//------------------------------------------------------------------------------
+
 - (void) loadCell
 {
 	[ super loadCell ];
@@ -87,11 +142,116 @@ static void* ASTTextViewItemCellTextContext;
 
 //------------------------------------------------------------------------------
 
+- (void) unloadCell
+{
+	if( self.cellLoaded && [ self.cell isKindOfClass: [ ASTTextViewItemCell class ] ] ) {
+		ASTTextViewItemCell* textViewCell = (ASTTextViewItemCell*)self.cell;
+		if( textViewCell.textInput.delegate == self ) {
+			textViewCell.textInput.delegate = nil;
+		}
+	}
+	
+	[ super unloadCell ];
+}
+
+//------------------------------------------------------------------------------
+
 - (void) textViewDidChange: (UITextView*) textView
 {
-	ASTTextViewItemCell* textFieldCell = (ASTTextViewItemCell*)self.cell;
-	[ self setCellPropertiesValue: textFieldCell.textInput.text forKeyPath: AST_cell_textInput_text ];
+	ASTTextViewItemCell* textViewCell = (ASTTextViewItemCell*)self.cell;
+	[ self updateTextWithTextView: textViewCell.textInput ];
+	[ self.tableViewController setNeedsRowHeightUpdateForItem: self ];
+	[ self valueDidChange ];
+}
+
+//------------------------------------------------------------------------------
+
+// The edit reported to the delegate is applied to the text of the item when it
+// explains the change. Marked text, several edits or anything else that does
+// not add up copies the text of the text view instead.
+
+- (void) updateTextWithTextView: (UITextView*) textView
+{
+	NSRange range = _pendingEditRange;
+	NSString* replacement = _pendingEditText;
+	BOOL singleEdit = _pendingEditCount == 1;
+	_pendingEditText = nil;
+	_pendingEditCount = 0;
 	
+	NSUInteger length = _editedText.length;
+	if( singleEdit && _editedText
+			&& [ super cellPropertiesValueForKeyPath: AST_cell_textInput_text ] == _editedText
+			&& textView.markedTextRange == nil
+			&& NSMaxRange( range ) <= length
+			&& length - range.length + replacement.length == textView.textStorage.length ) {
+		[ _editedText replaceCharactersInRange: range withString: replacement ];
+		return;
+	}
+	
+	_editedText = [ textView.text mutableCopy ];
+	[ self setCellPropertiesValue: _editedText forKeyPath: AST_cell_textInput_text ];
+}
+
+//------------------------------------------------------------------------------
+
+// The edited text is only handed out as copies, which valueForKeyPath: and the
+// cell properties applied to a cell also get.
+
+- (id) cellPropertiesValueForKeyPath: (NSString*) keyPath
+{
+	id result = [ super cellPropertiesValueForKeyPath: keyPath ];
+	return result && result == _editedText ? [ _editedText copy ] : result;
+}
+
+//------------------------------------------------------------------------------
+
+- (NSDictionary*) cellProperties
+{
+	NSDictionary* result = [ super cellProperties ];
+	if( _editedText && result[ AST_cell_textInput_text ] == _editedText ) {
+		NSMutableDictionary* cellProperties = [ result mutableCopy ];
+		cellProperties[ AST_cell_textInput_text ] = [ _editedText copy ];
+		result = cellProperties;
+	}
+	return result;
+}
+
+//------------------------------------------------------------------------------
+
+- (void) setCellPropertyValue: (id) value forKeyPath: (NSString*) keyPath
+{
+	[ super setCellPropertyValue: value forKeyPath: keyPath ];
+	
+	// The cells of items that are not displayed are measured when they are.
+	if( self.cellDisplayed && ( [ keyPath isEqualToString: AST_cell_textInput_text ]
+			|| [ keyPath isEqualToString: AST_cell_textInput_font ]
+			|| [ keyPath isEqualToString: AST_cell_textInput_minHeightInLines ]
+			|| [ keyPath isEqualToString: AST_cell_textInput_maxHeightInLines ] ) ) {
+		[ self.tableViewController setNeedsRowHeightUpdateForItem: self ];
+	}
+}
+
+//------------------------------------------------------------------------------
+
+- (void) rowHeightDidChange
+{
+	// Keeps the end of the text being typed above the keyboard.
+	if( self.editing ) {
+		[ self scrollToPosition: UITableViewScrollPositionBottom animated: NO ];
+	}
+}
+
+//------------------------------------------------------------------------------
+
+- (void) textViewDidEndEditing: (UITextView*) textView
+{
+	[ self commitValueChange ];
+}
+
+//------------------------------------------------------------------------------
+
+- (void) sendValueChange
+{
 	if( _textViewValueAction ) {
 		[ self sendAction: _textViewValueAction
 				to: [ self resolveTargetObjectReference: _textViewValueTarget ] ];
@@ -107,7 +267,13 @@ static void* ASTTextViewItemCellTextContext;
 		shouldChangeTextInRange: (NSRange) range
 		replacementText: (NSString*) text
 {
+	_pendingEditRange = range;
+	_pendingEditText = text;
+	++_pendingEditCount;
+	
 	if( [ text isEqualToString: @"\n" ] ) {
+		// The return key action sees the value action first.
+		[ self commitValueChange ];
 		if( _textViewReturnKeyAction ) {
 			[ self sendAction: _textViewReturnKeyAction
 					to: [ self resolveTargetObjectReference: _textViewReturnKeyTarget ] ];
@@ -146,6 +312,16 @@ static void* ASTTextViewItemCellTextContext;
 
 //------------------------------------------------------------------------------
 
+@interface ASTTextView() {
+	// Whether the text was empty after its last change, which decides if the
+	// placeholder is drawn.
+	BOOL _textWasEmpty;
+}
+
+@end
+
+//------------------------------------------------------------------------------
+
 @implementation ASTTextView
 
 //------------------------------------------------------------------------------
@@ -158,6 +334,7 @@ static void* ASTTextViewItemCellTextContext;
 		_minHeightInLines = 3;
 		_maxHeightInLines = 10;
 		self.backgroundColor = [ UIColor clearColor ];
+		_textWasEmpty = YES;
 		
 		[ [ NSNotificationCenter defaultCenter ] addObserver: self 
 				selector: @selector( textChanged: ) 
@@ -215,15 +392,10 @@ static void* ASTTextViewItemCellTextContext;
 {
 	CGSize result = [ super intrinsicContentSize ];
 	
-	// The min and max height values could be cached if it was deemed
-	// necessary.
-	NSDictionary* attributes = @{
-		NSFontAttributeName : self.font,
-	};
-	CGSize lineSize = [ @"Line Height" sizeWithAttributes: attributes ];
+	CGFloat lineHeight = lineHeightOfFont( self.font );
 	CGFloat verticalMargins = self.textContainerInset.top + self.textContainerInset.bottom;
-	CGFloat minHeight = lineSize.height * _minHeightInLines + verticalMargins;
-	CGFloat maxHeight = lineSize.height * _maxHeightInLines + verticalMargins;
+	CGFloat minHeight = lineHeight * _minHeightInLines + verticalMargins;
+	CGFloat maxHeight = lineHeight * _maxHeightInLines + verticalMargins;
 	if( result.height < minHeight ) {
 		result.height = minHeight;
 	} else if( result.height > maxHeight ) {
@@ -289,16 +461,34 @@ static void* ASTTextViewItemCellTextContext;
 
 - (void) textChanged: (NSNotification*) theNotification
 {
-	// This needs to be called in order to start/stop drawing the placeholder
-	// text when the value changes.
-	
-	[ self setNeedsDisplay ];
+	[ self textDidChange ];
 }
 
 // LCOV_EXCL_STOP
 
 //------------------------------------------------------------------------------
 
+- (void) setText: (NSString*) text
+{
+	[ super setText: text ];
+	[ self textDidChange ];
+}
+
+//------------------------------------------------------------------------------
+
+- (void) textDidChange
+{
+	// The placeholder only needs to be drawn or erased when the text becomes
+	// empty or stops being empty, not on every change.
+	BOOL textIsEmpty = self.textStorage.length == 0;
+	if( textIsEmpty != _textWasEmpty ) {
+		_textWasEmpty = textIsEmpty;
+		[ self setNeedsDisplay ];
+	}
+}
+
+//------------------------------------------------------------------------------
+
 @end
 
 //------------------------------------------------------------------------------
@@ -327,18 +517,6 @@ static void* ASTTextViewItemCellTextContext;
 
 //------------------------------------------------------------------------------
 
-- (void) dealloc
-{
-	NSNotificationCenter* nc = [ NSNotificationCenter defaultCenter ];
-	[ nc removeObserver: self name: UITextViewTextDidChangeNotification
-			object: _textInput ];
-	
-	[ _textInput removeObserver: self forKeyPath: @"text"
-			context: &ASTTextViewItemCellTextContext ];
-}
-
-//------------------------------------------------------------------------------
-
 - (UITextView*) textView
 {
 	if( _textInput == nil ) {
@@ -374,12 +552,6 @@ static void* ASTTextViewItemCellTextContext;
 		[ self.contentView addConstraints: [ NSLayoutConstraint
 				constraintsWithVisualFormat: @"H:|-[_textInput]-|"
 				options: 0 metrics: metrics views: views ] ];
-		
-		NSNotificationCenter* nc = [ NSNotificationCenter defaultCenter ];
-		[ nc addObserver: self selector: @selector(textViewDidChange:)
-				name: UITextViewTextDidChangeNotification object: _textInput ];
-		[ _textInput addObserver: self forKeyPath: @"text" options: 0
-				context: &ASTTextViewItemCellTextContext ];
 	}
 	
 	return _textInput;
@@ -387,65 +559,5 @@ static void* ASTTextViewItemCellTextContext;
 
 //------------------------------------------------------------------------------
 
-// LCOV_EXCL_START
-
-- (void) updateCellSize
-{
-	UITableView* tableView = self.tableView;
-	
-	// Note that we are disabling animations because beginUpdates/endUpdates
-	// has the effect of resetting the scroll position to be under the keyboard.
-	// This should be fixed so the animation can look nice.
-	BOOL animationsEnabled = [ UIView areAnimationsEnabled ];
-	if( [ _textInput isFirstResponder ] ) {
-		[ UIView setAnimationsEnabled: NO ];
-	}
-	
-	[ tableView beginUpdates ];
-	[ tableView endUpdates ];
-	
-	if( [ _textInput isFirstResponder ] ) {
-		NSIndexPath* indexPath = [ tableView indexPathForCell: self ];
-		[ tableView scrollToRowAtIndexPath: indexPath
-				atScrollPosition: UITableViewScrollPositionBottom
-				animated: NO ];
-		
-		[ UIView setAnimationsEnabled: animationsEnabled ];
-	}
-}
-
-// LCOV_EXCL_STOP
-
-//------------------------------------------------------------------------------
-
-// LCOV_EXCL_START
-
-- (void) textViewDidChange: (NSNotification*) notification
-{
-	[ self updateCellSize ];
-}
-
-// LCOV_EXCL_STOP
-
-//------------------------------------------------------------------------------
-
-// LCOV_EXCL_START
-
-- (void) observeValueForKeyPath: (NSString*) keyPath ofObject: (id) object
-		change: (NSDictionary*) change context: (void*) context
-{
-	if( context == &ASTTextViewItemCellTextContext ) {
-		[ self updateCellSize ];
-		return;
-	}
-	
-	[ super observeValueForKeyPath: keyPath ofObject: object
-			change: change context: context ];
-}
-
-// LCOV_EXCL_STOP
-
-//------------------------------------------------------------------------------
-
 @end
 
@@ -28,6 +28,7 @@
 
 #import "ASTTextViewItem.h"
 
+#import "ASTItemSubclass.h"
 #import "ASTTextFieldItem.h"
 
 #import <UIKit/UIKit.h>
@@ -85,6 +86,59 @@
 
 //------------------------------------------------------------------------------
 
+- (void) testTextFollowsEdits
+{
+	ASTTextViewItem* item = [ ASTTextViewItem item ];
+	ASTTextViewItemCell* cell = (ASTTextViewItemCell*)item.cell;
+	UITextView* textView = cell.textInput;
+	id<UITextViewDelegate> delegate = textView.delegate;
+	
+	textView.text = @"foo";
+	[ delegate textViewDidChange: textView ];
+	NSString* text = [ item valueForKeyPath: AST_cell_textInput_text ];
+	XCTAssertEqualObjects( text, @"foo" );
+	
+	// Edits reported to the delegate are applied to the text of the item.
+	XCTAssertTrue( [ delegate textView: textView shouldChangeTextInRange: NSMakeRange( 3, 0 )
+			replacementText: @" bar" ] );
+	textView.text = @"foo bar";
+	[ delegate textViewDidChange: textView ];
+	XCTAssertTrue( [ delegate textView: textView shouldChangeTextInRange: NSMakeRange( 0, 3 )
+			replacementText: @"baz" ] );
+	textView.text = @"baz bar";
+	[ delegate textViewDidChange: textView ];
+	XCTAssertEqualObjects( [ item valueForKeyPath: AST_cell_textInput_text ], @"baz bar" );
+	// Values read earlier do not change.
+	XCTAssertEqualObjects( text, @"foo" );
+	NSString* cellPropertiesText = item.cellProperties[ AST_cell_textInput_text ];
+	NSString* keyPathText = [ item cellPropertiesValueForKeyPath: AST_cell_textInput_text ];
+	XCTAssertTrue( [ delegate textView: textView shouldChangeTextInRange: NSMakeRange( 7, 0 )
+			replacementText: @"!" ] );
+	textView.text = @"baz bar!";
+	[ delegate textViewDidChange: textView ];
+	XCTAssertEqualObjects( cellPropertiesText, @"baz bar" );
+	XCTAssertEqualObjects( keyPathText, @"baz bar" );
+	XCTAssertEqualObjects( item.cellProperties[ AST_cell_textInput_text ], @"baz bar!" );
+	
+	// A change the reported edit does not explain copies the text view.
+	[ delegate textView: textView shouldChangeTextInRange: NSMakeRange( 0, 0 )
+			replacementText: @"x" ];
+	textView.text = @"something else";
+	[ delegate textViewDidChange: textView ];
+	XCTAssertEqualObjects( [ item valueForKeyPath: AST_cell_textInput_text ], @"something else" );
+	
+	// So does a change of the text of the item made in the meantime.
+	[ item setValue: @"new" forKeyPath: AST_cell_textInput_text ];
+	XCTAssertEqualObjects( textView.text, @"new" );
+	[ delegate textView: textView shouldChangeTextInRange: NSMakeRange( 3, 0 )
+			replacementText: @"!" ];
+	textView.text = @"new!";
+	[ delegate textViewDidChange: textView ];
+	XCTAssertEqualObjects( [ item valueForKeyPath: AST_cell_textInput_text ], @"new!" );
+}
+
+//------------------------------------------------------------------------------
+
 - (void) testPlaceholderKey
 {
 	ASTTextViewItem* item = [ ASTTextViewItem itemWithDict: @{
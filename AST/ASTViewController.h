@@ -33,11 +33,32 @@
 #import "ASTSliderItem.h"
 #import "ASTTextFieldItem.h"
 #import "ASTTextViewItem.h"
+#import "ASTPerformanceMetrics.h"
+#import "ASTSorting.h"
 
 
 NS_ASSUME_NONNULL_BEGIN
 
 typedef void (^ASTUpdateBlock)( void );
+typedef void (^ASTDataBuildBlock)( NSArray* __nullable data, NSError* __nullable error );
+
+/// The domain of errors reporting data that could not be built.
+extern NSString* const ASTDataErrorDomain;
+/// The key of the exception that was raised while building the data in the user
+/// info of an error in the ASTDataErrorDomain.
+extern NSString* const ASTDataExceptionKey;
+
+typedef NS_ENUM( NSInteger, ASTDataError ) {
+	/// The data contained an object that is not a section, an item, a
+	/// dictionary describing one or NSNull, or a dictionary that could not be
+	/// turned into a section or an item.
+	ASTDataErrorInvalidData = 1,
+	/// The data contained a value that can not be stored in a table definition
+	/// file. See ASTTableDefinition.h.
+	ASTDataErrorUnsupportedValue = 2,
+	/// A table definition file is damaged or was written by a newer version.
+	ASTDataErrorInvalidTableDefinition = 3,
+};
 
 //------------------------------------------------------------------------------
 
@@ -47,9 +68,93 @@ typedef void (^ASTUpdateBlock)( void );
 /// depends on the table view style. If the table view is grouped then the array
 /// is expected to contain ASTSection objects. If the table view is plain then
 /// the array is expected to contain ASTItem objects. The array may also contain
-/// dictionaries that describe the expected type.
+/// dictionaries that describe the expected type. Dictionaries describing items
+/// reuse the items already in the table view as setData:withRowAnimation: does.
 @property (copy,nonatomic) NSArray* data;
 
+/// Determines how setting data or the items of a section updates the table
+/// view. When this is YES the new sections and items are compared with the
+/// current ones and the differences are applied as one animated batch update,
+/// which keeps the scroll position and the rows that did not change. When this
+/// is NO the table view is reloaded. The default is NO.
+@property (nonatomic) BOOL animatesDataChanges;
+
+/// Replaces the data and updates the table view with one batch update. Sections
+/// and items in the current and new data match when they are the same object
+/// or have the same identifier. Unmatched sections and items are deleted or
+/// inserted, matched ones are moved if their order changed, and matched ones
+/// that are different objects are reloaded. A replaced section that keeps its
+/// position and header and footer has only the rows that changed updated.
+/// A dictionary describing an item with the identifier of an item already in
+/// the table view reuses that item if updateWithDict: accepts it, so the item
+/// keeps its cell and its row is not reloaded.
+/// @param data The new items or sections. See data.
+/// @param animation A constant that either specifies the kind of animation to
+/// perform when updating the rows or requests no animation.
+- (void) setData: (NSArray*) data withRowAnimation: (UITableViewRowAnimation) animation;
+
+/// Builds the sections and items described by dictionaries in the data on a
+/// background queue and returns them to the completion block on the main
+/// thread. Long arrays of sections or items are built on several cores. Only
+/// the section and item objects are created; cells are created when the rows
+/// are displayed. The items are not attached to a table view controller until
+/// the data is set.
+/// @param data The sections or items, or dictionaries describing them. See
+/// data.
+/// @param style The style of the table view the data is for, which determines
+/// if the data contains sections or items.
+/// @param completion A block called on the main thread with the built data,
+/// or with an error in the ASTDataErrorDomain if the data is invalid.
++ (void) buildData: (NSArray*) data forStyle: (UITableViewStyle) style
+		completion: (ASTDataBuildBlock) completion;
+/// Builds the data with buildData:forStyle:completion: and sets it on the main
+/// thread with setData:, so the table view is updated in one step. If the data
+/// is set again before the build finishes the built data is dropped and the
+/// completion block is not called.
+/// @param data The sections or items, or dictionaries describing them. See
+/// data.
+/// @param completion A block called on the main thread after the data is set,
+/// or with an error if the data is invalid, in which case the data is not
+/// changed. May be nil.
+- (void) setDataInBackground: (NSArray*) data
+		completion: (nullable void (^)( NSError* __nullable error )) completion;
+
+/// Determines if items share cells. When this is YES an item only holds a cell
+/// while its row is displayed. When the table view ends displaying the row the
+/// cell is put in a pool keyed by cell class, cell style and reuse identifier
+/// and is configured from the cell properties of the next item that needs one.
+/// This keeps the number of cells proportional to the number of visible rows.
+/// The default is NO.
+@property (nonatomic) BOOL reusesCells;
+
+/// Determines when changes to the cell properties of items reach cells that
+/// are already loaded. When this is YES only the properties that changed are
+/// applied. The changes to items whose cells are on screen are applied together
+/// once per display frame, and the changes to items whose cells are not on
+/// screen wait until the cells are displayed or read. When this is NO changes
+/// are applied to loaded cells right away. The default is NO.
+@property (nonatomic) BOOL defersCellUpdates;
+/// Applies the changes waiting for the next display frame right away. See
+/// defersCellUpdates.
+- (void) applyPendingCellUpdates;
+
+/// The heights of displayed rows are recorded for each table width and content
+/// size category and are used as the estimated heights of the rows. When this
+/// key is not nil the heights of the rows of items with identifiers are saved
+/// under the key when the view disappears, and setting the key loads the
+/// heights saved under it, so a table that is shown again starts with the
+/// heights its rows had. The default is nil, which does not save the heights.
+@property (copy,nullable,nonatomic) NSString* rowHeightCacheKey;
+
+/// The store the preference items read and write their preferences in when
+/// they do not have their own. The default is nil, which uses the standard user
+/// defaults. See ASTPreferenceStore.h.
+@property (nullable,nonatomic) id<ASTPreferenceStore> prefStore;
+/// The metrics the table view controller, its sections and its items record
+/// their operations in. Nothing is recorded while it is nil, the default. See
+/// ASTPerformanceMetrics.h.
+@property (nullable,nonatomic) ASTPerformanceMetrics* performanceMetrics;
+
 /// Returns the first section with the identifier. Nil is allowed.
 /// @param identifier A string identifying the section to return.
 /// @return The first section with an identifier matching the identifier or nil
@@ -72,7 +177,8 @@ typedef void (^ASTUpdateBlock)( void );
 /// @return The item at the index path or nil if the index is invalid.
 - (nullable ASTItem*) itemAtIndexPath: (NSIndexPath*) indexPath;
 /// Returns the first item with a representedObject that matches the parameter.
-/// The objects are compared with isEqual:. The parameter may be nil.
+/// The objects are compared with isEqual: and hash, so the hash of a represented
+/// object must not change while its item is in use. The parameter may be nil.
 /// @param representedObject An object to compare to the representedObject of
 /// each of the items. May be nil.
 /// @return The first item with a represented object matching the parameter or
@@ -80,14 +186,15 @@ typedef void (^ASTUpdateBlock)( void );
 - (nullable ASTItem*) itemWithRepresentedObject: (nullable id) representedObject;
 
 /// Returns the index of the section or NSNotFound if the section is not in the
-/// table view. This method performs a linear search and may not be performant.
+/// table view. The index is cached, so this only searches the table view if
+/// sections were inserted, removed or moved since the last lookup.
 /// @param section A section to find in the table view.
 /// @return The index of the section or NSNotFound.
 - (NSInteger) indexOfSection: (ASTSection*) section;
 /// Returns the index path of the item or nil if the item is not in the table
-/// view.
-/// @param item An item to find in the table view. This method performs a linear
-/// search and may not be performant.
+/// view. Like indexOfSection: this uses cached indexes that are only refreshed
+/// after the table view or the section of the item changes.
+/// @param item An item to find in the table view.
 /// @return The index path of the item or nil.
 - (nullable NSIndexPath*) indexPathForItem: (ASTItem*) item;
 
@@ -105,6 +212,15 @@ typedef void (^ASTUpdateBlock)( void );
 /// perform when inserting the items or requests no animation.
 - (void) insertSections: (NSArray*) sections atIndexes: (NSArray*) indexes
 		withRowAnimation: (UITableViewRowAnimation) animation;
+/// Inserts sections so that they end up at the indexes of the index set, with
+/// an option to animate the insertion. The sections are spliced in with one
+/// pass over the existing sections.
+/// @param sections An array of ASTSection objects in the order of the indexes.
+/// @param indexes The indexes of the sections after the insertion.
+/// @param animation A constant that either specifies the kind of animation to
+/// perform when inserting the sections or requests no animation.
+- (void) insertSections: (NSArray*) sections atIndexSet: (NSIndexSet*) indexes
+		withRowAnimation: (UITableViewRowAnimation) animation;
 /// Removes the sections specified by an array of indexes, with an option to
 /// animate the removal.
 /// @param indexes An array of NSNumber objects.
@@ -112,6 +228,13 @@ typedef void (^ASTUpdateBlock)( void );
 /// perform when removing the items or requests no animation.
 - (void) removeSectionsAtIndexes: (NSArray*) indexes
 		withRowAnimation: (UITableViewRowAnimation) animation;
+/// Removes the sections at the indexes of the index set with one pass over the
+/// sections, with an option to animate the removal.
+/// @param indexes The indexes of the sections to remove.
+/// @param animation A constant that either specifies the kind of animation to
+/// perform when removing the sections or requests no animation.
+- (void) removeSectionsAtIndexSet: (NSIndexSet*) indexes
+		withRowAnimation: (UITableViewRowAnimation) animation;
 /// Moves a section from one location to another.
 /// @param index An index identifying the section to move.
 /// @param newIndex An index identifying the section that is the destination of
@@ -143,20 +266,73 @@ typedef void (^ASTUpdateBlock)( void );
 - (void) moveItemWithAnimationAtIndexPath: (NSIndexPath*) indexPath
 		toIndexPath: (NSIndexPath*) newIndexPath;
 
+/// Performs the changes made by the block as one table view update. While the
+/// block runs, the insert, remove and move methods of the table view controller
+/// and of its sections, setData:, setItems: and their row animation variants
+/// only change the model, and each index refers to the state left by the
+/// previous change. After the block the sections and items are compared with
+/// those before it, so that an item inserted and then removed is not animated,
+/// and the differences are sent to the table view between one beginUpdates and
+/// endUpdates, with the indexes translated to the state before the block. The
+/// row animations passed to the methods called in the block are ignored.
+/// Calls can be nested, in which case the outermost call updates the table
+/// view.
+/// @param updates The block making the changes.
+/// @param animation A constant that either specifies the kind of animation to
+/// perform when updating the rows or requests no animation.
+- (void) performBatchUpdates: (ASTUpdateBlock) updates
+		withRowAnimation: (UITableViewRowAnimation) animation;
+/// Performs the changes made by the block as one table view update with
+/// UITableViewRowAnimationAutomatic. See performBatchUpdates:withRowAnimation:.
+/// @param updates The block making the changes.
+- (void) performBatchUpdates: (ASTUpdateBlock) updates;
+
+// Filtering
+
+/// The text the displayed items are filtered by. Each word of the filter text
+/// must be the start of a word of the text, detail text or identifier of an
+/// item, ignoring case and diacritics. In a grouped table view sections without
+/// matching items are hidden. The items are found with an index of their words
+/// that is built when filtering starts, which builds all lazy items and keeps
+/// them until filtering stops. Items that are added, removed or have their text
+/// changed while filtering only update their own words in the index. Setting the filter text animates the change of
+/// the displayed rows with UITableViewRowAnimationAutomatic. Nil, or text
+/// without words, shows all of the items. The default is nil.
+@property (copy,nullable,nonatomic) NSString* filterText;
+/// Sets the filter text and animates the change of the displayed rows. Text
+/// that extends the previous filter text only searches the items that are
+/// displayed. The items are not changed or rebuilt, so they keep their cells.
+/// @param filterText The text to filter the items by, or nil.
+/// @param animation A constant that either specifies the kind of animation to
+/// perform when updating the rows or requests no animation.
+- (void) setFilterText: (nullable NSString*) filterText
+		withRowAnimation: (UITableViewRowAnimation) animation;
+/// YES if the filter text has words, in which case the table view displays
+/// only the matching items.
+@property (readonly,nonatomic,getter=isFiltering) BOOL filtering;
+/// Searches the items again and animates the change of the displayed rows.
+/// Changes made to the sections and items while filtering are shown this way
+/// soon after they are made. Call this after changing the text of an item to
+/// show it or hide it right away.
+- (void) updateFilterResults;
+/// Returns the index path of the row displaying the item, which differs from
+/// indexPathForItem: while filtering, or nil if the item is not displayed.
+/// @param item An item to find in the table view.
+/// @return The index path of the row of the item or nil.
+- (nullable NSIndexPath*) displayedIndexPathForItem: (ASTItem*) item;
+
 // Selection
 
-/// Selects the item in the table view. This method performs a linear
-/// search and may not be performant. If you have the index path of the item
-/// then it is faster to use the selection methods on the table view.
+/// Selects the item in the table view. The index path of the item is found
+/// with displayedIndexPathForItem:.
 /// @param item An item to select in the table view.
 /// @param animated A flag indicating whether animation should be performed as
 /// the selection changes.
 - (void) selectItem: (ASTItem*) item withAnimation: (BOOL) animated
 		scrollPosition: (UITableViewScrollPosition) scrollPosition;
 
-/// Deselects the item in the table view. This method performs a linear
-/// search and may not be performant. If you have the index path of the item
-/// then it is faster to use the selection methods on the table view.
+/// Deselects the item in the table view. The index path of the item is found
+/// with displayedIndexPathForItem:.
 /// @param item An item to deselect in the table view.
 /// @param animated A flag indicating whether animation should be performed as
 /// the selection changes.
@@ -179,14 +355,4 @@ typedef void (^ASTUpdateBlock)( void );
 
 //------------------------------------------------------------------------------
 
-static BOOL SortAscending = YES;
-static BOOL SortDescending = NO;
-
-//------------------------------------------------------------------------------
-
-NSArray* sortIndexesOfArray( NSArray* array, NSString* key, BOOL ascending );
-NSArray* sortArray( NSArray* indexArray, NSString* key, BOOL ascending );
-
-//------------------------------------------------------------------------------
-
 NS_ASSUME_NONNULL_END
@@ -32,101 +32,304 @@
 #import "ASTItemSubclass.h"
 #import "ASTSection.h"
 #import "ASTSectionSubclass.h"
+#import "ASTCellPool.h"
+#import "ASTObjectIndex.h"
+#import "ASTTableViewUpdate.h"
+#import "ASTRowHeightCache.h"
+#import "ASTSearchIndex.h"
+#import "ASTPerformanceSpan.h"
 
 
 //------------------------------------------------------------------------------
 
-static NSIndexSet* indexSetFromArray( NSArray* indexArray )
+static BOOL arraysHaveSameObjects( NSArray* array1, NSArray* array2 )
 {
-	NSMutableIndexSet* indexSet = [ NSMutableIndexSet indexSet ];
-	for( NSNumber* indexValue in indexArray ) {
-		[ indexSet addIndex: [ indexValue unsignedIntegerValue ] ];
+	if( array1.count != array2.count ) {
+		return NO;
+	}
+	for( NSUInteger i = 0; i < array1.count; ++i ) {
+		if( array1[ i ] != array2[ i ] ) {
+			return NO;
+		}
+	}
+	return YES;
+}
+
+//------------------------------------------------------------------------------
+
+// An index or index path paired with its position in the array it came from.
+
+typedef struct {
+	NSUInteger section;
+	NSUInteger row;
+	NSUInteger position;
+} ASTSortedIndex;
+
+static int compareSortedIndexes( const void* a, const void* b )
+{
+	const ASTSortedIndex* index1 = a;
+	const ASTSortedIndex* index2 = b;
+	if( index1->section != index2->section ) {
+		return index1->section < index2->section ? -1 : 1;
+	}
+	if( index1->row != index2->row ) {
+		return index1->row < index2->row ? -1 : 1;
+	}
+	return 0;
+}
+
+//------------------------------------------------------------------------------
+
+// Calls the block once for each section with the rows of the index paths in the
+// section and the objects paired with them, in the order of the rows. The
+// indexes are unboxed once and sorted with qsort. NSNumber indexes are rows of
+// section 0. The objects may be nil.
+
+static void enumerateRowsBySection( NSArray* indexes, NSArray* objects,
+		void (^block)( NSUInteger section, NSIndexSet* rows, NSArray* rowObjects ) )
+{
+	NSUInteger count = indexes.count;
+	if( count == 0 ) {
+		return;
+	}
+	
+	NSMutableData* sortedData = [ NSMutableData dataWithLength: count * sizeof( ASTSortedIndex ) ];
+	ASTSortedIndex* sorted = sortedData.mutableBytes;
+	NSUInteger position = 0;
+	for( id index in indexes ) {
+		if( [ index isKindOfClass: [ NSIndexPath class ] ] ) {
+			NSIndexPath* indexPath = index;
+			sorted[ position ].section = indexPath.section;
+			sorted[ position ].row = indexPath.row;
+		} else {
+			sorted[ position ].section = 0;
+			sorted[ position ].row = [ index unsignedIntegerValue ];
+		}
+		sorted[ position ].position = position;
+		++position;
+	}
+	qsort( sorted, count, sizeof( ASTSortedIndex ), compareSortedIndexes );
+	
+	NSUInteger start = 0;
+	while( start < count ) {
+		NSUInteger section = sorted[ start ].section;
+		NSMutableIndexSet* rows = [ NSMutableIndexSet indexSet ];
+		NSMutableArray* rowObjects = objects ? [ NSMutableArray array ] : nil;
+		NSUInteger end = start;
+		for( ; end < count && sorted[ end ].section == section; ++end ) {
+			[ rows addIndex: sorted[ end ].row ];
+			[ rowObjects addObject: objects[ sorted[ end ].position ] ];
+		}
+		NSCAssert( rows.count == end - start, @"Repeated index in section %lu",
+				(unsigned long)section );
+		block( section, rows, rowObjects );
+		start = end;
 	}
-	return indexSet;
 }
 
 //------------------------------------------------------------------------------
 
-NSArray* sortArray( NSArray* indexArray, NSString* key, BOOL ascending )
+NSIndexSet* indexSetFromIndexes( NSArray* indexes, NSArray* objects,
+		NSArray** sortedObjects )
 {
-	NSSortDescriptor* descriptor = [ NSSortDescriptor
-			sortDescriptorWithKey: key
-			ascending: ascending ];
-	return [ indexArray sortedArrayUsingDescriptors: @[ descriptor ] ];
+	__block NSIndexSet* result = [ NSIndexSet indexSet ];
+	__block NSArray* resultObjects = objects ? @[] : nil;
+	enumerateRowsBySection( indexes, objects,
+			^( NSUInteger section, NSIndexSet* rows, NSArray* rowObjects ) {
+		result = rows;
+		resultObjects = rowObjects;
+	} );
+	if( sortedObjects ) {
+		*sortedObjects = resultObjects;
+	}
+	return result;
 }
 
 //------------------------------------------------------------------------------
 
-NSArray* sortIndexesOfArray( NSArray* array, NSString* key, BOOL ascending )
+void insertObjectsAtIndexSet( NSMutableArray* array, NSArray* objects,
+		NSIndexSet* indexes )
 {
-	NSSortDescriptor* descriptor = [ NSSortDescriptor
-			sortDescriptorWithKey: key
-			ascending: ascending ];
-	NSMutableArray* result = [ NSMutableArray arrayWithCapacity: array.count ];
-	for( NSUInteger i = 0; i < array.count; ++i ) {
-		[ result addObject: @(i) ];
+	NSCParameterAssert( objects.count == indexes.count );
+	
+	NSUInteger count = array.count;
+	if( objects.count <= 1 ) {
+		if( objects.count ) {
+			[ array insertObject: objects.firstObject atIndex: MIN( indexes.firstIndex, count ) ];
+		}
+		return;
 	}
 	
-	[ result sortUsingComparator: ^NSComparisonResult( id index1, id index2 ) {
-		id value1 = array[ [ index1 unsignedIntegerValue ] ];
-		id value2 = array[ [ index2 unsignedIntegerValue ] ];
-		return [ descriptor compareObject: value1 toObject: value2 ];
+	// Each index is where the object ends up, so the old objects are copied
+	// until the result reaches it. Indexes past the end append.
+	NSMutableArray* result = [ NSMutableArray arrayWithCapacity: count + objects.count ];
+	__block NSUInteger next = 0;
+	__block NSUInteger objectIndex = 0;
+	[ indexes enumerateIndexesUsingBlock: ^( NSUInteger index, BOOL* stop ) {
+		if( index > result.count && next < count ) {
+			NSUInteger length = MIN( index - result.count, count - next );
+			[ result addObjectsFromArray: [ array subarrayWithRange: NSMakeRange( next, length ) ] ];
+			next += length;
+		}
+		[ result addObject: objects[ objectIndex++ ] ];
 	} ];
+	if( next < count ) {
+		[ result addObjectsFromArray: [ array subarrayWithRange: NSMakeRange( next, count - next ) ] ];
+	}
+	[ array setArray: result ];
+}
+
+//------------------------------------------------------------------------------
+
+void removeObjectsAtIndexSet( NSMutableArray* array, NSIndexSet* indexes )
+{
+	NSUInteger count = array.count;
+	NSCParameterAssert( indexes.count == 0 || indexes.lastIndex < count );
+	if( indexes.count <= 1 ) {
+		if( indexes.count ) {
+			[ array removeObjectAtIndex: indexes.firstIndex ];
+		}
+		return;
+	}
 	
-	return [ result copy ];
+	NSMutableArray* result = [ NSMutableArray arrayWithCapacity: count - indexes.count ];
+	__block NSUInteger next = 0;
+	[ indexes enumerateRangesUsingBlock: ^( NSRange range, BOOL* stop ) {
+		[ result addObjectsFromArray: [ array subarrayWithRange:
+				NSMakeRange( next, range.location - next ) ] ];
+		next = NSMaxRange( range );
+	} ];
+	[ result addObjectsFromArray: [ array subarrayWithRange: NSMakeRange( next, count - next ) ] ];
+	[ array setArray: result ];
 }
 
 //------------------------------------------------------------------------------
 
-static NSArray* groupIndexesOfArray( NSArray* array, NSString* key,
-		NSString* sortKey, BOOL ascending )
+NSUInteger containerIndexOfObject( NSArray* container, id object,
+		NSUInteger* firstStaleIndex )
 {
-	NSMutableDictionary* groups = [ NSMutableDictionary dictionary ];
-	for( NSUInteger i = 0; i < array.count; ++i ) {
-		id object = array[ i ];
-		id keyValue = [ object valueForKey: key ];
-		NSMutableArray* group = groups[ keyValue ];
-		if( group == nil ) {
-			group = [ NSMutableArray array ];
-			groups[ keyValue ] = group;
+	NSUInteger count = container.count;
+	NSUInteger index = [ object containerIndex ];
+	if( index < *firstStaleIndex && index < count && container[ index ] == object ) {
+		return index;
+	}
+	
+	// Something changed at or after the first stale index. Renumbering from
+	// there makes the following lookups constant time until the next change.
+	for( NSUInteger i = *firstStaleIndex; i < count; ++i ) {
+		id containedObject = container[ i ];
+		if( [ containedObject respondsToSelector: @selector( setContainerIndex: ) ] ) {
+			[ containedObject setContainerIndex: i ];
 		}
-		[ group addObject: @(i) ];
 	}
-	NSMutableArray* keys = [ groups.allKeys mutableCopy ];
-	NSSortDescriptor* descriptor = [ NSSortDescriptor
-			sortDescriptorWithKey: sortKey
-			ascending: ascending ];
-	[ keys sortUsingDescriptors: @[ descriptor ] ];
-	NSMutableArray* result = [ NSMutableArray arrayWithCapacity: keys.count ];
-	for( id key in keys ) {
-		id keyValue = groups[ key ];
-		[ result addObject: keyValue ];
+	*firstStaleIndex = count;
+	
+	index = [ object containerIndex ];
+	if( index < count && container[ index ] == object ) {
+		return index;
 	}
-	return result;
+	return NSNotFound;
+}
+
+//------------------------------------------------------------------------------
+
+static BOOL sectionsHaveSameHeaderAndFooter( ASTSection* section, ASTSection* otherSection )
+{
+	return (section.headerText == otherSection.headerText
+					|| [ section.headerText isEqualToString: otherSection.headerText ])
+			&& (section.footerText == otherSection.footerText
+					|| [ section.footerText isEqualToString: otherSection.footerText ])
+			&& section.headerView == otherSection.headerView
+			&& section.footerView == otherSection.footerView;
 }
 
 //------------------------------------------------------------------------------
 
-static NSArray* objectsAtIndexes( NSArray* sourceArray, NSArray* indexArray )
+// Adds the changes of a section replaced by a different section that matched it
+// by identifier. The rows are compared when only the items differ.
+
+static void addChangesOfReplacedSection( ASTTableViewUpdate* update,
+		ASTSection* oldSection, ASTSection* newSection, NSUInteger oldIndex,
+		NSUInteger newIndex, BOOL moved )
 {
-	NSMutableArray* result = [ NSMutableArray arrayWithCapacity: indexArray.count ];
-	for( NSNumber* indexValue in indexArray ) {
-		NSUInteger index = [ indexValue unsignedIntegerValue ];
-		id value = sourceArray[ index ];
-		[ result addObject: value ];
+	if( moved ) {
+		// Rows can not be updated in a section that moves.
+		[ update deleteSection: oldIndex ];
+		[ update insertSection: newIndex ];
+	} else if( sectionsHaveSameHeaderAndFooter( oldSection, newSection )
+			&& oldSection.hasLazyItems == NO && newSection.hasLazyItems == NO ) {
+		NSArray* oldItems = oldSection.items;
+		NSArray* newItems = newSection.items;
+		[ update addRowsOfDiff: [ ASTDiff diffFromObjects: oldItems toObjects: newItems ]
+				oldItems: oldItems newItems: newItems
+				section: oldIndex newSection: newIndex ];
+	} else {
+		[ update reloadSection: oldIndex ];
 	}
-	return result;
 }
 
 //------------------------------------------------------------------------------
 
-static NSArray* mapIndexPathsToRows( NSArray* indexPaths )
+// Adds the changes between two presentations of the table, each made of the
+// displayed sections and an array of the displayed items of each of them. The
+// items of a section are NSNull when they are not known, in which case the
+// section is reloaded. A plain table has one section, which is NSNull.
+
+static void addChangesOfPresentation( ASTTableViewUpdate* update,
+		NSArray* oldSections, NSArray* oldItems,
+		NSArray* newSections, NSArray* newItems )
 {
-	NSMutableArray* result = [ NSMutableArray arrayWithCapacity: indexPaths.count ];
-	for( NSIndexPath* indexPath in indexPaths ) {
-		[ result addObject: @(indexPath.row) ];
+	ASTDiff* diff = [ ASTDiff diffFromObjects: oldSections toObjects: newSections ];
+	[ diff.deletedIndexes enumerateIndexesUsingBlock: ^( NSUInteger index, BOOL* stop ) {
+		[ update deleteSection: index ];
+	} ];
+	for( NSUInteger i = 0; i < newSections.count; ++i ) {
+		NSUInteger oldIndex = [ diff oldIndexForNewIndex: i ];
+		if( oldIndex == NSNotFound ) {
+			[ update insertSection: i ];
+			continue;
+		}
+		
+		NSArray* oldSectionItems = oldItems[ oldIndex ];
+		NSArray* newSectionItems = newItems[ i ];
+		BOOL itemsKnown = oldSectionItems != (id)[ NSNull null ]
+				&& newSectionItems != (id)[ NSNull null ];
+		if( [ diff.movedIndexes containsIndex: i ] ) {
+			if( itemsKnown && arraysHaveSameObjects( oldSectionItems, newSectionItems ) ) {
+				[ update moveSection: oldIndex toSection: i ];
+			} else {
+				// Rows can not be updated in a section that moves.
+				[ update deleteSection: oldIndex ];
+				[ update insertSection: i ];
+			}
+		} else if( itemsKnown == NO || oldSections[ oldIndex ] != newSections[ i ] ) {
+			[ update reloadSection: oldIndex ];
+		} else if( arraysHaveSameObjects( oldSectionItems, newSectionItems ) == NO ) {
+			[ update addRowsOfDiff: [ ASTDiff diffFromObjects: oldSectionItems
+							toObjects: newSectionItems ]
+					oldItems: oldSectionItems newItems: newSectionItems
+					section: oldIndex newSection: i ];
+		}
 	}
-	return result;
+}
+
+//------------------------------------------------------------------------------
+
+// Returns YES if every item matching the new filter tokens matches the old
+// ones, which is the case when each old token starts the new token at its
+// position.
+
+static BOOL filterTokensNarrowTokens( NSArray* newTokens, NSArray* oldTokens )
+{
+	if( newTokens.count < oldTokens.count ) {
+		return NO;
+	}
+	for( NSUInteger i = 0; i < oldTokens.count; ++i ) {
+		if( [ newTokens[ i ] hasPrefix: oldTokens[ i ] ] == NO ) {
+			return NO;
+		}
+	}
+	return YES;
 }
 
 //------------------------------------------------------------------------------
@@ -167,8 +370,134 @@ static ASTSection* sectionFromObject( id sectionObject )
 
 //------------------------------------------------------------------------------
 
-@interface ASTViewController() {
+// Arrays at least this long are built on several threads, in chunks of this
+// size.
+static const NSUInteger ASTConcurrentBuildChunkSize = 256;
+
+// Returns the non-nil results of calling the block with each of the objects,
+// in order. The first exception raised by the block is raised again after all
+// of the objects are done.
+
+static NSArray* buildObjectsConcurrently( NSArray* objects, id (^build)( id object ) )
+{
+	NSUInteger count = objects.count;
+	if( count < ASTConcurrentBuildChunkSize ) {
+		NSMutableArray* result = [ NSMutableArray arrayWithCapacity: count ];
+		for( id object in objects ) {
+			id builtObject = build( object );
+			if( builtObject ) {
+				[ result addObject: builtObject ];
+			}
+		}
+		return result;
+	}
+	
+	__strong id* builtObjects = (__strong id*)calloc( count, sizeof( id ) );
+	NSObject* exceptionLock = [ [ NSObject alloc ] init ];
+	__block NSException* exception = nil;
+	size_t chunkCount = (count + ASTConcurrentBuildChunkSize - 1) / ASTConcurrentBuildChunkSize;
+	dispatch_apply( chunkCount, dispatch_get_global_queue( QOS_CLASS_USER_INITIATED, 0 ), ^( size_t chunk ) {
+		NSUInteger end = MIN( (chunk + 1) * ASTConcurrentBuildChunkSize, count );
+		@try {
+			for( NSUInteger i = chunk * ASTConcurrentBuildChunkSize; i < end; ++i ) {
+				builtObjects[ i ] = build( objects[ i ] );
+			}
+		} @catch( NSException* chunkException ) {
+			@synchronized( exceptionLock ) {
+				exception = exception ?: chunkException;
+			}
+		}
+	} );
+	
+	NSMutableArray* result = [ NSMutableArray arrayWithCapacity: count ];
+	for( NSUInteger i = 0; i < count; ++i ) {
+		if( builtObjects[ i ] ) {
+			[ result addObject: builtObjects[ i ] ];
+			builtObjects[ i ] = nil;
+		}
+	}
+	free( builtObjects );
+	
+	[ exception raise ];
+	return result;
+}
+
+//------------------------------------------------------------------------------
+
+// Builds a section with its items built concurrently.
+
+static ASTSection* buildSection( id sectionObject )
+{
+	if( [ sectionObject isKindOfClass: [ NSDictionary class ] ] ) {
+		NSArray* itemObjects = sectionObject[ AST_items ];
+		if( [ itemObjects isKindOfClass: [ NSArray class ] ] ) {
+			NSMutableDictionary* dict = [ sectionObject mutableCopy ];
+			dict[ AST_items ] = buildObjectsConcurrently( itemObjects, ^id( id itemObject ) {
+				return itemFromObject( itemObject );
+			} );
+			sectionObject = dict;
+		}
+	}
+	return sectionFromObject( sectionObject );
+}
+
+//------------------------------------------------------------------------------
+
+// Returns nil before iOS 10, where traits do not have a content size category.
+
+static NSString* contentSizeCategoryOfTraitCollection( UITraitCollection* traitCollection )
+{
+	if( [ traitCollection respondsToSelector: @selector(preferredContentSizeCategory) ] ) {
+		return traitCollection.preferredContentSizeCategory;
+	}
+	return nil;
+}
+
+//------------------------------------------------------------------------------
+
+@interface ASTViewController() <ASTObjectIndexContainer, UITableViewDataSourcePrefetching> {
 	NSMutableArray* _data;
+	// Sections or items in _data at or after this index have a stale
+	// containerIndex.
+	NSUInteger _firstStaleIndex;
+	// Index the sections or items in _data. Code that changes _data must also
+	// update these.
+	ASTObjectIndex* _identifierIndex;
+	ASTObjectIndex* _representedObjectIndex;
+	ASTCellPool* _cellPool;
+	// Items whose cells are on screen and have changes waiting for the display
+	// link to fire. See defersCellUpdates.
+	NSHashTable* _itemsNeedingCellUpdate;
+	CADisplayLink* _cellUpdateDisplayLink;
+	// Items whose rows may need a new height at the next display frame. See
+	// setNeedsRowHeightUpdateForItem:.
+	NSHashTable* _itemsNeedingRowHeightUpdate;
+	CADisplayLink* _rowHeightUpdateDisplayLink;
+	NSUInteger _sectionViewMeasurementCount;
+	ASTRowHeightCache* _rowHeightCache;
+	// Incremented each time the data is set so that data built in the
+	// background can tell if it is still wanted.
+	NSUInteger _dataGeneration;
+	// While performBatchUpdates: runs, the sections or items before the batch,
+	// the items of the sections changed by the batch before they changed, and
+	// the sections to reload.
+	NSUInteger _batchUpdateDepth;
+	NSArray* _dataBeforeBatch;
+	NSMapTable* _itemsBeforeBatch;
+	NSHashTable* _sectionsToReloadAfterBatch;
+	// While filtering, the words of the filter text, the index of the words of
+	// the items with the items it must be updated with, and the displayed
+	// sections with their displayed items. A plain table has one displayed
+	// section, which is NSNull. The displayed sections and items only change
+	// when the filter results are updated, so they keep matching the table view
+	// while the model changes.
+	NSString* _filterText;
+	NSArray* _filterTokens;
+	ASTSearchIndex* _searchIndex;
+	NSHashTable* _staleSearchItems;
+	NSArray* _filteredSections;
+	NSArray* _filteredItems;
+	BOOL _filterUpdateScheduled;
 }
 
 @end
@@ -231,6 +560,10 @@ static ASTSection* sectionFromObject( id sectionObject )
 - (void) initializeASTViewControllerMembers
 {
 	_data = [ NSMutableArray array ];
+	_identifierIndex = [ [ ASTObjectIndex alloc ] initWithKey: @"identifier" ];
+	_representedObjectIndex = [ [ ASTObjectIndex alloc ]
+			initWithKey: @"representedObject" ];
+	_rowHeightCache = [ [ ASTRowHeightCache alloc ] initWithKey: nil ];
 }
 
 //------------------------------------------------------------------------------
@@ -241,24 +574,56 @@ static ASTSection* sectionFromObject( id sectionObject )
 	
 	UITableView* tableView = self.tableView;
 	// Note that setting both the estimatedRowHeight and rowHeight seem to be
-	// necessary to get the tableview to correctly handle autolayout.
+	// necessary to get the tableview to correctly handle autolayout. The
+	// estimate is only used for rows whose height was not recorded yet.
 	tableView.estimatedRowHeight = 44;
 	tableView.rowHeight = UITableViewAutomaticDimension;
 	tableView.allowsMultipleSelectionDuringEditing = NO;
+	if( [ tableView respondsToSelector: @selector(setPrefetchDataSource:) ] ) {
+		tableView.prefetchDataSource = self;
+	}
 }
 
 //------------------------------------------------------------------------------
 
-- (ASTSection*) sectionWithIdentifier: (NSString*) identifier
+- (void) viewDidDisappear: (BOOL) animated
+{
+	[ super viewDidDisappear: animated ];
+	
+	[ _rowHeightCache save ];
+}
+
+//------------------------------------------------------------------------------
+
+- (void) didReceiveMemoryWarning
+{
+	[ super didReceiveMemoryWarning ];
+	
+	[ _cellPool removeAllCells ];
+}
+
+//------------------------------------------------------------------------------
+
+- (void) traitCollectionDidChange: (UITraitCollection*) previousTraitCollection
 {
+	[ super traitCollectionDidChange: previousTraitCollection ];
+	
+	// Header and footer views can change size with any trait, for example when
+	// they use size classes.
 	if( self.tableView.style == UITableViewStyleGrouped ) {
 		for( ASTSection* section in _data ) {
-			if( section.identifier == identifier
-					|| [ section.identifier isEqualToString: identifier ] ) {
-				return section;
-			}
+			[ section invalidateMeasuredHeights ];
 		}
 	}
+}
+
+//------------------------------------------------------------------------------
+
+- (ASTSection*) sectionWithIdentifier: (NSString*) identifier
+{
+	if( self.tableView.style == UITableViewStyleGrouped ) {
+		return [ self indexedObjectWithValue: identifier inIndex: _identifierIndex ];
+	}
 	
 	return nil;
 }
@@ -287,12 +652,7 @@ static ASTSection* sectionFromObject( id sectionObject )
 			}
 		}
 	} else {
-		for( ASTItem* item in _data ) {
-			if( item.identifier == identifier
-					|| [ item.identifier isEqualToString: identifier ] ) {
-				return item;
-			}
-		}
+		return [ self indexedObjectWithValue: identifier inIndex: _identifierIndex ];
 	}
 	
 	return nil;
@@ -310,11 +670,25 @@ static ASTSection* sectionFromObject( id sectionObject )
 			}
 		}
 	} else {
-		for( ASTItem* item in _data ) {
-			if( item.representedObject == representedObject
-					|| [ item.representedObject isEqual: representedObject ] ) {
-				return item;
-			}
+		return [ self indexedObjectWithValue: representedObject
+				inIndex: _representedObjectIndex ];
+	}
+	
+	return nil;
+}
+
+//------------------------------------------------------------------------------
+
+- (id) indexedObjectWithValue: (id) value inIndex: (ASTObjectIndex*) index
+{
+	if( value ) {
+		return [ index firstObjectWithValue: value inContainer: _data
+				firstStaleIndex: &_firstStaleIndex ];
+	}
+	
+	for( id object in _data ) {
+		if( [ object valueForKey: index.key ] == nil ) {
+			return object;
 		}
 	}
 	
@@ -323,6 +697,18 @@ static ASTSection* sectionFromObject( id sectionObject )
 
 //------------------------------------------------------------------------------
 
+- (void) indexedObject: (id) object didChangeValueForKey: (NSString*) key
+		fromValue: (id) oldValue
+{
+	if( [ key isEqualToString: _identifierIndex.key ] ) {
+		[ _identifierIndex object: object didChangeValueFrom: oldValue ];
+	} else if( [ key isEqualToString: _representedObjectIndex.key ] ) {
+		[ _representedObjectIndex object: object didChangeValueFrom: oldValue ];
+	}
+}
+
+//------------------------------------------------------------------------------
+
 - (ASTItem*) itemAtIndexPath: (NSIndexPath*) indexPath
 {
 	if( indexPath == nil ) {
@@ -356,49 +742,39 @@ static ASTSection* sectionFromObject( id sectionObject )
 		return NSNotFound;
 	}
 	
-	int sectionIndex = 0;
-	
-	for( ASTSection* iterSection in _data ) {
-		if( iterSection == section ) {
-			return sectionIndex;
-		}
-		++sectionIndex;
+	if( section.tableViewController != self ) {
+		return NSNotFound;
 	}
 	
-	return NSNotFound;
+	return containerIndexOfObject( _data, section, &_firstStaleIndex );
 }
 
 //------------------------------------------------------------------------------
 
 - (NSIndexPath*) indexPathForItem: (ASTItem*) item
 {
-	if( item == nil ) {
+	if( item == nil || item.tableViewController != self ) {
 		return nil;
 	}
 	
-	int section = 0;
-	int row = 0;
-	Class sectionClass = [ ASTSection class ];
+	ASTPerformanceSpan span = ASTPerformanceSpanBegin( _performanceMetrics );
+	NSUInteger section = 0;
+	NSUInteger row = NSNotFound;
 	
-	for( id sectionOrItem in _data ) {
-		if( [ sectionOrItem isKindOfClass: sectionClass ] ) {
-			row = 0;
-			for( id sectionItem in [ sectionOrItem items ] ) {
-				if( sectionItem == item ) {
-					return [ NSIndexPath indexPathForItem: row inSection: section ];
-				}
-				++row;
-			}
-			++section;
-		} else {
-			if( sectionOrItem == item ) {
-				return [ NSIndexPath indexPathForItem: row inSection: section ];
-			}
+	if( self.tableView.style == UITableViewStyleGrouped ) {
+		section = [ self indexOfSection: item.section ];
+		if( section != NSNotFound ) {
+			row = [ item.section indexOfItem: item ];
 		}
-		++row;
+	} else if( item.section == nil ) {
+		row = containerIndexOfObject( _data, item, &_firstStaleIndex );
 	}
+	ASTPerformanceSpanEnd( span, ASTPerformanceOperationIndexPathForItem, nil );
 	
-	return nil;
+	if( row == NSNotFound ) {
+		return nil;
+	}
+	return [ NSIndexPath indexPathForItem: row inSection: section ];
 }
 
 //------------------------------------------------------------------------------
@@ -414,18 +790,28 @@ static ASTSection* sectionFromObject( id sectionObject )
 {
 	NSParameterAssert( sections.count == indexes.count );
 	
-	if( self.tableView.style == UITableViewStyleGrouped ) {
-		NSArray* sortedIndexes = sortIndexesOfArray( indexes, @"unsignedIntegerValue", SortAscending );
-		for( NSInteger i = 0; i < sortedIndexes.count; ++i ) {
-			NSUInteger sortedIndex = [ sortedIndexes[ i ] unsignedIntegerValue ];
-			ASTSection* section = sectionFromObject( sections[ sortedIndex ] );
+	NSArray* sortedSections = nil;
+	NSIndexSet* indexSet = indexSetFromIndexes( indexes, sections, &sortedSections );
+	[ self insertSections: sortedSections atIndexSet: indexSet ];
+}
+
+//------------------------------------------------------------------------------
+
+- (void) insertSections: (NSArray*) sections atIndexSet: (NSIndexSet*) indexes
+{
+	NSParameterAssert( sections.count == indexes.count );
+	
+	if( self.tableView.style == UITableViewStyleGrouped && indexes.count ) {
+		NSMutableArray* insertedSections = [ NSMutableArray arrayWithCapacity: sections.count ];
+		for( id object in sections ) {
+			ASTSection* section = sectionFromObject( object );
 			NSParameterAssert( section != nil );
-			NSUInteger sectionIndex = [ indexes[ sortedIndex ] unsignedIntegerValue ];
-			if( sectionIndex >= _data.count ) {
-				[ _data addObject: section ];
-			} else {
-				[ _data insertObject: section atIndex: sectionIndex ];
-			}
+			[ insertedSections addObject: section ];
+		}
+		insertObjectsAtIndexSet( _data, insertedSections, indexes );
+		_firstStaleIndex = MIN( _firstStaleIndex, indexes.firstIndex );
+		for( ASTSection* section in insertedSections ) {
+			[ _identifierIndex addObject: section ];
 			section.tableViewController = self;
 		}
 	}
@@ -435,12 +821,19 @@ static ASTSection* sectionFromObject( id sectionObject )
 
 - (void) removeSectionsAtIndexes: (NSArray*) indexes
 {
-	if( self.tableView.style == UITableViewStyleGrouped ) {
-		NSArray* sortedIndexes = sortArray( indexes, @"unsignedIntegerValue", SortDescending );
-		for( NSInteger i = 0; i < sortedIndexes.count; ++i ) {
-			NSUInteger index = [ sortedIndexes[ i ] unsignedIntegerValue ];
-			ASTSection* section = _data[ index ];
-			[ _data removeObjectAtIndex: index ];
+	[ self removeSectionsAtIndexSet: indexSetFromIndexes( indexes, nil, NULL ) ];
+}
+
+//------------------------------------------------------------------------------
+
+- (void) removeSectionsAtIndexSet: (NSIndexSet*) indexes
+{
+	if( self.tableView.style == UITableViewStyleGrouped && indexes.count ) {
+		NSArray* removedSections = [ _data objectsAtIndexes: indexes ];
+		removeObjectsAtIndexSet( _data, indexes );
+		_firstStaleIndex = MIN( _firstStaleIndex, indexes.firstIndex );
+		for( ASTSection* section in removedSections ) {
+			[ _identifierIndex removeObject: section ];
 			section.tableViewController = nil;
 		}
 	}
@@ -454,6 +847,7 @@ static ASTSection* sectionFromObject( id sectionObject )
 		id section = _data[ index ];
 		[ _data removeObjectAtIndex: index ];
 		[ _data insertObject: section atIndex: newIndex ];
+		_firstStaleIndex = MIN( _firstStaleIndex, MIN( index, newIndex ) );
 	}
 }
 
@@ -464,30 +858,31 @@ static ASTSection* sectionFromObject( id sectionObject )
 	NSParameterAssert( items.count == indexPaths.count );
 	
 	if( self.tableView.style == UITableViewStyleGrouped ) {
-		NSArray* indexGroups = groupIndexesOfArray( indexPaths, @"section",
-				@"unsignedIntegerValue", SortDescending );
-		for( NSArray* indexGroup in indexGroups ) {
-			NSArray* groupItems = objectsAtIndexes( items, indexGroup );
-			NSArray* groupPaths = objectsAtIndexes( indexPaths, indexGroup );
-			NSUInteger sectionIndex = ((NSIndexPath*)(groupPaths.firstObject)).section;
+		enumerateRowsBySection( indexPaths, items,
+				^( NSUInteger sectionIndex, NSIndexSet* rows, NSArray* rowItems ) {
 			ASTSection* section = [ self sectionAtIndex: sectionIndex ];
-			[ section insertItemReferences: groupItems atIndexes: mapIndexPathsToRows( groupPaths ) ];
-		}
-	} else {
-		NSArray* sortedIndexes = sortIndexesOfArray( indexPaths, @"row", SortAscending );
-		for( NSInteger i = 0; i < items.count; ++i ) {
-			NSUInteger sortedIndex = [ sortedIndexes[ i ] unsignedIntegerValue ];
-			ASTItem* item = itemFromObject( items[ sortedIndex ] );
-			NSParameterAssert( item != nil );
-			NSIndexPath* path = indexPaths[ sortedIndex ];
-			NSUInteger dataIndex = path.row;
-			if( dataIndex >= _data.count ) {
-				[ _data addObject: item ];
-			} else {
-				[ _data insertObject: item atIndex: dataIndex ];
-			}
-			item.tableViewController = self;
-		}
+			[ section insertItemReferences: rowItems atIndexSet: rows ];
+		} );
+		return;
+	}
+	
+	NSArray* sortedObjects = nil;
+	NSIndexSet* rows = indexSetFromIndexes( indexPaths, items, &sortedObjects );
+	if( rows.count == 0 ) {
+		return;
+	}
+	NSMutableArray* insertedItems = [ NSMutableArray arrayWithCapacity: sortedObjects.count ];
+	for( id object in sortedObjects ) {
+		ASTItem* item = itemFromObject( object );
+		NSParameterAssert( item != nil );
+		[ insertedItems addObject: item ];
+	}
+	insertObjectsAtIndexSet( _data, insertedItems, rows );
+	_firstStaleIndex = MIN( _firstStaleIndex, rows.firstIndex );
+	for( ASTItem* item in insertedItems ) {
+		[ _identifierIndex addObject: item ];
+		[ _representedObjectIndex addObject: item ];
+		item.tableViewController = self;
 	}
 }
 
@@ -496,26 +891,40 @@ static ASTSection* sectionFromObject( id sectionObject )
 - (void) removeItemsAtIndexPaths: (NSArray*) indexPaths
 {
 	if( self.tableView.style == UITableViewStyleGrouped ) {
-		NSArray* sortedIndexes = sortIndexesOfArray( indexPaths, @"row", SortDescending );
-		for( NSInteger i = 0; i < indexPaths.count; ++i ) {
-			NSUInteger sortedIndex = [ sortedIndexes[ i ] unsignedIntegerValue ];
-			NSIndexPath* path = indexPaths[ sortedIndex ];
-			ASTSection* section = [ self sectionAtIndex: path.section ];
-			[ section removeItemReferencesAtIndexes: @[ @(path.row) ] ];
-		}
-	} else {
-		NSArray* sortedIndexPaths = sortArray( indexPaths, @"row", SortDescending );
-		for( NSInteger i = 0; i < sortedIndexPaths.count; ++i ) {
-			NSIndexPath* path = sortedIndexPaths[ i ];
-			ASTItem* item = [ self itemAtIndexPath: path ];
-			[ _data removeObjectAtIndex: path.row ];
-			item.tableViewController = nil;
-		}
+		enumerateRowsBySection( indexPaths, nil,
+				^( NSUInteger sectionIndex, NSIndexSet* rows, NSArray* rowItems ) {
+			ASTSection* section = [ self sectionAtIndex: sectionIndex ];
+			[ section removeItemReferencesAtIndexSet: rows ];
+		} );
+		return;
+	}
+	
+	NSIndexSet* rows = indexSetFromIndexes( indexPaths, nil, NULL );
+	if( rows.count == 0 ) {
+		return;
+	}
+	NSArray* removedItems = [ _data objectsAtIndexes: rows ];
+	removeObjectsAtIndexSet( _data, rows );
+	_firstStaleIndex = MIN( _firstStaleIndex, rows.firstIndex );
+	for( ASTItem* item in removedItems ) {
+		[ _identifierIndex removeObject: item ];
+		[ _representedObjectIndex removeObject: item ];
+		item.tableViewController = nil;
 	}
 }
 
 //------------------------------------------------------------------------------
 
+// Changes made inside performBatchUpdates:withRowAnimation: are recorded as
+// part of its batch update.
+
+- (ASTPerformanceMetrics*) batchUpdateMetrics
+{
+	return _batchUpdateDepth ? nil : _performanceMetrics;
+}
+
+//------------------------------------------------------------------------------
+
 - (void) moveItemAtIndexPath: (NSIndexPath*) indexPath
 		toIndexPath: (NSIndexPath*) newIndexPath
 {
@@ -524,20 +933,27 @@ static ASTSection* sectionFromObject( id sectionObject )
 	ASTItem* item = [ self itemAtIndexPath: indexPath ];
 	NSAssert( item != nil, @"indexPath is not valid %@", indexPath );
 	
-	UITableView* tableView = self.tableView;
+	ASTPerformanceSpan span = ASTPerformanceSpanBegin( [ self batchUpdateMetrics ] );
+	UITableView* tableView = self.tableViewForUpdates;
 	
 	[ tableView beginUpdates ];
-	if( tableView.style == UITableViewStyleGrouped ) {
+	if( self.tableView.style == UITableViewStyleGrouped ) {
 		ASTSection* section = [ self sectionAtIndex: indexPath.section ];
-		[ section removeItemReferencesAtIndexes: @[ @(indexPath.row) ] ];
+		[ self recordBatchChangeOfSection: section ];
+		[ section removeItemReferencesAtIndexSet: [ NSIndexSet indexSetWithIndex: indexPath.row ] ];
 		
 		section = [ self sectionAtIndex: newIndexPath.section ];
-		[ section insertItemReferences: @[ item ] atIndexes: @[ @(newIndexPath.row) ] ];
+		[ self recordBatchChangeOfSection: section ];
+		[ section insertItemReferences: @[ item ]
+				atIndexSet: [ NSIndexSet indexSetWithIndex: newIndexPath.row ] ];
 	} else {
 		[ _data removeObjectAtIndex: indexPath.row ];
 		[ _data insertObject: item atIndex: newIndexPath.row ];
+		_firstStaleIndex = MIN( _firstStaleIndex,
+				MIN( indexPath.row, newIndexPath.row ) );
 	}
 	[ tableView endUpdates ];
+	ASTPerformanceSpanEnd( span, ASTPerformanceOperationBatchUpdate, nil );
 }
 
 //------------------------------------------------------------------------------
@@ -547,13 +963,26 @@ static ASTSection* sectionFromObject( id sectionObject )
 {
 	NSParameterAssert( sections.count == indexes.count );
 	
-	UITableView* tableView = self.tableView;
-	if( tableView.style == UITableViewStyleGrouped ) {
+	NSArray* sortedSections = nil;
+	NSIndexSet* indexSet = indexSetFromIndexes( indexes, sections, &sortedSections );
+	[ self insertSections: sortedSections atIndexSet: indexSet withRowAnimation: animation ];
+}
+
+//------------------------------------------------------------------------------
+
+- (void) insertSections: (NSArray*) sections atIndexSet: (NSIndexSet*) indexes
+		withRowAnimation: (UITableViewRowAnimation) animation
+{
+	NSParameterAssert( sections.count == indexes.count );
+	
+	if( self.tableView.style == UITableViewStyleGrouped ) {
+		ASTPerformanceSpan span = ASTPerformanceSpanBegin( [ self batchUpdateMetrics ] );
+		UITableView* tableView = self.tableViewForUpdates;
 		[ tableView beginUpdates ];
-		[ self insertSections: sections atIndexes: indexes ];
-		[ tableView insertSections: indexSetFromArray( indexes )
-				withRowAnimation: animation ];
+		[ self insertSections: sections atIndexSet: indexes ];
+		[ tableView insertSections: indexes withRowAnimation: animation ];
 		[ tableView endUpdates ];
+		ASTPerformanceSpanEnd( span, ASTPerformanceOperationBatchUpdate, nil );
 	}
 }
 
@@ -562,13 +991,23 @@ static ASTSection* sectionFromObject( id sectionObject )
 - (void) removeSectionsAtIndexes: (NSArray*) indexes
 		withRowAnimation: (UITableViewRowAnimation) animation
 {
-	UITableView* tableView = self.tableView;
-	if( tableView.style == UITableViewStyleGrouped ) {
+	[ self removeSectionsAtIndexSet: indexSetFromIndexes( indexes, nil, NULL )
+			withRowAnimation: animation ];
+}
+
+//------------------------------------------------------------------------------
+
+- (void) removeSectionsAtIndexSet: (NSIndexSet*) indexes
+		withRowAnimation: (UITableViewRowAnimation) animation
+{
+	if( self.tableView.style == UITableViewStyleGrouped ) {
+		ASTPerformanceSpan span = ASTPerformanceSpanBegin( [ self batchUpdateMetrics ] );
+		UITableView* tableView = self.tableViewForUpdates;
 		[ tableView beginUpdates ];
-		[ self removeSectionsAtIndexes: indexes ];
-		[ tableView deleteSections: indexSetFromArray( indexes )
-				withRowAnimation: animation ];
+		[ self removeSectionsAtIndexSet: indexes ];
+		[ tableView deleteSections: indexes withRowAnimation: animation ];
 		[ tableView endUpdates ];
+		ASTPerformanceSpanEnd( span, ASTPerformanceOperationBatchUpdate, nil );
 	}
 }
 
@@ -577,12 +1016,14 @@ static ASTSection* sectionFromObject( id sectionObject )
 - (void) moveSectionWithAnimationAtIndex: (NSUInteger) index
 		toIndex: (NSUInteger) newIndex
 {
-	UITableView* tableView = self.tableView;
-	if( tableView.style == UITableViewStyleGrouped ) {
+	if( self.tableView.style == UITableViewStyleGrouped ) {
+		ASTPerformanceSpan span = ASTPerformanceSpanBegin( [ self batchUpdateMetrics ] );
+		UITableView* tableView = self.tableViewForUpdates;
 		[ tableView beginUpdates ];
 		[ self moveSectionAtIndex: index toIndex: newIndex ];
 		[ tableView moveSection: index toSection: newIndex ];
 		[ tableView endUpdates ];
+		ASTPerformanceSpanEnd( span, ASTPerformanceOperationBatchUpdate, nil );
 	}
 }
 
@@ -593,11 +1034,14 @@ static ASTSection* sectionFromObject( id sectionObject )
 {
 	NSParameterAssert( items.count == indexPaths.count );
 	
-	UITableView* tableView = self.tableView;
+	ASTPerformanceSpan span = ASTPerformanceSpanBegin( [ self batchUpdateMetrics ] );
+	UITableView* tableView = self.tableViewForUpdates;
 	[ tableView beginUpdates ];
+	[ self recordBatchChangeOfSectionsAtIndexPaths: indexPaths ];
 	[ self insertItems: items atIndexPaths: indexPaths ];
-	[ self.tableView insertRowsAtIndexPaths: indexPaths withRowAnimation: animation ];
+	[ tableView insertRowsAtIndexPaths: indexPaths withRowAnimation: animation ];
 	[ tableView endUpdates ];
+	ASTPerformanceSpanEnd( span, ASTPerformanceOperationBatchUpdate, nil );
 }
 
 //------------------------------------------------------------------------------
@@ -605,11 +1049,14 @@ static ASTSection* sectionFromObject( id sectionObject )
 - (void) removeItemsAtIndexPaths: (NSArray*) indexPaths
 		withRowAnimation: (UITableViewRowAnimation) animation
 {
-	UITableView* tableView = self.tableView;
+	ASTPerformanceSpan span = ASTPerformanceSpanBegin( [ self batchUpdateMetrics ] );
+	UITableView* tableView = self.tableViewForUpdates;
 	[ tableView beginUpdates ];
+	[ self recordBatchChangeOfSectionsAtIndexPaths: indexPaths ];
 	[ self removeItemsAtIndexPaths: indexPaths ];
-	[ self.tableView deleteRowsAtIndexPaths: indexPaths withRowAnimation: animation ];
+	[ tableView deleteRowsAtIndexPaths: indexPaths withRowAnimation: animation ];
 	[ tableView endUpdates ];
+	ASTPerformanceSpanEnd( span, ASTPerformanceOperationBatchUpdate, nil );
 }
 
 //------------------------------------------------------------------------------
@@ -619,69 +1066,673 @@ static ASTSection* sectionFromObject( id sectionObject )
 {
 	NSAssert( [ self itemAtIndexPath: indexPath ] != nil, @"indexPath is not valid %@", indexPath );
 	
-	UITableView* tableView = self.tableView;
+	UITableView* tableView = self.tableViewForUpdates;
 	[ tableView beginUpdates ];
 	[ self moveItemAtIndexPath: indexPath toIndexPath: newIndexPath ];
-	[ self.tableView moveRowAtIndexPath: indexPath toIndexPath: newIndexPath ];
+	[ tableView moveRowAtIndexPath: indexPath toIndexPath: newIndexPath ];
 	[ tableView endUpdates ];
 }
 
 //------------------------------------------------------------------------------
 
-- (void) selectItem: (ASTItem*) item withAnimation: (BOOL) animated
-		scrollPosition: (UITableViewScrollPosition) scrollPosition
+- (void) performBatchUpdates: (ASTUpdateBlock) updates
+		withRowAnimation: (UITableViewRowAnimation) animation
 {
-	NSIndexPath* indexPath = [ self indexPathForItem: item ];
-	[ self.tableView selectRowAtIndexPath: indexPath animated: animated scrollPosition: scrollPosition ];
+	NSParameterAssert( updates );
+	
+	if( _batchUpdateDepth++ ) {
+		updates();
+		--_batchUpdateDepth;
+		return;
+	}
+	
+	ASTPerformanceSpan span = ASTPerformanceSpanBegin( _performanceMetrics );
+	_dataBeforeBatch = [ _data copy ];
+	_itemsBeforeBatch = [ NSMapTable
+			mapTableWithKeyOptions: NSPointerFunctionsObjectPointerPersonality
+			valueOptions: NSPointerFunctionsStrongMemory ];
+	_sectionsToReloadAfterBatch = [ NSHashTable
+			hashTableWithOptions: NSPointerFunctionsObjectPointerPersonality ];
+	
+	updates();
+	
+	ASTTableViewUpdate* update = [ self updateForBatch ];
+	_batchUpdateDepth = 0;
+	_dataBeforeBatch = nil;
+	_itemsBeforeBatch = nil;
+	_sectionsToReloadAfterBatch = nil;
+	
+	if( _filterTokens ) {
+		// The filter results are updated from the model instead.
+		[ self setNeedsFilterUpdate ];
+	} else if( update.empty == NO ) {
+		UITableView* tableView = self.tableView;
+		[ tableView beginUpdates ];
+		[ update applyToTableView: tableView withRowAnimation: animation ];
+		[ tableView endUpdates ];
+	}
+	ASTPerformanceSpanEnd( span, ASTPerformanceOperationBatchUpdate, nil );
 }
 
 //------------------------------------------------------------------------------
 
-- (void) deselectItem: (ASTItem*) item withAnimation: (BOOL) animated
+- (void) performBatchUpdates: (ASTUpdateBlock) updates
 {
-	NSIndexPath* indexPath = [ self indexPathForItem: item ];
-	[ self.tableView deselectRowAtIndexPath: indexPath animated: animated ];
+	[ self performBatchUpdates: updates withRowAnimation: UITableViewRowAnimationAutomatic ];
 }
 
 //------------------------------------------------------------------------------
 
-#pragma mark - Accessors
-
-//------------------------------------------------------------------------------
+// Compares the sections or items before the batch with the current ones. The
+// update is made from the difference, not from the changes that were made, so
+// changes that cancel out are dropped and the counts of the table view always
+// match those of the model.
 
-- (void) setData: (NSArray*) data
+- (ASTTableViewUpdate*) updateForBatch
 {
-	BOOL isGrouped = self.tableView.style == UITableViewStyleGrouped;
+	NSArray* oldData = _dataBeforeBatch;
+	NSArray* newData = [ _data copy ];
+	ASTDiff* diff = [ ASTDiff diffFromObjects: oldData toObjects: newData ];
+	ASTTableViewUpdate* update = [ [ ASTTableViewUpdate alloc ] init ];
 	
-	// Remove all of the existing items or sections
-	if( isGrouped ) {
-		for( ASTSection* section in _data ) {
-			section.tableViewController = nil;
+	if( self.tableView.style != UITableViewStyleGrouped ) {
+		[ update addRowsOfDiff: diff oldItems: oldData newItems: newData
+				section: 0 newSection: 0 ];
+		return update;
+	}
+	
+	[ diff.deletedIndexes enumerateIndexesUsingBlock: ^( NSUInteger index, BOOL* stop ) {
+		[ update deleteSection: index ];
+	} ];
+	for( NSUInteger i = 0; i < newData.count; ++i ) {
+		NSUInteger oldIndex = [ diff oldIndexForNewIndex: i ];
+		if( oldIndex == NSNotFound ) {
+			[ update insertSection: i ];
+			continue;
 		}
-	} else {
-		for( ASTItem* item in _data ) {
-			item.tableViewController = nil;
+		
+		ASTSection* oldSection = oldData[ oldIndex ];
+		ASTSection* newSection = newData[ i ];
+		BOOL moved = [ diff.movedIndexes containsIndex: i ];
+		NSArray* oldItems = [ _itemsBeforeBatch objectForKey: oldSection ];
+		BOOL reload = [ _sectionsToReloadAfterBatch containsObject: oldSection ];
+		if( oldSection != newSection ) {
+			// The items of the old section before the batch are only known if
+			// they were not changed by it.
+			if( oldItems || reload ) {
+				[ update deleteSection: oldIndex ];
+				[ update insertSection: i ];
+			} else {
+				addChangesOfReplacedSection( update, oldSection, newSection,
+						oldIndex, i, moved );
+			}
+			continue;
+		}
+		
+		NSArray* newItems = nil;
+		BOOL itemsChanged = NO;
+		if( oldItems && newSection.hasLazyItems ) {
+			reload = YES;
+		} else if( oldItems ) {
+			newItems = newSection.items;
+			itemsChanged = arraysHaveSameObjects( oldItems, newItems ) == NO;
+		}
+		if( moved ) {
+			if( reload || itemsChanged ) {
+				// Rows can not be updated in a section that moves.
+				[ update deleteSection: oldIndex ];
+				[ update insertSection: i ];
+			} else {
+				[ update moveSection: oldIndex toSection: i ];
+			}
+		} else if( reload ) {
+			[ update reloadSection: oldIndex ];
+		} else if( itemsChanged ) {
+			[ update addRowsOfDiff: [ ASTDiff diffFromObjects: oldItems toObjects: newItems ]
+					oldItems: oldItems newItems: newItems
+					section: oldIndex newSection: i ];
 		}
 	}
-	[ _data removeAllObjects ];
+	return update;
+}
+
+//------------------------------------------------------------------------------
+
+- (void) recordBatchChangeOfSectionsAtIndexPaths: (NSArray*) indexPaths
+{
+	if( _batchUpdateDepth == 0 || self.tableView.style != UITableViewStyleGrouped ) {
+		return;
+	}
+	for( NSIndexPath* indexPath in indexPaths ) {
+		[ self recordBatchChangeOfSection: [ self sectionAtIndex: indexPath.section ] ];
+	}
+}
+
+//------------------------------------------------------------------------------
+
+- (void) selectItem: (ASTItem*) item withAnimation: (BOOL) animated
+		scrollPosition: (UITableViewScrollPosition) scrollPosition
+{
+	NSIndexPath* indexPath = [ self displayedIndexPathForItem: item ];
+	[ self.tableView selectRowAtIndexPath: indexPath animated: animated scrollPosition: scrollPosition ];
+}
+
+//------------------------------------------------------------------------------
+
+- (void) deselectItem: (ASTItem*) item withAnimation: (BOOL) animated
+{
+	NSIndexPath* indexPath = [ self displayedIndexPathForItem: item ];
+	[ self.tableView deselectRowAtIndexPath: indexPath animated: animated ];
+}
+
+//------------------------------------------------------------------------------
+
+#pragma mark - Filtering
+
+//------------------------------------------------------------------------------
+
+- (NSString*) filterText
+{
+	return _filterText;
+}
+
+//------------------------------------------------------------------------------
+
+- (void) setFilterText: (NSString*) filterText
+{
+	[ self setFilterText: filterText withRowAnimation: UITableViewRowAnimationAutomatic ];
+}
+
+//------------------------------------------------------------------------------
+
+- (void) setFilterText: (NSString*) filterText
+		withRowAnimation: (UITableViewRowAnimation) animation
+{
+	_filterText = [ filterText copy ];
 	
-	for( id object in data ) {
-		if( isGrouped ) {
-			ASTSection* section = sectionFromObject( object );
-			if( section ) {
-				section.tableViewController = self;
-				[ _data addObject: section ];
+	NSArray* tokens = [ ASTSearchIndex tokensOfString: filterText ];
+	if( tokens.count == 0 ) {
+		tokens = nil;
+	}
+	NSArray* oldTokens = _filterTokens;
+	if( tokens == oldTokens || [ tokens isEqualToArray: oldTokens ] ) {
+		return;
+	}
+	
+	_filterTokens = tokens;
+	BOOL narrowing = oldTokens && tokens && filterTokensNarrowTokens( tokens, oldTokens );
+	[ self updateFilterResultsNarrowing: narrowing withRowAnimation: animation ];
+}
+
+//------------------------------------------------------------------------------
+
+- (BOOL) isFiltering
+{
+	return _filterTokens != nil;
+}
+
+//------------------------------------------------------------------------------
+
+- (void) updateFilterResults
+{
+	_filterUpdateScheduled = NO;
+	if( _filterTokens ) {
+		[ self updateFilterResultsNarrowing: NO
+				withRowAnimation: UITableViewRowAnimationAutomatic ];
+	}
+}
+
+//------------------------------------------------------------------------------
+
+- (void) setNeedsFilterUpdate
+{
+	if( _filterUpdateScheduled ) {
+		return;
+	}
+	
+	_filterUpdateScheduled = YES;
+	__weak ASTViewController* weakSelf = self;
+	dispatch_async( dispatch_get_main_queue(), ^{
+		ASTViewController* strongSelf = weakSelf;
+		if( strongSelf && strongSelf->_filterUpdateScheduled ) {
+			[ strongSelf updateFilterResults ];
+		}
+	} );
+}
+
+//------------------------------------------------------------------------------
+
+// Replaces the displayed sections and items with those matching the filter
+// tokens, or with all of them when not filtering, and animates the difference.
+// A narrowing filter only checks the items that are displayed, unless items
+// changed since the index was updated. Otherwise the index is updated with the
+// items that changed, and the items are looked up in it and are displayed in
+// the order of the model.
+
+- (void) updateFilterResultsNarrowing: (BOOL) narrowing
+		withRowAnimation: (UITableViewRowAnimation) animation
+{
+	BOOL isGrouped = self.tableView.style == UITableViewStyleGrouped;
+	NSArray* oldSections = _filteredSections;
+	NSArray* oldItems = _filteredItems;
+	if( oldItems == nil ) {
+		[ self getUnfilteredSections: &oldSections items: &oldItems ];
+	}
+	
+	NSArray* newSections = nil;
+	NSArray* newItems = nil;
+	if( _filterTokens == nil ) {
+		[ self getUnfilteredSections: &newSections items: &newItems ];
+		_searchIndex = nil;
+		_staleSearchItems = nil;
+	} else if( narrowing && _searchIndex && _staleSearchItems == nil && _filteredItems ) {
+		NSMutableArray* sections = [ NSMutableArray array ];
+		NSMutableArray* items = [ NSMutableArray array ];
+		for( NSUInteger i = 0; i < _filteredSections.count; ++i ) {
+			NSMutableArray* sectionItems = [ NSMutableArray array ];
+			for( ASTItem* item in _filteredItems[ i ] ) {
+				if( [ _searchIndex item: item matchesTokens: _filterTokens ] ) {
+					[ sectionItems addObject: item ];
+				}
+			}
+			if( sectionItems.count || isGrouped == NO ) {
+				[ sections addObject: _filteredSections[ i ] ];
+				[ items addObject: sectionItems ];
 			}
+		}
+		newSections = sections;
+		newItems = items;
+	} else {
+		if( _searchIndex == nil ) {
+			[ self buildSearchIndex ];
 		} else {
-			ASTItem* item = itemFromObject( object );
-			if( item ) {
-				item.tableViewController = self;
-				[ _data addObject: item ];
+			[ self updateSearchIndex ];
+		}
+		NSHashTable* matches = [ _searchIndex itemsMatchingTokens: _filterTokens ];
+		NSMutableArray* sections = [ NSMutableArray array ];
+		NSMutableArray* items = [ NSMutableArray array ];
+		NSArray* unfilteredSections = isGrouped ? _data : @[ [ NSNull null ] ];
+		for( id section in unfilteredSections ) {
+			NSMutableArray* sectionItems = [ NSMutableArray array ];
+			for( ASTItem* item in isGrouped ? [ (ASTSection*)section items ] : _data ) {
+				if( [ matches containsObject: item ] ) {
+					[ sectionItems addObject: item ];
+				}
+			}
+			if( sectionItems.count || isGrouped == NO ) {
+				[ sections addObject: section ];
+				[ items addObject: sectionItems ];
 			}
 		}
+		newSections = sections;
+		newItems = items;
+	}
+	
+	ASTTableViewUpdate* update = [ [ ASTTableViewUpdate alloc ] init ];
+	addChangesOfPresentation( update, oldSections, oldItems, newSections, newItems );
+	
+	UITableView* tableView = self.tableView;
+	[ tableView beginUpdates ];
+	_filteredSections = _filterTokens ? newSections : nil;
+	_filteredItems = _filterTokens ? newItems : nil;
+	[ update applyToTableView: tableView withRowAnimation: animation ];
+	[ tableView endUpdates ];
+}
+
+//------------------------------------------------------------------------------
+
+// The sections and items of the model in the form of the filtered ones. The
+// items of sections with lazy items are NSNull so that they are not built.
+
+- (void) getUnfilteredSections: (NSArray**) sections items: (NSArray**) items
+{
+	if( self.tableView.style != UITableViewStyleGrouped ) {
+		*sections = @[ [ NSNull null ] ];
+		*items = @[ [ _data copy ] ];
+		return;
 	}
 	
+	NSMutableArray* sectionItems = [ NSMutableArray arrayWithCapacity: _data.count ];
+	for( ASTSection* section in _data ) {
+		[ sectionItems addObject: section.hasLazyItems ? [ NSNull null ] : section.items ];
+	}
+	*sections = [ _data copy ];
+	*items = sectionItems;
+}
+
+//------------------------------------------------------------------------------
+
+- (void) buildSearchIndex
+{
+	ASTSearchIndex* searchIndex = [ [ ASTSearchIndex alloc ] init ];
+	if( self.tableView.style != UITableViewStyleGrouped ) {
+		for( ASTItem* item in _data ) {
+			[ searchIndex addItem: item ];
+		}
+	} else {
+		for( ASTSection* section in _data ) {
+			for( ASTItem* item in section.items ) {
+				[ searchIndex addItem: item ];
+			}
+		}
+	}
+	
+	// Lazy items built above are attached before the index is set, so they are
+	// not taken for changed items.
+	_searchIndex = searchIndex;
+	_staleSearchItems = nil;
+}
+
+//------------------------------------------------------------------------------
+
+// Indexes the stale items that belong to the table view controller, and removes
+// the others, which were removed from it.
+
+- (void) updateSearchIndex
+{
+	for( ASTItem* item in _staleSearchItems ) {
+		if( item.tableViewController == self ) {
+			[ _searchIndex addItem: item ];
+		} else {
+			[ _searchIndex removeItem: item ];
+		}
+	}
+	_staleSearchItems = nil;
+}
+
+//------------------------------------------------------------------------------
+
+- (void) setNeedsSearchIndexUpdateForItem: (ASTItem*) item
+{
+	if( _searchIndex == nil ) {
+		return;
+	}
+	
+	// Replacing most of the items is faster with a new index.
+	if( _staleSearchItems.count > _searchIndex.count ) {
+		_searchIndex = nil;
+		_staleSearchItems = nil;
+		return;
+	}
+	
+	if( _staleSearchItems == nil ) {
+		_staleSearchItems = [ NSHashTable
+				hashTableWithOptions: NSPointerFunctionsObjectPointerPersonality ];
+	}
+	[ _staleSearchItems addObject: item ];
+}
+
+//------------------------------------------------------------------------------
+
+- (ASTSection*) displayedSectionAtIndex: (NSInteger) index
+{
+	return _filteredItems ? _filteredSections[ index ] : _data[ index ];
+}
+
+//------------------------------------------------------------------------------
+
+- (ASTItem*) displayedItemAtIndexPath: (NSIndexPath*) indexPath
+{
+	if( _filteredItems == nil ) {
+		return [ self itemAtIndexPath: indexPath ];
+	}
+	
+	if( indexPath && indexPath.section < _filteredItems.count ) {
+		NSArray* items = _filteredItems[ indexPath.section ];
+		if( indexPath.row < items.count ) {
+			return items[ indexPath.row ];
+		}
+	}
+	return nil;
+}
+
+//------------------------------------------------------------------------------
+
+// Returns the displayed item at the index path without building it if it is a
+// lazy item that was not built yet.
+
+- (ASTItem*) builtDisplayedItemAtIndexPath: (NSIndexPath*) indexPath
+{
+	if( self.tableView.style == UITableViewStyleGrouped && _filteredItems == nil ) {
+		return [ [ self sectionAtIndex: indexPath.section ] builtItemAtIndex: indexPath.row ];
+	}
+	return [ self displayedItemAtIndexPath: indexPath ];
+}
+
+//------------------------------------------------------------------------------
+
+- (NSIndexPath*) displayedIndexPathForItem: (ASTItem*) item
+{
+	if( _filteredItems == nil ) {
+		return [ self indexPathForItem: item ];
+	}
+	
+	if( item == nil || item.tableViewController != self ) {
+		return nil;
+	}
+	id section = self.tableView.style == UITableViewStyleGrouped
+			? item.section : [ NSNull null ];
+	NSUInteger sectionIndex = section
+			? [ _filteredSections indexOfObjectIdenticalTo: section ] : NSNotFound;
+	if( sectionIndex == NSNotFound ) {
+		return nil;
+	}
+	NSUInteger row = [ _filteredItems[ sectionIndex ] indexOfObjectIdenticalTo: item ];
+	if( row == NSNotFound ) {
+		return nil;
+	}
+	return [ NSIndexPath indexPathForItem: row inSection: sectionIndex ];
+}
+
+//------------------------------------------------------------------------------
+
+#pragma mark - Accessors
+
+//------------------------------------------------------------------------------
+
+- (void) setData: (NSArray*) data
+{
+	++_dataGeneration;
+	
+	if( (_animatesDataChanges && _data.count) || _batchUpdateDepth ) {
+		[ self setData: data withRowAnimation: UITableViewRowAnimationAutomatic ];
+		return;
+	}
+	
+	ASTPerformanceSpan span = ASTPerformanceSpanBegin( _performanceMetrics );
+	[ self replaceDataReferences: [ self dataFromObjects: [ self reuseItemsForObjects: data ] ] ];
+	
 	[ self.tableView reloadData ];
+	ASTPerformanceSpanEnd( span, ASTPerformanceOperationSetData, nil );
+}
+
+//------------------------------------------------------------------------------
+
+- (void) setData: (NSArray*) data withRowAnimation: (UITableViewRowAnimation) animation
+{
+	++_dataGeneration;
+	
+	ASTPerformanceSpan span = ASTPerformanceSpanBegin( _performanceMetrics );
+	UITableView* tableView = self.tableView;
+	NSArray* oldData = [ _data copy ];
+	NSArray* newData = [ self dataFromObjects: [ self reuseItemsForObjects: data ] ];
+	
+	if( _batchUpdateDepth || _filterTokens ) {
+		[ self replaceDataReferences: newData ];
+		ASTPerformanceSpanEnd( span, ASTPerformanceOperationSetData, nil );
+		return;
+	}
+	
+	ASTDiff* diff = [ ASTDiff diffFromObjects: oldData toObjects: newData ];
+	ASTTableViewUpdate* update = [ [ ASTTableViewUpdate alloc ] init ];
+	
+	if( tableView.style == UITableViewStyleGrouped ) {
+		[ diff.deletedIndexes enumerateIndexesUsingBlock: ^( NSUInteger index, BOOL* stop ) {
+			[ update deleteSection: index ];
+		} ];
+		for( NSUInteger i = 0; i < newData.count; ++i ) {
+			NSUInteger oldIndex = [ diff oldIndexForNewIndex: i ];
+			if( oldIndex == NSNotFound ) {
+				[ update insertSection: i ];
+				continue;
+			}
+			
+			ASTSection* oldSection = oldData[ oldIndex ];
+			ASTSection* newSection = newData[ i ];
+			BOOL moved = [ diff.movedIndexes containsIndex: i ];
+			if( oldSection == newSection ) {
+				if( moved ) {
+					[ update moveSection: oldIndex toSection: i ];
+				}
+			} else {
+				addChangesOfReplacedSection( update, oldSection, newSection,
+						oldIndex, i, moved );
+			}
+		}
+	} else {
+		[ update addRowsOfDiff: diff oldItems: oldData newItems: newData
+				section: 0 newSection: 0 ];
+	}
+	
+	[ tableView beginUpdates ];
+	[ self replaceDataReferences: newData ];
+	[ update applyToTableView: tableView withRowAnimation: animation ];
+	[ tableView endUpdates ];
+	ASTPerformanceSpanEnd( span, ASTPerformanceOperationSetData, nil );
+}
+
+//------------------------------------------------------------------------------
+
++ (void) buildData: (NSArray*) data forStyle: (UITableViewStyle) style
+		completion: (ASTDataBuildBlock) completion
+{
+	NSParameterAssert( completion );
+	
+	NSArray* objects = [ data copy ];
+	BOOL isGrouped = style == UITableViewStyleGrouped;
+	dispatch_async( dispatch_get_global_queue( QOS_CLASS_USER_INITIATED, 0 ), ^{
+		NSArray* builtData = nil;
+		NSError* error = nil;
+		@try {
+			builtData = buildObjectsConcurrently( objects, ^id( id object ) {
+				return isGrouped ? buildSection( object ) : itemFromObject( object );
+			} );
+		} @catch( NSException* exception ) {
+			error = [ NSError errorWithDomain: ASTDataErrorDomain
+					code: ASTDataErrorInvalidData userInfo: @{
+						NSLocalizedDescriptionKey : exception.reason ?: exception.name,
+						ASTDataExceptionKey : exception,
+					} ];
+		}
+		
+		dispatch_async( dispatch_get_main_queue(), ^{
+			completion( builtData, error );
+		} );
+	} );
+}
+
+//------------------------------------------------------------------------------
+
+- (void) setDataInBackground: (NSArray*) data
+		completion: (void (^)( NSError* error )) completion
+{
+	NSUInteger generation = ++_dataGeneration;
+	__weak ASTViewController* weakSelf = self;
+	[ ASTViewController buildData: data forStyle: self.tableView.style
+			completion: ^( NSArray* builtData, NSError* error ) {
+		ASTViewController* strongSelf = weakSelf;
+		if( strongSelf == nil || strongSelf->_dataGeneration != generation ) {
+			return;
+		}
+		if( builtData ) {
+			strongSelf.data = builtData;
+		}
+		if( completion ) {
+			completion( error );
+		}
+	} ];
+}
+
+//------------------------------------------------------------------------------
+
+// Replaces the dictionaries describing items that are already in the table view
+// with those items, updated in place, so that they keep their cells.
+
+- (NSArray*) reuseItemsForObjects: (NSArray*) objects
+{
+	if( _data.count == 0 ) {
+		return objects;
+	}
+	
+	NSMutableDictionary* itemsByIdentifier = [ NSMutableDictionary dictionary ];
+	
+	if( self.tableView.style != UITableViewStyleGrouped ) {
+		addItemsByIdentifier( _data, itemsByIdentifier );
+		return reuseItemsForItemValues( objects, itemsByIdentifier );
+	}
+	
+	for( ASTSection* section in _data ) {
+		addItemsByIdentifier( section.builtItems, itemsByIdentifier );
+	}
+	NSMutableArray* result = [ NSMutableArray arrayWithCapacity: objects.count ];
+	for( id object in objects ) {
+		id sectionItems = [ object isKindOfClass: [ NSDictionary class ] ]
+				? object[ AST_items ] : nil;
+		if( [ sectionItems isKindOfClass: [ NSArray class ] ] ) {
+			NSMutableDictionary* sectionDict = [ object mutableCopy ];
+			sectionDict[ AST_items ] = reuseItemsForItemValues( sectionItems, itemsByIdentifier );
+			[ result addObject: sectionDict ];
+		} else {
+			[ result addObject: object ];
+		}
+	}
+	return result;
+}
+
+//------------------------------------------------------------------------------
+
+- (NSArray*) dataFromObjects: (NSArray*) objects
+{
+	BOOL isGrouped = self.tableView.style == UITableViewStyleGrouped;
+	NSMutableArray* result = [ NSMutableArray arrayWithCapacity: objects.count ];
+	for( id object in objects ) {
+		id sectionOrItem = isGrouped ? sectionFromObject( object ) : itemFromObject( object );
+		if( sectionOrItem ) {
+			[ result addObject: sectionOrItem ];
+		}
+	}
+	return result;
+}
+
+//------------------------------------------------------------------------------
+
+- (void) replaceDataReferences: (NSArray*) data
+{
+	// Remove the existing items or sections that are not in the new data first,
+	// so that items shared with a new section end up attached to it.
+	NSHashTable* keptObjects = [ NSHashTable
+			hashTableWithOptions: NSPointerFunctionsObjectPointerPersonality ];
+	for( id sectionOrItem in data ) {
+		[ keptObjects addObject: sectionOrItem ];
+	}
+	for( id sectionOrItem in _data ) {
+		if( [ keptObjects containsObject: sectionOrItem ] == NO ) {
+			[ sectionOrItem setTableViewController: nil ];
+		}
+	}
+	
+	[ _data setArray: data ];
+	_firstStaleIndex = 0;
+	[ _identifierIndex invalidate ];
+	[ _representedObjectIndex invalidate ];
+	
+	for( id sectionOrItem in data ) {
+		[ sectionOrItem setTableViewController: self ];
+	}
+	
+	if( _filterTokens ) {
+		[ self setNeedsFilterUpdate ];
+	}
 }
 
 //------------------------------------------------------------------------------
@@ -693,6 +1744,238 @@ static ASTSection* sectionFromObject( id sectionObject )
 
 //------------------------------------------------------------------------------
 
+- (void) setReusesCells: (BOOL) reusesCells
+{
+	_reusesCells = reusesCells;
+	if( reusesCells ) {
+		if( _cellPool == nil ) {
+			_cellPool = [ [ ASTCellPool alloc ] init ];
+		}
+	} else {
+		_cellPool = nil;
+	}
+}
+
+//------------------------------------------------------------------------------
+
+- (ASTCellPool*) cellPool
+{
+	return _cellPool;
+}
+
+//------------------------------------------------------------------------------
+
+- (void) setDefersCellUpdates: (BOOL) defersCellUpdates
+{
+	_defersCellUpdates = defersCellUpdates;
+	if( defersCellUpdates == NO ) {
+		[ self applyPendingCellUpdates ];
+	}
+}
+
+//------------------------------------------------------------------------------
+
+- (void) setNeedsCellUpdateForItem: (ASTItem*) item
+{
+	if( _itemsNeedingCellUpdate == nil ) {
+		_itemsNeedingCellUpdate = [ NSHashTable weakObjectsHashTable ];
+	}
+	[ _itemsNeedingCellUpdate addObject: item ];
+	
+	// The display link holds on to the controller until it fires, which is
+	// fine because it only lives for one frame.
+	if( _cellUpdateDisplayLink == nil ) {
+		_cellUpdateDisplayLink = [ CADisplayLink displayLinkWithTarget: self
+				selector: @selector(cellUpdateDisplayLinkFired:) ];
+		[ _cellUpdateDisplayLink addToRunLoop: [ NSRunLoop mainRunLoop ]
+				forMode: NSRunLoopCommonModes ];
+	}
+}
+
+//------------------------------------------------------------------------------
+
+- (void) cellUpdateDisplayLinkFired: (CADisplayLink*) displayLink
+{
+	[ self applyPendingCellUpdates ];
+}
+
+//------------------------------------------------------------------------------
+
+- (void) applyPendingCellUpdates
+{
+	[ _cellUpdateDisplayLink invalidate ];
+	_cellUpdateDisplayLink = nil;
+	
+	NSArray* items = _itemsNeedingCellUpdate.allObjects;
+	[ _itemsNeedingCellUpdate removeAllObjects ];
+	for( ASTItem* item in items ) {
+		// Items that went off screen in the meantime stay stale.
+		if( item.cellDisplayed ) {
+			[ item applyStaleCellProperties ];
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+
+- (void) setNeedsRowHeightUpdateForItem: (ASTItem*) item
+{
+	if( _itemsNeedingRowHeightUpdate == nil ) {
+		_itemsNeedingRowHeightUpdate = [ NSHashTable weakObjectsHashTable ];
+	}
+	[ _itemsNeedingRowHeightUpdate addObject: item ];
+	
+	if( _rowHeightUpdateDisplayLink == nil ) {
+		_rowHeightUpdateDisplayLink = [ CADisplayLink displayLinkWithTarget: self
+				selector: @selector(rowHeightUpdateDisplayLinkFired:) ];
+		[ _rowHeightUpdateDisplayLink addToRunLoop: [ NSRunLoop mainRunLoop ]
+				forMode: NSRunLoopCommonModes ];
+	}
+}
+
+//------------------------------------------------------------------------------
+
+- (void) rowHeightUpdateDisplayLinkFired: (CADisplayLink*) displayLink
+{
+	[ self applyPendingRowHeightUpdates ];
+}
+
+//------------------------------------------------------------------------------
+
+// Only rows whose cells no longer fit are resized, so typing within a line of
+// a text view does not update the table view.
+
+- (void) applyPendingRowHeightUpdates
+{
+	[ _rowHeightUpdateDisplayLink invalidate ];
+	_rowHeightUpdateDisplayLink = nil;
+	
+	NSArray* items = _itemsNeedingRowHeightUpdate.allObjects;
+	[ _itemsNeedingRowHeightUpdate removeAllObjects ];
+	NSMutableArray* resizedItems = [ NSMutableArray array ];
+	for( ASTItem* item in items ) {
+		if( item.cellDisplayed == NO ) {
+			continue;
+		}
+		UIView* contentView = item.cell.contentView;
+		CGSize fittingSize = CGSizeMake( contentView.bounds.size.width,
+				UILayoutFittingCompressedSize.height );
+		CGFloat height = [ contentView systemLayoutSizeFittingSize: fittingSize
+				withHorizontalFittingPriority: UILayoutPriorityRequired
+				verticalFittingPriority: UILayoutPriorityFittingSizeLevel ].height;
+		if( fabs( height - contentView.bounds.size.height ) >= 0.5 ) {
+			[ resizedItems addObject: item ];
+		}
+	}
+	if( resizedItems.count == 0 ) {
+		return;
+	}
+	
+	// Animating the update scrolls the row being edited under the keyboard.
+	UITableView* tableView = self.tableView;
+	[ UIView performWithoutAnimation: ^{
+		[ tableView beginUpdates ];
+		[ tableView endUpdates ];
+	} ];
+	for( ASTItem* item in resizedItems ) {
+		[ item rowHeightDidChange ];
+	}
+}
+
+//------------------------------------------------------------------------------
+
+- (NSUInteger) sectionViewMeasurementCount
+{
+	return _sectionViewMeasurementCount;
+}
+
+//------------------------------------------------------------------------------
+
+- (BOOL) isBatchingUpdates
+{
+	return _batchUpdateDepth > 0;
+}
+
+//------------------------------------------------------------------------------
+
+- (UITableView*) tableViewForUpdates
+{
+	// While filtering the rows of the table view are not those of the model,
+	// so the change is shown by the next update of the filter results.
+	if( _filterTokens ) {
+		[ self setNeedsFilterUpdate ];
+		return nil;
+	}
+	return _batchUpdateDepth ? nil : self.tableView;
+}
+
+//------------------------------------------------------------------------------
+
+- (void) recordBatchChangeOfSection: (ASTSection*) section
+{
+	if( _batchUpdateDepth == 0 || section == nil ) {
+		return;
+	}
+	
+	// Lazy items are not compared because that would build all of them.
+	if( section.hasLazyItems ) {
+		[ _sectionsToReloadAfterBatch addObject: section ];
+	} else if( [ _itemsBeforeBatch objectForKey: section ] == nil ) {
+		[ _itemsBeforeBatch setObject: section.items forKey: section ];
+	}
+}
+
+//------------------------------------------------------------------------------
+
+- (void) reloadSectionAfterBatchUpdates: (ASTSection*) section
+{
+	[ _sectionsToReloadAfterBatch addObject: section ];
+}
+
+//------------------------------------------------------------------------------
+
+- (void) setRowHeightCacheKey: (NSString*) rowHeightCacheKey
+{
+	[ _rowHeightCache save ];
+	_rowHeightCache = [ [ ASTRowHeightCache alloc ] initWithKey: rowHeightCacheKey ];
+}
+
+//------------------------------------------------------------------------------
+
+- (NSString*) rowHeightCacheKey
+{
+	return _rowHeightCache.key;
+}
+
+//------------------------------------------------------------------------------
+
+- (void) setPrefStore: (id<ASTPreferenceStore>) prefStore
+{
+	_prefStore = prefStore;
+	
+	// Lazy items that are not built yet get the store when they are built.
+	for( id sectionOrItem in _data ) {
+		if( [ sectionOrItem isKindOfClass: [ ASTSection class ] ] ) {
+			for( ASTItem* item in [ sectionOrItem builtItems ] ) {
+				[ item prefStoreMayHaveChanged ];
+			}
+		} else {
+			[ sectionOrItem prefStoreMayHaveChanged ];
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+
+- (ASTRowHeightCache*) rowHeightCacheForTableView: (UITableView*) tableView
+{
+	[ _rowHeightCache selectWidth: tableView.bounds.size.width
+			contentSizeCategory: contentSizeCategoryOfTraitCollection( tableView.traitCollection ) ];
+	return _rowHeightCache;
+}
+
+//------------------------------------------------------------------------------
+
 #pragma mark - UITableViewDataSource
 
 //------------------------------------------------------------------------------
@@ -700,7 +1983,7 @@ static ASTSection* sectionFromObject( id sectionObject )
 - (NSInteger) numberOfSectionsInTableView: (UITableView*) tableView
 {
 	if( self.tableView.style == UITableViewStyleGrouped ) {
-		return _data.count;
+		return _filteredItems ? _filteredItems.count : _data.count;
 	}
 	return 1;
 }
@@ -710,8 +1993,12 @@ static ASTSection* sectionFromObject( id sectionObject )
 - (NSInteger) tableView: (UITableView*) tableView
 		numberOfRowsInSection: (NSInteger) section
 {
+	if( _filteredItems ) {
+		NSArray* items = _filteredItems[ section ];
+		return items.count;
+	}
 	if( self.tableView.style == UITableViewStyleGrouped ) {
-		ASTSection* sectionData = _data[ section ];
+		ASTSection* sectionData = [ self displayedSectionAtIndex: section ];
 		return sectionData.numberOfItems;
 	}
 	return _data.count;
@@ -722,8 +2009,11 @@ static ASTSection* sectionFromObject( id sectionObject )
 - (UITableViewCell*) tableView: (UITableView*) tableView
 		cellForRowAtIndexPath: (NSIndexPath*) indexPath
 {
-	ASTItem* item = [ self itemAtIndexPath: indexPath ];
-	return item.cell;
+	ASTPerformanceSpan span = ASTPerformanceSpanBegin( _performanceMetrics );
+	ASTItem* item = [ self displayedItemAtIndexPath: indexPath ];
+	UITableViewCell* result = item.cell;
+	ASTPerformanceSpanEnd( span, ASTPerformanceOperationCellForRow, [ item class ] );
+	return result;
 }
 
 //------------------------------------------------------------------------------
@@ -732,7 +2022,7 @@ static ASTSection* sectionFromObject( id sectionObject )
 		titleForHeaderInSection: (NSInteger) section
 {
 	if( self.tableView.style == UITableViewStyleGrouped ) {
-		ASTSection* sectionData = _data[ section ];
+		ASTSection* sectionData = [ self displayedSectionAtIndex: section ];
 		return sectionData.headerText;
 	}
 	return nil;
@@ -744,7 +2034,7 @@ static ASTSection* sectionFromObject( id sectionObject )
 		titleForFooterInSection: (NSInteger) section
 {
 	if( self.tableView.style == UITableViewStyleGrouped ) {
-		ASTSection* sectionData = _data[ section ];
+		ASTSection* sectionData = [ self displayedSectionAtIndex: section ];
 		return sectionData.footerText;
 	}
 	return nil;
@@ -755,7 +2045,7 @@ static ASTSection* sectionFromObject( id sectionObject )
 - (UIView*) tableView: (UITableView*) tableView viewForHeaderInSection: (NSInteger) section
 {
 	if( self.tableView.style == UITableViewStyleGrouped ) {
-		ASTSection* sectionData = _data[ section ];
+		ASTSection* sectionData = [ self displayedSectionAtIndex: section ];
 		return sectionData.headerView;
 	}
 	return nil;
@@ -766,7 +2056,7 @@ static ASTSection* sectionFromObject( id sectionObject )
 - (UIView*) tableView: (UITableView*) tableView viewForFooterInSection: (NSInteger) section
 {
 	if( self.tableView.style == UITableViewStyleGrouped ) {
-		ASTSection* sectionData = _data[ section ];
+		ASTSection* sectionData = [ self displayedSectionAtIndex: section ];
 		return sectionData.footerView;
 	}
 	return nil;
@@ -776,7 +2066,7 @@ static ASTSection* sectionFromObject( id sectionObject )
 
 - (BOOL) tableView: (UITableView*) tableView canEditRowAtIndexPath: (NSIndexPath*) indexPath
 {
-	ASTItem* item = [ self itemAtIndexPath: indexPath ];
+	ASTItem* item = [ self displayedItemAtIndexPath: indexPath ];
 	return item.editable;
 }
 
@@ -786,7 +2076,7 @@ static ASTSection* sectionFromObject( id sectionObject )
 		commitEditingStyle: (UITableViewCellEditingStyle) editingStyle
 		forRowAtIndexPath: (NSIndexPath*) indexPath
 {
-	ASTItem* item = [ self itemAtIndexPath: indexPath ];
+	ASTItem* item = [ self displayedItemAtIndexPath: indexPath ];
 	if( item.deleteBlock ) {
 		item.deleteBlock( item );
 	}
@@ -801,26 +2091,42 @@ static ASTSection* sectionFromObject( id sectionObject )
 // header and footer views because that is the only option that we can measure
 // correctly. We could choose to measure the text but there is no way to get
 // the font that is used by the system.
+// UITableView asks for these heights constantly while scrolling and updating,
+// so the sections keep the measured heights until their views, the table
+// width, the content size category or the traits change.
 
 - (CGFloat) tableView: (UITableView*) tableView heightForHeaderInSection: (NSInteger) section
 {
 	assert( self.tableView.style == UITableViewStyleGrouped );
-	ASTSection* sectionData = _data[ section ];
+	ASTSection* sectionData = [ self displayedSectionAtIndex: section ];
 	UIView* headerView = sectionData.headerView;
 	if( headerView ) {
+		CGFloat width = tableView.bounds.size.width;
+		NSString* contentSizeCategory = contentSizeCategoryOfTraitCollection( tableView.traitCollection );
+		CGFloat result = [ sectionData measuredHeightOfFooter: NO forWidth: width
+				contentSizeCategory: contentSizeCategory ];
+		if( result >= 0 ) {
+			return result;
+		}
+		
 		// We put the headerView in the tableView during the layout because if
 		// the headerView is being styled by UIAppearance the layout will not be
 		// the right size if it is not in the tableView.
+		ASTPerformanceSpan span = ASTPerformanceSpanBegin( _performanceMetrics );
 		BOOL wasNotInSuperview = headerView.superview == nil;
 		if( wasNotInSuperview ) {
 			[ tableView addSubview: headerView ];
 		}
 		CGSize fittingSize = tableView.bounds.size;
 		fittingSize.height = 10000;
-		CGFloat result = [ headerView systemLayoutSizeFittingSize: fittingSize ].height;
+		result = [ headerView systemLayoutSizeFittingSize: fittingSize ].height;
 		if( wasNotInSuperview ) {
 			[ headerView removeFromSuperview ];
 		}
+		ASTPerformanceSpanEnd( span, ASTPerformanceOperationMeasureSectionView, nil );
+		++_sectionViewMeasurementCount;
+		[ sectionData setMeasuredHeight: result ofFooter: NO forWidth: width
+				contentSizeCategory: contentSizeCategory ];
 		return result;
 	}
 	
@@ -836,24 +2142,37 @@ static ASTSection* sectionFromObject( id sectionObject )
 	// done.
 	
 	assert( self.tableView.style == UITableViewStyleGrouped );
-	ASTSection* sectionData = _data[ section ];
+	ASTSection* sectionData = [ self displayedSectionAtIndex: section ];
 	UIView* footerView = sectionData.footerView;
 	if( footerView ) {
+		CGFloat width = tableView.bounds.size.width;
+		NSString* contentSizeCategory = contentSizeCategoryOfTraitCollection( tableView.traitCollection );
+		CGFloat result = [ sectionData measuredHeightOfFooter: YES forWidth: width
+				contentSizeCategory: contentSizeCategory ];
+		if( result >= 0 ) {
+			return result;
+		}
+		
 		// We put the footerView in the tableView during the layout because if
 		// the footerView is being styled by UIAppearance the layout will not be
 		// the right size if it is not in the tableView.
+		ASTPerformanceSpan span = ASTPerformanceSpanBegin( _performanceMetrics );
 		BOOL wasNotInSuperview = footerView.superview == nil;
 		if( wasNotInSuperview ) {
 			[ tableView addSubview: footerView ];
 		}
 		CGSize fittingSize = tableView.bounds.size;
 		fittingSize.height = 10000;
-		CGFloat result = ceil( [ footerView systemLayoutSizeFittingSize: fittingSize
+		result = ceil( [ footerView systemLayoutSizeFittingSize: fittingSize
 				withHorizontalFittingPriority: UILayoutPriorityDefaultHigh
 				verticalFittingPriority: 1 ].height );
 		if( wasNotInSuperview ) {
 			[ footerView removeFromSuperview ];
 		}
+		ASTPerformanceSpanEnd( span, ASTPerformanceOperationMeasureSectionView, nil );
+		++_sectionViewMeasurementCount;
+		[ sectionData setMeasuredHeight: result ofFooter: YES forWidth: width
+				contentSizeCategory: contentSizeCategory ];
 		return result;
 	}
 	
@@ -862,16 +2181,116 @@ static ASTSection* sectionFromObject( id sectionObject )
 
 //------------------------------------------------------------------------------
 
+#pragma mark - UITableViewDataSourcePrefetching
+
+//------------------------------------------------------------------------------
+
+- (void) tableView: (UITableView*) tableView
+		prefetchRowsAtIndexPaths: (NSArray*) indexPaths
+{
+	// Lazy items are built here, a few rows ahead of the scrolling, rather than
+	// when their cells are needed. Items described by dictionaries are built on
+	// a background queue and prefetch once they are in their section. Filter
+	// results only display built items.
+	BOOL displaysSections = self.tableView.style == UITableViewStyleGrouped
+			&& _filteredItems == nil;
+	for( NSIndexPath* indexPath in indexPaths ) {
+		if( displaysSections ) {
+			[ [ self sectionAtIndex: indexPath.section ]
+					buildItemInBackgroundAtIndex: indexPath.row
+					completion: ^( ASTItem* item ) {
+				[ item prefetch ];
+			} ];
+		} else {
+			[ [ self displayedItemAtIndexPath: indexPath ] prefetch ];
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+
+- (void) tableView: (UITableView*) tableView
+		cancelPrefetchingForRowsAtIndexPaths: (NSArray*) indexPaths
+{
+	BOOL displaysSections = self.tableView.style == UITableViewStyleGrouped
+			&& _filteredItems == nil;
+	for( NSIndexPath* indexPath in indexPaths ) {
+		if( displaysSections ) {
+			[ [ self sectionAtIndex: indexPath.section ]
+					cancelBackgroundBuildOfItemAtIndex: indexPath.row ];
+		}
+		[ [ self builtDisplayedItemAtIndexPath: indexPath ] cancelPrefetch ];
+	}
+}
+
+//------------------------------------------------------------------------------
+
 #pragma mark - UITableViewDelegate
 
 //------------------------------------------------------------------------------
 
+- (void) tableView: (UITableView*) tableView
+		willDisplayCell: (UITableViewCell*) cell
+		forRowAtIndexPath: (NSIndexPath*) indexPath
+{
+	ASTItem* item = [ _cellPool itemForCell: cell ] ?: [ self displayedItemAtIndexPath: indexPath ];
+	if( item.cellLoaded && item.cell == cell ) {
+		item.cellDisplayed = YES;
+		[ [ self rowHeightCacheForTableView: tableView ] setHeight: cell.bounds.size.height
+				forItem: item ];
+	}
+}
+
+//------------------------------------------------------------------------------
+
+- (CGFloat) tableView: (UITableView*) tableView
+		estimatedHeightForRowAtIndexPath: (NSIndexPath*) indexPath
+{
+	// Lazy items are not built just to estimate their height.
+	ASTItem* item = [ self builtDisplayedItemAtIndexPath: indexPath ];
+	CGFloat result = item ? [ [ self rowHeightCacheForTableView: tableView ]
+			heightForItem: item ] : -1;
+	return result >= 0 ? result : tableView.estimatedRowHeight;
+}
+
+//------------------------------------------------------------------------------
+
 - (void) tableView: (UITableView*) tableView
 		didEndDisplayingCell: (UITableViewCell*) cell
 		forRowAtIndexPath: (NSIndexPath*) indexPath
 {
-	ASTItem* item = [ self itemAtIndexPath: indexPath ];
+	if( _cellPool == nil ) {
+		ASTItem* item = [ self displayedItemAtIndexPath: indexPath ];
+		if( item.cellLoaded && item.cell == cell ) {
+			item.cellDisplayed = NO;
+			// The row may have changed height while it was displayed.
+			[ [ self rowHeightCacheForTableView: tableView ] setHeight: cell.bounds.size.height
+					forItem: item ];
+		}
+		[ item didEndDisplayingCell ];
+		return;
+	}
+	
+	// Reloading a row can hand the same cell back to the table view before the
+	// old row ends displaying, in which case the cell is still in use.
+	if( [ tableView.visibleCells containsObject: cell ] ) {
+		return;
+	}
+	
+	// The index path may no longer identify the item that owns the cell if
+	// rows were inserted or removed, so the owner is looked up from the cell.
+	// The owner may also be gone if it was removed from the table.
+	ASTItem* item = [ _cellPool itemForCell: cell ];
+	item.cellDisplayed = NO;
+	if( item ) {
+		[ [ self rowHeightCacheForTableView: tableView ] setHeight: cell.bounds.size.height
+				forItem: item ];
+	}
 	[ item didEndDisplayingCell ];
+	if( item.cellLoaded && item.cell == cell ) {
+		[ item unloadCell ];
+	}
+	[ _cellPool enqueueCell: cell ];
 }
 
 //------------------------------------------------------------------------------
@@ -879,7 +2298,7 @@ static ASTSection* sectionFromObject( id sectionObject )
 - (BOOL) tableView: (UITableView*) tableView
 		shouldHighlightRowAtIndexPath: (NSIndexPath*) indexPath
 {
-	ASTItem* item = [ self itemAtIndexPath: indexPath ];
+	ASTItem* item = [ self displayedItemAtIndexPath: indexPath ];
 	return item.selectable;
 }
 
@@ -888,7 +2307,7 @@ static ASTSection* sectionFromObject( id sectionObject )
 - (void) tableView:(UITableView*) tableView
 		didSelectRowAtIndexPath: (NSIndexPath*) indexPath
 {
-	ASTItem* item = [ self itemAtIndexPath: indexPath ];
+	ASTItem* item = [ self displayedItemAtIndexPath: indexPath ];
 	[ item performSelectionAction ];
 }
 
@@ -897,7 +2316,7 @@ static ASTSection* sectionFromObject( id sectionObject )
 - (UITableViewCellEditingStyle) tableView: (UITableView*) tableView
 		editingStyleForRowAtIndexPath: (NSIndexPath*) indexPath
 {
-	ASTItem* item = [ self itemAtIndexPath: indexPath ];
+	ASTItem* item = [ self displayedItemAtIndexPath: indexPath ];
 	return item.editable ? UITableViewCellEditingStyleDelete : UITableViewCellEditingStyleNone;
 }
 
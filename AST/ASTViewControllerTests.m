@@ -26,12 +26,24 @@
 //
 //==============================================================================
 
+#import "ASTRowHeightCache.h"
+#import "ASTSectionSubclass.h"
+#import "ASTSwitchItem.h"
 #import "ASTViewController.h"
 
 #import <UIKit/UIKit.h>
 #import <XCTest/XCTest.h>
 
 
+//------------------------------------------------------------------------------
+
+@interface PrefetchTestItem : ASTItem
+
+@property (nonatomic) NSUInteger prefetchCount;
+@property (nonatomic) NSUInteger cancelPrefetchCount;
+
+@end
+
 //------------------------------------------------------------------------------
 
 @interface ASTViewControllerTests : XCTestCase
@@ -162,6 +174,157 @@
 
 //------------------------------------------------------------------------------
 
+- (void) testSetDataWithRowAnimation
+{
+	// Group table
+	{
+		ASTItem* keptItem = [ ASTItem itemWithDict: @{ AST_id : @"kept" } ];
+		ASTSection* keptSection = [ ASTSection sectionWithDict: @{
+			AST_id : @"first",
+			AST_items : @[ keptItem, @{ AST_id : @"removed" } ],
+		} ];
+		ASTViewController* vc = [ [ ASTViewController alloc ]
+				initWithStyle: UITableViewStyleGrouped ];
+		vc.data = @[
+			keptSection,
+			@{ AST_id : @"second", AST_headerText : @"Second" },
+			@{ AST_id : @"third", AST_items : @[ @{} ] },
+		];
+		ASTSection* thirdSection = [ vc sectionAtIndex: 2 ];
+		
+		[ vc setData: @[
+			@{
+				AST_id : @"first",
+				AST_items : @[ @{ AST_id : @"added" }, keptItem ],
+			},
+			@{ AST_id : @"second", AST_headerText : @"Changed" },
+			thirdSection,
+			@{ AST_id : @"fourth" },
+		] withRowAnimation: UITableViewRowAnimationNone ];
+		
+		XCTAssertEqual( vc.numberOfItems, 4 );
+		XCTAssertNil( keptSection.tableViewController );
+		XCTAssertEqual( [ vc sectionAtIndex: 2 ], thirdSection );
+		XCTAssertEqualObjects( [ vc sectionAtIndex: 1 ].headerText, @"Changed" );
+		XCTAssertEqualObjects( [ vc indexPathForItem: keptItem ],
+				[ NSIndexPath indexPathForRow: 1 inSection: 0 ] );
+		XCTAssertEqual( keptItem.tableViewController, vc );
+		XCTAssertEqual( [ vc tableView: vc.tableView numberOfRowsInSection: 0 ], 2 );
+		XCTAssertEqual( [ vc.tableView numberOfRowsInSection: 0 ], 2 );
+		XCTAssertEqual( vc.tableView.numberOfSections, 4 );
+		
+		// Moves and removals
+		[ vc setData: @[ [ vc sectionAtIndex: 3 ], [ vc sectionAtIndex: 0 ] ]
+				withRowAnimation: UITableViewRowAnimationNone ];
+		XCTAssertEqual( vc.tableView.numberOfSections, 2 );
+		XCTAssertEqualObjects( [ vc indexPathForItem: keptItem ],
+				[ NSIndexPath indexPathForRow: 1 inSection: 1 ] );
+		XCTAssertNil( thirdSection.tableViewController );
+	}
+	// Plain table
+	{
+		ASTItem* keptItem = [ ASTItem itemWithDict: @{ AST_id : @"kept" } ];
+		ASTViewController* vc = [ [ ASTViewController alloc ]
+				initWithStyle: UITableViewStylePlain ];
+		vc.animatesDataChanges = YES;
+		vc.data = @[ @{ AST_id : @"replaced" }, keptItem, @{ AST_id : @"removed" } ];
+		ASTItem* replacedItem = [ vc itemAtIndexPath:
+				[ NSIndexPath indexPathForRow: 0 inSection: 0 ] ];
+		
+		vc.data = @[ keptItem, @{ AST_id : @"replaced" }, @{} ];
+		
+		XCTAssertEqual( [ vc.tableView numberOfRowsInSection: 0 ], 3 );
+		XCTAssertEqualObjects( [ vc indexPathForItem: keptItem ],
+				[ NSIndexPath indexPathForRow: 0 inSection: 0 ] );
+		XCTAssertNil( replacedItem.tableViewController );
+		XCTAssertEqualObjects( [ vc itemWithIdentifier: @"replaced" ].indexPath,
+				[ NSIndexPath indexPathForRow: 1 inSection: 0 ] );
+		XCTAssertNil( [ vc itemWithIdentifier: @"removed" ] );
+	}
+}
+
+//------------------------------------------------------------------------------
+
+- (void) testSetDataWithRowAnimationReusesItems
+{
+	ASTViewController* vc = [ [ ASTViewController alloc ]
+			initWithStyle: UITableViewStyleGrouped ];
+	vc.data = @[
+		@{
+			AST_id : @"section",
+			AST_items : @[
+				@{ AST_id : @"a", AST_cell_textLabel_text : @"A" },
+				@{ AST_id : @"b", AST_cell_textLabel_text : @"B" },
+			],
+		},
+	];
+	ASTItem* itemA = [ vc itemWithIdentifier: @"a" ];
+	ASTItem* itemB = [ vc itemWithIdentifier: @"b" ];
+	
+	[ vc setData: @[
+		@{
+			AST_id : @"section",
+			AST_items : @[
+				@{ AST_id : @"b", AST_cell_textLabel_text : @"B" },
+				@{ AST_id : @"a", AST_cell_textLabel_text : @"Changed" },
+				@{ AST_id : @"c", AST_itemClass : @"ASTSwitchItem" },
+			],
+		},
+		@{
+			AST_items : @[
+				// Items of a different class are replaced.
+				@{ AST_id : @"b", AST_itemClass : @"ASTSwitchItem" },
+			],
+		},
+	] withRowAnimation: UITableViewRowAnimationNone ];
+	
+	XCTAssertEqual( [ vc itemAtIndexPath: [ NSIndexPath indexPathForRow: 0 inSection: 0 ] ], itemB );
+	XCTAssertEqual( [ vc itemAtIndexPath: [ NSIndexPath indexPathForRow: 1 inSection: 0 ] ], itemA );
+	XCTAssertEqualObjects( itemA.cell.textLabel.text, @"Changed" );
+	XCTAssertEqual( itemA.tableViewController, vc );
+	XCTAssertEqual( itemA.section, [ vc sectionAtIndex: 0 ] );
+	XCTAssert( [ [ vc itemAtIndexPath: [ NSIndexPath indexPathForRow: 0 inSection: 1 ] ]
+			isKindOfClass: [ ASTSwitchItem class ] ] );
+	XCTAssertEqual( [ vc.tableView numberOfRowsInSection: 0 ], 3 );
+}
+
+//------------------------------------------------------------------------------
+
+- (void) testSetDataReusesItems
+{
+	ASTViewController* vc = [ [ ASTViewController alloc ]
+			initWithStyle: UITableViewStylePlain ];
+	vc.data = @[
+		@{ AST_id : @"a", AST_cell_textLabel_text : @"A" },
+		@{ AST_id : @"b", AST_cell_textLabel_text : @"B" },
+	];
+	ASTItem* itemA = [ vc itemWithIdentifier: @"a" ];
+	[ itemA setValue: @"Typed" forKeyPath: AST_cell_detailTextLabel_text ];
+	
+	vc.data = @[
+		@{ AST_id : @"b", AST_cell_textLabel_text : @"B" },
+		@{ AST_id : @"a", AST_cell_textLabel_text : @"Changed" },
+	];
+	XCTAssertEqual( [ vc itemAtIndexPath: [ NSIndexPath indexPathForRow: 1 inSection: 0 ] ], itemA );
+	XCTAssertEqualObjects( [ itemA valueForKeyPath: AST_cell_textLabel_text ], @"Changed" );
+	XCTAssertEqualObjects( [ itemA valueForKeyPath: AST_cell_detailTextLabel_text ], @"Typed" );
+	XCTAssertEqual( itemA.tableViewController, vc );
+	
+	// Setting the items of a section reuses them too.
+	ASTSection* section = [ ASTSection sectionWithItems: @[
+		@{ AST_id : @"c", AST_cell_textLabel_text : @"C" },
+	] ];
+	ASTItem* itemC = [ section itemWithIdentifier: @"c" ];
+	section.items = @[
+		@{ AST_id : @"d", AST_cell_textLabel_text : @"D" },
+		@{ AST_id : @"c", AST_cell_textLabel_text : @"Changed" },
+	];
+	XCTAssertEqual( [ section itemAtIndex: 1 ], itemC );
+	XCTAssertEqualObjects( [ itemC valueForKeyPath: AST_cell_textLabel_text ], @"Changed" );
+}
+
+//------------------------------------------------------------------------------
+
 - (void) testGroupedTableData
 {
 	ASTViewController* vc = [ [ ASTViewController alloc ]
@@ -470,6 +633,64 @@
 
 //------------------------------------------------------------------------------
 
+- (void) testLookupFollowsChanges
+{
+	// Group table
+	{
+		ASTSection* section = [ ASTSection sectionWithDict: @{ AST_id : @"dup" } ];
+		ASTSection* otherSection = [ ASTSection sectionWithDict: @{ AST_id : @"dup" } ];
+		ASTViewController* vc = [ [ ASTViewController alloc ]
+				initWithStyle: UITableViewStyleGrouped ];
+		vc.data = @[ section, otherSection ];
+		XCTAssertEqual( [ vc sectionWithIdentifier: @"dup" ], section );
+		
+		[ vc moveSectionWithAnimationAtIndex: 1 toIndex: 0 ];
+		XCTAssertEqual( [ vc sectionWithIdentifier: @"dup" ], otherSection );
+		
+		otherSection.identifier = @"other";
+		XCTAssertEqual( [ vc sectionWithIdentifier: @"dup" ], section );
+		XCTAssertEqual( [ vc sectionWithIdentifier: @"other" ], otherSection );
+		
+		[ vc removeSectionsAtIndexes: @[ @0 ] withRowAnimation: UITableViewRowAnimationNone ];
+		XCTAssertNil( [ vc sectionWithIdentifier: @"other" ] );
+		
+		ASTItem* item = [ ASTItem item ];
+		[ section insertItems: @[ item ] atIndexes: @[ @0 ]
+				withRowAnimation: UITableViewRowAnimationNone ];
+		item.identifier = @"item";
+		item.representedObject = @"object";
+		XCTAssertEqual( [ vc itemWithIdentifier: @"item" ], item );
+		XCTAssertEqual( [ vc itemWithRepresentedObject: @"object" ], item );
+	}
+	// Plain table
+	{
+		ASTItem* item = [ ASTItem itemWithDict: @{ AST_id : @"dup" } ];
+		ASTItem* otherItem = [ ASTItem itemWithDict: @{ AST_id : @"dup" } ];
+		ASTViewController* vc = [ [ ASTViewController alloc ]
+				initWithStyle: UITableViewStylePlain ];
+		vc.data = @[ item ];
+		XCTAssertEqual( [ vc itemWithIdentifier: @"dup" ], item );
+		
+		[ vc insertItems: @[ otherItem ]
+				atIndexPaths: @[ [ NSIndexPath indexPathForItem: 0 inSection: 0 ] ]
+				withRowAnimation: UITableViewRowAnimationNone ];
+		XCTAssertEqual( [ vc itemWithIdentifier: @"dup" ], otherItem );
+		
+		otherItem.representedObject = @"object";
+		XCTAssertEqual( [ vc itemWithRepresentedObject: @"object" ], otherItem );
+		
+		[ vc removeItemsAtIndexPaths: @[ [ NSIndexPath indexPathForItem: 0 inSection: 0 ] ]
+				withRowAnimation: UITableViewRowAnimationNone ];
+		XCTAssertEqual( [ vc itemWithIdentifier: @"dup" ], item );
+		XCTAssertNil( [ vc itemWithRepresentedObject: @"object" ] );
+		
+		vc.data = @[ otherItem ];
+		XCTAssertEqual( [ vc itemWithIdentifier: @"dup" ], otherItem );
+	}
+}
+
+//------------------------------------------------------------------------------
+
 - (void) testItemAtIndexPath
 {
 	// Group table
@@ -689,6 +910,126 @@
 
 //------------------------------------------------------------------------------
 
+- (void) testIndexPathForItemAfterMutations
+{
+	// Group table
+	{
+		ASTItem* item = [ ASTItem itemWithText: @"Foo" ];
+		ASTSection* section = [ ASTSection sectionWithItems: @[
+			[ ASTItem itemWithText: @"1" ],
+			item,
+		] ];
+		
+		ASTViewController* vc = [ [ ASTViewController alloc ]
+				initWithStyle: UITableViewStyleGrouped ];
+		vc.data = @[
+			[ ASTSection sectionWithItems: @[ [ ASTItem itemWithText: @"1" ] ] ],
+			section,
+		];
+		XCTAssertEqualObjects( [ vc indexPathForItem: item ],
+				[ NSIndexPath indexPathForItem: 1 inSection: 1 ] );
+		
+		[ vc insertSections: @[ [ ASTSection section ] ] atIndexes: @[ @0 ]
+				withRowAnimation: UITableViewRowAnimationNone ];
+		XCTAssertEqual( [ vc indexOfSection: section ], 2 );
+		XCTAssertEqualObjects( [ vc indexPathForItem: item ],
+				[ NSIndexPath indexPathForItem: 1 inSection: 2 ] );
+		
+		[ section insertItems: @[ [ ASTItem itemWithText: @"0" ] ] atIndexes: @[ @0 ]
+				withRowAnimation: UITableViewRowAnimationNone ];
+		XCTAssertEqualObjects( [ vc indexPathForItem: item ],
+				[ NSIndexPath indexPathForItem: 2 inSection: 2 ] );
+		
+		[ vc moveSectionWithAnimationAtIndex: 2 toIndex: 0 ];
+		[ section moveItemAtIndex: 2 toIndex: 0 ];
+		XCTAssertEqualObjects( [ vc indexPathForItem: item ],
+				[ NSIndexPath indexPathForItem: 0 inSection: 0 ] );
+		
+		[ vc moveItemWithAnimationAtIndexPath: [ NSIndexPath indexPathForItem: 0 inSection: 0 ]
+				toIndexPath: [ NSIndexPath indexPathForItem: 1 inSection: 2 ] ];
+		XCTAssertEqualObjects( [ vc indexPathForItem: item ],
+				[ NSIndexPath indexPathForItem: 1 inSection: 2 ] );
+		XCTAssertEqual( [ section indexOfItem: item ], NSNotFound );
+		
+		[ vc removeSectionsAtIndexes: @[ @0, @1 ]
+				withRowAnimation: UITableViewRowAnimationNone ];
+		XCTAssertEqual( [ vc indexOfSection: section ], NSNotFound );
+		XCTAssertEqualObjects( [ vc indexPathForItem: item ],
+				[ NSIndexPath indexPathForItem: 1 inSection: 0 ] );
+		
+		[ item removeFromContainerWithAnimation: UITableViewRowAnimationNone ];
+		XCTAssertNil( [ vc indexPathForItem: item ] );
+	}
+	// Plain table
+	{
+		ASTItem* item = [ ASTItem itemWithText: @"Foo" ];
+		
+		ASTViewController* vc = [ [ ASTViewController alloc ]
+				initWithStyle: UITableViewStylePlain ];
+		vc.data = @[ @{}, item, @{} ];
+		XCTAssertEqualObjects( [ vc indexPathForItem: item ],
+				[ NSIndexPath indexPathForItem: 1 inSection: 0 ] );
+		
+		[ vc removeItemsAtIndexPaths: @[ [ NSIndexPath indexPathForItem: 0 inSection: 0 ] ]
+				withRowAnimation: UITableViewRowAnimationNone ];
+		XCTAssertEqualObjects( [ vc indexPathForItem: item ],
+				[ NSIndexPath indexPathForItem: 0 inSection: 0 ] );
+		
+		[ vc moveItemWithAnimationAtIndexPath: [ NSIndexPath indexPathForItem: 0 inSection: 0 ]
+				toIndexPath: [ NSIndexPath indexPathForItem: 1 inSection: 0 ] ];
+		XCTAssertEqualObjects( [ vc indexPathForItem: item ],
+				[ NSIndexPath indexPathForItem: 1 inSection: 0 ] );
+		
+		[ vc insertItems: @[ [ ASTItem item ], [ ASTItem item ] ]
+				atIndexPaths: @[
+					[ NSIndexPath indexPathForItem: 0 inSection: 0 ],
+					[ NSIndexPath indexPathForItem: 3 inSection: 0 ],
+				]
+				withRowAnimation: UITableViewRowAnimationNone ];
+		XCTAssertEqualObjects( [ vc indexPathForItem: item ],
+				[ NSIndexPath indexPathForItem: 2 inSection: 0 ] );
+	}
+}
+
+//------------------------------------------------------------------------------
+
+- (void) testIndexPathForItemPerformance
+{
+	// 100 sections of 1000 rows.
+	NSMutableArray* sections = [ NSMutableArray array ];
+	NSMutableArray* allItems = [ NSMutableArray array ];
+	for( int i = 0; i < 100; ++i ) {
+		NSMutableArray* items = [ NSMutableArray array ];
+		for( int j = 0; j < 1000; ++j ) {
+			[ items addObject: [ ASTItem item ] ];
+		}
+		[ allItems addObjectsFromArray: items ];
+		[ sections addObject: [ ASTSection sectionWithItems: items ] ];
+	}
+	
+	ASTViewController* vc = [ [ ASTViewController alloc ]
+			initWithStyle: UITableViewStyleGrouped ];
+	vc.data = sections;
+	ASTSection* firstSection = sections.firstObject;
+	
+	[ self measureBlock: ^{
+		// Each insertion at the front invalidates every row of the section
+		// and every section after it.
+		[ firstSection insertItems: @[ [ ASTItem item ] ] atIndexes: @[ @0 ]
+				withRowAnimation: UITableViewRowAnimationNone ];
+		[ vc insertSections: @[ [ ASTSection section ] ] atIndexes: @[ @0 ]
+				withRowAnimation: UITableViewRowAnimationNone ];
+		for( ASTItem* item in allItems ) {
+			XCTAssertNotNil( item.indexPath );
+		}
+	} ];
+	
+	XCTAssertEqualObjects( [ vc indexPathForItem: allItems.lastObject ],
+			[ NSIndexPath indexPathForItem: 999 inSection: vc.numberOfItems - 1 ] );
+}
+
+//------------------------------------------------------------------------------
+
 - (void) testSectionForItem
 {
 	// Group table
@@ -1051,6 +1392,229 @@
 
 //------------------------------------------------------------------------------
 
+- (void) testPerformBatchUpdates
+{
+	// Group table
+	{
+		ASTItem* movedItem = [ ASTItem itemWithText: @"Moved" ];
+		ASTItem* removedItem = [ ASTItem itemWithText: @"Removed" ];
+		ASTItem* insertedItem = [ ASTItem itemWithText: @"Inserted" ];
+		ASTItem* transientItem = [ ASTItem itemWithText: @"Transient" ];
+		ASTSection* firstSection = [ ASTSection sectionWithItems: @[
+			[ ASTItem itemWithText: @"1" ],
+			movedItem,
+		] ];
+		ASTSection* secondSection = [ ASTSection sectionWithItems: @[
+			removedItem,
+			[ ASTItem itemWithText: @"2" ],
+		] ];
+		ASTSection* thirdSection = [ ASTSection sectionWithItems: @[
+			[ ASTItem itemWithText: @"3" ],
+		] ];
+		ASTViewController* vc = [ [ ASTViewController alloc ]
+				initWithStyle: UITableViewStyleGrouped ];
+		vc.data = @[ firstSection, secondSection, thirdSection ];
+		UITableView* tableView = vc.tableView;
+		XCTAssertEqual( tableView.numberOfSections, 3 );
+		
+		[ vc performBatchUpdates: ^{
+			// Each index refers to the state left by the previous change.
+			[ vc removeItemsAtIndexPaths: @[ [ NSIndexPath indexPathForRow: 0 inSection: 1 ] ]
+					withRowAnimation: UITableViewRowAnimationFade ];
+			[ vc insertItems: @[ transientItem ]
+					atIndexPaths: @[ [ NSIndexPath indexPathForRow: 0 inSection: 2 ] ]
+					withRowAnimation: UITableViewRowAnimationFade ];
+			[ vc moveItemWithAnimationAtIndexPath: [ NSIndexPath indexPathForRow: 1 inSection: 0 ]
+					toIndexPath: [ NSIndexPath indexPathForRow: 0 inSection: 1 ] ];
+			[ secondSection insertItems: @[ insertedItem ] atIndexes: @[ @2 ]
+					withRowAnimation: UITableViewRowAnimationFade ];
+			[ thirdSection removeItemsAtIndexes: @[ @0 ]
+					withRowAnimation: UITableViewRowAnimationFade ];
+			[ vc moveSectionWithAnimationAtIndex: 2 toIndex: 0 ];
+		} withRowAnimation: UITableViewRowAnimationNone ];
+		
+		XCTAssertEqual( [ vc sectionAtIndex: 0 ], thirdSection );
+		XCTAssertEqual( thirdSection.numberOfItems, 1 );
+		XCTAssertNil( transientItem.tableViewController );
+		XCTAssertNil( removedItem.tableViewController );
+		XCTAssertEqualObjects( [ vc indexPathForItem: movedItem ],
+				[ NSIndexPath indexPathForRow: 0 inSection: 2 ] );
+		XCTAssertEqualObjects( [ vc indexPathForItem: insertedItem ],
+				[ NSIndexPath indexPathForRow: 2 inSection: 2 ] );
+		XCTAssertEqual( tableView.numberOfSections, 3 );
+		XCTAssertEqual( [ tableView numberOfRowsInSection: 0 ], 1 );
+		XCTAssertEqual( [ tableView numberOfRowsInSection: 1 ], 1 );
+		XCTAssertEqual( [ tableView numberOfRowsInSection: 2 ], 3 );
+	}
+	// Plain table
+	{
+		ASTItem* item = [ ASTItem itemWithText: @"Foo" ];
+		ASTViewController* vc = [ [ ASTViewController alloc ]
+				initWithStyle: UITableViewStylePlain ];
+		vc.data = @[ @{}, item, @{} ];
+		UITableView* tableView = vc.tableView;
+		XCTAssertEqual( [ tableView numberOfRowsInSection: 0 ], 3 );
+		
+		[ vc performBatchUpdates: ^{
+			[ vc removeItemsAtIndexPaths: @[ [ NSIndexPath indexPathForRow: 0 inSection: 0 ] ]
+					withRowAnimation: UITableViewRowAnimationFade ];
+			// Nested batches are applied by the outermost one.
+			[ vc performBatchUpdates: ^{
+				[ vc insertItems: @[ @{}, @{} ] atIndexPaths: @[
+					[ NSIndexPath indexPathForRow: 0 inSection: 0 ],
+					[ NSIndexPath indexPathForRow: 3 inSection: 0 ],
+				] withRowAnimation: UITableViewRowAnimationFade ];
+			} ];
+			XCTAssertEqual( [ tableView numberOfRowsInSection: 0 ], 3 );
+			[ vc removeItemsAtIndexPaths: @[ [ NSIndexPath indexPathForRow: 0 inSection: 0 ] ]
+					withRowAnimation: UITableViewRowAnimationFade ];
+		} ];
+		
+		XCTAssertEqual( vc.data.count, 3 );
+		XCTAssertEqualObjects( [ vc indexPathForItem: item ],
+				[ NSIndexPath indexPathForRow: 0 inSection: 0 ] );
+		XCTAssertEqual( [ tableView numberOfRowsInSection: 0 ], 3 );
+	}
+}
+
+//------------------------------------------------------------------------------
+
+- (void) testFilterText
+{
+	// Group table
+	{
+		ASTItem* apple = [ ASTItem itemWithStyle: UITableViewCellStyleSubtitle
+				text: @"Apple" detailText: @"Red fruit" ];
+		ASTItem* apricot = [ ASTItem itemWithText: @"Apricot" ];
+		ASTItem* banana = [ ASTItem itemWithText: @"Banana" ];
+		ASTItem* creme = [ ASTItem itemWithText: @"Crème brûlée" ];
+		ASTSection* fruitSection = [ ASTSection sectionWithItems: @[ apple, apricot, banana ] ];
+		ASTSection* dessertSection = [ ASTSection sectionWithItems: @[ creme ] ];
+		ASTViewController* vc = [ [ ASTViewController alloc ]
+				initWithStyle: UITableViewStyleGrouped ];
+		vc.data = @[ fruitSection, dessertSection ];
+		UITableView* tableView = vc.tableView;
+		XCTAssertFalse( vc.filtering );
+		
+		vc.filterText = @"a";
+		XCTAssertTrue( vc.filtering );
+		XCTAssertEqual( tableView.numberOfSections, 1 );
+		XCTAssertEqual( [ tableView numberOfRowsInSection: 0 ], 3 );
+		
+		// Narrowing only searches the displayed items.
+		vc.filterText = @"Ap";
+		XCTAssertEqual( [ tableView numberOfRowsInSection: 0 ], 2 );
+		XCTAssertEqualObjects( [ vc displayedIndexPathForItem: apricot ],
+				[ NSIndexPath indexPathForRow: 1 inSection: 0 ] );
+		XCTAssertNil( [ vc displayedIndexPathForItem: banana ] );
+		XCTAssertEqualObjects( [ vc indexPathForItem: banana ],
+				[ NSIndexPath indexPathForRow: 2 inSection: 0 ] );
+		
+		// Every word must match, in the detail text as well.
+		vc.filterText = @"ap fru";
+		XCTAssertEqual( [ tableView numberOfRowsInSection: 0 ], 1 );
+		XCTAssertEqual( [ tableView cellForRowAtIndexPath:
+				[ NSIndexPath indexPathForRow: 0 inSection: 0 ] ], apple.cell );
+		
+		// Case and diacritics are ignored.
+		vc.filterText = @"CREME";
+		XCTAssertEqual( tableView.numberOfSections, 1 );
+		XCTAssertEqualObjects( [ vc displayedIndexPathForItem: creme ],
+				[ NSIndexPath indexPathForRow: 0 inSection: 0 ] );
+		
+		// Changes to the model are shown when the results are updated.
+		ASTItem* cranberry = [ ASTItem itemWithText: @"Cranberry" ];
+		[ fruitSection insertItems: @[ cranberry ] atIndexes: @[ @0 ]
+				withRowAnimation: UITableViewRowAnimationNone ];
+		XCTAssertEqual( tableView.numberOfSections, 1 );
+		vc.filterText = @"cr";
+		XCTAssertEqual( tableView.numberOfSections, 2 );
+		XCTAssertEqualObjects( [ vc displayedIndexPathForItem: cranberry ],
+				[ NSIndexPath indexPathForRow: 0 inSection: 0 ] );
+		XCTAssertEqualObjects( [ vc displayedIndexPathForItem: creme ],
+				[ NSIndexPath indexPathForRow: 0 inSection: 1 ] );
+		[ banana setValue: @"Crab apple" forKeyPath: AST_cell_textLabel_text ];
+		[ vc updateFilterResults ];
+		XCTAssertEqual( [ tableView numberOfRowsInSection: 0 ], 2 );
+		
+		// Text without words shows all of the items.
+		vc.filterText = @" - ";
+		XCTAssertFalse( vc.filtering );
+		XCTAssertEqual( tableView.numberOfSections, 2 );
+		XCTAssertEqual( [ tableView numberOfRowsInSection: 0 ], 4 );
+		XCTAssertEqualObjects( [ vc displayedIndexPathForItem: banana ],
+				[ NSIndexPath indexPathForRow: 3 inSection: 0 ] );
+	}
+	// Plain table
+	{
+		ASTItem* item = [ ASTItem itemWithText: @"Foo" ];
+		item.identifier = @"first";
+		ASTViewController* vc = [ [ ASTViewController alloc ]
+				initWithStyle: UITableViewStylePlain ];
+		vc.data = @[ item, [ ASTItem itemWithText: @"Bar" ] ];
+		UITableView* tableView = vc.tableView;
+		
+		vc.filterText = @"fir";
+		XCTAssertEqual( tableView.numberOfSections, 1 );
+		XCTAssertEqual( [ tableView numberOfRowsInSection: 0 ], 1 );
+		vc.filterText = @"baz";
+		XCTAssertEqual( [ tableView numberOfRowsInSection: 0 ], 0 );
+		vc.filterText = nil;
+		XCTAssertEqual( [ tableView numberOfRowsInSection: 0 ], 2 );
+	}
+}
+
+//------------------------------------------------------------------------------
+
+- (void) testFilterTextUpdatesSearchIndex
+{
+	ASTItem* apple = [ ASTItem itemWithText: @"Apple" ];
+	ASTItem* banana = [ ASTItem itemWithText: @"Banana" ];
+	ASTItem* cherry = [ ASTItem itemWithText: @"Cherry" ];
+	ASTSection* section = [ ASTSection sectionWithItems: @[ apple, banana, cherry ] ];
+	ASTViewController* vc = [ [ ASTViewController alloc ]
+			initWithStyle: UITableViewStyleGrouped ];
+	vc.data = @[ section ];
+	UITableView* tableView = vc.tableView;
+	
+	vc.filterText = @"a";
+	XCTAssertEqual( [ tableView numberOfRowsInSection: 0 ], 2 );
+	id searchIndex = [ vc valueForKey: @"_searchIndex" ];
+	XCTAssertNotNil( searchIndex );
+	
+	// Inserted, removed and changed items update the index instead of
+	// replacing it.
+	ASTItem* apricot = [ ASTItem itemWithText: @"Apricot" ];
+	[ section insertItems: @[ apricot ] atIndexes: @[ @1 ]
+			withRowAnimation: UITableViewRowAnimationNone ];
+	[ section removeItemsAtIndexes: @[ @0 ] withRowAnimation: UITableViewRowAnimationNone ];
+	[ cherry setValue: @"Almond" forKeyPath: AST_cell_textLabel_text ];
+	[ vc updateFilterResults ];
+	XCTAssertEqual( [ vc valueForKey: @"_searchIndex" ], searchIndex );
+	XCTAssertEqual( [ tableView numberOfRowsInSection: 0 ], 3 );
+	XCTAssertNil( [ vc displayedIndexPathForItem: apple ] );
+	XCTAssertEqualObjects( [ vc displayedIndexPathForItem: apricot ],
+			[ NSIndexPath indexPathForRow: 0 inSection: 0 ] );
+	XCTAssertEqualObjects( [ vc displayedIndexPathForItem: cherry ],
+			[ NSIndexPath indexPathForRow: 2 inSection: 0 ] );
+	
+	// Narrowing after a change searches the index instead of the displayed
+	// items.
+	banana.identifier = @"alpha";
+	vc.filterText = @"al";
+	XCTAssertEqual( [ vc valueForKey: @"_searchIndex" ], searchIndex );
+	XCTAssertEqual( [ tableView numberOfRowsInSection: 0 ], 2 );
+	XCTAssertEqualObjects( [ vc displayedIndexPathForItem: banana ],
+			[ NSIndexPath indexPathForRow: 0 inSection: 0 ] );
+	
+	// Removing the items from the table view removes them from the index.
+	[ vc removeSectionsAtIndexes: @[ @0 ] withRowAnimation: UITableViewRowAnimationNone ];
+	vc.filterText = @"a";
+	XCTAssertEqual( tableView.numberOfSections, 0 );
+}
+
+//------------------------------------------------------------------------------
+
 - (void) testShouldHighlightRowAtIndexPath
 {
 	// Group table
@@ -1161,4 +1725,410 @@
 
 //------------------------------------------------------------------------------
 
+- (void) testReusedCellCountFollowsVisibleRows
+{
+	ASTViewController* vc = [ [ ASTViewController alloc ]
+			initWithStyle: UITableViewStylePlain ];
+	vc.reusesCells = YES;
+	
+	NSMutableArray* lotsOfItems = [ NSMutableArray array ];
+	for( int i = 0; i < 1000; ++i ) {
+		[ lotsOfItems addObject: [ ASTItem itemWithText: [ NSString stringWithFormat: @"%d", i ] ] ];
+	}
+	vc.data = lotsOfItems;
+	
+	vc.tableView.bounds = CGRectMake( 0, 0, 640, 960 );
+	[ vc.view layoutIfNeeded ];
+	
+	ASTItem* firstItem = lotsOfItems[ 0 ];
+	XCTAssert( firstItem.cellLoaded );
+	
+	NSMutableSet* seenCells = [ NSMutableSet set ];
+	for( CGFloat offset = 0; offset < 20000; offset += 400 ) {
+		vc.tableView.contentOffset = CGPointMake( 0, offset );
+		[ vc.view layoutIfNeeded ];
+		
+		for( NSIndexPath* indexPath in vc.tableView.indexPathsForVisibleRows ) {
+			ASTItem* item = [ vc itemAtIndexPath: indexPath ];
+			UITableViewCell* cell = [ vc.tableView cellForRowAtIndexPath: indexPath ];
+			XCTAssertEqual( item.cell, cell );
+			XCTAssertEqualObjects( cell.textLabel.text, [ item valueForKeyPath: AST_cell_textLabel_text ] );
+			[ seenCells addObject: cell ];
+		}
+	}
+	
+	XCTAssertFalse( firstItem.cellLoaded );
+	XCTAssertLessThan( seenCells.count, 2 * vc.tableView.visibleCells.count + 2 );
+}
+
+//------------------------------------------------------------------------------
+
+- (void) testReusedCellIsReconfigured
+{
+	ASTViewController* vc = [ [ ASTViewController alloc ]
+			initWithStyle: UITableViewStylePlain ];
+	vc.reusesCells = YES;
+	
+	ASTItem* checkedItem = [ ASTItem itemWithDict: @{
+		AST_cell_textLabel_text : @"checked",
+		AST_cell_accessoryType : @(UITableViewCellAccessoryCheckmark),
+	} ];
+	ASTItem* plainItem = [ ASTItem itemWithText: @"plain" ];
+	vc.data = @[ checkedItem, plainItem ];
+	
+	UITableViewCell* cell = checkedItem.cell;
+	XCTAssertEqual( cell.accessoryType, UITableViewCellAccessoryCheckmark );
+	
+	[ vc tableView: vc.tableView didEndDisplayingCell: cell
+			forRowAtIndexPath: [ NSIndexPath indexPathForRow: 0 inSection: 0 ] ];
+	XCTAssertFalse( checkedItem.cellLoaded );
+	
+	XCTAssertEqual( plainItem.cell, cell );
+	XCTAssertEqualObjects( cell.textLabel.text, @"plain" );
+	XCTAssertEqual( cell.accessoryType, UITableViewCellAccessoryNone );
+	
+	// A cell of a removed item still goes back to the pool.
+	[ vc removeItemsAtIndexPaths: @[ [ NSIndexPath indexPathForRow: 1 inSection: 0 ] ]
+			withRowAnimation: UITableViewRowAnimationNone ];
+	[ vc tableView: vc.tableView didEndDisplayingCell: cell
+			forRowAtIndexPath: [ NSIndexPath indexPathForRow: 1 inSection: 0 ] ];
+	
+	XCTAssertEqual( checkedItem.cell, cell );
+	XCTAssertEqualObjects( cell.textLabel.text, @"checked" );
+	XCTAssertEqual( cell.accessoryType, UITableViewCellAccessoryCheckmark );
+}
+
+//------------------------------------------------------------------------------
+
+- (void) testDeferredCellUpdates
+{
+	ASTViewController* vc = [ [ ASTViewController alloc ]
+			initWithStyle: UITableViewStylePlain ];
+	vc.defersCellUpdates = YES;
+	
+	ASTItem* onscreenItem = [ ASTItem itemWithText: @"a" ];
+	ASTItem* offscreenItem = [ ASTItem itemWithText: @"b" ];
+	vc.data = @[ onscreenItem, offscreenItem ];
+	
+	NSIndexPath* onscreenIndexPath = [ NSIndexPath indexPathForRow: 0 inSection: 0 ];
+	NSIndexPath* offscreenIndexPath = [ NSIndexPath indexPathForRow: 1 inSection: 0 ];
+	UITableViewCell* onscreenCell = onscreenItem.cell;
+	UITableViewCell* offscreenCell = offscreenItem.cell;
+	[ vc tableView: vc.tableView willDisplayCell: onscreenCell
+			forRowAtIndexPath: onscreenIndexPath ];
+	[ vc tableView: vc.tableView willDisplayCell: offscreenCell
+			forRowAtIndexPath: offscreenIndexPath ];
+	[ vc tableView: vc.tableView didEndDisplayingCell: offscreenCell
+			forRowAtIndexPath: offscreenIndexPath ];
+	
+	// Changes wait for the next frame and only the last value is applied.
+	[ onscreenItem setValue: @"a1" forKeyPath: AST_cell_textLabel_text ];
+	[ onscreenItem setValue: @"a2" forKeyPath: AST_cell_textLabel_text ];
+	[ offscreenItem setValue: @"b1" forKeyPath: AST_cell_textLabel_text ];
+	XCTAssertEqualObjects( onscreenCell.textLabel.text, @"a" );
+	XCTAssertEqualObjects( [ onscreenItem valueForKeyPath: AST_cell_textLabel_text ], @"a2" );
+	
+	[ vc applyPendingCellUpdates ];
+	XCTAssertEqualObjects( onscreenCell.textLabel.text, @"a2" );
+	
+	// Cells that are not on screen are updated when they are displayed again.
+	XCTAssertEqualObjects( offscreenCell.textLabel.text, @"b" );
+	[ vc tableView: vc.tableView willDisplayCell: offscreenCell
+			forRowAtIndexPath: offscreenIndexPath ];
+	XCTAssertEqualObjects( offscreenCell.textLabel.text, @"b1" );
+	
+	// The display link applies the changes without being asked.
+	[ onscreenItem setValue: @"a3" forKeyPath: AST_cell_textLabel_text ];
+	NSDate* timeout = [ NSDate dateWithTimeIntervalSinceNow: 1 ];
+	while( [ onscreenCell.textLabel.text isEqualToString: @"a3" ] == NO
+			&& [ timeout timeIntervalSinceNow ] > 0 ) {
+		[ [ NSRunLoop mainRunLoop ] runUntilDate: [ NSDate dateWithTimeIntervalSinceNow: 0.01 ] ];
+	}
+	XCTAssertEqualObjects( onscreenCell.textLabel.text, @"a3" );
+	
+	// Reading the cell brings it up to date.
+	[ vc tableView: vc.tableView didEndDisplayingCell: offscreenCell
+			forRowAtIndexPath: offscreenIndexPath ];
+	[ offscreenItem setValue: @"b2" forKeyPath: AST_cell_textLabel_text ];
+	XCTAssertEqualObjects( offscreenItem.cell.textLabel.text, @"b2" );
+}
+
+//------------------------------------------------------------------------------
+
+- (void) testSectionViewHeightsAreCached
+{
+	ASTViewController* vc = [ [ ASTViewController alloc ]
+			initWithStyle: UITableViewStyleGrouped ];
+	vc.tableView.frame = CGRectMake( 0, 0, 320, 480 );
+	UILabel* headerView = [ [ UILabel alloc ] init ];
+	headerView.text = @"Header";
+	UILabel* footerView = [ [ UILabel alloc ] init ];
+	footerView.text = @"Footer";
+	ASTSection* section = [ ASTSection sectionWithDict: @{
+		AST_headerView : headerView,
+		AST_footerView : footerView,
+	} ];
+	vc.data = @[ section ];
+	
+	NSUInteger count = vc.sectionViewMeasurementCount;
+	for( NSUInteger i = 0; i < 3; ++i ) {
+		[ vc tableView: vc.tableView heightForHeaderInSection: 0 ];
+		[ vc tableView: vc.tableView heightForFooterInSection: 0 ];
+	}
+	XCTAssertEqual( vc.sectionViewMeasurementCount, count + 2 );
+	
+	// Replacing a view only measures that view again.
+	section.headerView = [ [ UILabel alloc ] init ];
+	[ vc tableView: vc.tableView heightForHeaderInSection: 0 ];
+	[ vc tableView: vc.tableView heightForFooterInSection: 0 ];
+	XCTAssertEqual( vc.sectionViewMeasurementCount, count + 3 );
+	
+	section.footerText = @"Footer text";
+	[ vc tableView: vc.tableView heightForHeaderInSection: 0 ];
+	[ vc tableView: vc.tableView heightForFooterInSection: 0 ];
+	XCTAssertEqual( vc.sectionViewMeasurementCount, count + 4 );
+	
+	// A different width measures both views again.
+	vc.tableView.frame = CGRectMake( 0, 0, 480, 320 );
+	[ vc tableView: vc.tableView heightForHeaderInSection: 0 ];
+	[ vc tableView: vc.tableView heightForFooterInSection: 0 ];
+	XCTAssertEqual( vc.sectionViewMeasurementCount, count + 6 );
+	
+	[ vc traitCollectionDidChange: nil ];
+	[ vc tableView: vc.tableView heightForHeaderInSection: 0 ];
+	[ vc tableView: vc.tableView heightForFooterInSection: 0 ];
+	XCTAssertEqual( vc.sectionViewMeasurementCount, count + 8 );
+}
+
+//------------------------------------------------------------------------------
+
+- (void) testEstimatedRowHeights
+{
+	NSString* key = [ NSUUID UUID ].UUIDString;
+	NSArray* data = @[
+		@{ AST_id : @"tall", AST_cell_textLabel_text : @"Tall" },
+		@{ AST_cell_textLabel_text : @"No identifier" },
+		@{ AST_id : @"new", AST_cell_textLabel_text : @"New" },
+	];
+	NSIndexPath* tallIndexPath = [ NSIndexPath indexPathForRow: 0 inSection: 0 ];
+	NSIndexPath* unnamedIndexPath = [ NSIndexPath indexPathForRow: 1 inSection: 0 ];
+	NSIndexPath* newIndexPath = [ NSIndexPath indexPathForRow: 2 inSection: 0 ];
+	
+	ASTViewController* vc = [ [ ASTViewController alloc ]
+			initWithStyle: UITableViewStylePlain ];
+	vc.tableView.frame = CGRectMake( 0, 0, 320, 480 );
+	vc.rowHeightCacheKey = key;
+	vc.data = data;
+	CGFloat defaultEstimate = vc.tableView.estimatedRowHeight;
+	
+	for( NSIndexPath* indexPath in @[ tallIndexPath, unnamedIndexPath ] ) {
+		UITableViewCell* cell = [ vc itemAtIndexPath: indexPath ].cell;
+		cell.frame = CGRectMake( 0, 0, 320, 120 );
+		[ vc tableView: vc.tableView willDisplayCell: cell forRowAtIndexPath: indexPath ];
+	}
+	XCTAssertEqual( [ vc tableView: vc.tableView estimatedHeightForRowAtIndexPath: tallIndexPath ], 120 );
+	XCTAssertEqual( [ vc tableView: vc.tableView estimatedHeightForRowAtIndexPath: unnamedIndexPath ], 120 );
+	XCTAssertEqual( [ vc tableView: vc.tableView estimatedHeightForRowAtIndexPath: newIndexPath ], defaultEstimate );
+	
+	// Heights recorded for another width are not used.
+	vc.tableView.frame = CGRectMake( 0, 0, 480, 320 );
+	XCTAssertEqual( [ vc tableView: vc.tableView estimatedHeightForRowAtIndexPath: tallIndexPath ], defaultEstimate );
+	vc.tableView.frame = CGRectMake( 0, 0, 320, 480 );
+	[ vc viewDidDisappear: NO ];
+	
+	// A new table view controller with the same key starts with the saved
+	// heights of the items with identifiers.
+	ASTViewController* reopenedVC = [ [ ASTViewController alloc ]
+			initWithStyle: UITableViewStylePlain ];
+	reopenedVC.tableView.frame = CGRectMake( 0, 0, 320, 480 );
+	reopenedVC.rowHeightCacheKey = key;
+	reopenedVC.data = data;
+	XCTAssertEqual( [ reopenedVC tableView: reopenedVC.tableView estimatedHeightForRowAtIndexPath: tallIndexPath ], 120 );
+	XCTAssertEqual( [ reopenedVC tableView: reopenedVC.tableView estimatedHeightForRowAtIndexPath: unnamedIndexPath ], defaultEstimate );
+	
+	[ ASTRowHeightCache removeSavedHeightsForKey: key ];
+}
+
+//------------------------------------------------------------------------------
+
+- (void) testSetDataInBackground
+{
+	ASTViewController* vc = [ [ ASTViewController alloc ]
+			initWithStyle: UITableViewStyleGrouped ];
+	NSMutableArray* items = [ NSMutableArray array ];
+	for( NSUInteger i = 0; i < 2000; ++i ) {
+		NSString* identifier = [ NSString stringWithFormat: @"%lu", (unsigned long)i ];
+		[ items addObject: @{ AST_id : identifier, AST_cell_textLabel_text : identifier } ];
+	}
+	
+	XCTestExpectation* expectation = [ self expectationWithDescription: @"data set" ];
+	[ vc setDataInBackground: @[
+		@{ AST_id : @"big", AST_items : items },
+		@{
+			AST_items : @[
+				[ NSNull null ],
+				@{ AST_id : @"switch", AST_itemClass : @"ASTSwitchItem" },
+			],
+		},
+	] completion: ^( NSError* error ) {
+		XCTAssertNil( error );
+		[ expectation fulfill ];
+	} ];
+	XCTAssertEqual( vc.numberOfItems, 0 );
+	[ self waitForExpectationsWithTimeout: 10 handler: nil ];
+	
+	XCTAssertEqual( vc.numberOfItems, 2 );
+	ASTSection* bigSection = [ vc sectionWithIdentifier: @"big" ];
+	XCTAssertEqual( bigSection.numberOfItems, 2000 );
+	for( NSUInteger i = 0; i < 2000; i += 111 ) {
+		ASTItem* item = [ bigSection itemAtIndex: i ];
+		XCTAssertEqualObjects( item.identifier, ( [ NSString stringWithFormat: @"%lu", (unsigned long)i ] ) );
+		XCTAssertEqual( item.tableViewController, vc );
+		XCTAssertFalse( item.cellLoaded );
+	}
+	XCTAssertEqual( [ vc sectionAtIndex: 1 ].numberOfItems, 1 );
+	XCTAssert( [ [ vc itemWithIdentifier: @"switch" ] isKindOfClass: [ ASTSwitchItem class ] ] );
+}
+
+//------------------------------------------------------------------------------
+
+- (void) testSetDataInBackgroundErrors
+{
+	ASTViewController* vc = [ [ ASTViewController alloc ]
+			initWithStyle: UITableViewStylePlain ];
+	vc.data = @[ @{ AST_id : @"original" } ];
+	
+	XCTestExpectation* invalidExpectation = [ self expectationWithDescription: @"invalid data" ];
+	[ vc setDataInBackground: @[ @{ AST_id : @"new" }, @42 ] completion: ^( NSError* error ) {
+		XCTAssertEqualObjects( error.domain, ASTDataErrorDomain );
+		XCTAssertEqual( error.code, ASTDataErrorInvalidData );
+		[ invalidExpectation fulfill ];
+	} ];
+	[ self waitForExpectationsWithTimeout: 10 handler: nil ];
+	XCTAssertNotNil( [ vc itemWithIdentifier: @"original" ] );
+	XCTAssertNil( [ vc itemWithIdentifier: @"new" ] );
+	
+	// Data built for a table view whose data was set in the meantime is dropped.
+	[ vc setDataInBackground: @[ @{ AST_id : @"dropped" } ] completion: ^( NSError* error ) {
+		XCTFail( @"Dropped data was set" );
+	} ];
+	vc.data = @[ @{ AST_id : @"replaced" } ];
+	XCTestExpectation* expectation = [ self expectationWithDescription: @"data set" ];
+	[ vc setDataInBackground: @[ @{ AST_id : @"last" } ] completion: ^( NSError* error ) {
+		[ expectation fulfill ];
+	} ];
+	[ self waitForExpectationsWithTimeout: 10 handler: nil ];
+	XCTAssertNotNil( [ vc itemWithIdentifier: @"last" ] );
+	XCTAssertEqual( vc.numberOfItems, 1 );
+}
+
+//------------------------------------------------------------------------------
+
+- (void) testPrefetching
+{
+	ASTViewController* vc = [ [ ASTViewController alloc ] init ];
+	id<UITableViewDataSourcePrefetching> prefetchDataSource = (id<UITableViewDataSourcePrefetching>)vc;
+	XCTAssertEqual( vc.tableView.prefetchDataSource, prefetchDataSource );
+	
+	__block NSUInteger buildCount = 0;
+	ASTSection* section = [ ASTSection sectionWithNumberOfItems: 100
+			itemProvider: ^( NSUInteger index ) {
+		++buildCount;
+		return [ PrefetchTestItem item ];
+	} ];
+	vc.data = @[ section ];
+	NSUInteger initialBuildCount = buildCount;
+	
+	NSIndexPath* indexPath = [ NSIndexPath indexPathForRow: 50 inSection: 0 ];
+	NSIndexPath* nextIndexPath = [ NSIndexPath indexPathForRow: 51 inSection: 0 ];
+	[ prefetchDataSource tableView: vc.tableView prefetchRowsAtIndexPaths: @[ indexPath, nextIndexPath ] ];
+	XCTAssertEqual( buildCount, initialBuildCount + 2 );
+	PrefetchTestItem* item = (PrefetchTestItem*)[ section builtItemAtIndex: 50 ];
+	XCTAssertEqual( item.prefetchCount, 1 );
+	XCTAssertFalse( item.cellLoaded );
+	
+	// Cancelling does not build items.
+	NSIndexPath* unbuiltIndexPath = [ NSIndexPath indexPathForRow: 80 inSection: 0 ];
+	[ prefetchDataSource tableView: vc.tableView cancelPrefetchingForRowsAtIndexPaths: @[ indexPath, unbuiltIndexPath ] ];
+	XCTAssertEqual( item.cancelPrefetchCount, 1 );
+	XCTAssertNil( [ section builtItemAtIndex: 80 ] );
+	XCTAssertEqual( buildCount, initialBuildCount + 2 );
+}
+
+//------------------------------------------------------------------------------
+
+- (void) testPrefetchingBuildsLazyItemsInBackground
+{
+	ASTViewController* vc = [ [ ASTViewController alloc ] init ];
+	id<UITableViewDataSourcePrefetching> prefetchDataSource = (id<UITableViewDataSourcePrefetching>)vc;
+	
+	NSMutableArray* itemDicts = [ NSMutableArray array ];
+	for( NSUInteger i = 0; i < 100; ++i ) {
+		[ itemDicts addObject: @{
+			AST_itemClass : @"PrefetchTestItem",
+			AST_id : [ NSString stringWithFormat: @"%lu", (unsigned long)i ],
+		} ];
+	}
+	ASTSection* section = [ ASTSection section ];
+	[ section setLazyItems: itemDicts ];
+	vc.data = @[ section ];
+	
+	// The items are put in the section on the main thread, after this method
+	// returns.
+	NSIndexPath* indexPath = [ NSIndexPath indexPathForRow: 50 inSection: 0 ];
+	NSIndexPath* cancelledIndexPath = [ NSIndexPath indexPathForRow: 60 inSection: 0 ];
+	NSIndexPath* displayedIndexPath = [ NSIndexPath indexPathForRow: 70 inSection: 0 ];
+	[ prefetchDataSource tableView: vc.tableView
+			prefetchRowsAtIndexPaths: @[ indexPath, cancelledIndexPath, displayedIndexPath ] ];
+	XCTAssertNil( [ section builtItemAtIndex: 50 ] );
+	[ prefetchDataSource tableView: vc.tableView
+			cancelPrefetchingForRowsAtIndexPaths: @[ cancelledIndexPath ] ];
+	// A row displayed before its background build is done is built right away
+	// and keeps that item.
+	PrefetchTestItem* displayedItem = (PrefetchTestItem*)[ section itemAtIndex: 70 ];
+	
+	NSPredicate* built = [ NSPredicate predicateWithBlock: ^BOOL( ASTSection* object,
+			NSDictionary* bindings ) {
+		return [ object builtItemAtIndex: 50 ] != nil;
+	} ];
+	[ self expectationForPredicate: built evaluatedWithObject: section handler: nil ];
+	[ self waitForExpectationsWithTimeout: 10 handler: nil ];
+	
+	PrefetchTestItem* item = (PrefetchTestItem*)[ section builtItemAtIndex: 50 ];
+	XCTAssertEqualObjects( item.identifier, @"50" );
+	XCTAssertEqual( item.section, section );
+	XCTAssertEqual( item.tableViewController, vc );
+	XCTAssertEqual( item.prefetchCount, 1 );
+	XCTAssertFalse( item.cellLoaded );
+	XCTAssertNil( [ section builtItemAtIndex: 60 ] );
+	XCTAssertEqual( [ section builtItemAtIndex: 70 ], displayedItem );
+	XCTAssertEqual( displayedItem.prefetchCount, 0 );
+}
+
+//------------------------------------------------------------------------------
+
+@end
+
+//------------------------------------------------------------------------------
+
+@implementation PrefetchTestItem
+
+//------------------------------------------------------------------------------
+
+- (void) prefetch
+{
+	[ super prefetch ];
+	++_prefetchCount;
+}
+
+//------------------------------------------------------------------------------
+
+- (void) cancelPrefetch
+{
+	[ super cancelPrefetch ];
+	++_cancelPrefetchCount;
+}
+
+//------------------------------------------------------------------------------
+
 @end
@@ -0,0 +1,80 @@
+//==============================================================================
+//
+//  ASTBenchmark.h
+//
+//==============================================================================
+//
+//  Copyright (c) 2016 Adobe Systems Incorporated. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a
+//  copy of this software and associated documentation files (the "Software"),
+//  to deal in the Software without restriction, including without limitation
+//  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//  and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//
+//==============================================================================
+
+// This is private to the benchmark targets. It times benchmarks and compares
+// them with baselines. It only uses Foundation, so the benchmarks of the
+// UIKit-free parts of the framework also build and run outside of an iOS test
+// bundle, see ASTBenchmarkMain.m.
+
+#import <Foundation/Foundation.h>
+
+
+NS_ASSUME_NONNULL_BEGIN
+
+//------------------------------------------------------------------------------
+
+/// The relative regression above which a benchmark fails by default.
+extern const double ASTBenchmarkDefaultThreshold;
+/// The number of times a benchmark runs by default.
+extern const NSUInteger ASTBenchmarkDefaultIterations;
+
+//------------------------------------------------------------------------------
+
+@interface ASTBenchmarkRunner : NSObject
+
+/// The baselines map benchmark names to results. A benchmark fails when its
+/// result exceeds its baseline by more than the threshold, or when it has no
+/// baseline. Without baselines the results are only recorded, so that they can
+/// be written as the first baselines.
+- (instancetype) initWithBaselines: (nullable NSDictionary<NSString*,NSNumber*>*) baselines
+		threshold: (double) threshold NS_DESIGNATED_INITIALIZER;
+- (instancetype) init NS_UNAVAILABLE;
+
+/// The results of the benchmarks run so far, which can be written as a plist
+/// to replace the baselines.
+@property (readonly,nonatomic) NSDictionary<NSString*,NSNumber*>* results;
+/// The failure messages of the benchmarks run so far.
+@property (readonly,nonatomic) NSArray<NSString*>* failures;
+
+/// Runs the block the given number of times, each time after a setUp block that
+/// is not measured. The result is the median duration divided by the median
+/// duration of a fixed Foundation workload, so that it mostly depends on the
+/// code and not on the speed of the device. Returns a failure message or nil.
+- (nullable NSString*) measure: (NSString*) name iterations: (NSUInteger) iterations
+		setUp: (nullable void (^)( void )) setUp block: (void (^)( void )) block;
+
+/// Runs the benchmarks of the parts of the framework that only use Foundation:
+/// ASTDiff, sortIndexesOfArray and ASTKeyPathSetter. Returns their failure
+/// messages.
+- (NSArray<NSString*>*) runFoundationBenchmarks;
+
+@end
+
+//------------------------------------------------------------------------------
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,256 @@
+//==============================================================================
+//
+//  ASTBenchmark.m
+//
+//==============================================================================
+//
+//  Copyright (c) 2016 Adobe Systems Incorporated. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a
+//  copy of this software and associated documentation files (the "Software"),
+//  to deal in the Software without restriction, including without limitation
+//  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//  and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//
+//==============================================================================
+
+#import "ASTBenchmark.h"
+
+#import <time.h>
+#import "ASTDiff.h"
+#import "ASTKeyPathSetter.h"
+#import "ASTSorting.h"
+
+
+//------------------------------------------------------------------------------
+
+const double ASTBenchmarkDefaultThreshold = 0.25;
+const NSUInteger ASTBenchmarkDefaultIterations = 5;
+
+//------------------------------------------------------------------------------
+
+// A monotonic clock that is available with Foundation on every platform the
+// benchmarks build for.
+
+static double currentTime( void )
+{
+	struct timespec time;
+	clock_gettime( CLOCK_MONOTONIC, &time );
+	return time.tv_sec + time.tv_nsec * 1e-9;
+}
+
+//------------------------------------------------------------------------------
+
+static double medianDuration( NSArray* durations )
+{
+	NSArray* sortedDurations = [ durations sortedArrayUsingSelector: @selector(compare:) ];
+	return [ sortedDurations[ sortedDurations.count / 2 ] doubleValue ];
+}
+
+//------------------------------------------------------------------------------
+
+static double measureDuration( NSUInteger iterations, void (^ setUp)( void ), void (^ block)( void ) )
+{
+	NSMutableArray* durations = [ NSMutableArray arrayWithCapacity: iterations ];
+	for( NSUInteger iteration = 0; iteration < iterations; ++iteration ) {
+		@autoreleasepool {
+			if( setUp ) {
+				setUp();
+			}
+			double startTime = currentTime();
+			block();
+			[ durations addObject: @( currentTime() - startTime ) ];
+		}
+	}
+	return medianDuration( durations );
+}
+
+//------------------------------------------------------------------------------
+
+// A workload that only uses Foundation and does not change with the framework:
+// building dictionaries and sorting them by a key.
+
+static double calibrationDuration( void )
+{
+	static double result;
+	static dispatch_once_t onceToken;
+	dispatch_once( &onceToken, ^{
+		result = measureDuration( ASTBenchmarkDefaultIterations, nil, ^{
+			NSMutableArray* array = [ NSMutableArray arrayWithCapacity: 50000 ];
+			for( NSUInteger i = 0; i < 50000; ++i ) {
+				[ array addObject: @{
+					@"key" : @( ( i * 7919 ) % 50000 ),
+					@"text" : [ NSString stringWithFormat: @"Row %lu", (unsigned long)i ],
+				} ];
+			}
+			[ array sortUsingDescriptors: @[ [ NSSortDescriptor sortDescriptorWithKey: @"key" ascending: YES ] ] ];
+		} );
+	} );
+	return result;
+}
+
+//------------------------------------------------------------------------------
+
+// Stands in for items and sections in the diff benchmark and for cells in the
+// keypath setter benchmarks.
+
+@interface ASTBenchmarkObject : NSObject
+
+@property (nullable,copy,nonatomic) NSString* identifier;
+@property (nullable,copy,nonatomic) NSString* name;
+@property (nonatomic) NSInteger count;
+@property (nonatomic) double ratio;
+@property (nullable,strong,nonatomic) ASTBenchmarkObject* child;
+
+@end
+
+//------------------------------------------------------------------------------
+
+@implementation ASTBenchmarkObject
+
+@end
+
+//------------------------------------------------------------------------------
+
+static NSArray* benchmarkObjects( NSUInteger count, NSUInteger identifierOffset )
+{
+	NSMutableArray* result = [ NSMutableArray arrayWithCapacity: count ];
+	for( NSUInteger i = 0; i < count; ++i ) {
+		ASTBenchmarkObject* object = [ [ ASTBenchmarkObject alloc ] init ];
+		object.identifier = [ NSString stringWithFormat: @"object%lu",
+				(unsigned long)( ( i * 7919 + identifierOffset ) % ( count + identifierOffset ) ) ];
+		object.child = [ [ ASTBenchmarkObject alloc ] init ];
+		[ result addObject: object ];
+	}
+	return result;
+}
+
+//------------------------------------------------------------------------------
+
+@implementation ASTBenchmarkRunner {
+	NSDictionary* _baselines;
+	double _threshold;
+	NSMutableDictionary* _results;
+	NSMutableArray* _failures;
+}
+
+//------------------------------------------------------------------------------
+
+- (instancetype) initWithBaselines: (NSDictionary*) baselines threshold: (double) threshold
+{
+	self = [ super init ];
+	if( self ) {
+		_baselines = [ baselines copy ];
+		_threshold = threshold;
+		_results = [ NSMutableDictionary dictionary ];
+		_failures = [ NSMutableArray array ];
+	}
+	return self;
+}
+
+//------------------------------------------------------------------------------
+
+- (NSDictionary*) results
+{
+	return [ _results copy ];
+}
+
+//------------------------------------------------------------------------------
+
+- (NSArray*) failures
+{
+	return [ _failures copy ];
+}
+
+//------------------------------------------------------------------------------
+
+- (NSString*) measure: (NSString*) name iterations: (NSUInteger) iterations
+		setUp: (void (^)( void )) setUp block: (void (^)( void )) block
+{
+	double duration = measureDuration( iterations, setUp, block );
+	double result = duration / calibrationDuration();
+	_results[ name ] = @(result);
+	
+	NSString* failure = nil;
+	NSNumber* baseline = _baselines[ name ];
+	if( _baselines == nil ) {
+		NSLog( @"%@: %.3f (%.2f ms)", name, result, duration * 1000 );
+	} else if( baseline == nil ) {
+		NSLog( @"%@: %.3f (%.2f ms), no baseline", name, result, duration * 1000 );
+		failure = [ NSString stringWithFormat: @"%@ has no baseline, record the baselines "
+				"again with AST_BENCHMARK_RESULTS on the reference device", name ];
+	} else {
+		double change = result / baseline.doubleValue - 1;
+		NSLog( @"%@: %.3f (%.2f ms), baseline %.3f, %+.0f%%", name, result, duration * 1000,
+				baseline.doubleValue, change * 100 );
+		if( change > _threshold ) {
+			failure = [ NSString stringWithFormat: @"%@ regressed by %.0f%%", name, change * 100 ];
+		}
+	}
+	if( failure ) {
+		[ _failures addObject: failure ];
+	}
+	return failure;
+}
+
+//------------------------------------------------------------------------------
+
+- (NSArray*) runFoundationBenchmarks
+{
+	NSUInteger failureCount = _failures.count;
+	
+	// Every object moves and a tenth of them are replaced.
+	NSArray* oldObjects = benchmarkObjects( 10000, 0 );
+	NSArray* newObjects = benchmarkObjects( 10000, 1000 );
+	[ self measure: @"diff.10k" iterations: ASTBenchmarkDefaultIterations setUp: nil block: ^{
+		[ ASTDiff diffFromObjects: oldObjects toObjects: newObjects ];
+	} ];
+	
+	NSMutableArray* array = [ NSMutableArray arrayWithCapacity: 100000 ];
+	for( NSUInteger i = 0; i < 100000; ++i ) {
+		[ array addObject: @{ @"value" : @( ( i * 7919 ) % 100000 ) } ];
+	}
+	[ self measure: @"sortIndexesOfArray.100k" iterations: ASTBenchmarkDefaultIterations setUp: nil block: ^{
+		sortIndexesOfArray( array, @"value", SortAscending );
+	} ];
+	
+	NSArray* keyPaths = @[ @"name", @"count", @"ratio", @"child.name", @"child.count", @"-child.-setRatio:" ];
+	NSArray* values = @[ @"Name", @42, @0.5, @"Child", @7, @0.25 ];
+	NSMutableArray* manyKeyPaths = [ NSMutableArray arrayWithCapacity: 1000 ];
+	for( NSUInteger i = 0; i < 1000; ++i ) {
+		[ manyKeyPaths addObject: [ NSString stringWithFormat: @"child.child.key%lu", (unsigned long)i ] ];
+	}
+	[ self measure: @"keyPathSetterParsing.1k" iterations: ASTBenchmarkDefaultIterations setUp: nil block: ^{
+		for( NSString* keyPath in manyKeyPaths ) {
+			(void)[ [ ASTKeyPathSetter alloc ] initWithKeyPath: keyPath ];
+		}
+	} ];
+	
+	NSArray* objects = [ benchmarkObjects( 1000, 0 ) copy ];
+	[ self measure: @"keyPathSetterCached.1k" iterations: ASTBenchmarkDefaultIterations setUp: nil block: ^{
+		for( ASTBenchmarkObject* object in objects ) {
+			for( NSUInteger i = 0; i < keyPaths.count; ++i ) {
+				[ [ ASTKeyPathSetter setterForClass: [ object class ] keyPath: keyPaths[ i ] ]
+						setValue: values[ i ] forObject: object ];
+			}
+		}
+	} ];
+	
+	return [ _failures subarrayWithRange: NSMakeRange( failureCount, _failures.count - failureCount ) ];
+}
+
+//------------------------------------------------------------------------------
+
+@end
@@ -0,0 +1,85 @@
+//==============================================================================
+//
+//  ASTBenchmarkMain.m
+//
+//==============================================================================
+//
+//  Copyright (c) 2016 Adobe Systems Incorporated. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a
+//  copy of this software and associated documentation files (the "Software"),
+//  to deal in the Software without restriction, including without limitation
+//  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//  and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//
+//==============================================================================
+
+// Runs the benchmarks of the parts of the framework that only use Foundation
+// without a simulator or device. The ast-benchmarks target of AST.xcodeproj
+// builds it for macOS. On a build machine without Xcode it builds with clang:
+//
+//     clang -fobjc-arc -fblocks -I AST -o ast-benchmarks \
+//         Benchmarks/ASTBenchmarkMain.m Benchmarks/ASTBenchmark.m AST/ASTDiff.m \
+//         AST/ASTSorting.m AST/ASTKeyPathSetter.m -framework Foundation
+//
+// or with `$(gnustep-config --objc-flags --base-libs)` in place of
+// `-framework Foundation` with GNUstep. Then
+//
+//     ./ast-benchmarks [results.plist]
+//
+// prints the results and writes them to the path when given. When
+// AST_BENCHMARK_BASELINES is the path of results recorded on the same machine,
+// it compares the results with them and exits with 1 if any benchmark regressed
+// or has no baseline. AST_BENCHMARK_THRESHOLD overrides the threshold as it
+// does for the tests. The results are relative to the same calibration
+// workload as in the tests but a build machine is a different reference
+// configuration, so its baselines are recorded separately.
+
+#import <Foundation/Foundation.h>
+#import "ASTBenchmark.h"
+
+
+//------------------------------------------------------------------------------
+
+int main( int argc, const char* argv[] )
+{
+	@autoreleasepool {
+		if( argc > 2 ) {
+			fprintf( stderr, "usage: %s [results.plist]\n", argv[ 0 ] );
+			return 2;
+		}
+		
+		NSDictionary* environment = [ NSProcessInfo processInfo ].environment;
+		NSString* baselinesPath = environment[ @"AST_BENCHMARK_BASELINES" ];
+		NSDictionary* baselines = baselinesPath
+				? [ NSDictionary dictionaryWithContentsOfFile: baselinesPath ] : nil;
+		if( baselinesPath && baselines == nil ) {
+			fprintf( stderr, "no baselines at %s\n", baselinesPath.UTF8String );
+			return 2;
+		}
+		NSString* thresholdValue = environment[ @"AST_BENCHMARK_THRESHOLD" ];
+		ASTBenchmarkRunner* runner = [ [ ASTBenchmarkRunner alloc ] initWithBaselines: baselines
+				threshold: thresholdValue ? thresholdValue.doubleValue : ASTBenchmarkDefaultThreshold ];
+		NSArray* failures = [ runner runFoundationBenchmarks ];
+		
+		if( argc > 1 ) {
+			[ runner.results writeToFile: @(argv[ 1 ]) atomically: YES ];
+		}
+		for( NSString* failure in failures ) {
+			fprintf( stderr, "%s\n", failure.UTF8String );
+		}
+		return failures.count ? 1 : 0;
+	}
+}
@@ -0,0 +1,317 @@
+//==============================================================================
+//
+//  ASTBenchmarkTests.m
+//
+//==============================================================================
+//
+//  Copyright (c) 2016 Adobe Systems Incorporated. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a
+//  copy of this software and associated documentation files (the "Software"),
+//  to deal in the Software without restriction, including without limitation
+//  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//  and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//
+//==============================================================================
+
+#import <UIKit/UIKit.h>
+#import <XCTest/XCTest.h>
+#import "ASTBenchmark.h"
+#import "ASTItem.h"
+#import "ASTSection.h"
+#import "ASTViewController.h"
+
+
+// The benchmarks are built by the ASTBenchmarks target, apart from the unit
+// tests, and run with
+//
+//     xcodebuild test -project AST.xcodeproj -scheme ASTBenchmarks ...
+//
+// The environment variables below are passed to them with the TEST_RUNNER_
+// prefix. They are timed by ASTBenchmarkRunner. Setting AST_BENCHMARK_RESULTS to a path
+// writes the results there as a plist. The results are only compared when
+// AST_BENCHMARK_BASELINES is the path of such a plist recorded on the same
+// reference device. A benchmark then fails when its result exceeds its baseline
+// by more than the threshold, 25% unless AST_BENCHMARK_THRESHOLD says
+// otherwise, or when it has no baseline.
+
+static ASTBenchmarkRunner* benchmarkRunner;
+
+//------------------------------------------------------------------------------
+
+static NSString* environmentValue( NSString* name )
+{
+	return [ NSProcessInfo processInfo ].environment[ name ];
+}
+
+//------------------------------------------------------------------------------
+
+static NSArray* itemDicts( NSUInteger count, NSString* prefix )
+{
+	NSMutableArray* result = [ NSMutableArray arrayWithCapacity: count ];
+	for( NSUInteger i = 0; i < count; ++i ) {
+		[ result addObject: @{
+			AST_id : [ NSString stringWithFormat: @"%@%lu", prefix, (unsigned long)i ],
+			AST_cellStyle : @(UITableViewCellStyleValue1),
+			AST_cell_textLabel_text : [ NSString stringWithFormat: @"Row %lu", (unsigned long)i ],
+			AST_cell_detailTextLabel_text : @"Detail",
+			AST_cell_accessoryType : @(UITableViewCellAccessoryDisclosureIndicator),
+		} ];
+	}
+	return result;
+}
+
+//------------------------------------------------------------------------------
+
+// Data of sections of 1000 rows.
+
+static NSArray* tableData( NSUInteger numberOfRows )
+{
+	NSMutableArray* result = [ NSMutableArray array ];
+	for( NSUInteger row = 0; row < numberOfRows; row += 1000 ) {
+		NSString* prefix = [ NSString stringWithFormat: @"s%lu.", (unsigned long)result.count ];
+		[ result addObject: @{
+			AST_items : itemDicts( MIN( numberOfRows - row, 1000 ), prefix ),
+		} ];
+	}
+	return result;
+}
+
+//------------------------------------------------------------------------------
+
+static ASTViewController* viewControllerWithRows( NSUInteger numberOfRows )
+{
+	ASTViewController* vc = [ [ ASTViewController alloc ] init ];
+	vc.tableView.frame = CGRectMake( 0, 0, 320, 480 );
+	vc.data = tableData( numberOfRows );
+	return vc;
+}
+
+//------------------------------------------------------------------------------
+
+// Index paths spread evenly over a table of sections of 1000 rows.
+
+static NSArray* spreadIndexPaths( NSUInteger count, NSUInteger numberOfRows )
+{
+	NSMutableArray* result = [ NSMutableArray arrayWithCapacity: count ];
+	NSUInteger step = numberOfRows / count;
+	for( NSUInteger i = 0; i < count; ++i ) {
+		NSUInteger row = i * step;
+		[ result addObject: [ NSIndexPath indexPathForRow: row % 1000 inSection: row / 1000 ] ];
+	}
+	return result;
+}
+
+//------------------------------------------------------------------------------
+
+@interface ASTBenchmarkTests : XCTestCase
+
+@end
+
+//------------------------------------------------------------------------------
+
+@implementation ASTBenchmarkTests
+
+//------------------------------------------------------------------------------
+
++ (void) setUp
+{
+	[ super setUp ];
+	NSString* baselinesPath = environmentValue( @"AST_BENCHMARK_BASELINES" );
+	NSDictionary* baselines = baselinesPath
+			? [ NSDictionary dictionaryWithContentsOfFile: baselinesPath ] : nil;
+	NSAssert( baselinesPath == nil || baselines, @"No baselines at %@", baselinesPath );
+	NSString* thresholdValue = environmentValue( @"AST_BENCHMARK_THRESHOLD" );
+	benchmarkRunner = [ [ ASTBenchmarkRunner alloc ] initWithBaselines: baselines
+			threshold: thresholdValue ? thresholdValue.doubleValue : ASTBenchmarkDefaultThreshold ];
+}
+
+//------------------------------------------------------------------------------
+
++ (void) tearDown
+{
+	NSString* resultsPath = environmentValue( @"AST_BENCHMARK_RESULTS" );
+	if( resultsPath && benchmarkRunner.results.count ) {
+		[ benchmarkRunner.results writeToFile: resultsPath atomically: YES ];
+	}
+	benchmarkRunner = nil;
+	[ super tearDown ];
+}
+
+//------------------------------------------------------------------------------
+
+- (void) setUp
+{
+	[ super setUp ];
+	self.continueAfterFailure = NO;
+}
+
+//------------------------------------------------------------------------------
+
+- (void) benchmark: (NSString*) name iterations: (NSUInteger) iterations
+		setUp: (void (^ __nullable)( void )) setUp block: (void (^)( void )) block
+{
+	NSString* failure = [ benchmarkRunner measure: name iterations: iterations
+			setUp: setUp block: block ];
+	XCTAssertNil( failure, @"%@", failure );
+}
+
+//------------------------------------------------------------------------------
+
+- (void) benchmark: (NSString*) name block: (void (^)( void )) block
+{
+	[ self benchmark: name iterations: ASTBenchmarkDefaultIterations setUp: nil block: block ];
+}
+
+//------------------------------------------------------------------------------
+
+- (void) testItemsWithDicts
+{
+	NSArray* dicts = itemDicts( 10000, @"item" );
+	[ self benchmark: @"itemsWithDicts.10k" block: ^{
+		for( NSDictionary* dict in dicts ) {
+			[ ASTItem itemWithDict: dict ];
+		}
+	} ];
+}
+
+//------------------------------------------------------------------------------
+
+- (void) testSetData
+{
+	for( NSNumber* numberOfRows in @[ @1000, @10000, @100000 ] ) {
+		NSArray* data = tableData( numberOfRows.unsignedIntegerValue );
+		__block ASTViewController* vc = nil;
+		NSString* name = [ NSString stringWithFormat: @"setData.%luk",
+				(unsigned long)numberOfRows.unsignedIntegerValue / 1000 ];
+		[ self benchmark: name iterations: ASTBenchmarkDefaultIterations setUp: ^{
+			vc = [ [ ASTViewController alloc ] init ];
+			vc.tableView.frame = CGRectMake( 0, 0, 320, 480 );
+		} block: ^{
+			vc.data = data;
+		} ];
+	}
+}
+
+//------------------------------------------------------------------------------
+
+- (void) testLookups
+{
+	ASTViewController* vc = viewControllerWithRows( 10000 );
+	NSMutableArray* identifiers = [ NSMutableArray array ];
+	NSMutableArray* items = [ NSMutableArray array ];
+	for( NSIndexPath* indexPath in spreadIndexPaths( 1000, 10000 ) ) {
+		ASTItem* item = [ vc itemAtIndexPath: indexPath ];
+		[ identifiers addObject: item.identifier ];
+		[ items addObject: item ];
+	}
+	
+	[ self benchmark: @"itemWithIdentifier.10k" block: ^{
+		for( NSString* identifier in identifiers ) {
+			[ vc itemWithIdentifier: identifier ];
+		}
+	} ];
+	[ self benchmark: @"itemAtIndexPath.10k" block: ^{
+		for( NSIndexPath* indexPath in spreadIndexPaths( 1000, 10000 ) ) {
+			[ vc itemAtIndexPath: indexPath ];
+		}
+	} ];
+	[ self benchmark: @"indexPathForItem.10k" block: ^{
+		for( ASTItem* item in items ) {
+			[ vc indexPathForItem: item ];
+		}
+	} ];
+}
+
+//------------------------------------------------------------------------------
+
+- (void) testBatchUpdates
+{
+	__block ASTViewController* vc = nil;
+	void (^setUp)( void ) = ^{
+		vc = viewControllerWithRows( 10000 );
+	};
+	
+	// The index paths are in reverse order so that each one still refers to
+	// the row it was chosen for after the previous changes of the batch.
+	NSArray* indexPaths = spreadIndexPaths( 1000, 10000 ).reverseObjectEnumerator.allObjects;
+	NSMutableArray* newItems = [ NSMutableArray arrayWithCapacity: indexPaths.count ];
+	for( NSUInteger i = 0; i < indexPaths.count; ++i ) {
+		[ newItems addObject: itemDicts( 1, [ NSString stringWithFormat: @"new%lu.", (unsigned long)i ] )[ 0 ] ];
+	}
+	
+	[ self benchmark: @"batchInsert.1k" iterations: ASTBenchmarkDefaultIterations setUp: setUp block: ^{
+		[ vc performBatchUpdates: ^{
+			[ vc insertItems: newItems atIndexPaths: indexPaths
+					withRowAnimation: UITableViewRowAnimationNone ];
+		} withRowAnimation: UITableViewRowAnimationNone ];
+	} ];
+	[ self benchmark: @"batchRemove.1k" iterations: ASTBenchmarkDefaultIterations setUp: setUp block: ^{
+		[ vc performBatchUpdates: ^{
+			[ vc removeItemsAtIndexPaths: indexPaths
+					withRowAnimation: UITableViewRowAnimationNone ];
+		} withRowAnimation: UITableViewRowAnimationNone ];
+	} ];
+	[ self benchmark: @"batchMove.100" iterations: ASTBenchmarkDefaultIterations setUp: setUp block: ^{
+		[ vc performBatchUpdates: ^{
+			for( NSUInteger i = 0; i < 100; ++i ) {
+				[ vc moveItemWithAnimationAtIndexPath: indexPaths[ i ]
+						toIndexPath: indexPaths[ indexPaths.count - 1 - i ] ];
+			}
+		} withRowAnimation: UITableViewRowAnimationNone ];
+	} ];
+}
+
+//------------------------------------------------------------------------------
+
+// ASTDiff, sortIndexesOfArray and ASTKeyPathSetter, which only use Foundation
+// and also run headless with Benchmarks/ASTBenchmarkMain.m.
+
+- (void) testFoundationBenchmarks
+{
+	NSArray* failures = [ benchmarkRunner runFoundationBenchmarks ];
+	XCTAssertEqual( failures.count, 0, @"%@", [ failures componentsJoinedByString: @"\n" ] );
+}
+
+//------------------------------------------------------------------------------
+
+- (void) testCellPropertyKeyPaths
+{
+	// Half of the items have a loaded cell that the properties are applied to.
+	ASTViewController* vc = viewControllerWithRows( 1000 );
+	NSMutableArray* items = [ NSMutableArray array ];
+	for( NSIndexPath* indexPath in spreadIndexPaths( 200, 1000 ) ) {
+		ASTItem* item = [ vc itemAtIndexPath: indexPath ];
+		if( items.count % 2 ) {
+			[ vc tableView: vc.tableView cellForRowAtIndexPath: indexPath ];
+		}
+		[ items addObject: item ];
+	}
+	
+	__block NSUInteger iteration = 0;
+	[ self benchmark: @"cellPropertyKeyPaths.200" block: ^{
+		NSString* text = [ NSString stringWithFormat: @"Text %lu", (unsigned long)++iteration ];
+		for( ASTItem* item in items ) {
+			[ item setValue: text forKeyPath: AST_cell_textLabel_text ];
+			[ item setValue: text forKeyPath: AST_cell_detailTextLabel_text ];
+			[ item setValue: @(UITableViewCellAccessoryCheckmark) forKeyPath: AST_cell_accessoryType ];
+			[ item setValue: [ UIColor redColor ] forKeyPath: AST_cell_textLabel_textColor ];
+		}
+	} ];
+}
+
+//------------------------------------------------------------------------------
+
+@end
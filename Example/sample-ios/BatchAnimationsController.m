@@ -143,7 +143,7 @@ static NSArray* randomIndexes( u_int32_t count, u_int32_t range)
 		[ pathsToDelete addObject: [ NSIndexPath indexPathForRow: row inSection: 0 ] ];
 	}
 	
-	[ self.tableView performUpdates: ^{
+	[ self performBatchUpdates: ^{
 		[ self removeItemsAtIndexPaths: pathsToDelete
 				withRowAnimation: UITableViewRowAnimationAutomatic ];
 	} ];
@@ -177,7 +177,7 @@ static NSArray* randomIndexes( u_int32_t count, u_int32_t range)
 		} ];
 	}
 	
-	[ self.tableView performUpdates: ^{
+	[ self performBatchUpdates: ^{
 		[ self insertItems: itemsToAdd atIndexPaths: pathsToAdd
 				withRowAnimation: UITableViewRowAnimationAutomatic ];
 	} ];
@@ -206,7 +206,7 @@ static NSArray* randomIndexes( u_int32_t count, u_int32_t range)
 	NSIndexPath* sourcePath = [ NSIndexPath indexPathForRow: sourceRow inSection: 0 ];
 	NSIndexPath* destPath = [ NSIndexPath indexPathForRow: destRow inSection: 0 ];
 	
-	[ self.tableView performUpdates: ^{
+	[ self performBatchUpdates: ^{
 		[ self moveItemWithAnimationAtIndexPath: sourcePath toIndexPath: destPath ];
 	} ];
 }
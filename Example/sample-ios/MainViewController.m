@@ -409,6 +409,7 @@
 	ASTViewController* bigExample = [ [ ASTViewController alloc ]
 			initWithStyle: UITableViewStyleGrouped ];
 	bigExample.title = item.cell.textLabel.text;
+	bigExample.reusesCells = YES;
 	
 	[ bigExample.tableView registerClass: [ BigTestCell class ] forCellReuseIdentifier: @"bigcell" ];
 	
@@ -417,11 +418,15 @@
 	NSUInteger sectionCount = ceil( (double)rowCount / (double)sectionRowCount );
 	NSMutableArray* bigData = [ NSMutableArray arrayWithCapacity: sectionCount ];
 	
+	// The rows only differ in their text, so they share the rest.
+	ASTItemTemplate* itemTemplate = [ ASTItemTemplate templateWithDict: @{
+		AST_cellReuseIdentifier : @"bigcell",
+	} ];
 	NSMutableArray* sectionItems = [ NSMutableArray array ];
 	for( NSUInteger row = 0 ; row < rowCount; ++row ) {
 		NSString* itemText = [ NSString stringWithFormat: @"Item %ld", (unsigned long)row ];
 		ASTItem* item = [ ASTItem itemWithDict: @{
-			AST_cellReuseIdentifier : @"bigcell",
+			AST_template : itemTemplate,
 			AST_cell_textLabel_text : itemText,
 		} ];
 		